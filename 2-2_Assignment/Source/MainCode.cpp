@@ -9,6 +9,7 @@
 
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -22,6 +23,7 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "GoldenPoseRenderer.h"
 
 // Namespace for declaring global variables
 namespace
@@ -38,6 +40,12 @@ namespace
 	ShaderManager* g_ShaderManager = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+	// directory of the golden images the frames from its poses
+	// are checked against, and whether they are replaced
+	const char* g_GoldenDirectory = nullptr;
+	bool g_bGoldenUpdate = false;
+	// name the golden images and poses of this scene start with
+	const char* const GOLDEN_NAME = "2-2_Assignment";
 }
 
 // Function declarations - all functions that are called manually
@@ -54,12 +62,36 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	int exitCode = EXIT_SUCCESS;
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
 		return(EXIT_FAILURE);
 	}
 
+	// process the command line options
+	for (int i = 1; i < argc; i++)
+	{
+		// check the frames from the poses in a directory against
+		// its golden images
+		if ((strcmp(argv[i], "--golden") == 0) && (i + 1 < argc))
+		{
+			g_GoldenDirectory = argv[++i];
+		}
+		// replace the golden images with the new frames
+		else if (strcmp(argv[i], "--golden-update") == 0)
+		{
+			g_bGoldenUpdate = true;
+		}
+	}
+	// checking the golden image only needs the OpenGL context,
+	// so the window is never shown
+	if (nullptr != g_GoldenDirectory)
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
+
 	// try to create a new shader manager object
 	g_ShaderManager = new ShaderManager();
 	// try to create a new view manager object
@@ -85,6 +117,30 @@ int main(int argc, char* argv[])
 	g_SceneManager = new SceneManager(g_ShaderManager);
 	g_SceneManager->PrepareScene();
 
+	// draw the scene offscreen from each of its golden poses,
+	// check the frames against the golden images and exit
+	// without entering the loop
+	if (nullptr != g_GoldenDirectory)
+	{
+		GoldenPoseRenderer goldenRenderer;
+		int width = 0;
+		int height = 0;
+
+		glfwGetWindowSize(g_Window, &width, &height);
+		if ((goldenRenderer.Initialize(width, height) == false) ||
+			(goldenRenderer.CheckPoses(g_GoldenDirectory, GOLDEN_NAME, g_bGoldenUpdate,
+				[](const CameraPath::CAMERA_KEYFRAME& pose)
+				{
+					g_ViewManager->SetCameraPose(pose.position, pose.front, pose.zoom);
+					g_ViewManager->PrepareSceneView();
+					g_SceneManager->RenderScene();
+				}) == false))
+		{
+			exitCode = EXIT_FAILURE;
+		}
+		glfwSetWindowShouldClose(g_Window, GLFW_TRUE);
+	}
+
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
 	while (!glfwWindowShouldClose(g_Window))
@@ -128,7 +184,7 @@ int main(int argc, char* argv[])
 	}
 
 	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
+	exit(exitCode);
 }
 
 /***********************************************************
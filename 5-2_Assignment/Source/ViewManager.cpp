@@ -224,4 +224,19 @@ void ViewManager::PrepareSceneView()
 		// set the view position of the camera into the shader for proper rendering
 		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
 	}
+}
+/***********************************************************
+ *  SetCameraPose()
+ *
+ *  This method is used for placing the camera, as when the
+ *  golden images are checked from fixed poses.
+ ***********************************************************/
+void ViewManager::SetCameraPose(
+	const glm::vec3& position,
+	const glm::vec3& front,
+	float zoom)
+{
+	g_pCamera->Position = position;
+	g_pCamera->Front = front;
+	g_pCamera->Zoom = zoom;
 }
\ No newline at end of file
@@ -42,4 +42,9 @@ public:
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+	// place the camera
+	void SetCameraPose(
+		const glm::vec3& position,
+		const glm::vec3& front,
+		float zoom);
 };
\ No newline at end of file
@@ -7,175 +7,12 @@
 #include <vector>
 #include <windows.h>
 #include <time.h>
+#include "BrickWorld.h"
 
 using namespace std;
 
-const float DEG2RAD = 3.14159 / 180;
-
 void processInput(GLFWwindow* window);
 
-enum BRICKTYPE { REFLECTIVE, DESTRUCTABLE };
-enum ONOFF { ON, OFF };
-
-class Brick
-{
-public:
-	float red, green, blue;
-	float x, y, width;
-	int health; //brick health
-	BRICKTYPE brick_type;
-	ONOFF onoff;
-
-	Brick(BRICKTYPE bt, float xx, float yy, float ww, float rr, float gg, float bb)
-	{
-		brick_type = bt; x = xx; y = yy, width = ww; red = rr, green = gg, blue = bb;
-		onoff = ON;
-		health = 10;
-	};
-
-	void drawBrick()
-	{
-		if (onoff == ON)
-		{
-			double halfside = width / 2;
-
-			glColor3d(red, green, blue);
-			glBegin(GL_POLYGON);
-
-			glVertex2d(x + halfside, y + halfside);
-			glVertex2d(x + halfside, y - halfside);
-			glVertex2d(x - halfside, y - halfside);
-			glVertex2d(x - halfside, y + halfside);
-
-			glEnd();
-		}
-	}
-};
-
-
-class Circle
-{
-public:
-	float red, green, blue;
-	float radius;
-	float x;
-	float y;
-	float speed = 0.01;
-	int health;
-	int direction; // 1=up 2=right 3=down 4=left 5 = up right   6 = up left  7 = down right  8= down left
-	ONOFF onoff;
-	
-
-	Circle(double xx, double yy, double rr, int dir, float rad, float r, float g, float b)
-	{
-		x = xx;
-		y = yy;
-		radius = rr;
-		red = r;
-		green = g;
-		blue = b;
-		radius = rad;
-		direction = dir;
-		onoff = ON;
-		health = 2;
-	}
-
-	void CheckCollision(Brick* brk)
-	{
-		if (brk->brick_type == REFLECTIVE)
-		{
-			if ((x > brk->x - brk->width && x <= brk->x + brk->width) && (y > brk->y - brk->width && y <= brk->y + brk->width))
-			{
-				direction = GetRandomDirection();
-				x = x + 0.03;
-				y = y + 0.04;
-			}
-		}
-		else if (brk->brick_type == DESTRUCTABLE && brk->onoff == ON && brk->health>0 && onoff == ON)
-		{
-			if ((x > brk->x - brk->width && x <= brk->x + brk->width) && (y > brk->y - brk->width && y <= brk->y + brk->width))
-			{
-				brk->health--;
-				if (brk->health <= 0) //check brick health
-				{
-					brk->onoff = OFF;
-				}
-				direction = GetRandomDirection();
-				x = x + 0.03;
-				y = y + 0.04;
-			}
-		}
-	}
-
-	int GetRandomDirection()
-	{
-		return (rand() % 8) + 1;
-	}
-
-	void MoveOneStep()
-	{
-		
-		if (direction == 1 || direction == 5 || direction == 6)  // up
-		{
-			if (y > -1 + radius)
-			{
-				y -= speed;
-			}
-			else
-			{
-				direction = GetRandomDirection();
-			}
-		}
-
-		if (direction == 2 || direction == 5 || direction == 7)  // right
-		{
-			if (x < 1 - radius)
-			{
-				x += speed;
-			}
-			else
-			{
-				direction = GetRandomDirection();
-			}
-		}
-
-		if (direction == 3 || direction == 7 || direction == 8)  // down
-		{
-			if (y < 1 - radius) {
-				y += speed;
-			}
-			else
-			{
-				direction = GetRandomDirection();
-			}
-		}
-
-		if (direction == 4 || direction == 6 || direction == 8)  // left
-		{
-			if (x > -1 + radius) {
-				x -= speed;
-			}
-			else
-			{
-				direction = GetRandomDirection();
-			}
-		}
-	}
-
-	void DrawCircle()
-	{
-		
-			glColor3f(red, green, blue);
-			glBegin(GL_POLYGON);
-			for (int i = 0; i < 360; i++) {
-				float degInRad = i * DEG2RAD;
-				glVertex2f((cos(degInRad) * radius) + x, (sin(degInRad) * radius) + y);
-			}
-			glEnd();
-		}
-};
-
-
 vector<Circle> world;
 
 
@@ -0,0 +1,338 @@
+///////////////////////////////////////////////////////////////////////////////
+// animationsystem.cpp
+// ============
+// keyframed tracks evaluated in batches with SIMD into the transform store
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AnimationSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define ANIMATION_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+// declaration of the global variables and defines
+namespace
+{
+	const glm::vec4 IDENTITY_ROTATION = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+#ifndef ANIMATION_USE_SSE
+	/***********************************************************
+	 *  CorrectSlerpFactor()
+	 *
+	 *  This function is used for bending the blend factor of a
+	 *  normalized straight line blend so it follows the even
+	 *  angular speed of a true slerp, from the absolute cosine
+	 *  of the angle between the rotations.  It avoids the
+	 *  inverse cosine and sines of the exact formula.
+	 ***********************************************************/
+	float CorrectSlerpFactor(float factor, float cosine)
+	{
+		float A = 1.0904f + cosine * (-3.2452f + cosine * (3.55645f - cosine * 1.43519f));
+		float B = 0.848013f + cosine * (-1.06021f + cosine * 0.215638f);
+		float centered = factor - 0.5f;
+		float k = A * centered * centered + B;
+		return(factor + factor * centered * (factor - 1.0f) * k);
+	}
+#endif
+}
+
+/***********************************************************
+ *  AnimationSystem()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AnimationSystem::AnimationSystem(TransformStore* pTransforms)
+{
+	m_pTransforms = pTransforms;
+}
+
+/***********************************************************
+ *  ~AnimationSystem()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AnimationSystem::~AnimationSystem()
+{
+	m_tracks.clear();
+	m_pTransforms = NULL;
+}
+
+/***********************************************************
+ *  AddTrack()
+ *
+ *  This method is used for adding an empty track that drives
+ *  one channel of a node.  Looping tracks repeat from their
+ *  first key after the last, the others hold the end keys.
+ ***********************************************************/
+int AnimationSystem::AddTrack(int node, TransformStore::TRANSFORM_CHANNEL channel, bool bLoop)
+{
+	ANIMATION_TRACK track;
+	track.node = node;
+	track.channel = channel;
+	track.bLoop = bLoop;
+	track.cursor = 0;
+
+	m_tracks.push_back(track);
+	m_channelTracks[channel].push_back((int)m_tracks.size() - 1);
+	return((int)m_tracks.size() - 1);
+}
+
+/***********************************************************
+ *  AddKeyframe()
+ *
+ *  This method is used for adding a key at the end of a
+ *  track.
+ ***********************************************************/
+void AnimationSystem::AddKeyframe(int track, float time, const glm::vec4& value)
+{
+	m_tracks[track].times.push_back(time);
+	m_tracks[track].values.push_back(value);
+}
+
+/***********************************************************
+ *  AxisAngle()
+ *
+ *  This method is used for building the quaternion that
+ *  rotates around an axis by the passed in degrees.
+ ***********************************************************/
+glm::vec4 AnimationSystem::AxisAngle(const glm::vec3& axis, float degrees)
+{
+	float halfAngle = glm::radians(degrees) * 0.5f;
+	glm::vec3 unitAxis = glm::normalize(axis);
+	float sine = std::sin(halfAngle);
+
+	return(glm::vec4(unitAxis.x * sine, unitAxis.y * sine, unitAxis.z * sine, std::cos(halfAngle)));
+}
+
+/***********************************************************
+ *  Evaluate()
+ *
+ *  This method is used for evaluating every track at a time
+ *  in seconds, one channel at a time.  The keys of all of the
+ *  tracks in the channel are gathered side by side, blended
+ *  together, and the results are written into the transform
+ *  store.  Nodes without tracks are never touched.
+ ***********************************************************/
+void AnimationSystem::Evaluate(float time)
+{
+	for (int channel = 0; channel < TransformStore::CHANNEL_COUNT; channel++)
+	{
+		const std::vector<int>& channelTracks = m_channelTracks[channel];
+		// room for a whole group of four past the last track
+		int capacity = ((int)channelTracks.size() + 3) & ~3;
+		int count = 0;
+
+		m_slotTracks.resize(capacity);
+		m_fromValues.resize(capacity);
+		m_toValues.resize(capacity);
+		m_factors.resize(capacity);
+		m_results.resize(capacity);
+
+		for (int i = 0; i < (int)channelTracks.size(); i++)
+		{
+			if (m_tracks[channelTracks[i]].times.size() > 0)
+			{
+				FindKeys(m_tracks[channelTracks[i]], time, count);
+				m_slotTracks[count] = channelTracks[i];
+				count++;
+			}
+		}
+		if (count == 0)
+		{
+			continue;
+		}
+
+		if (channel == TransformStore::CHANNEL_ROTATION)
+		{
+			SlerpTracks(count);
+		}
+		else
+		{
+			LerpTracks(count);
+		}
+
+		float* components[4];
+		for (int component = 0; component < 4; component++)
+		{
+			components[component] = m_pTransforms->GetComponent((TransformStore::TRANSFORM_CHANNEL)channel, component);
+		}
+		for (int slot = 0; slot < count; slot++)
+		{
+			int node = m_tracks[m_slotTracks[slot]].node;
+			components[0][node] = m_results[slot].x;
+			components[1][node] = m_results[slot].y;
+			components[2][node] = m_results[slot].z;
+			components[3][node] = m_results[slot].w;
+			m_pTransforms->MarkDirty(node);
+		}
+	}
+}
+
+/***********************************************************
+ *  FindKeys()
+ *
+ *  This method is used for finding the two keys around a
+ *  time and how far between them it is.  The search starts
+ *  from the key found last time, so a track played forward
+ *  only steps past the keys it has crossed since the last
+ *  frame and only restarts from the first key after looping.
+ ***********************************************************/
+void AnimationSystem::FindKeys(ANIMATION_TRACK& track, float time, int slot)
+{
+	int keyCount = (int)track.times.size();
+	float startTime = track.times[0];
+	float endTime = track.times[keyCount - 1];
+	float duration = endTime - startTime;
+	float localTime = time;
+
+	if ((track.bLoop == true) && (duration > 0.0f))
+	{
+		localTime = startTime + std::fmod(time - startTime, duration);
+		if (localTime < startTime)
+		{
+			localTime += duration;
+		}
+	}
+	else
+	{
+		localTime = std::min(std::max(time, startTime), endTime);
+	}
+
+	if (localTime < track.times[track.cursor])
+	{
+		track.cursor = 0;
+	}
+	while ((track.cursor + 1 < keyCount) && (localTime >= track.times[track.cursor + 1]))
+	{
+		track.cursor++;
+	}
+
+	int next = std::min(track.cursor + 1, keyCount - 1);
+	float span = track.times[next] - track.times[track.cursor];
+
+	m_fromValues[slot] = track.values[track.cursor];
+	m_toValues[slot] = track.values[next];
+	m_factors[slot] = (span > 0.0f) ? (localTime - track.times[track.cursor]) / span : 0.0f;
+}
+
+/***********************************************************
+ *  LerpTracks()
+ *
+ *  This method is used for blending the gathered keys in a
+ *  straight line, all four components of a track at once.
+ ***********************************************************/
+void AnimationSystem::LerpTracks(int count)
+{
+	for (int slot = 0; slot < count; slot++)
+	{
+#ifdef ANIMATION_USE_SSE
+		__m128 from = _mm_loadu_ps(&m_fromValues[slot].x);
+		__m128 to = _mm_loadu_ps(&m_toValues[slot].x);
+		__m128 factor = _mm_set1_ps(m_factors[slot]);
+		_mm_storeu_ps(&m_results[slot].x, _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from), factor)));
+#else
+		m_results[slot] = m_fromValues[slot] + (m_toValues[slot] - m_fromValues[slot]) * m_factors[slot];
+#endif
+	}
+}
+
+/***********************************************************
+ *  SlerpTracks()
+ *
+ *  This method is used for blending the gathered rotations
+ *  along the shorter arc.  Four tracks are blended at a time
+ *  after transposing their quaternions so each register holds
+ *  one component of all four, using a corrected normalized
+ *  blend in place of the exact slerp.
+ ***********************************************************/
+void AnimationSystem::SlerpTracks(int count)
+{
+	// the unused slots of the last group blend identities
+	for (int slot = count; slot < ((count + 3) & ~3); slot++)
+	{
+		m_fromValues[slot] = IDENTITY_ROTATION;
+		m_toValues[slot] = IDENTITY_ROTATION;
+		m_factors[slot] = 0.0f;
+	}
+
+#ifdef ANIMATION_USE_SSE
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	for (int slot = 0; slot < count; slot += 4)
+	{
+		__m128 fromX = _mm_loadu_ps(&m_fromValues[slot].x);
+		__m128 fromY = _mm_loadu_ps(&m_fromValues[slot + 1].x);
+		__m128 fromZ = _mm_loadu_ps(&m_fromValues[slot + 2].x);
+		__m128 fromW = _mm_loadu_ps(&m_fromValues[slot + 3].x);
+		__m128 toX = _mm_loadu_ps(&m_toValues[slot].x);
+		__m128 toY = _mm_loadu_ps(&m_toValues[slot + 1].x);
+		__m128 toZ = _mm_loadu_ps(&m_toValues[slot + 2].x);
+		__m128 toW = _mm_loadu_ps(&m_toValues[slot + 3].x);
+		_MM_TRANSPOSE4_PS(fromX, fromY, fromZ, fromW);
+		_MM_TRANSPOSE4_PS(toX, toY, toZ, toW);
+		__m128 factor = _mm_loadu_ps(&m_factors[slot]);
+
+		// flip the end rotation onto the same side as the start
+		__m128 cosine = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(fromX, toX), _mm_mul_ps(fromY, toY)),
+			_mm_add_ps(_mm_mul_ps(fromZ, toZ), _mm_mul_ps(fromW, toW)));
+		__m128 sign = _mm_and_ps(cosine, signMask);
+		toX = _mm_xor_ps(toX, sign);
+		toY = _mm_xor_ps(toY, sign);
+		toZ = _mm_xor_ps(toZ, sign);
+		toW = _mm_xor_ps(toW, sign);
+		cosine = _mm_andnot_ps(signMask, cosine);
+
+		// bend the factor to the even angular speed of a slerp
+		__m128 A = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(cosine,
+			_mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(cosine,
+			_mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(cosine, _mm_set1_ps(1.43519f)))))));
+		__m128 B = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(cosine,
+			_mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(cosine, _mm_set1_ps(0.215638f)))));
+		__m128 centered = _mm_sub_ps(factor, half);
+		__m128 k = _mm_add_ps(_mm_mul_ps(A, _mm_mul_ps(centered, centered)), B);
+		factor = _mm_add_ps(factor, _mm_mul_ps(_mm_mul_ps(factor, centered), _mm_mul_ps(_mm_sub_ps(factor, one), k)));
+
+		__m128 resultX = _mm_add_ps(fromX, _mm_mul_ps(_mm_sub_ps(toX, fromX), factor));
+		__m128 resultY = _mm_add_ps(fromY, _mm_mul_ps(_mm_sub_ps(toY, fromY), factor));
+		__m128 resultZ = _mm_add_ps(fromZ, _mm_mul_ps(_mm_sub_ps(toZ, fromZ), factor));
+		__m128 resultW = _mm_add_ps(fromW, _mm_mul_ps(_mm_sub_ps(toW, fromW), factor));
+		__m128 length = _mm_sqrt_ps(_mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(resultX, resultX), _mm_mul_ps(resultY, resultY)),
+			_mm_add_ps(_mm_mul_ps(resultZ, resultZ), _mm_mul_ps(resultW, resultW))));
+		__m128 inverseLength = _mm_div_ps(one, length);
+		resultX = _mm_mul_ps(resultX, inverseLength);
+		resultY = _mm_mul_ps(resultY, inverseLength);
+		resultZ = _mm_mul_ps(resultZ, inverseLength);
+		resultW = _mm_mul_ps(resultW, inverseLength);
+
+		_MM_TRANSPOSE4_PS(resultX, resultY, resultZ, resultW);
+		_mm_storeu_ps(&m_results[slot].x, resultX);
+		_mm_storeu_ps(&m_results[slot + 1].x, resultY);
+		_mm_storeu_ps(&m_results[slot + 2].x, resultZ);
+		_mm_storeu_ps(&m_results[slot + 3].x, resultW);
+	}
+#else
+	for (int slot = 0; slot < count; slot++)
+	{
+		glm::vec4 from = m_fromValues[slot];
+		glm::vec4 to = m_toValues[slot];
+		float cosine = glm::dot(from, to);
+
+		if (cosine < 0.0f)
+		{
+			to = to * -1.0f;
+			cosine = -cosine;
+		}
+		float factor = CorrectSlerpFactor(m_factors[slot], cosine);
+		m_results[slot] = glm::normalize(from + (to - from) * factor);
+	}
+#endif
+}
@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////
+// animationsystem.h
+// ============
+// keyframed tracks evaluated in batches with SIMD into the transform store
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TransformStore.h"
+
+#include <vector>
+
+/***********************************************************
+ *  AnimationSystem
+ *
+ *  This class contains the code for playing keyframed tracks
+ *  on the nodes of a transform store.  Each track drives one
+ *  channel of one node.  Evaluation runs over all of the
+ *  tracks of a channel together - first finding the two keys
+ *  around the time from a cached cursor, then blending every
+ *  track with SSE, then writing the results into the store
+ *  and flagging only those nodes as dirty.
+ ***********************************************************/
+class AnimationSystem
+{
+public:
+	// constructor
+	AnimationSystem(TransformStore* pTransforms);
+	// destructor
+	~AnimationSystem();
+
+	// add a track driving a channel of a node, returning its index
+	int AddTrack(int node, TransformStore::TRANSFORM_CHANNEL channel, bool bLoop);
+	// add a key to a track - keys must be added in time order,
+	// rotations are quaternions stored as x, y, z, w
+	void AddKeyframe(int track, float time, const glm::vec4& value);
+
+	// evaluate every track at a time in seconds
+	void Evaluate(float time);
+
+	// get the quaternion rotating around an axis by degrees
+	static glm::vec4 AxisAngle(const glm::vec3& axis, float degrees);
+
+private:
+	struct ANIMATION_TRACK
+	{
+		int node;
+		TransformStore::TRANSFORM_CHANNEL channel;
+		bool bLoop;
+		std::vector<float> times;
+		std::vector<glm::vec4> values;
+		// key at or before the last evaluated time
+		int cursor;
+	};
+
+	// pointer to the transforms written by the tracks
+	TransformStore* m_pTransforms;
+	// every track, and the tracks of each channel by index
+	std::vector<ANIMATION_TRACK> m_tracks;
+	std::vector<int> m_channelTracks[TransformStore::CHANNEL_COUNT];
+	// track gathered into each slot of the arrays below
+	std::vector<int> m_slotTracks;
+	// keys around the time and blend factor of each track in
+	// the channel being evaluated, then the blended values
+	std::vector<glm::vec4> m_fromValues;
+	std::vector<glm::vec4> m_toValues;
+	std::vector<float> m_factors;
+	std::vector<glm::vec4> m_results;
+
+	// find the keys around the time for a track
+	void FindKeys(ANIMATION_TRACK& track, float time, int slot);
+	// blend the keys of the gathered tracks in a straight line
+	void LerpTracks(int count);
+	// blend the gathered rotations along the sphere
+	void SlerpTracks(int count);
+};
@@ -0,0 +1,296 @@
+///////////////////////////////////////////////////////////////////////////////
+// batchrenderer.cpp
+// ============
+// render a camera path offscreen into an image sequence as fast as possible
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BatchRenderer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+/***********************************************************
+ *  BatchRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BatchRenderer::BatchRenderer(
+	SceneManager* pSceneManager,
+	ViewManager* pViewManager,
+	GLStateCache* pStateCache)
+{
+	m_pSceneManager = pSceneManager;
+	m_pViewManager = pViewManager;
+	m_pStateCache = pStateCache;
+	m_framebufferID = 0;
+	m_colorBufferID = 0;
+	m_depthBufferID = 0;
+	m_width = 0;
+	m_height = 0;
+	m_framesPerSecond = 0.0;
+}
+
+/***********************************************************
+ *  ~BatchRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+BatchRenderer::~BatchRenderer()
+{
+	GLuint renderbuffers[] = { m_colorBufferID, m_depthBufferID };
+
+	glDeleteRenderbuffers(2, renderbuffers);
+	glDeleteFramebuffers(1, &m_framebufferID);
+
+	m_pSceneManager = NULL;
+	m_pViewManager = NULL;
+	m_pStateCache = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the offscreen frame
+ *  buffer the frames are drawn into and read back from.
+ ***********************************************************/
+bool BatchRenderer::Initialize(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+
+	glGenRenderbuffers(1, &m_colorBufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glGenRenderbuffers(1, &m_depthBufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_framebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBufferID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBufferID);
+
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	if (bComplete == false)
+	{
+		std::cout << "Batch render frame buffer is incomplete" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	return(bComplete);
+}
+
+/***********************************************************
+ *  Render()
+ *
+ *  This method is used for rendering frames spread evenly
+ *  from the start to the end of the path.  The scene is
+ *  queued and drawn exactly as in the window, then handed to
+ *  the frame capture, which only waits when the GPU falls a
+ *  whole ring of frames behind.
+ ***********************************************************/
+bool BatchRenderer::Render(
+	const CameraPath& path,
+	int frameCount,
+	const std::string& filePrefix,
+	FrameCapture::IMAGE_FORMAT format)
+{
+	FrameCapture capture;
+	CameraPath::CAMERA_KEYFRAME camera;
+	GLint sceneViewport[4];
+
+	if ((path.GetKeyframeCount() == 0) || (frameCount <= 0) || (0 == m_framebufferID))
+	{
+		return false;
+	}
+
+	// the render thread is busy drawing, so it is not counted
+	capture.Initialize(filePrefix, format, (int)std::thread::hardware_concurrency() - 1);
+
+	glGetIntegerv(GL_VIEWPORT, sceneViewport);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+	glViewport(0, 0, m_width, m_height);
+	m_pSceneManager->ClearViewports();
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < frameCount; i++)
+	{
+		float time = 0.0f;
+		if (frameCount > 1)
+		{
+			time = path.GetDuration() * (float)i / (float)(frameCount - 1);
+		}
+		path.Sample(time, camera);
+
+		m_pViewManager->SetCameraPose(camera.position, camera.front, camera.zoom);
+		DrawFrame();
+
+		capture.CaptureFrame(m_width, m_height);
+	}
+	capture.Finish();
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(sceneViewport[0], sceneViewport[1], sceneViewport[2], sceneViewport[3]);
+
+	ReportFrames(frameCount, capture.GetFramesWritten(), capture.GetStallCount(), elapsed);
+
+	return(capture.GetFramesWritten() == frameCount);
+}
+
+/***********************************************************
+ *  Play()
+ *
+ *  This method is used for playing a camera recording back
+ *  offscreen.  The camera and the moving parts of the scene
+ *  step on exactly as in a playback in the window, so the
+ *  frames match it and every run of it, only drawn without
+ *  waiting for the display.
+ ***********************************************************/
+bool BatchRenderer::Play(
+	const CameraRecording& recording,
+	const std::string& filePrefix,
+	FrameCapture::IMAGE_FORMAT format)
+{
+	FrameCapture capture;
+	GLint sceneViewport[4];
+	int frameCount = 0;
+	bool bWriteImages = (filePrefix.empty() == false);
+
+	if ((recording.GetStateCount() == 0) || (0 == m_framebufferID))
+	{
+		return false;
+	}
+
+	if (bWriteImages == true)
+	{
+		capture.Initialize(filePrefix, format, (int)std::thread::hardware_concurrency() - 1);
+	}
+
+	glGetIntegerv(GL_VIEWPORT, sceneViewport);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+	glViewport(0, 0, m_width, m_height);
+	m_pSceneManager->ClearViewports();
+
+	m_pViewManager->StartPlayback(&recording);
+	m_pSceneManager->SetFixedFrameTime(m_pViewManager->GetPlaybackFrameTime());
+
+	auto start = std::chrono::steady_clock::now();
+	while (m_pViewManager->AdvancePlayback() == true)
+	{
+		DrawFrame();
+		if (bWriteImages == true)
+		{
+			capture.CaptureFrame(m_width, m_height);
+		}
+		frameCount++;
+	}
+	if (bWriteImages == true)
+	{
+		capture.Finish();
+	}
+	else
+	{
+		// count the frames still being drawn
+		glFinish();
+	}
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	m_pSceneManager->SetFixedFrameTime(0.0f);
+	m_pViewManager->StartPlayback(NULL);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(sceneViewport[0], sceneViewport[1], sceneViewport[2], sceneViewport[3]);
+
+	ReportFrames(frameCount,
+		bWriteImages ? capture.GetFramesWritten() : 0,
+		capture.GetStallCount(),
+		elapsed);
+
+	return((bWriteImages == false) || (capture.GetFramesWritten() == frameCount));
+}
+
+/***********************************************************
+ *  CheckGoldenImages()
+ *
+ *  This method is used for drawing the scene from each key
+ *  of the path, without any blending between them, and
+ *  checking the frames against the golden images.  The
+ *  moving parts of the scene step on by a fixed time, so the
+ *  frames are the same on every run.
+ ***********************************************************/
+bool BatchRenderer::CheckGoldenImages(
+	const CameraPath& poses,
+	const std::string& namePrefix,
+	GoldenImageTest& goldenTest)
+{
+	GLint sceneViewport[4];
+	bool bPassed = true;
+
+	if ((poses.GetKeyframeCount() == 0) || (0 == m_framebufferID))
+	{
+		return false;
+	}
+
+	glGetIntegerv(GL_VIEWPORT, sceneViewport);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+	glViewport(0, 0, m_width, m_height);
+	m_pSceneManager->ClearViewports();
+	m_pSceneManager->SetFixedFrameTime(1.0f / 60.0f);
+
+	for (int i = 0; i < poses.GetKeyframeCount(); i++)
+	{
+		const CameraPath::CAMERA_KEYFRAME& pose = poses.GetKeyframe(i);
+		char name[16];
+
+		m_pViewManager->SetCameraPose(pose.position, pose.front, pose.zoom);
+		DrawFrame();
+
+		snprintf(name, sizeof(name), "_%02d", i);
+		bPassed = goldenTest.CheckFrame(namePrefix + name, m_width, m_height) && bPassed;
+	}
+
+	m_pSceneManager->SetFixedFrameTime(0.0f);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(sceneViewport[0], sceneViewport[1], sceneViewport[2], sceneViewport[3]);
+
+	return(bPassed);
+}
+
+/***********************************************************
+ *  DrawFrame()
+ *
+ *  This method is used for clearing the offscreen frame
+ *  buffer and drawing the scene into it from the camera,
+ *  exactly as the window would draw it.
+ ***********************************************************/
+void BatchRenderer::DrawFrame()
+{
+	m_pStateCache->SetDepthTest(true);
+	m_pStateCache->SetClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	m_pViewManager->PrepareCameraView(m_width, m_height);
+	m_pSceneManager->SetCameraView(
+		m_pViewManager->GetViewMatrix(),
+		m_pViewManager->GetProjectionMatrix(),
+		m_pViewManager->GetViewPosition());
+	m_pSceneManager->RenderScene();
+}
+
+/***********************************************************
+ *  ReportFrames()
+ *
+ *  This method is used for keeping and printing the rate of
+ *  a finished render.
+ ***********************************************************/
+void BatchRenderer::ReportFrames(int framesDrawn, int framesWritten, int stallCount, double elapsed)
+{
+	m_framesPerSecond = (elapsed > 0.0) ? (double)framesDrawn / elapsed : 0.0;
+	std::cout << "INFO: Rendered " << framesDrawn << " frames at " << m_width << "x" << m_height
+		<< " in " << elapsed << " seconds - " << m_framesPerSecond << " frames per second, "
+		<< framesWritten << " written, " << stallCount << " waits on the GPU" << std::endl;
+}
@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+// batchrenderer.h
+// ============
+// render a camera path offscreen into an image sequence as fast as possible
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "GLStateCache.h"
+#include "CameraPath.h"
+#include "CameraRecording.h"
+#include "FrameCapture.h"
+#include "GoldenImageTest.h"
+
+#include <string>
+
+/***********************************************************
+ *  BatchRenderer
+ *
+ *  This class contains the code for rendering the scene
+ *  along a camera path into an offscreen frame buffer, one
+ *  image per frame, with no waiting for the display.  The
+ *  frames are pipelined - while the GPU draws a frame, the
+ *  pixel buffers of the frame capture are still reading back
+ *  the frames before it and its workers are encoding the
+ *  ones before those.
+ ***********************************************************/
+class BatchRenderer
+{
+public:
+	// constructor
+	BatchRenderer(
+		SceneManager* pSceneManager,
+		ViewManager* pViewManager,
+		GLStateCache* pStateCache);
+	// destructor
+	~BatchRenderer();
+
+	// create the offscreen frame buffer of the image size
+	bool Initialize(int width, int height);
+
+	// render the passed in number of frames spread evenly over
+	// the path, written to files named from the prefix
+	bool Render(
+		const CameraPath& path,
+		int frameCount,
+		const std::string& filePrefix,
+		FrameCapture::IMAGE_FORMAT format);
+	// play a camera recording back frame by frame, the same
+	// frames as a playback in the window, writing them to files
+	// named from the prefix unless it is empty
+	bool Play(
+		const CameraRecording& recording,
+		const std::string& filePrefix,
+		FrameCapture::IMAGE_FORMAT format);
+	// draw the scene from the camera of every key of the path
+	// and check each frame against its golden image, named from
+	// the prefix and the number of the key
+	bool CheckGoldenImages(
+		const CameraPath& poses,
+		const std::string& namePrefix,
+		GoldenImageTest& goldenTest);
+
+	// get the rate of the last render, encoding included
+	double GetFramesPerSecond() const { return(m_framesPerSecond); }
+
+private:
+	// pointers to the scene, the camera and the OpenGL state
+	SceneManager* m_pSceneManager;
+	ViewManager* m_pViewManager;
+	GLStateCache* m_pStateCache;
+
+	// offscreen frame buffer and its color and depth
+	GLuint m_framebufferID;
+	GLuint m_colorBufferID;
+	GLuint m_depthBufferID;
+	int m_width;
+	int m_height;
+
+	double m_framesPerSecond;
+
+	// draw the scene from the camera as it is now
+	void DrawFrame();
+	// report the rate of a finished render
+	void ReportFrames(int framesDrawn, int framesWritten, int stallCount, double elapsed);
+};
@@ -0,0 +1,181 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerapath.cpp
+// ============
+// keyframed camera path sampled for the batch renderer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// declaration of the global variables and defines
+namespace
+{
+	/***********************************************************
+	 *  CatmullRom()
+	 *
+	 *  This function is used for blending between the middle
+	 *  two of four points on a Catmull-Rom spline.
+	 ***********************************************************/
+	glm::vec3 CatmullRom(
+		const glm::vec3& p0,
+		const glm::vec3& p1,
+		const glm::vec3& p2,
+		const glm::vec3& p3,
+		float t)
+	{
+		float t2 = t * t;
+		float t3 = t2 * t;
+
+		return(0.5f * ((2.0f * p1) +
+			(p2 - p0) * t +
+			(2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+			(3.0f * p1 - p0 - 3.0f * p2 + p3) * t3));
+	}
+}
+
+/***********************************************************
+ *  CameraPath()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CameraPath::CameraPath()
+{
+}
+
+/***********************************************************
+ *  ~CameraPath()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CameraPath::~CameraPath()
+{
+	m_keyframes.clear();
+}
+
+/***********************************************************
+ *  AddKeyframe()
+ *
+ *  This method is used for adding a key to the end of the
+ *  path.
+ ***********************************************************/
+void CameraPath::AddKeyframe(const CAMERA_KEYFRAME& keyframe)
+{
+	m_keyframes.push_back(keyframe);
+}
+
+/***********************************************************
+ *  LoadFromFile()
+ *
+ *  This method is used for loading the keys of the path
+ *  from a text file, replacing any keys already added.
+ ***********************************************************/
+bool CameraPath::LoadFromFile(const std::string& filename)
+{
+	std::ifstream file(filename);
+	std::string line;
+	int lineNumber = 0;
+
+	if (!file)
+	{
+		std::cout << "Could not open the camera path " << filename << std::endl;
+		return false;
+	}
+
+	m_keyframes.clear();
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		line = line.substr(0, line.find('#'));
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+		{
+			continue;
+		}
+
+		std::istringstream values(line);
+		CAMERA_KEYFRAME keyframe;
+		values >> keyframe.time
+			>> keyframe.position.x >> keyframe.position.y >> keyframe.position.z
+			>> keyframe.front.x >> keyframe.front.y >> keyframe.front.z
+			>> keyframe.zoom;
+		if (values.fail())
+		{
+			std::cout << "Could not read line " << lineNumber << " of the camera path " << filename << std::endl;
+			return false;
+		}
+		if ((m_keyframes.size() > 0) && (keyframe.time < m_keyframes.back().time))
+		{
+			std::cout << "Camera path keys are out of time order at line " << lineNumber << std::endl;
+			return false;
+		}
+		m_keyframes.push_back(keyframe);
+	}
+
+	return(m_keyframes.size() > 0);
+}
+
+/***********************************************************
+ *  Sample()
+ *
+ *  This method is used for getting the camera at a time
+ *  along the path.  The keys on either side of the two
+ *  around the time shape the curve of the position.
+ ***********************************************************/
+void CameraPath::Sample(float time, CAMERA_KEYFRAME& keyframe) const
+{
+	if (m_keyframes.size() == 0)
+	{
+		return;
+	}
+
+	int last = (int)m_keyframes.size() - 1;
+	if ((time <= m_keyframes[0].time) || (last == 0))
+	{
+		keyframe = m_keyframes[0];
+		keyframe.time = time;
+		return;
+	}
+	if (time >= m_keyframes[last].time)
+	{
+		keyframe = m_keyframes[last];
+		keyframe.time = time;
+		return;
+	}
+
+	// first key after the time
+	int next = 1;
+	while (m_keyframes[next].time <= time)
+	{
+		next++;
+	}
+	const CAMERA_KEYFRAME& from = m_keyframes[next - 1];
+	const CAMERA_KEYFRAME& to = m_keyframes[next];
+	const CAMERA_KEYFRAME& before = m_keyframes[std::max(next - 2, 0)];
+	const CAMERA_KEYFRAME& after = m_keyframes[std::min(next + 1, last)];
+	float span = to.time - from.time;
+	float t = (span > 0.0f) ? (time - from.time) / span : 0.0f;
+
+	keyframe.time = time;
+	keyframe.position = CatmullRom(before.position, from.position, to.position, after.position, t);
+	keyframe.front = glm::normalize(glm::mix(glm::normalize(from.front), glm::normalize(to.front), t));
+	keyframe.zoom = glm::mix(from.zoom, to.zoom, t);
+}
+
+/***********************************************************
+ *  GetDuration()
+ *
+ *  This method is used for getting the time of the last key.
+ ***********************************************************/
+float CameraPath::GetDuration() const
+{
+	if (m_keyframes.size() == 0)
+	{
+		return(0.0f);
+	}
+
+	return(m_keyframes.back().time);
+}
@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerapath.h
+// ============
+// keyframed camera path sampled for the batch renderer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  CameraPath
+ *
+ *  This class contains the code for a keyframed path of the
+ *  camera, with the same position, front and zoom as the
+ *  camera of the view manager.  Positions are blended along
+ *  a Catmull-Rom spline so the camera passes smoothly
+ *  through every key, the front is blended and normalized,
+ *  and the zoom is blended in a straight line.
+ ***********************************************************/
+class CameraPath
+{
+public:
+	// constructor
+	CameraPath();
+	// destructor
+	~CameraPath();
+
+	// camera at one time along the path
+	struct CAMERA_KEYFRAME
+	{
+		float time;
+		glm::vec3 position;
+		glm::vec3 front;
+		// field of view in degrees
+		float zoom;
+	};
+
+	// add a key - keys must be added in time order
+	void AddKeyframe(const CAMERA_KEYFRAME& keyframe);
+	// load the keys from a text file, one per line as the time,
+	// position, front and zoom, with # starting a comment
+	bool LoadFromFile(const std::string& filename);
+
+	// get the camera at a time in seconds, held at the ends
+	void Sample(float time, CAMERA_KEYFRAME& keyframe) const;
+
+	// get a key, the number of keys and the time of the last one
+	const CAMERA_KEYFRAME& GetKeyframe(int index) const { return(m_keyframes[index]); }
+	int GetKeyframeCount() const { return((int)m_keyframes.size()); }
+	float GetDuration() const;
+
+private:
+	std::vector<CAMERA_KEYFRAME> m_keyframes;
+};
@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerarecording.cpp
+// ============
+// camera states recorded at a fixed time step for repeatable playback
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CameraRecording.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+// declaration of the global variables and defines
+namespace
+{
+	// "CAMR" and the layout of the file
+	const uint32_t RECORDING_FILE_MAGIC = 0x524D4143;
+	const uint32_t RECORDING_FILE_VERSION = 1;
+	// position, front and up followed by the zoom
+	const int FLOATS_PER_STATE = 10;
+}
+
+/***********************************************************
+ *  CameraRecording()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CameraRecording::CameraRecording()
+{
+	m_timeStep = 0.0f;
+}
+
+/***********************************************************
+ *  ~CameraRecording()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CameraRecording::~CameraRecording()
+{
+	m_states.clear();
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every state so a new
+ *  recording can start.
+ ***********************************************************/
+void CameraRecording::Clear(float timeStep)
+{
+	m_timeStep = timeStep;
+	m_states.clear();
+}
+
+/***********************************************************
+ *  AddState()
+ *
+ *  This method is used for adding the camera of the next
+ *  time step.
+ ***********************************************************/
+void CameraRecording::AddState(const CAMERA_STATE& state)
+{
+	m_states.push_back(state);
+}
+
+/***********************************************************
+ *  SaveToFile()
+ *
+ *  This method is used for saving the states as ten floats
+ *  and a projection byte each, behind a short header with
+ *  the time step and the number of states.
+ ***********************************************************/
+bool CameraRecording::SaveToFile(const std::string& filename) const
+{
+	std::ofstream file(filename, std::ios::binary);
+	uint32_t stateCount = (uint32_t)m_states.size();
+
+	if (!file)
+	{
+		std::cout << "Could not save camera recording:" << filename << std::endl;
+		return false;
+	}
+
+	file.write((const char*)&RECORDING_FILE_MAGIC, sizeof(uint32_t));
+	file.write((const char*)&RECORDING_FILE_VERSION, sizeof(uint32_t));
+	file.write((const char*)&m_timeStep, sizeof(float));
+	file.write((const char*)&stateCount, sizeof(uint32_t));
+	for (const CAMERA_STATE& state : m_states)
+	{
+		float values[FLOATS_PER_STATE] =
+		{
+			state.position.x, state.position.y, state.position.z,
+			state.front.x, state.front.y, state.front.z,
+			state.up.x, state.up.y, state.up.z,
+			state.zoom
+		};
+		uint8_t orthographic = state.bOrthographic ? 1 : 0;
+
+		file.write((const char*)values, sizeof(values));
+		file.write((const char*)&orthographic, sizeof(uint8_t));
+	}
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  LoadFromFile()
+ *
+ *  This method is used for loading saved states, replacing
+ *  any already added.
+ ***********************************************************/
+bool CameraRecording::LoadFromFile(const std::string& filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	float timeStep = 0.0f;
+	uint32_t stateCount = 0;
+
+	if (!file)
+	{
+		std::cout << "Could not open the camera recording " << filename << std::endl;
+		return false;
+	}
+
+	file.read((char*)&magic, sizeof(uint32_t));
+	file.read((char*)&version, sizeof(uint32_t));
+	file.read((char*)&timeStep, sizeof(float));
+	file.read((char*)&stateCount, sizeof(uint32_t));
+
+	if ((!file) ||
+		(magic != RECORDING_FILE_MAGIC) ||
+		(version != RECORDING_FILE_VERSION) ||
+		(timeStep <= 0.0f))
+	{
+		std::cout << "Could not read the camera recording " << filename << std::endl;
+		return false;
+	}
+
+	m_timeStep = timeStep;
+	m_states.clear();
+	for (uint32_t i = 0; i < stateCount; i++)
+	{
+		float values[FLOATS_PER_STATE];
+		uint8_t orthographic = 0;
+		CAMERA_STATE state;
+
+		file.read((char*)values, sizeof(values));
+		file.read((char*)&orthographic, sizeof(uint8_t));
+		if (!file)
+		{
+			std::cout << "The camera recording " << filename << " ends after "
+				<< i << " of " << stateCount << " states" << std::endl;
+			m_states.clear();
+			return false;
+		}
+
+		state.position = glm::vec3(values[0], values[1], values[2]);
+		state.front = glm::vec3(values[3], values[4], values[5]);
+		state.up = glm::vec3(values[6], values[7], values[8]);
+		state.zoom = values[9];
+		state.bOrthographic = (orthographic != 0);
+		m_states.push_back(state);
+	}
+
+	return(m_states.size() > 0);
+}
@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerarecording.h
+// ============
+// camera states recorded at a fixed time step for repeatable playback
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  CameraRecording
+ *
+ *  This class contains the code for keeping the state of the
+ *  camera at every fixed time step of the view manager, and
+ *  for saving and loading it as a small binary file.  Played
+ *  back one step at a time, a recording shows exactly the
+ *  same views on every run, whatever the frame rate.
+ ***********************************************************/
+class CameraRecording
+{
+public:
+	// constructor
+	CameraRecording();
+	// destructor
+	~CameraRecording();
+
+	// camera at one time step
+	struct CAMERA_STATE
+	{
+		glm::vec3 position;
+		glm::vec3 front;
+		glm::vec3 up;
+		// field of view in degrees
+		float zoom;
+		bool bOrthographic;
+	};
+
+	// remove every state and set the time between them
+	void Clear(float timeStep);
+	// add the state of the next time step
+	void AddState(const CAMERA_STATE& state);
+
+	// save and load the states, replacing any already added
+	// when loading
+	bool SaveToFile(const std::string& filename) const;
+	bool LoadFromFile(const std::string& filename);
+
+	// get a state, the number of states and the time between them
+	const CAMERA_STATE& GetState(int index) const { return(m_states[index]); }
+	int GetStateCount() const { return((int)m_states.size()); }
+	float GetTimeStep() const { return(m_timeStep); }
+
+private:
+	float m_timeStep;
+	std::vector<CAMERA_STATE> m_states;
+};
@@ -0,0 +1,257 @@
+///////////////////////////////////////////////////////////////////////////////
+// debugviewrenderer.cpp
+// ============
+// draw overdraw, lights per pixel and mip level heatmaps of the scene
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DebugViewRenderer.h"
+
+#include <algorithm>
+#include <cstring>
+
+// declaration of the global variables and defines
+namespace
+{
+	// names of the views on the command line, by DEBUG_VIEW
+	const char* const VIEW_NAMES[DebugViewRenderer::DEBUG_VIEW_COUNT] =
+	{
+		"none",
+		"overdraw",
+		"lights",
+		"mip"
+	};
+}
+
+/***********************************************************
+ *  DebugViewRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DebugViewRenderer::DebugViewRenderer(GLStateCache* pStateCache)
+{
+	m_pStateCache = pStateCache;
+	m_pResolveShader = NULL;
+	m_framebufferID = 0;
+	m_countTextureID = 0;
+	m_depthBufferID = 0;
+	m_vertexArrayID = 0;
+	m_width = 0;
+	m_height = 0;
+	m_sceneFramebufferID = 0;
+}
+
+/***********************************************************
+ *  ~DebugViewRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DebugViewRenderer::~DebugViewRenderer()
+{
+	DestroyTargets();
+	if (0 != m_vertexArrayID)
+	{
+		glDeleteVertexArrays(1, &m_vertexArrayID);
+		m_vertexArrayID = 0;
+	}
+	if (NULL != m_pResolveShader)
+	{
+		delete m_pResolveShader;
+		m_pResolveShader = NULL;
+	}
+	m_pStateCache = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the heatmap shader.  The
+ *  targets are created on the first pass, once the size of
+ *  the viewport is known.
+ ***********************************************************/
+bool DebugViewRenderer::Initialize()
+{
+	m_pResolveShader = new ShaderManager();
+	m_pResolveShader->LoadShaders(
+		"shaders/oitCompositeVertexShader.glsl",
+		"shaders/debugViewFragmentShader.glsl");
+	if (0 == m_pResolveShader->m_programID)
+	{
+		std::cout << "Could not load the debug view shader" << std::endl;
+		return false;
+	}
+
+	// the core profile needs a bound vertex array even when
+	// the vertices are generated in the shader
+	glGenVertexArrays(1, &m_vertexArrayID);
+
+	return true;
+}
+
+/***********************************************************
+ *  BeginPass()
+ *
+ *  This method is used for redirecting drawing into the
+ *  count target, cleared to zero with a cleared depth buffer
+ *  of its own.  The scene is drawn into it in place of the
+ *  scene frame buffer, every viewport of a quad view
+ *  included.
+ ***********************************************************/
+void DebugViewRenderer::BeginPass()
+{
+	GLint viewport[4];
+	const GLfloat clearCount[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const GLfloat clearDepth = 1.0f;
+
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_sceneFramebufferID);
+
+	// the targets only grow, the same as the transparency ones
+	int width = viewport[0] + viewport[2];
+	int height = viewport[1] + viewport[3];
+	if ((width > m_width) || (height > m_height))
+	{
+		CreateTargets(std::max(width, m_width), std::max(height, m_height));
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+	m_pStateCache->SetDepthMask(true);
+	glClearBufferfv(GL_COLOR, 0, clearCount);
+	glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+}
+
+/***********************************************************
+ *  EndPass()
+ *
+ *  This method is used for returning drawing to the frame
+ *  buffer of the scene.
+ ***********************************************************/
+void DebugViewRenderer::EndPass()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebufferID);
+}
+
+/***********************************************************
+ *  Resolve()
+ *
+ *  This method is used for replacing the scene with the
+ *  heatmap of the counts, read back one texel per pixel.
+ ***********************************************************/
+void DebugViewRenderer::Resolve(DEBUG_VIEW view)
+{
+	if ((NULL == m_pResolveShader) || (0 == m_framebufferID))
+	{
+		return;
+	}
+
+	m_pStateCache->UseProgram(m_pResolveShader->m_programID);
+	m_pStateCache->BindTexture(COUNT_TEXTURE_UNIT, GL_TEXTURE_2D, m_countTextureID);
+	m_pResolveShader->setSampler2DValue("countTexture", COUNT_TEXTURE_UNIT);
+	m_pResolveShader->setIntValue("debugView", view);
+
+	m_pStateCache->SetBlend(false);
+	m_pStateCache->SetDepthTest(false);
+
+	m_pStateCache->BindVertexArray(m_vertexArrayID);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	m_pStateCache->SetDepthTest(true);
+}
+
+/***********************************************************
+ *  FindView()
+ *
+ *  This method is used for looking up a view by the name
+ *  given on the command line.
+ ***********************************************************/
+DebugViewRenderer::DEBUG_VIEW DebugViewRenderer::FindView(const char* name)
+{
+	for (int i = 0; i < DEBUG_VIEW_COUNT; i++)
+	{
+		if (strcmp(name, VIEW_NAMES[i]) == 0)
+		{
+			return((DEBUG_VIEW)i);
+		}
+	}
+	return(DEBUG_VIEW_NONE);
+}
+
+/***********************************************************
+ *  GetViewName()
+ *
+ *  This method is used for getting the name of a view, as
+ *  given on the command line.
+ ***********************************************************/
+const char* DebugViewRenderer::GetViewName(DEBUG_VIEW view)
+{
+	if ((view < 0) || (view >= DEBUG_VIEW_COUNT))
+	{
+		return(VIEW_NAMES[DEBUG_VIEW_NONE]);
+	}
+	return(VIEW_NAMES[view]);
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method is used for creating the count frame buffer.
+ *  OpenGL does not blend into integer formats, so the counts
+ *  are kept in a half float target instead - whole numbers
+ *  up to 2048 add up exactly.
+ ***********************************************************/
+void DebugViewRenderer::CreateTargets(int width, int height)
+{
+	DestroyTargets();
+
+	m_width = width;
+	m_height = height;
+
+	glGenTextures(1, &m_countTextureID);
+	m_pStateCache->BindTexture(COUNT_TEXTURE_UNIT, GL_TEXTURE_2D, m_countTextureID);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R16F, width, height, 0, GL_RED, GL_HALF_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glGenRenderbuffers(1, &m_depthBufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+	glGenFramebuffers(1, &m_framebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_countTextureID, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBufferID);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Debug view frame buffer is incomplete" << std::endl;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebufferID);
+}
+
+/***********************************************************
+ *  DestroyTargets()
+ *
+ *  This method is used for freeing the count targets.
+ ***********************************************************/
+void DebugViewRenderer::DestroyTargets()
+{
+	if (0 != m_framebufferID)
+	{
+		glDeleteFramebuffers(1, &m_framebufferID);
+		m_framebufferID = 0;
+	}
+	if (0 != m_countTextureID)
+	{
+		glDeleteTextures(1, &m_countTextureID);
+		m_countTextureID = 0;
+	}
+	if (0 != m_depthBufferID)
+	{
+		glDeleteRenderbuffers(1, &m_depthBufferID);
+		m_depthBufferID = 0;
+	}
+	m_pStateCache->InvalidateTextures();
+	m_width = 0;
+	m_height = 0;
+}
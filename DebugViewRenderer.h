@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// debugviewrenderer.h
+// ============
+// draw overdraw, lights per pixel and mip level heatmaps of the scene
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "GLStateCache.h"
+
+/***********************************************************
+ *  DebugViewRenderer
+ *
+ *  This class contains the code for showing where the scene
+ *  spends its fill rate.  While a debug view is on, the
+ *  scene shader writes a count for each fragment in place of
+ *  its color - one per fragment shaded, summed by additive
+ *  blending, or the lights it evaluated, or the mip level it
+ *  sampled - into a single channel target of its own.  The
+ *  resolve maps the counts to a heatmap over the frame.
+ ***********************************************************/
+class DebugViewRenderer
+{
+public:
+	// views that replace the lit scene - must match the
+	// DEBUG_VIEW defines of the fragment shaders
+	enum DEBUG_VIEW
+	{
+		DEBUG_VIEW_NONE,
+		DEBUG_VIEW_OVERDRAW,
+		DEBUG_VIEW_LIGHTS,
+		DEBUG_VIEW_MIP_LEVEL,
+		DEBUG_VIEW_COUNT
+	};
+
+	// constructor
+	DebugViewRenderer(GLStateCache* pStateCache);
+	// destructor
+	~DebugViewRenderer();
+
+	// load the heatmap shader
+	bool Initialize();
+
+	// redirect drawing into the cleared count target
+	void BeginPass();
+	// return drawing to the scene frame buffer
+	void EndPass();
+	// draw the counts as a heatmap over the current viewport
+	void Resolve(DEBUG_VIEW view);
+
+	// get the view named on the command line - overdraw, lights
+	// or mip - or DEBUG_VIEW_NONE for any other name
+	static DEBUG_VIEW FindView(const char* name);
+	// get the name of a view
+	static const char* GetViewName(DEBUG_VIEW view);
+
+private:
+	// texture unit used for reading the counts in the resolve
+	static const int COUNT_TEXTURE_UNIT = GLStateCache::DEBUG_VIEW_TEXTURE_UNIT;
+
+	// pointer to OpenGL state cache object
+	GLStateCache* m_pStateCache;
+	// shader used for the full screen heatmap
+	ShaderManager* m_pResolveShader;
+
+	// count frame buffer and its attachments
+	GLuint m_framebufferID;
+	GLuint m_countTextureID;
+	GLuint m_depthBufferID;
+	// empty vertex array for the full screen triangle
+	GLuint m_vertexArrayID;
+	// size of the targets in pixels
+	int m_width;
+	int m_height;
+	// frame buffer the scene is drawn into
+	GLint m_sceneFramebufferID;
+
+	// create the targets, or recreate them at a new size
+	void CreateTargets(int width, int height);
+	// free the targets
+	void DestroyTargets();
+};
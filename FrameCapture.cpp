@@ -0,0 +1,643 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.cpp
+// ============
+// read back rendered frames without stalling and write them as images
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameCapture.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+// declaration of the global variables and defines
+namespace
+{
+	// longest wait for a fence before trying again, in nanoseconds
+	const GLuint64 FENCE_TIMEOUT = 1000000000;
+	// most bytes in one stored deflate block
+	const int MAX_STORED_BLOCK = 65535;
+
+	/***********************************************************
+	 *  BuildCrcTable()
+	 *
+	 *  This function is used for building the table of the
+	 *  CRC-32 used by the PNG chunks.
+	 ***********************************************************/
+	std::vector<uint32_t> BuildCrcTable()
+	{
+		std::vector<uint32_t> table(256);
+
+		for (uint32_t n = 0; n < 256; n++)
+		{
+			uint32_t c = n;
+			for (int k = 0; k < 8; k++)
+			{
+				c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+			}
+			table[n] = c;
+		}
+
+		return(table);
+	}
+
+	/***********************************************************
+	 *  AppendUint32()
+	 *
+	 *  This function is used for appending a value with the
+	 *  most significant byte first.
+	 ***********************************************************/
+	void AppendUint32(std::vector<unsigned char>& data, uint32_t value)
+	{
+		data.push_back((unsigned char)(value >> 24));
+		data.push_back((unsigned char)(value >> 16));
+		data.push_back((unsigned char)(value >> 8));
+		data.push_back((unsigned char)value);
+	}
+
+	/***********************************************************
+	 *  AppendChunk()
+	 *
+	 *  This function is used for appending a PNG chunk - its
+	 *  length, type, data and the CRC of the type and data.
+	 ***********************************************************/
+	void AppendChunk(std::vector<unsigned char>& file, const char* type, const std::vector<unsigned char>& data)
+	{
+		// the table is built once, by whichever worker gets here first
+		static const std::vector<uint32_t> crcTable = BuildCrcTable();
+		uint32_t crc = 0xFFFFFFFFu;
+
+		AppendUint32(file, (uint32_t)data.size());
+		size_t start = file.size();
+		file.insert(file.end(), type, type + 4);
+		file.insert(file.end(), data.begin(), data.end());
+		for (size_t i = start; i < file.size(); i++)
+		{
+			crc = crcTable[(crc ^ file[i]) & 0xFF] ^ (crc >> 8);
+		}
+		AppendUint32(file, crc ^ 0xFFFFFFFFu);
+	}
+
+	/***********************************************************
+	 *  WriteFile()
+	 *
+	 *  This function is used for writing a whole file.
+	 ***********************************************************/
+	bool WriteFile(const std::string& filename, const std::vector<unsigned char>& data)
+	{
+		std::ofstream file(filename, std::ios::binary);
+
+		if (!file)
+		{
+			return false;
+		}
+		file.write((const char*)data.data(), data.size());
+
+		return(file.good());
+	}
+}
+
+/***********************************************************
+ *  FrameCapture()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameCapture::FrameCapture()
+{
+	for (int i = 0; i < RING_SIZE; i++)
+	{
+		m_ring[i].bufferID = 0;
+		m_ring[i].fence = 0;
+		m_ring[i].width = 0;
+		m_ring[i].height = 0;
+		m_ring[i].frame = 0;
+	}
+	m_nextBuffer = 0;
+	m_oldestBuffer = 0;
+	m_buffersInFlight = 0;
+	m_format = FORMAT_PNG;
+	m_activeJobs = 0;
+	m_bStopping = false;
+	m_framesCaptured = 0;
+	m_framesWritten = 0;
+	m_stallCount = 0;
+}
+
+/***********************************************************
+ *  ~FrameCapture()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameCapture::~FrameCapture()
+{
+	Finish();
+	StopWorkers();
+
+	for (int i = 0; i < RING_SIZE; i++)
+	{
+		if (0 != m_ring[i].fence)
+		{
+			glDeleteSync(m_ring[i].fence);
+		}
+		if (0 != m_ring[i].bufferID)
+		{
+			glDeleteBuffers(1, &m_ring[i].bufferID);
+		}
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the ring of pixel
+ *  buffers and starting the workers.  Frames are written to
+ *  the file prefix followed by the frame number.
+ ***********************************************************/
+void FrameCapture::Initialize(const std::string& filePrefix, IMAGE_FORMAT format, int threadCount)
+{
+	m_filePrefix = filePrefix;
+	m_format = format;
+
+	for (int i = 0; i < RING_SIZE; i++)
+	{
+		glGenBuffers(1, &m_ring[i].bufferID);
+	}
+
+	if (threadCount < 1)
+	{
+		threadCount = 1;
+	}
+	for (int i = 0; i < threadCount; i++)
+	{
+		m_workers.push_back(std::thread(&FrameCapture::RunWorker, this));
+	}
+}
+
+/***********************************************************
+ *  CaptureFrame()
+ *
+ *  This method is used for starting to read back the frame
+ *  just drawn.  The copy into the pixel buffer runs on the
+ *  GPU after the frame, so the call returns at once.  Only
+ *  when every buffer of the ring is still in flight does it
+ *  wait for the oldest, which is counted as a stall.
+ ***********************************************************/
+void FrameCapture::CaptureFrame(int width, int height)
+{
+	if ((width <= 0) || (height <= 0) || (m_workers.size() == 0))
+	{
+		return;
+	}
+
+	if (m_buffersInFlight == RING_SIZE)
+	{
+		if (ReadOldestBuffer(false) == false)
+		{
+			m_stallCount++;
+			ReadOldestBuffer(true);
+		}
+	}
+
+	PIXEL_BUFFER& buffer = m_ring[m_nextBuffer];
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.bufferID);
+	if ((buffer.width != width) || (buffer.height != height))
+	{
+		glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, NULL, GL_STREAM_READ);
+		buffer.width = width;
+		buffer.height = height;
+	}
+	// four bytes a pixel keeps every row aligned
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	buffer.frame = m_framesCaptured++;
+	m_nextBuffer = (m_nextBuffer + 1) % RING_SIZE;
+	m_buffersInFlight++;
+
+	// hand over every earlier frame the GPU has already finished
+	while ((m_buffersInFlight > 0) && (ReadOldestBuffer(false) == true))
+	{
+	}
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for reading back every frame still in
+ *  flight and waiting for the workers to write them all.
+ ***********************************************************/
+void FrameCapture::Finish()
+{
+	while (m_buffersInFlight > 0)
+	{
+		ReadOldestBuffer(true);
+	}
+
+	std::unique_lock<std::mutex> lock(m_jobMutex);
+	m_jobDone.wait(lock, [this]() { return((m_jobs.empty() == true) && (m_activeJobs == 0)); });
+}
+
+/***********************************************************
+ *  ReadOldestBuffer()
+ *
+ *  This method is used for handing the oldest frame in
+ *  flight to the workers.  Without waiting, nothing is done
+ *  and false returned when its fence has not passed yet.
+ *  The rows are flipped while copying, as OpenGL reads the
+ *  bottom row first.
+ ***********************************************************/
+bool FrameCapture::ReadOldestBuffer(bool bWait)
+{
+	PIXEL_BUFFER& buffer = m_ring[m_oldestBuffer];
+	GLenum result = glClientWaitSync(buffer.fence, 0, 0);
+
+	while ((bWait == true) && (result == GL_TIMEOUT_EXPIRED))
+	{
+		result = glClientWaitSync(buffer.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+	}
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		return false;
+	}
+	glDeleteSync(buffer.fence);
+	buffer.fence = 0;
+
+	ENCODE_JOB job;
+	int rowSize = buffer.width * 4;
+
+	job.width = buffer.width;
+	job.height = buffer.height;
+	job.frame = buffer.frame;
+	job.pixels.resize((size_t)rowSize * buffer.height);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.bufferID);
+	const unsigned char* pMapped = (const unsigned char*)glMapBufferRange(
+		GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)rowSize * buffer.height, GL_MAP_READ_BIT);
+	if (NULL != pMapped)
+	{
+		for (int row = 0; row < buffer.height; row++)
+		{
+			memcpy(&job.pixels[(size_t)row * rowSize],
+				pMapped + (size_t)(buffer.height - 1 - row) * rowSize, rowSize);
+		}
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	m_oldestBuffer = (m_oldestBuffer + 1) % RING_SIZE;
+	m_buffersInFlight--;
+
+	if (NULL != pMapped)
+	{
+		// wait for room rather than dropping frames when the
+		// workers fall behind
+		std::unique_lock<std::mutex> lock(m_jobMutex);
+		m_jobDone.wait(lock, [this]() { return((int)m_jobs.size() < MAX_QUEUED_FRAMES); });
+		m_jobs.push_back(std::move(job));
+		m_jobReady.notify_one();
+	}
+
+	return true;
+}
+
+/***********************************************************
+ *  RunWorker()
+ *
+ *  This method is used for encoding and writing queued
+ *  frames on a worker thread until the workers are stopped.
+ ***********************************************************/
+void FrameCapture::RunWorker()
+{
+	for (;;)
+	{
+		ENCODE_JOB job;
+		{
+			std::unique_lock<std::mutex> lock(m_jobMutex);
+			m_jobReady.wait(lock, [this]() { return((m_bStopping == true) || (m_jobs.empty() == false)); });
+			if (m_jobs.empty() == true)
+			{
+				return;
+			}
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+			m_activeJobs++;
+		}
+		m_jobDone.notify_all();
+
+		char number[16];
+		snprintf(number, sizeof(number), "%06d", job.frame);
+		std::string filename = m_filePrefix + number + ((m_format == FORMAT_PNG) ? ".png" : ".qoi");
+
+		bool bWritten = (m_format == FORMAT_PNG) ?
+			WritePNG(filename, job.pixels.data(), job.width, job.height) :
+			WriteQOI(filename, job.pixels.data(), job.width, job.height);
+		if (bWritten == true)
+		{
+			m_framesWritten++;
+		}
+		else
+		{
+			std::cout << "Could not write the captured frame " << filename << std::endl;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_jobMutex);
+			m_activeJobs--;
+		}
+		m_jobDone.notify_all();
+	}
+}
+
+/***********************************************************
+ *  StopWorkers()
+ *
+ *  This method is used for letting the workers finish the
+ *  queued frames and joining them.
+ ***********************************************************/
+void FrameCapture::StopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_jobMutex);
+		m_bStopping = true;
+	}
+	m_jobReady.notify_all();
+
+	for (int i = 0; i < (int)m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+	m_workers.clear();
+}
+
+/***********************************************************
+ *  WritePNG()
+ *
+ *  This method is used for writing an RGB PNG image.  The
+ *  rows are kept in stored deflate blocks, so no time is
+ *  spent compressing - QOI is the smaller of the two.
+ ***********************************************************/
+bool FrameCapture::WritePNG(const std::string& filename, const unsigned char* pPixels, int width, int height)
+{
+	const unsigned char signature[] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+	std::vector<unsigned char> file(signature, signature + 8);
+	std::vector<unsigned char> header;
+	std::vector<unsigned char> rows;
+	std::vector<unsigned char> compressed;
+	std::vector<unsigned char> none;
+
+	// width, height, 8 bits, RGB, deflate, adaptive filtering, no interlace
+	AppendUint32(header, (uint32_t)width);
+	AppendUint32(header, (uint32_t)height);
+	header.push_back(8);
+	header.push_back(2);
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+	AppendChunk(file, "IHDR", header);
+
+	// each row starts with its filter, none here
+	rows.reserve((size_t)(width * 3 + 1) * height);
+	for (int y = 0; y < height; y++)
+	{
+		const unsigned char* pRow = pPixels + (size_t)y * width * 4;
+		rows.push_back(0);
+		for (int x = 0; x < width; x++)
+		{
+			rows.push_back(pRow[x * 4]);
+			rows.push_back(pRow[x * 4 + 1]);
+			rows.push_back(pRow[x * 4 + 2]);
+		}
+	}
+
+	// zlib stream of stored blocks, then the Adler-32 of the rows
+	uint32_t adlerA = 1;
+	uint32_t adlerB = 0;
+	for (size_t i = 0; i < rows.size(); i++)
+	{
+		adlerA = (adlerA + rows[i]) % 65521;
+		adlerB = (adlerB + adlerA) % 65521;
+	}
+	compressed.reserve(rows.size() + rows.size() / MAX_STORED_BLOCK * 5 + 16);
+	compressed.push_back(0x78);
+	compressed.push_back(0x01);
+	size_t offset = 0;
+	do
+	{
+		size_t blockSize = rows.size() - offset;
+		if (blockSize > (size_t)MAX_STORED_BLOCK)
+		{
+			blockSize = MAX_STORED_BLOCK;
+		}
+		compressed.push_back((offset + blockSize == rows.size()) ? 1 : 0);
+		compressed.push_back((unsigned char)(blockSize & 0xFF));
+		compressed.push_back((unsigned char)(blockSize >> 8));
+		compressed.push_back((unsigned char)(~blockSize & 0xFF));
+		compressed.push_back((unsigned char)((~blockSize >> 8) & 0xFF));
+		compressed.insert(compressed.end(), rows.begin() + offset, rows.begin() + offset + blockSize);
+		offset += blockSize;
+	} while (offset < rows.size());
+	AppendUint32(compressed, (adlerB << 16) | adlerA);
+	AppendChunk(file, "IDAT", compressed);
+	AppendChunk(file, "IEND", none);
+
+	return(WriteFile(filename, file));
+}
+
+/***********************************************************
+ *  WriteQOI()
+ *
+ *  This method is used for writing an RGB image in the
+ *  "Quite OK Image" format, which compresses with runs,
+ *  a table of recent colors and small color differences,
+ *  fast enough to keep up with the frames.
+ ***********************************************************/
+bool FrameCapture::WriteQOI(const std::string& filename, const unsigned char* pPixels, int width, int height)
+{
+	std::vector<unsigned char> file;
+	unsigned char index[64][4];
+	unsigned char previous[3] = { 0, 0, 0 };
+	int pixelCount = width * height;
+	int run = 0;
+
+	memset(index, 0, sizeof(index));
+	file.reserve((size_t)pixelCount * 4 + 22);
+
+	// magic, size, three channels, sRGB
+	file.push_back('q');
+	file.push_back('o');
+	file.push_back('i');
+	file.push_back('f');
+	AppendUint32(file, (uint32_t)width);
+	AppendUint32(file, (uint32_t)height);
+	file.push_back(3);
+	file.push_back(0);
+
+	for (int i = 0; i < pixelCount; i++)
+	{
+		const unsigned char* pPixel = pPixels + (size_t)i * 4;
+
+		if ((pPixel[0] == previous[0]) && (pPixel[1] == previous[1]) && (pPixel[2] == previous[2]))
+		{
+			run++;
+			if ((run == 62) || (i == pixelCount - 1))
+			{
+				file.push_back((unsigned char)(0xC0 | (run - 1)));
+				run = 0;
+			}
+			continue;
+		}
+		if (run > 0)
+		{
+			file.push_back((unsigned char)(0xC0 | (run - 1)));
+			run = 0;
+		}
+
+		// the alpha of every pixel is opaque
+		int hash = (pPixel[0] * 3 + pPixel[1] * 5 + pPixel[2] * 7 + 255 * 11) % 64;
+		if ((index[hash][0] == pPixel[0]) && (index[hash][1] == pPixel[1]) &&
+			(index[hash][2] == pPixel[2]) && (index[hash][3] == 255))
+		{
+			file.push_back((unsigned char)hash);
+		}
+		else
+		{
+			memcpy(index[hash], pPixel, 3);
+			index[hash][3] = 255;
+
+			signed char dr = (signed char)(pPixel[0] - previous[0]);
+			signed char dg = (signed char)(pPixel[1] - previous[1]);
+			signed char db = (signed char)(pPixel[2] - previous[2]);
+			int drg = dr - dg;
+			int dbg = db - dg;
+
+			if ((dr > -3) && (dr < 2) && (dg > -3) && (dg < 2) && (db > -3) && (db < 2))
+			{
+				file.push_back((unsigned char)(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2)));
+			}
+			else if ((drg > -9) && (drg < 8) && (dg > -33) && (dg < 32) && (dbg > -9) && (dbg < 8))
+			{
+				file.push_back((unsigned char)(0x80 | (dg + 32)));
+				file.push_back((unsigned char)(((drg + 8) << 4) | (dbg + 8)));
+			}
+			else
+			{
+				file.push_back(0xFE);
+				file.push_back(pPixel[0]);
+				file.push_back(pPixel[1]);
+				file.push_back(pPixel[2]);
+			}
+		}
+		memcpy(previous, pPixel, 3);
+	}
+
+	// end marker
+	for (int i = 0; i < 7; i++)
+	{
+		file.push_back(0);
+	}
+	file.push_back(1);
+
+	return(WriteFile(filename, file));
+}
+
+/***********************************************************
+ *  ReadQOI()
+ *
+ *  This method is used for decoding a QOI image, such as a
+ *  saved frame to compare a new one against.  Images of
+ *  three or four channels are both read.
+ ***********************************************************/
+bool FrameCapture::ReadQOI(const std::string& filename, std::vector<unsigned char>& pixels, int& width, int& height)
+{
+	std::ifstream stream(filename, std::ios::binary);
+	std::vector<unsigned char> file;
+	unsigned char index[64][4];
+	unsigned char pixel[4] = { 0, 0, 0, 255 };
+
+	if (!stream)
+	{
+		return false;
+	}
+	file.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	if ((file.size() < 22) || (memcmp(file.data(), "qoif", 4) != 0))
+	{
+		std::cout << "Could not read QOI image:" << filename << std::endl;
+		return false;
+	}
+
+	width = (int)(((uint32_t)file[4] << 24) | ((uint32_t)file[5] << 16) | ((uint32_t)file[6] << 8) | file[7]);
+	height = (int)(((uint32_t)file[8] << 24) | ((uint32_t)file[9] << 16) | ((uint32_t)file[10] << 8) | file[11]);
+	if ((width <= 0) || (height <= 0) || ((size_t)width * height > file.size() * 62))
+	{
+		std::cout << "Could not read QOI image:" << filename << std::endl;
+		return false;
+	}
+
+	memset(index, 0, sizeof(index));
+	pixels.resize((size_t)width * height * 4);
+
+	size_t position = 14;
+	size_t end = file.size() - 8;
+	size_t pixelCount = (size_t)width * height;
+	int run = 0;
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		if (run > 0)
+		{
+			run--;
+		}
+		else if (position < end)
+		{
+			unsigned char tag = file[position++];
+
+			if (tag == 0xFE)
+			{
+				pixel[0] = file[position];
+				pixel[1] = file[position + 1];
+				pixel[2] = file[position + 2];
+				position += 3;
+			}
+			else if (tag == 0xFF)
+			{
+				memcpy(pixel, &file[position], 4);
+				position += 4;
+			}
+			else if ((tag & 0xC0) == 0x00)
+			{
+				memcpy(pixel, index[tag], 4);
+			}
+			else if ((tag & 0xC0) == 0x40)
+			{
+				pixel[0] += ((tag >> 4) & 0x03) - 2;
+				pixel[1] += ((tag >> 2) & 0x03) - 2;
+				pixel[2] += (tag & 0x03) - 2;
+			}
+			else if ((tag & 0xC0) == 0x80)
+			{
+				int dg = (tag & 0x3F) - 32;
+				unsigned char next = file[position++];
+				pixel[0] += dg - 8 + ((next >> 4) & 0x0F);
+				pixel[1] += dg;
+				pixel[2] += dg - 8 + (next & 0x0F);
+			}
+			else
+			{
+				run = tag & 0x3F;
+			}
+
+			int hash = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+			memcpy(index[hash], pixel, 4);
+		}
+
+		memcpy(&pixels[i * 4], pixel, 4);
+	}
+
+	return true;
+}
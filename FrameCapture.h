@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.h
+// ============
+// read back rendered frames without stalling and write them as images
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  FrameCapture
+ *
+ *  This class contains the code for saving rendered frames
+ *  as a numbered image sequence.  Each frame is copied into
+ *  the next pixel buffer of a ring with a fence behind it,
+ *  and only mapped once the fence has passed, a few frames
+ *  later, so reading back never waits on the GPU unless the
+ *  ring is full.  The mapped pixels are handed to a pool of
+ *  worker threads that encode and write the images.
+ ***********************************************************/
+class FrameCapture
+{
+public:
+	// constructor
+	FrameCapture();
+	// destructor
+	~FrameCapture();
+
+	// image file written for each frame
+	enum IMAGE_FORMAT
+	{
+		FORMAT_PNG,
+		FORMAT_QOI
+	};
+
+	// pixel buffers in flight between the GPU and the workers
+	static const int RING_SIZE = 4;
+	// frames waiting to be encoded before the capture waits
+	static const int MAX_QUEUED_FRAMES = 16;
+
+	// start the workers writing files named from the prefix
+	void Initialize(const std::string& filePrefix, IMAGE_FORMAT format, int threadCount);
+
+	// start reading back the frame just drawn into the bound
+	// frame buffer, and queue any earlier frames now read back
+	void CaptureFrame(int width, int height);
+	// wait until every captured frame has been written
+	void Finish();
+
+	// get the counts since the capture started
+	int GetFramesCaptured() const { return(m_framesCaptured); }
+	int GetFramesWritten() const { return(m_framesWritten); }
+	// get the number of frames that had to wait for the GPU
+	int GetStallCount() const { return(m_stallCount); }
+
+	// write an image, top row first, of four bytes per pixel
+	static bool WritePNG(const std::string& filename, const unsigned char* pPixels, int width, int height);
+	static bool WriteQOI(const std::string& filename, const unsigned char* pPixels, int width, int height);
+	// read a QOI image back into four bytes per pixel, top row
+	// first
+	static bool ReadQOI(const std::string& filename, std::vector<unsigned char>& pixels, int& width, int& height);
+
+private:
+	// one pixel buffer of the ring, with the frame it holds
+	struct PIXEL_BUFFER
+	{
+		GLuint bufferID;
+		GLsync fence;
+		int width;
+		int height;
+		int frame;
+	};
+
+	// read back frame waiting for a worker
+	struct ENCODE_JOB
+	{
+		std::vector<unsigned char> pixels;
+		int width;
+		int height;
+		int frame;
+	};
+
+	PIXEL_BUFFER m_ring[RING_SIZE];
+	// next buffer written, and the oldest one still in flight
+	int m_nextBuffer;
+	int m_oldestBuffer;
+	int m_buffersInFlight;
+
+	std::string m_filePrefix;
+	IMAGE_FORMAT m_format;
+
+	// workers and the frames queued for them
+	std::vector<std::thread> m_workers;
+	std::deque<ENCODE_JOB> m_jobs;
+	std::mutex m_jobMutex;
+	std::condition_variable m_jobReady;
+	std::condition_variable m_jobDone;
+	int m_activeJobs;
+	bool m_bStopping;
+
+	int m_framesCaptured;
+	std::atomic<int> m_framesWritten;
+	int m_stallCount;
+
+	// map the oldest buffer once its fence has passed, or wait
+	// for it, and queue its pixels
+	bool ReadOldestBuffer(bool bWait);
+	// encode and write queued frames until stopped
+	void RunWorker();
+	// stop and join the workers
+	void StopWorkers();
+};
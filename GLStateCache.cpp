@@ -0,0 +1,393 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.cpp
+// ============
+// shadow copy of the OpenGL pipeline state - filters redundant state changes
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLStateCache.h"
+
+/***********************************************************
+ *  GLStateCache()
+ *
+ *  The constructor for the class.  The cached values start
+ *  at the OpenGL defaults for a newly created context.
+ ***********************************************************/
+GLStateCache::GLStateCache()
+{
+	m_programID = 0;
+	m_vertexArrayID = 0;
+	m_activeTextureUnit = 0;
+	for (int i = 0; i < MAX_TEXTURE_UNITS; i++)
+	{
+		m_boundTextures2D[i] = 0;
+		m_boundTexturesCube[i] = 0;
+		m_boundTexturesArray[i] = 0;
+	}
+	m_bProgramKnown = true;
+	m_bVertexArrayKnown = true;
+	m_bTexturesKnown = true;
+
+	m_blend = CAP_DISABLED;
+	m_depthTest = CAP_DISABLED;
+	m_depthMask = CAP_ENABLED;
+	m_cullFace = CAP_DISABLED;
+	m_colorMask = CAP_ENABLED;
+	m_blendSource = GL_ONE;
+	m_blendDestination = GL_ZERO;
+	m_depthFunc = GL_LESS;
+	m_clearColor = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+	m_bClearColorKnown = true;
+
+	ResetStats();
+}
+
+/***********************************************************
+ *  ~GLStateCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GLStateCache::~GLStateCache()
+{
+}
+
+/***********************************************************
+ *  UseProgram()
+ *
+ *  This method is used for binding a shader program.
+ ***********************************************************/
+void GLStateCache::UseProgram(GLuint programID)
+{
+	if ((m_bProgramKnown == true) && (m_programID == programID))
+	{
+		m_stats.redundantCalls++;
+		return;
+	}
+
+	glUseProgram(programID);
+	m_programID = programID;
+	m_bProgramKnown = true;
+	m_stats.programBinds++;
+}
+
+/***********************************************************
+ *  BindVertexArray()
+ *
+ *  This method is used for binding a vertex array object.
+ ***********************************************************/
+void GLStateCache::BindVertexArray(GLuint vertexArrayID)
+{
+	if ((m_bVertexArrayKnown == true) && (m_vertexArrayID == vertexArrayID))
+	{
+		m_stats.redundantCalls++;
+		return;
+	}
+
+	glBindVertexArray(vertexArrayID);
+	m_vertexArrayID = vertexArrayID;
+	m_bVertexArrayKnown = true;
+	m_stats.vertexArrayBinds++;
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for binding a texture to a texture
+ *  unit.  The active texture unit is only switched when the
+ *  binding itself has to change.
+ ***********************************************************/
+void GLStateCache::BindTexture(int textureUnit, GLenum target, GLuint textureID)
+{
+	GLuint* pSlot = GetTextureSlot(textureUnit, target);
+
+	if ((m_bTexturesKnown == true) && (NULL != pSlot) && (*pSlot == textureID))
+	{
+		m_stats.redundantCalls++;
+		return;
+	}
+
+	if ((m_bTexturesKnown == false) || (m_activeTextureUnit != textureUnit))
+	{
+		glActiveTexture(GL_TEXTURE0 + textureUnit);
+		m_activeTextureUnit = textureUnit;
+	}
+	glBindTexture(target, textureID);
+	m_stats.textureBinds++;
+
+	if (m_bTexturesKnown == false)
+	{
+		// the other slots are still unknown, so reset them to
+		// a value that can never match a generated texture name
+		for (int i = 0; i < MAX_TEXTURE_UNITS; i++)
+		{
+			m_boundTextures2D[i] = (GLuint)-1;
+			m_boundTexturesCube[i] = (GLuint)-1;
+			m_boundTexturesArray[i] = (GLuint)-1;
+		}
+		m_bTexturesKnown = true;
+	}
+	if (NULL != pSlot)
+	{
+		*pSlot = textureID;
+	}
+}
+
+/***********************************************************
+ *  SetBlend()
+ *
+ *  This method is used for enabling or disabling blending.
+ ***********************************************************/
+void GLStateCache::SetBlend(bool bEnable)
+{
+	SetCapability(GL_BLEND, m_blend, bEnable);
+}
+
+/***********************************************************
+ *  SetBlendFunc()
+ *
+ *  This method is used for setting the blend factors.
+ ***********************************************************/
+void GLStateCache::SetBlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+	if ((m_blendSource == sourceFactor) && (m_blendDestination == destinationFactor))
+	{
+		m_stats.redundantCalls++;
+		return;
+	}
+
+	glBlendFunc(sourceFactor, destinationFactor);
+	m_blendSource = sourceFactor;
+	m_blendDestination = destinationFactor;
+	m_stats.capabilityChanges++;
+}
+
+/***********************************************************
+ *  SetBlendFuncIndexed()
+ *
+ *  This method is used for setting the blend factors of one
+ *  draw buffer.  Per-buffer factors are not cached, so the
+ *  shared blend factors become unknown afterwards.
+ ***********************************************************/
+void GLStateCache::SetBlendFuncIndexed(GLuint drawBuffer, GLenum sourceFactor, GLenum destinationFactor)
+{
+	glBlendFunci(drawBuffer, sourceFactor, destinationFactor);
+	m_blendSource = GL_INVALID_ENUM;
+	m_blendDestination = GL_INVALID_ENUM;
+	m_stats.capabilityChanges++;
+}
+
+/***********************************************************
+ *  SetDepthTest()
+ *
+ *  This method is used for enabling or disabling the depth
+ *  test.
+ ***********************************************************/
+void GLStateCache::SetDepthTest(bool bEnable)
+{
+	SetCapability(GL_DEPTH_TEST, m_depthTest, bEnable);
+}
+
+/***********************************************************
+ *  SetDepthFunc()
+ *
+ *  This method is used for setting the depth comparison.
+ ***********************************************************/
+void GLStateCache::SetDepthFunc(GLenum depthFunc)
+{
+	if (m_depthFunc == depthFunc)
+	{
+		m_stats.redundantCalls++;
+		return;
+	}
+
+	glDepthFunc(depthFunc);
+	m_depthFunc = depthFunc;
+	m_stats.capabilityChanges++;
+}
+
+/***********************************************************
+ *  SetDepthMask()
+ *
+ *  This method is used for enabling or disabling writes
+ *  into the depth buffer.
+ ***********************************************************/
+void GLStateCache::SetDepthMask(bool bEnable)
+{
+	CAPABILITY_STATE requested = bEnable ? CAP_ENABLED : CAP_DISABLED;
+
+	if (m_depthMask == requested)
+	{
+		m_stats.redundantCalls++;
+		return;
+	}
+
+	glDepthMask(bEnable ? GL_TRUE : GL_FALSE);
+	m_depthMask = requested;
+	m_stats.capabilityChanges++;
+}
+
+/***********************************************************
+ *  SetCullFace()
+ *
+ *  This method is used for enabling or disabling back face
+ *  culling.
+ ***********************************************************/
+void GLStateCache::SetCullFace(bool bEnable)
+{
+	SetCapability(GL_CULL_FACE, m_cullFace, bEnable);
+}
+
+/***********************************************************
+ *  SetColorMask()
+ *
+ *  This method is used for enabling or disabling writes
+ *  into all channels of the color buffer.
+ ***********************************************************/
+void GLStateCache::SetColorMask(bool bEnable)
+{
+	CAPABILITY_STATE requested = bEnable ? CAP_ENABLED : CAP_DISABLED;
+
+	if (m_colorMask == requested)
+	{
+		m_stats.redundantCalls++;
+		return;
+	}
+
+	GLboolean mask = bEnable ? GL_TRUE : GL_FALSE;
+	glColorMask(mask, mask, mask, mask);
+	m_colorMask = requested;
+	m_stats.capabilityChanges++;
+}
+
+/***********************************************************
+ *  SetClearColor()
+ *
+ *  This method is used for setting the frame clear color.
+ ***********************************************************/
+void GLStateCache::SetClearColor(const glm::vec4& clearColor)
+{
+	if ((m_bClearColorKnown == true) && (m_clearColor == clearColor))
+	{
+		m_stats.redundantCalls++;
+		return;
+	}
+
+	glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+	m_clearColor = clearColor;
+	m_bClearColorKnown = true;
+	m_stats.capabilityChanges++;
+}
+
+/***********************************************************
+ *  InvalidateVertexArray()
+ *
+ *  This method is used for forgetting the bound vertex array
+ *  after code outside of the cache has bound its own.
+ ***********************************************************/
+void GLStateCache::InvalidateVertexArray()
+{
+	m_bVertexArrayKnown = false;
+}
+
+/***********************************************************
+ *  InvalidateTextures()
+ *
+ *  This method is used for forgetting the texture bindings,
+ *  for example after textures have been deleted.
+ ***********************************************************/
+void GLStateCache::InvalidateTextures()
+{
+	m_bTexturesKnown = false;
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for forgetting all of the cached
+ *  state so that every following call goes through.
+ ***********************************************************/
+void GLStateCache::Invalidate()
+{
+	m_bProgramKnown = false;
+	m_bVertexArrayKnown = false;
+	m_bTexturesKnown = false;
+	m_blend = CAP_UNKNOWN;
+	m_depthTest = CAP_UNKNOWN;
+	m_depthMask = CAP_UNKNOWN;
+	m_cullFace = CAP_UNKNOWN;
+	m_colorMask = CAP_UNKNOWN;
+	m_blendSource = GL_INVALID_ENUM;
+	m_blendDestination = GL_INVALID_ENUM;
+	m_depthFunc = GL_INVALID_ENUM;
+	m_bClearColorKnown = false;
+}
+
+/***********************************************************
+ *  ResetStats()
+ *
+ *  This method is used for clearing the per-frame counters.
+ ***********************************************************/
+void GLStateCache::ResetStats()
+{
+	m_stats.programBinds = 0;
+	m_stats.vertexArrayBinds = 0;
+	m_stats.textureBinds = 0;
+	m_stats.capabilityChanges = 0;
+	m_stats.redundantCalls = 0;
+}
+
+/***********************************************************
+ *  SetCapability()
+ *
+ *  This method is used for enabling or disabling an OpenGL
+ *  capability only when it differs from the cached value.
+ ***********************************************************/
+void GLStateCache::SetCapability(GLenum capability, CAPABILITY_STATE& current, bool bEnable)
+{
+	CAPABILITY_STATE requested = bEnable ? CAP_ENABLED : CAP_DISABLED;
+
+	if (current == requested)
+	{
+		m_stats.redundantCalls++;
+		return;
+	}
+
+	if (bEnable == true)
+	{
+		glEnable(capability);
+	}
+	else
+	{
+		glDisable(capability);
+	}
+
+	current = requested;
+	m_stats.capabilityChanges++;
+}
+
+/***********************************************************
+ *  GetTextureSlot()
+ *
+ *  This method is used for getting the cached binding for a
+ *  texture target on a unit.  Targets that are not tracked
+ *  return NULL so they are always forwarded.
+ ***********************************************************/
+GLuint* GLStateCache::GetTextureSlot(int textureUnit, GLenum target)
+{
+	if ((textureUnit < 0) || (textureUnit >= MAX_TEXTURE_UNITS))
+	{
+		return(NULL);
+	}
+
+	switch (target)
+	{
+	case GL_TEXTURE_2D:
+		return(&m_boundTextures2D[textureUnit]);
+	case GL_TEXTURE_CUBE_MAP:
+		return(&m_boundTexturesCube[textureUnit]);
+	case GL_TEXTURE_2D_ARRAY:
+		return(&m_boundTexturesArray[textureUnit]);
+	default:
+		return(NULL);
+	}
+}
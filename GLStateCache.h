@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.h
+// ============
+// shadow copy of the OpenGL pipeline state - filters redundant state changes
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  GLStateCache
+ *
+ *  This class keeps a copy of the OpenGL state that has been
+ *  set through it - bound program, vertex array, textures,
+ *  blending, depth and culling - and only forwards a call to
+ *  OpenGL when the requested value differs from the current
+ *  one.  Every call is counted so the per-frame cost of
+ *  state changes can be profiled.
+ ***********************************************************/
+class GLStateCache
+{
+public:
+	// constructor
+	GLStateCache();
+	// destructor
+	~GLStateCache();
+
+	// texture units - the scene textures are bound from the
+	// first unit up to the reserved ones, and every pass that
+	// samples a texture of its own has a unit no other pass
+	// binds to
+	static const int FIRST_RESERVED_TEXTURE_UNIT = 12;
+	static const int ENVIRONMENT_TEXTURE_UNIT = 12;
+	static const int SHADOW_TEXTURE_UNIT = 13;
+	static const int OIT_ACCUM_TEXTURE_UNIT = 14;
+	static const int OIT_REVEALAGE_TEXTURE_UNIT = 15;
+	static const int HUD_ATLAS_TEXTURE_UNIT = 16;
+	static const int DEBUG_VIEW_TEXTURE_UNIT = 17;
+	// number of texture units tracked by the cache, every
+	// reserved unit included - OpenGL 3.3 has at least 48
+	static const int MAX_TEXTURE_UNITS = 18;
+
+	struct STATE_STATS
+	{
+		// calls forwarded to OpenGL
+		int programBinds;
+		int vertexArrayBinds;
+		int textureBinds;
+		int capabilityChanges;
+		// calls dropped because the state was already set
+		int redundantCalls;
+	};
+
+	// bind a shader program
+	void UseProgram(GLuint programID);
+	// bind a vertex array object
+	void BindVertexArray(GLuint vertexArrayID);
+	// bind a texture to the passed in texture unit
+	void BindTexture(int textureUnit, GLenum target, GLuint textureID);
+
+	// enable or disable alpha blending
+	void SetBlend(bool bEnable);
+	// set the source and destination blend factors
+	void SetBlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+	// set the blend factors for a single draw buffer
+	void SetBlendFuncIndexed(GLuint drawBuffer, GLenum sourceFactor, GLenum destinationFactor);
+	// enable or disable the depth test
+	void SetDepthTest(bool bEnable);
+	// set the depth comparison function
+	void SetDepthFunc(GLenum depthFunc);
+	// enable or disable writes into the depth buffer
+	void SetDepthMask(bool bEnable);
+	// enable or disable back face culling
+	void SetCullFace(bool bEnable);
+	// enable or disable writes into the color buffer
+	void SetColorMask(bool bEnable);
+	// set the color used for clearing the frame buffer
+	void SetClearColor(const glm::vec4& clearColor);
+
+	// forget the bound vertex array after code outside the
+	// cache has bound its own
+	void InvalidateVertexArray();
+	// forget the bound textures after textures were deleted
+	void InvalidateTextures();
+	// forget all cached state
+	void Invalidate();
+
+	// clear the counters - called at the start of each frame
+	void ResetStats();
+	// get the counters collected since the last reset
+	const STATE_STATS& GetStats() const { return(m_stats); }
+
+private:
+	// tri-state for capabilities - unknown forces the next call through
+	enum CAPABILITY_STATE
+	{
+		CAP_UNKNOWN = -1,
+		CAP_DISABLED = 0,
+		CAP_ENABLED = 1
+	};
+
+	// currently bound objects
+	GLuint m_programID;
+	GLuint m_vertexArrayID;
+	int m_activeTextureUnit;
+	GLuint m_boundTextures2D[MAX_TEXTURE_UNITS];
+	GLuint m_boundTexturesCube[MAX_TEXTURE_UNITS];
+	GLuint m_boundTexturesArray[MAX_TEXTURE_UNITS];
+	bool m_bProgramKnown;
+	bool m_bVertexArrayKnown;
+	bool m_bTexturesKnown;
+
+	// fixed function state
+	CAPABILITY_STATE m_blend;
+	CAPABILITY_STATE m_depthTest;
+	CAPABILITY_STATE m_depthMask;
+	CAPABILITY_STATE m_cullFace;
+	CAPABILITY_STATE m_colorMask;
+	GLenum m_blendSource;
+	GLenum m_blendDestination;
+	GLenum m_depthFunc;
+	glm::vec4 m_clearColor;
+	bool m_bClearColorKnown;
+
+	// per-frame counters
+	STATE_STATS m_stats;
+
+	// enable or disable a capability when it differs from the cached value
+	void SetCapability(GLenum capability, CAPABILITY_STATE& current, bool bEnable);
+	// get the cached binding slot for a texture target on a unit
+	GLuint* GetTextureSlot(int textureUnit, GLenum target);
+};
@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+// goldenimagetest.cpp
+// ============
+// compare rendered frames against stored golden images
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GoldenImageTest.h"
+#include "FrameCapture.h"
+
+#include <cstring>
+#include <iostream>
+
+// declaration of the global variables and defines
+namespace
+{
+	// difference from 0 to 1 a pixel may have, enough to pass
+	// the rounding of different drivers but not a changed color
+	const float PIXEL_THRESHOLD = 0.1f;
+	// share of the pixels that may differ before a frame fails
+	const float MAX_DIFFERENT_FRACTION = 0.001f;
+}
+
+/***********************************************************
+ *  GoldenImageTest()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GoldenImageTest::GoldenImageTest(const std::string& directory, bool bUpdate)
+{
+	m_directory = directory;
+	m_bUpdate = bUpdate;
+	m_checkCount = 0;
+	m_failureCount = 0;
+	m_imageDiff.SetThreshold(PIXEL_THRESHOLD);
+}
+
+/***********************************************************
+ *  ~GoldenImageTest()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GoldenImageTest::~GoldenImageTest()
+{
+}
+
+/***********************************************************
+ *  CheckFrame()
+ *
+ *  This method is used for reading back the frame just drawn
+ *  and checking it.  OpenGL returns the bottom row first, so
+ *  the rows are turned over to match the saved images.
+ ***********************************************************/
+bool GoldenImageTest::CheckFrame(const std::string& name, int width, int height)
+{
+	std::vector<unsigned char> bottomUp((size_t)width * height * 4);
+	std::vector<unsigned char> pixels(bottomUp.size());
+	size_t rowSize = (size_t)width * 4;
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, bottomUp.data());
+	for (int row = 0; row < height; row++)
+	{
+		memcpy(&pixels[row * rowSize], &bottomUp[(height - 1 - row) * rowSize], rowSize);
+	}
+
+	return(CheckImage(name, pixels, width, height));
+}
+
+/***********************************************************
+ *  CheckImage()
+ *
+ *  This method is used for comparing an image with its
+ *  golden image and reporting the result.
+ ***********************************************************/
+bool GoldenImageTest::CheckImage(const std::string& name, const std::vector<unsigned char>& pixels, int width, int height)
+{
+	std::string goldenFile = m_directory + "/" + name + ".qoi";
+	std::vector<unsigned char> golden;
+	int goldenWidth = 0;
+	int goldenHeight = 0;
+
+	m_checkCount++;
+
+	// an updated golden image is taken as it is
+	if (m_bUpdate == true)
+	{
+		if (FrameCapture::WriteQOI(goldenFile, pixels.data(), width, height) == false)
+		{
+			m_failureCount++;
+			return false;
+		}
+		std::cout << "GOLDEN: " << name << " saved as the golden image" << std::endl;
+		return true;
+	}
+
+	// a missing golden image fails rather than passing on the
+	// frame it would have been made from
+	if (FrameCapture::ReadQOI(goldenFile, golden, goldenWidth, goldenHeight) == false)
+	{
+		std::cout << "GOLDEN: " << name << " FAILED - " << goldenFile
+			<< " is missing, run with --golden-update to create it" << std::endl;
+		m_failureCount++;
+		return false;
+	}
+
+	if ((goldenWidth != width) || (goldenHeight != height))
+	{
+		std::cout << "GOLDEN: " << name << " FAILED - the golden image is " << goldenWidth << "x"
+			<< goldenHeight << " but the frame is " << width << "x" << height << std::endl;
+		FrameCapture::WritePNG(m_directory + "/" + name + "_actual.png", pixels.data(), width, height);
+		m_failureCount++;
+		return false;
+	}
+
+	ImageDiff::DIFF_RESULT result;
+	m_imageDiff.Compare(golden.data(), pixels.data(), width, height, result);
+
+	float differentFraction = (float)result.differentPixels / (float)(width * height);
+	bool bPassed = (differentFraction <= MAX_DIFFERENT_FRACTION);
+	std::cout << "GOLDEN: " << name << (bPassed ? " passed" : " FAILED") << " - "
+		<< result.differentPixels << " pixels differ, largest difference "
+		<< result.maxDifference << std::endl;
+
+	if (bPassed == false)
+	{
+		FrameCapture::WritePNG(m_directory + "/" + name + "_actual.png", pixels.data(), width, height);
+		FrameCapture::WritePNG(m_directory + "/" + name + "_diff.png", m_imageDiff.GetDiffImage().data(), width, height);
+		m_failureCount++;
+	}
+
+	return(bPassed);
+}
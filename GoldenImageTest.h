@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////
+// goldenimagetest.h
+// ============
+// compare rendered frames against stored golden images
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ImageDiff.h"
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  GoldenImageTest
+ *
+ *  This class contains the code for checking rendered frames
+ *  against the golden images kept in a directory, so changes
+ *  made for speed can be shown not to change the picture.  A
+ *  frame passes when only a small share of its pixels differ
+ *  noticeably from the golden image.  A failing frame is
+ *  saved next to its golden image along with an image of the
+ *  pixels that differ.  A frame with no golden image fails,
+ *  and every frame is saved as the golden image when
+ *  updating.
+ ***********************************************************/
+class GoldenImageTest
+{
+public:
+	// constructor
+	GoldenImageTest(const std::string& directory, bool bUpdate);
+	// destructor
+	~GoldenImageTest();
+
+	// check the frame drawn into the bound frame buffer
+	bool CheckFrame(const std::string& name, int width, int height);
+	// check an image of four bytes per pixel, top row first
+	bool CheckImage(const std::string& name, const std::vector<unsigned char>& pixels, int width, int height);
+
+	// get the number of frames checked and the number that failed
+	int GetCheckCount() const { return(m_checkCount); }
+	int GetFailureCount() const { return(m_failureCount); }
+
+private:
+	std::string m_directory;
+	bool m_bUpdate;
+	ImageDiff m_imageDiff;
+	int m_checkCount;
+	int m_failureCount;
+};
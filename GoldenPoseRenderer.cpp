@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+// goldenposerenderer.cpp
+// ============
+// check the milestone scenes against golden images from fixed camera poses
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GoldenPoseRenderer.h"
+#include "GoldenImageTest.h"
+
+#include <cstdio>
+#include <iostream>
+
+/***********************************************************
+ *  GoldenPoseRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GoldenPoseRenderer::GoldenPoseRenderer()
+{
+	m_framebufferID = 0;
+	m_colorBufferID = 0;
+	m_depthBufferID = 0;
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  ~GoldenPoseRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GoldenPoseRenderer::~GoldenPoseRenderer()
+{
+	GLuint renderbuffers[] = { m_colorBufferID, m_depthBufferID };
+
+	glDeleteRenderbuffers(2, renderbuffers);
+	glDeleteFramebuffers(1, &m_framebufferID);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the offscreen frame
+ *  buffer the frames are drawn into and read back from, the
+ *  same as the one of the batch renderer.
+ ***********************************************************/
+bool GoldenPoseRenderer::Initialize(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+
+	glGenRenderbuffers(1, &m_colorBufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glGenRenderbuffers(1, &m_depthBufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_framebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBufferID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBufferID);
+
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	if (bComplete == false)
+	{
+		std::cout << "Golden image frame buffer is incomplete" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	return(bComplete);
+}
+
+/***********************************************************
+ *  CheckPoses()
+ *
+ *  This method is used for drawing the scene from each pose
+ *  of the pose file and checking the frames against the
+ *  golden images, reporting how many of them match.
+ ***********************************************************/
+bool GoldenPoseRenderer::CheckPoses(
+	const std::string& directory,
+	const std::string& name,
+	bool bUpdate,
+	const DRAW_POSE& drawPose)
+{
+	CameraPath poses;
+	GoldenImageTest goldenTest(directory, bUpdate);
+	GLint sceneViewport[4];
+	bool bPassed = true;
+
+	if ((0 == m_framebufferID) ||
+		(poses.LoadFromFile(directory + "/" + name + "_poses.txt") == false))
+	{
+		return false;
+	}
+
+	glGetIntegerv(GL_VIEWPORT, sceneViewport);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+	glViewport(0, 0, m_width, m_height);
+
+	for (int i = 0; i < poses.GetKeyframeCount(); i++)
+	{
+		char suffix[16];
+
+		glEnable(GL_DEPTH_TEST);
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		drawPose(poses.GetKeyframe(i));
+
+		snprintf(suffix, sizeof(suffix), "_%02d", i);
+		bPassed = goldenTest.CheckFrame(name + suffix, m_width, m_height) && bPassed;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(sceneViewport[0], sceneViewport[1], sceneViewport[2], sceneViewport[3]);
+
+	std::cout << "GOLDEN: " << (goldenTest.GetCheckCount() - goldenTest.GetFailureCount())
+		<< " of " << goldenTest.GetCheckCount() << " frames match" << std::endl;
+
+	return(bPassed);
+}
@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////
+// goldenposerenderer.h
+// ============
+// check the milestone scenes against golden images from fixed camera poses
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "CameraPath.h"
+
+#include <GL/glew.h>
+
+#include <functional>
+#include <string>
+
+/***********************************************************
+ *  GoldenPoseRenderer
+ *
+ *  This class contains the code for checking the milestone
+ *  scenes, which have no batch renderer, against their
+ *  golden images.  The scene is drawn from every pose of
+ *  <directory>/<name>_poses.txt into an offscreen frame
+ *  buffer, since the pixels of a hidden window are not
+ *  defined, and each frame is checked against
+ *  <directory>/<name>_NN.qoi.
+ ***********************************************************/
+class GoldenPoseRenderer
+{
+public:
+	// places the camera at a pose and draws the scene into the
+	// cleared frame buffer
+	typedef std::function<void(const CameraPath::CAMERA_KEYFRAME& pose)> DRAW_POSE;
+
+	// constructor
+	GoldenPoseRenderer();
+	// destructor
+	~GoldenPoseRenderer();
+
+	// create the offscreen frame buffer of the image size
+	bool Initialize(int width, int height);
+
+	// draw the scene from every pose and check the frames,
+	// replacing the golden images when updating
+	bool CheckPoses(
+		const std::string& directory,
+		const std::string& name,
+		bool bUpdate,
+		const DRAW_POSE& drawPose);
+
+private:
+	// offscreen frame buffer and its color and depth
+	GLuint m_framebufferID;
+	GLuint m_colorBufferID;
+	GLuint m_depthBufferID;
+	int m_width;
+	int m_height;
+};
@@ -0,0 +1,258 @@
+///////////////////////////////////////////////////////////////////////////////
+// imagediff.cpp
+// ============
+// perceptual difference between two rendered images
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ImageDiff.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define DIFF_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+// declaration of the global variables and defines
+namespace
+{
+	// the difference of black and white, so a threshold from
+	// 0 to 1 can be scaled to the squared YIQ difference
+	const float MAX_YIQ_DIFFERENCE = 35215.0f;
+	// rows compared by a thread at a time
+	const int ROWS_PER_BAND = 16;
+	// how far the unchanged pixels are faded towards white
+	const float DIFF_IMAGE_FADE = 0.1f;
+
+	/***********************************************************
+	 *  PixelDifference()
+	 *
+	 *  This function is used for getting the squared YIQ
+	 *  difference between two pixels.  The YIQ conversion is
+	 *  linear, so the channel differences are converted.
+	 ***********************************************************/
+	float PixelDifference(const unsigned char* pExpected, const unsigned char* pActual)
+	{
+		float r = (float)pExpected[0] - (float)pActual[0];
+		float g = (float)pExpected[1] - (float)pActual[1];
+		float b = (float)pExpected[2] - (float)pActual[2];
+		float y = r * 0.29889531f + g * 0.58662247f + b * 0.11448223f;
+		float i = r * 0.59597799f - g * 0.27417610f - b * 0.32180189f;
+		float q = r * 0.21147017f - g * 0.52261711f + b * 0.31114694f;
+
+		return(0.5053f * y * y + 0.299f * i * i + 0.1957f * q * q);
+	}
+
+#ifdef DIFF_USE_SSE
+	/***********************************************************
+	 *  PixelDifference4()
+	 *
+	 *  This function is used for getting the squared YIQ
+	 *  differences of four pixels at once.
+	 ***********************************************************/
+	__m128 PixelDifference4(const unsigned char* pExpected, const unsigned char* pActual)
+	{
+		const __m128i byteMask = _mm_set1_epi32(0xFF);
+		__m128i expected = _mm_loadu_si128((const __m128i*)pExpected);
+		__m128i actual = _mm_loadu_si128((const __m128i*)pActual);
+
+		__m128 r = _mm_sub_ps(
+			_mm_cvtepi32_ps(_mm_and_si128(expected, byteMask)),
+			_mm_cvtepi32_ps(_mm_and_si128(actual, byteMask)));
+		__m128 g = _mm_sub_ps(
+			_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(expected, 8), byteMask)),
+			_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(actual, 8), byteMask)));
+		__m128 b = _mm_sub_ps(
+			_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(expected, 16), byteMask)),
+			_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(actual, 16), byteMask)));
+
+		__m128 y = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(r, _mm_set1_ps(0.29889531f)),
+			_mm_mul_ps(g, _mm_set1_ps(0.58662247f))),
+			_mm_mul_ps(b, _mm_set1_ps(0.11448223f)));
+		__m128 i = _mm_sub_ps(_mm_sub_ps(
+			_mm_mul_ps(r, _mm_set1_ps(0.59597799f)),
+			_mm_mul_ps(g, _mm_set1_ps(0.27417610f))),
+			_mm_mul_ps(b, _mm_set1_ps(0.32180189f)));
+		__m128 q = _mm_add_ps(_mm_sub_ps(
+			_mm_mul_ps(r, _mm_set1_ps(0.21147017f)),
+			_mm_mul_ps(g, _mm_set1_ps(0.52261711f))),
+			_mm_mul_ps(b, _mm_set1_ps(0.31114694f)));
+
+		return(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_mul_ps(y, y), _mm_set1_ps(0.5053f)),
+			_mm_mul_ps(_mm_mul_ps(i, i), _mm_set1_ps(0.299f))),
+			_mm_mul_ps(_mm_mul_ps(q, q), _mm_set1_ps(0.1957f))));
+	}
+#endif
+
+	/***********************************************************
+	 *  WriteDiffPixel()
+	 *
+	 *  This function is used for marking a pixel of the diff
+	 *  image - red when different, otherwise the brightness of
+	 *  the expected pixel faded towards white.
+	 ***********************************************************/
+	void WriteDiffPixel(const unsigned char* pExpected, unsigned char* pDiff, bool bDifferent)
+	{
+		if (bDifferent == true)
+		{
+			pDiff[0] = 255;
+			pDiff[1] = 0;
+			pDiff[2] = 0;
+		}
+		else
+		{
+			float luma = pExpected[0] * 0.29889531f + pExpected[1] * 0.58662247f + pExpected[2] * 0.11448223f;
+			unsigned char gray = (unsigned char)(255.0f + (luma - 255.0f) * DIFF_IMAGE_FADE);
+			pDiff[0] = gray;
+			pDiff[1] = gray;
+			pDiff[2] = gray;
+		}
+		pDiff[3] = 255;
+	}
+}
+
+/***********************************************************
+ *  ImageDiff()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ImageDiff::ImageDiff()
+{
+	m_threshold = 0.1f;
+	m_threadCount = std::max((int)std::thread::hardware_concurrency(), 1);
+}
+
+/***********************************************************
+ *  ~ImageDiff()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ImageDiff::~ImageDiff()
+{
+	m_diffImage.clear();
+}
+
+/***********************************************************
+ *  Compare()
+ *
+ *  This method is used for comparing two images.  Bands of
+ *  rows are handed out to the threads as they finish, and
+ *  each band counts into its own result so no locking is
+ *  needed until the results are added up.
+ ***********************************************************/
+void ImageDiff::Compare(
+	const unsigned char* pExpected,
+	const unsigned char* pActual,
+	int width,
+	int height,
+	DIFF_RESULT& result)
+{
+	int bandCount = (height + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	int threadCount = std::min(m_threadCount, bandCount);
+	std::vector<DIFF_RESULT> bandResults(bandCount);
+	std::vector<std::thread> workers;
+	std::atomic<int> nextBand(0);
+
+	m_diffImage.resize((size_t)width * height * 4);
+
+	auto worker = [&]()
+		{
+			int band = nextBand++;
+			while (band < bandCount)
+			{
+				int firstRow = band * ROWS_PER_BAND;
+				int lastRow = std::min(firstRow + ROWS_PER_BAND, height);
+				CompareRows(pExpected, pActual, width, firstRow, lastRow, bandResults[band]);
+				band = nextBand++;
+			}
+		};
+
+	for (int i = 1; i < threadCount; i++)
+	{
+		workers.push_back(std::thread(worker));
+	}
+	worker();
+	for (int i = 0; i < (int)workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	result.differentPixels = 0;
+	result.maxDifference = 0.0f;
+	for (int band = 0; band < bandCount; band++)
+	{
+		result.differentPixels += bandResults[band].differentPixels;
+		result.maxDifference = std::max(result.maxDifference, bandResults[band].maxDifference);
+	}
+	result.maxDifference = std::sqrt(result.maxDifference / MAX_YIQ_DIFFERENCE);
+}
+
+/***********************************************************
+ *  CompareRows()
+ *
+ *  This method is used for comparing a band of rows and
+ *  writing it into the diff image.  The largest difference
+ *  is kept squared until all of the bands are added up.
+ ***********************************************************/
+void ImageDiff::CompareRows(
+	const unsigned char* pExpected,
+	const unsigned char* pActual,
+	int width,
+	int firstRow,
+	int lastRow,
+	DIFF_RESULT& result)
+{
+	float maxDelta = MAX_YIQ_DIFFERENCE * m_threshold * m_threshold;
+	float largest = 0.0f;
+	int differentPixels = 0;
+
+	for (int row = firstRow; row < lastRow; row++)
+	{
+		size_t rowStart = (size_t)row * width * 4;
+		const unsigned char* pExpectedRow = pExpected + rowStart;
+		const unsigned char* pActualRow = pActual + rowStart;
+		unsigned char* pDiffRow = m_diffImage.data() + rowStart;
+		int x = 0;
+
+#ifdef DIFF_USE_SSE
+		const __m128 maxDelta4 = _mm_set1_ps(maxDelta);
+		__m128 largest4 = _mm_setzero_ps();
+		for (; x + 4 <= width; x += 4)
+		{
+			__m128 delta = PixelDifference4(pExpectedRow + x * 4, pActualRow + x * 4);
+			int mask = _mm_movemask_ps(_mm_cmpgt_ps(delta, maxDelta4));
+
+			largest4 = _mm_max_ps(largest4, delta);
+			for (int i = 0; i < 4; i++)
+			{
+				bool bDifferent = ((mask >> i) & 1) != 0;
+				WriteDiffPixel(pExpectedRow + (x + i) * 4, pDiffRow + (x + i) * 4, bDifferent);
+				differentPixels += bDifferent ? 1 : 0;
+			}
+		}
+		float lanes[4];
+		_mm_storeu_ps(lanes, largest4);
+		largest = std::max(largest, std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3])));
+#endif
+		for (; x < width; x++)
+		{
+			float delta = PixelDifference(pExpectedRow + x * 4, pActualRow + x * 4);
+			bool bDifferent = (delta > maxDelta);
+
+			largest = std::max(largest, delta);
+			WriteDiffPixel(pExpectedRow + x * 4, pDiffRow + x * 4, bDifferent);
+			differentPixels += bDifferent ? 1 : 0;
+		}
+	}
+
+	result.differentPixels = differentPixels;
+	result.maxDifference = largest;
+}
@@ -0,0 +1,69 @@
+///////////////////////////////////////////////////////////////////////////////
+// imagediff.h
+// ============
+// perceptual difference between two rendered images
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+
+/***********************************************************
+ *  ImageDiff
+ *
+ *  This class contains the code for comparing two images of
+ *  four bytes per pixel the way the eye would.  The color
+ *  difference of each pixel is measured in YIQ, where
+ *  brightness counts most and the two color axes less, and
+ *  the pixels past a threshold are counted and marked in red
+ *  on a faded copy of the expected image.  The rows are
+ *  split between threads and four pixels are measured at
+ *  once with SSE2 where it is available.
+ ***********************************************************/
+class ImageDiff
+{
+public:
+	// constructor
+	ImageDiff();
+	// destructor
+	~ImageDiff();
+
+	// counts from the last comparison
+	struct DIFF_RESULT
+	{
+		int differentPixels;
+		// largest difference of any pixel, from 0 to 1
+		float maxDifference;
+	};
+
+	// set the difference from 0 to 1 a pixel may have before it
+	// counts as different
+	void SetThreshold(float threshold) { m_threshold = threshold; }
+
+	// compare two images of the same size
+	void Compare(
+		const unsigned char* pExpected,
+		const unsigned char* pActual,
+		int width,
+		int height,
+		DIFF_RESULT& result);
+
+	// get the image of the last comparison, different pixels in
+	// red over the faded expected image
+	const std::vector<unsigned char>& GetDiffImage() const { return(m_diffImage); }
+
+private:
+	float m_threshold;
+	int m_threadCount;
+	std::vector<unsigned char> m_diffImage;
+
+	// compare a band of rows into the diff image
+	void CompareRows(
+		const unsigned char* pExpected,
+		const unsigned char* pActual,
+		int width,
+		int firstRow,
+		int lastRow,
+		DIFF_RESULT& result);
+};
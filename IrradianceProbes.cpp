@@ -0,0 +1,276 @@
+///////////////////////////////////////////////////////////////////////////////
+// irradianceprobes.cpp
+// ============
+// bake a grid of spherical harmonics irradiance probes from the static lights
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "IrradianceProbes.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+// declaration of the global variables and defines
+namespace
+{
+	const float PI = 3.14159265f;
+	// distance between neighboring probes, widened for large scenes
+	const float PROBE_SPACING = 2.0f;
+	const int MAX_PROBES_PER_AXIS = 16;
+	// directions traced from every probe for the bounced light
+	const int PROBE_SAMPLES = 256;
+
+	/***********************************************************
+	 *  EvaluateBasis()
+	 *
+	 *  This function is used for evaluating the nine second
+	 *  order spherical harmonics basis functions for a unit
+	 *  direction.  The fragment shader uses the same order.
+	 ***********************************************************/
+	void EvaluateBasis(const glm::vec3& direction, float basis[IrradianceProbes::SH_COEFFICIENTS])
+	{
+		basis[0] = 0.282095f;
+		basis[1] = 0.488603f * direction.y;
+		basis[2] = 0.488603f * direction.z;
+		basis[3] = 0.488603f * direction.x;
+		basis[4] = 1.092548f * direction.x * direction.y;
+		basis[5] = 1.092548f * direction.y * direction.z;
+		basis[6] = 0.315392f * (3.0f * direction.z * direction.z - 1.0f);
+		basis[7] = 1.092548f * direction.x * direction.z;
+		basis[8] = 0.546274f * (direction.x * direction.x - direction.y * direction.y);
+	}
+
+	/***********************************************************
+	 *  GetSampleDirection()
+	 *
+	 *  This function is used for spreading the sample directions
+	 *  evenly over the sphere along a Fibonacci spiral.
+	 ***********************************************************/
+	glm::vec3 GetSampleDirection(int sample, int sampleCount)
+	{
+		float height = 1.0f - (2.0f * sample + 1.0f) / (float)sampleCount;
+		float radius = std::sqrt(std::max(1.0f - height * height, 0.0f));
+		// the golden angle keeps neighboring samples apart
+		float angle = 2.39996323f * (float)sample;
+
+		return(glm::vec3(radius * std::cos(angle), height, radius * std::sin(angle)));
+	}
+}
+
+/***********************************************************
+ *  IrradianceProbes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+IrradianceProbes::IrradianceProbes()
+{
+	m_gridMin = glm::vec3(0.0f);
+	m_gridSize = glm::ivec3(0, 0, 0);
+	m_spacing = PROBE_SPACING;
+}
+
+/***********************************************************
+ *  ~IrradianceProbes()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+IrradianceProbes::~IrradianceProbes()
+{
+	m_coefficients.clear();
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method is used for placing the grid around the
+ *  static shapes and baking all of the probes, handed out
+ *  to the worker threads one at a time.
+ ***********************************************************/
+void IrradianceProbes::Bake(const LightmapBaker& scene, int threadCount)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	const SceneBVH& sceneBVH = scene.GetSceneBVH();
+	glm::vec3 sceneMin = glm::vec3(1.0e30f);
+	glm::vec3 sceneMax = glm::vec3(-1.0e30f);
+	std::atomic<int> nextProbe(0);
+	std::vector<std::thread> workers;
+
+	for (int i = 0; i < sceneBVH.GetInstanceCount(); i++)
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		sceneBVH.GetInstanceBounds(i, boundsMin, boundsMax);
+		sceneMin = glm::min(sceneMin, boundsMin);
+		sceneMax = glm::max(sceneMax, boundsMax);
+	}
+	if (sceneBVH.GetInstanceCount() == 0)
+	{
+		sceneMin = glm::vec3(0.0f);
+		sceneMax = glm::vec3(0.0f);
+	}
+
+	glm::vec3 extent = sceneMax - sceneMin;
+	float longest = std::max(extent.x, std::max(extent.y, extent.z));
+	m_spacing = std::max(PROBE_SPACING, longest / (float)(MAX_PROBES_PER_AXIS - 1));
+	m_gridMin = sceneMin;
+	m_gridSize = glm::ivec3(
+		std::max((int)std::ceil(extent.x / m_spacing) + 1, 2),
+		std::max((int)std::ceil(extent.y / m_spacing) + 1, 2),
+		std::max((int)std::ceil(extent.z / m_spacing) + 1, 2));
+	m_coefficients.assign(GetProbeCount() * SH_COEFFICIENTS, glm::vec3(0.0f));
+
+	if (threadCount < 1)
+	{
+		threadCount = 1;
+	}
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers.push_back(std::thread([this, &scene, &nextProbe]()
+			{
+				int probe = nextProbe++;
+				while (probe < GetProbeCount())
+				{
+					BakeProbe(scene, probe);
+					probe = nextProbe++;
+				}
+			}));
+	}
+	for (int i = 0; i < (int)workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+	std::cout << "Baked " << m_gridSize.x << "x" << m_gridSize.y << "x" << m_gridSize.z
+		<< " irradiance probes in " << elapsed.count() << " ms" << std::endl;
+}
+
+/***********************************************************
+ *  BakeProbe()
+ *
+ *  This method is used for baking one probe.  Light bounced
+ *  off the static shapes is found by tracing rays in every
+ *  direction and taking the diffuse light leaving the point
+ *  each ray lands on.  The static lights themselves are
+ *  added as single directions when the probe can see them.
+ *  The result is convolved with the cosine lobe, so the
+ *  shader only evaluates the basis for its normal.
+ ***********************************************************/
+void IrradianceProbes::BakeProbe(const LightmapBaker& scene, int probe)
+{
+	glm::vec3* coefficients = &m_coefficients[probe * SH_COEFFICIENTS];
+	int x = probe % m_gridSize.x;
+	int y = (probe / m_gridSize.x) % m_gridSize.y;
+	int z = probe / (m_gridSize.x * m_gridSize.y);
+	glm::vec3 position = m_gridMin + glm::vec3((float)x, (float)y, (float)z) * m_spacing;
+	float basis[SH_COEFFICIENTS];
+	// each sample covers an equal part of the sphere
+	float sampleWeight = 4.0f * PI / (float)PROBE_SAMPLES;
+
+	for (int sample = 0; sample < PROBE_SAMPLES; sample++)
+	{
+		glm::vec3 direction = GetSampleDirection(sample, PROBE_SAMPLES);
+		SceneBVH::RAY_HIT hit;
+
+		if (scene.GetSceneBVH().Intersect(position, direction, 1.0e30f, hit) == false)
+		{
+			continue;
+		}
+		// the back of a surface does not reflect anything
+		if (glm::dot(hit.normal, direction) >= 0.0f)
+		{
+			continue;
+		}
+
+		// diffuse surfaces spread the light arriving at them over the hemisphere
+		glm::vec3 radiance = scene.GetObjectAlbedo(hit.instance) *
+			scene.GatherLight(hit.position, hit.normal) / PI;
+		EvaluateBasis(direction, basis);
+		for (int i = 0; i < SH_COEFFICIENTS; i++)
+		{
+			coefficients[i] += radiance * (basis[i] * sampleWeight);
+		}
+	}
+
+	for (int light = 0; light < scene.GetLightCount(); light++)
+	{
+		glm::vec3 direction;
+		glm::vec3 diffuse;
+
+		if (scene.SampleLight(light, position, direction, diffuse) == true)
+		{
+			EvaluateBasis(direction, basis);
+			for (int i = 0; i < SH_COEFFICIENTS; i++)
+			{
+				coefficients[i] += diffuse * basis[i];
+			}
+		}
+	}
+
+	// cosine lobe convolution for each band
+	coefficients[0] *= PI;
+	for (int i = 1; i < 4; i++)
+	{
+		coefficients[i] *= 2.0f * PI / 3.0f;
+	}
+	for (int i = 4; i < SH_COEFFICIENTS; i++)
+	{
+		coefficients[i] *= PI / 4.0f;
+	}
+}
+
+/***********************************************************
+ *  Sample()
+ *
+ *  This method is used for blending the eight probes around
+ *  a position by their distance to it.  Positions outside
+ *  of the grid use the nearest probes on its edge.
+ ***********************************************************/
+void IrradianceProbes::Sample(const glm::vec3& position, glm::vec3 coefficients[SH_COEFFICIENTS]) const
+{
+	for (int i = 0; i < SH_COEFFICIENTS; i++)
+	{
+		coefficients[i] = glm::vec3(0.0f);
+	}
+	if (m_coefficients.size() == 0)
+	{
+		return;
+	}
+
+	glm::vec3 gridPosition = (position - m_gridMin) / m_spacing;
+	int cell[3];
+	float fraction[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float limit = (float)(m_gridSize[axis] - 1);
+		float clamped = glm::clamp(gridPosition[axis], 0.0f, limit);
+		cell[axis] = std::min((int)clamped, m_gridSize[axis] - 2);
+		fraction[axis] = clamped - (float)cell[axis];
+	}
+
+	for (int corner = 0; corner < 8; corner++)
+	{
+		int offset[3] = { corner & 1, (corner >> 1) & 1, (corner >> 2) & 1 };
+		float weight = 1.0f;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			weight *= (offset[axis] == 1) ? fraction[axis] : 1.0f - fraction[axis];
+		}
+		if (weight <= 0.0f)
+		{
+			continue;
+		}
+
+		int probe = (cell[0] + offset[0]) +
+			(cell[1] + offset[1]) * m_gridSize.x +
+			(cell[2] + offset[2]) * m_gridSize.x * m_gridSize.y;
+		const glm::vec3* probeCoefficients = &m_coefficients[probe * SH_COEFFICIENTS];
+		for (int i = 0; i < SH_COEFFICIENTS; i++)
+		{
+			coefficients[i] += probeCoefficients[i] * weight;
+		}
+	}
+}
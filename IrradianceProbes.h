@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+// irradianceprobes.h
+// ============
+// bake a grid of spherical harmonics irradiance probes from the static lights
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "LightmapBaker.h"
+
+#include <vector>
+
+/***********************************************************
+ *  IrradianceProbes
+ *
+ *  This class contains the code for baking a grid of light
+ *  probes around the static scene.  Each probe stores the
+ *  light arriving from every direction - straight from the
+ *  static lights and bounced off the static shapes - as nine
+ *  second order spherical harmonics coefficients, already
+ *  convolved with the cosine lobe so that evaluating them
+ *  for a normal gives the diffuse irradiance.
+ ***********************************************************/
+class IrradianceProbes
+{
+public:
+	// constructor
+	IrradianceProbes();
+	// destructor
+	~IrradianceProbes();
+
+	// coefficients in a second order spherical harmonics probe
+	static const int SH_COEFFICIENTS = 9;
+
+	// bake the probes from the shapes and lights of the lightmap
+	void Bake(const LightmapBaker& scene, int threadCount);
+
+	// blend the eight probes around a position
+	void Sample(const glm::vec3& position, glm::vec3 coefficients[SH_COEFFICIENTS]) const;
+
+	// get the number of probes in the grid
+	int GetProbeCount() const { return(m_gridSize.x * m_gridSize.y * m_gridSize.z); }
+
+private:
+	// corner of the grid and number of probes along each axis
+	glm::vec3 m_gridMin;
+	glm::ivec3 m_gridSize;
+	float m_spacing;
+	// coefficients of every probe, x first then y then z
+	std::vector<glm::vec3> m_coefficients;
+
+	// bake the probe at a grid index
+	void BakeProbe(const LightmapBaker& scene, int probe);
+};
@@ -0,0 +1,267 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightculler.cpp
+// ============
+// find the lights in range of each shape - bounding volume hierarchy of lights
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightCuller.h"
+
+#include <algorithm>
+
+// declaration of the global variables and defines
+namespace
+{
+	// lights per leaf before a node is split
+	const int MAX_LEAF_LIGHTS = 2;
+	// deepest search stack needed by the tree
+	const int MAX_QUERY_DEPTH = 64;
+	// most lights gathered before keeping the nearest
+	const int MAX_CANDIDATES = 64;
+	// half the size of the box around a light with no range,
+	// which reaches everything as the shader never fades it
+	const float UNBOUNDED_EXTENT = 1.0e30f;
+
+	/***********************************************************
+	 *  DistanceSquaredToBounds()
+	 *
+	 *  This function is used for getting the squared distance
+	 *  from a point to the nearest point of a box.
+	 ***********************************************************/
+	float DistanceSquaredToBounds(
+		const glm::vec3& point,
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax)
+	{
+		glm::vec3 nearest = glm::clamp(point, boundsMin, boundsMax);
+		glm::vec3 offset = point - nearest;
+		return(glm::dot(offset, offset));
+	}
+
+	/***********************************************************
+	 *  BoundsOverlap()
+	 *
+	 *  This function is used for checking whether two boxes
+	 *  overlap.
+	 ***********************************************************/
+	bool BoundsOverlap(
+		const glm::vec3& minA,
+		const glm::vec3& maxA,
+		const glm::vec3& minB,
+		const glm::vec3& maxB)
+	{
+		return((minA.x <= maxB.x) && (maxA.x >= minB.x) &&
+			(minA.y <= maxB.y) && (maxA.y >= minB.y) &&
+			(minA.z <= maxB.z) && (maxA.z >= minB.z));
+	}
+}
+
+/***********************************************************
+ *  LightCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightCuller::LightCuller()
+{
+}
+
+/***********************************************************
+ *  ~LightCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+LightCuller::~LightCuller()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all of the lights and
+ *  the tree built over them.
+ ***********************************************************/
+void LightCuller::Clear()
+{
+	m_lights.clear();
+	m_nodes.clear();
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used for adding a light with the index it
+ *  has in the light array of the shader.  A light added with
+ *  an index already in use replaces the earlier one.  A range
+ *  of zero or less is unbounded, the same as in the shader.
+ ***********************************************************/
+void LightCuller::AddLight(int lightIndex, const glm::vec3& position, float range)
+{
+	CULL_LIGHT light;
+	float extent = (range > 0.0f) ? range : UNBOUNDED_EXTENT;
+	light.lightIndex = lightIndex;
+	light.position = position;
+	light.range = range;
+	light.boundsMin = position - glm::vec3(extent);
+	light.boundsMax = position + glm::vec3(extent);
+
+	for (int i = 0; i < (int)m_lights.size(); i++)
+	{
+		if (m_lights[i].lightIndex == lightIndex)
+		{
+			m_lights[i] = light;
+			return;
+		}
+	}
+	m_lights.push_back(light);
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for building the tree over all of
+ *  the added lights.
+ ***********************************************************/
+void LightCuller::Build()
+{
+	m_nodes.clear();
+	if (m_lights.size() > 0)
+	{
+		m_nodes.reserve(m_lights.size() * 2);
+		BuildNode(0, (int)m_lights.size());
+	}
+}
+
+/***********************************************************
+ *  BuildNode()
+ *
+ *  This method is used for building the node covering a
+ *  range of lights, split at the middle light along the
+ *  longest axis of their positions.
+ ***********************************************************/
+int LightCuller::BuildNode(int first, int count)
+{
+	int nodeIndex = (int)m_nodes.size();
+	CULL_NODE node;
+	glm::vec3 centerMin = glm::vec3(1.0e30f);
+	glm::vec3 centerMax = glm::vec3(-1.0e30f);
+
+	node.boundsMin = glm::vec3(1.0e30f);
+	node.boundsMax = glm::vec3(-1.0e30f);
+	node.secondChild = -1;
+	node.firstLight = first;
+	node.lightCount = count;
+
+	for (int i = first; i < first + count; i++)
+	{
+		node.boundsMin = glm::min(node.boundsMin, m_lights[i].boundsMin);
+		node.boundsMax = glm::max(node.boundsMax, m_lights[i].boundsMax);
+		centerMin = glm::min(centerMin, m_lights[i].position);
+		centerMax = glm::max(centerMax, m_lights[i].position);
+	}
+	m_nodes.push_back(node);
+
+	if (count <= MAX_LEAF_LIGHTS)
+	{
+		return(nodeIndex);
+	}
+
+	glm::vec3 extent = centerMax - centerMin;
+	int axis = 0;
+	if (extent.y > extent[axis])
+	{
+		axis = 1;
+	}
+	if (extent.z > extent[axis])
+	{
+		axis = 2;
+	}
+
+	int half = count / 2;
+	std::nth_element(
+		m_lights.begin() + first,
+		m_lights.begin() + first + half,
+		m_lights.begin() + first + count,
+		[axis](const CULL_LIGHT& a, const CULL_LIGHT& b)
+		{
+			return(a.position[axis] < b.position[axis]);
+		});
+
+	BuildNode(first, half);
+	int secondChild = BuildNode(first + half, count - half);
+
+	m_nodes[nodeIndex].secondChild = secondChild;
+	m_nodes[nodeIndex].lightCount = 0;
+	return(nodeIndex);
+}
+
+/***********************************************************
+ *  Query()
+ *
+ *  This method is used for finding the lights whose sphere
+ *  of influence touches a box.  When more lights reach it
+ *  than the shader takes, the ones nearest to the box
+ *  relative to their range are kept, unbounded lights
+ *  first.
+ ***********************************************************/
+int LightCuller::Query(
+	const glm::vec3& boundsMin,
+	const glm::vec3& boundsMax,
+	int lightIndices[MAX_LIGHTS_PER_OBJECT]) const
+{
+	int stack[MAX_QUERY_DEPTH];
+	int stackSize = 0;
+	std::pair<float, int> candidates[MAX_CANDIDATES];
+	int candidateCount = 0;
+
+	if (m_nodes.size() == 0)
+	{
+		return(0);
+	}
+
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		int nodeIndex = stack[--stackSize];
+		const CULL_NODE& node = m_nodes[nodeIndex];
+
+		if (BoundsOverlap(node.boundsMin, node.boundsMax, boundsMin, boundsMax) == false)
+		{
+			continue;
+		}
+
+		if (node.lightCount > 0)
+		{
+			for (int i = node.firstLight; (i < node.firstLight + node.lightCount) && (candidateCount < MAX_CANDIDATES); i++)
+			{
+				const CULL_LIGHT& light = m_lights[i];
+				float distanceSquared = DistanceSquaredToBounds(light.position, boundsMin, boundsMax);
+				// an unbounded light reaches every shape at full
+				// strength, so it is kept before any other
+				if (light.range <= 0.0f)
+				{
+					candidates[candidateCount++] = std::make_pair(0.0f, light.lightIndex);
+				}
+				else if (distanceSquared <= light.range * light.range)
+				{
+					candidates[candidateCount++] = std::make_pair(distanceSquared / (light.range * light.range), light.lightIndex);
+				}
+			}
+			continue;
+		}
+
+		if (stackSize + 2 <= MAX_QUERY_DEPTH)
+		{
+			stack[stackSize++] = node.secondChild;
+			stack[stackSize++] = nodeIndex + 1;
+		}
+	}
+
+	int count = std::min(candidateCount, (int)MAX_LIGHTS_PER_OBJECT);
+	std::partial_sort(candidates, candidates + count, candidates + candidateCount);
+	for (int i = 0; i < count; i++)
+	{
+		lightIndices[i] = candidates[i].second;
+	}
+	return(count);
+}
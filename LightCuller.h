@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightculler.h
+// ============
+// find the lights in range of each shape - bounding volume hierarchy of lights
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  LightCuller
+ *
+ *  This class contains the code for finding which lights
+ *  reach a shape.  Every light has a range past which it
+ *  adds nothing, and a binary tree of boxes around those
+ *  spheres of influence is searched with the bounds of the
+ *  shape, so the shader only loops over the lights nearby.
+ ***********************************************************/
+class LightCuller
+{
+public:
+	// constructor
+	LightCuller();
+	// destructor
+	~LightCuller();
+
+	// most lights passed to the shader for one shape, must
+	// match MAX_OBJECT_LIGHTS in the fragment shader
+	static const int MAX_LIGHTS_PER_OBJECT = 4;
+
+	// remove all of the lights
+	void Clear();
+	// add a light by its index in the shader - a range of zero
+	// or less reaches everything
+	void AddLight(int lightIndex, const glm::vec3& position, float range);
+	// build the tree over the added lights
+	void Build();
+
+	// find the lights reaching a box, nearest first, and
+	// return how many were written
+	int Query(
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax,
+		int lightIndices[MAX_LIGHTS_PER_OBJECT]) const;
+
+private:
+	// light with the box around its sphere of influence
+	struct CULL_LIGHT
+	{
+		int lightIndex;
+		glm::vec3 position;
+		float range;
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+	};
+
+	// node of the tree - the first child directly follows the
+	// node, leaves list a range of lights
+	struct CULL_NODE
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		int secondChild;
+		int firstLight;
+		int lightCount;
+	};
+
+	std::vector<CULL_LIGHT> m_lights;
+	std::vector<CULL_NODE> m_nodes;
+
+	// recursively build the node covering a range of lights
+	int BuildNode(int first, int count);
+};
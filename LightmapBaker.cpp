@@ -0,0 +1,529 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmapbaker.cpp
+// ============
+// bake the lighting of static lights into a lightmap atlas on the CPU
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightmapBaker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+// declaration of the global variables and defines
+namespace
+{
+	// texels per world unit, limited per tile
+	const float TEXELS_PER_UNIT = 8.0f;
+	const int MIN_TILE_TEXELS = 8;
+	const int MAX_TILE_TEXELS = 128;
+	// width of the atlas, the height grows with the shapes
+	const int ATLAS_WIDTH = 1024;
+	// distance rays start away from a surface
+	const float SURFACE_OFFSET = 2.0e-3f;
+	// passes spreading the baked texels into missed ones
+	const int DILATE_PASSES = 2;
+	// identifies the saved atlas files
+	const uint32_t LIGHTMAP_FILE_MAGIC = 0x50414D4C;
+	const uint32_t LIGHTMAP_FILE_VERSION = 1;
+}
+
+/***********************************************************
+ *  LightmapBaker()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightmapBaker::LightmapBaker()
+{
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  ~LightmapBaker()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+LightmapBaker::~LightmapBaker()
+{
+	m_lights.clear();
+	m_objects.clear();
+	m_rects.clear();
+	m_pixels.clear();
+	m_coverage.clear();
+}
+
+/***********************************************************
+ *  AddDirectionalLight()
+ *
+ *  This method is used for adding a static directional light
+ *  that travels along the passed in direction.
+ ***********************************************************/
+void LightmapBaker::AddDirectionalLight(const glm::vec3& direction, const glm::vec3& diffuse)
+{
+	BAKE_LIGHT light;
+	light.vector = glm::normalize(direction);
+	light.diffuse = diffuse;
+	light.range = 0.0f;
+	light.bDirectional = true;
+	m_lights.push_back(light);
+}
+
+/***********************************************************
+ *  AddPointLight()
+ *
+ *  This method is used for adding a static point light.
+ ***********************************************************/
+void LightmapBaker::AddPointLight(const glm::vec3& position, const glm::vec3& diffuse, float range)
+{
+	BAKE_LIGHT light;
+	light.vector = position;
+	light.diffuse = diffuse;
+	light.range = range;
+	light.bDirectional = false;
+	m_lights.push_back(light);
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method is used for adding a static shape that gets
+ *  a block in the atlas.  It also casts shadows onto the
+ *  other baked shapes.
+ ***********************************************************/
+int LightmapBaker::AddObject(SceneManager::SHAPE_TYPE shape, const glm::mat4& model, const glm::vec3& albedo)
+{
+	BAKE_OBJECT object;
+	object.shape = shape;
+	object.model = model;
+	object.albedo = albedo;
+	m_objects.push_back(object);
+	m_sceneBVH.AddInstance(shape, model);
+
+	return((int)m_objects.size() - 1);
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method is used for baking the atlas.  The tiles of
+ *  all of the shapes are handed out to the worker threads
+ *  one at a time, and each thread writes only the texels of
+ *  the tiles it took.
+ ***********************************************************/
+void LightmapBaker::Bake(int threadCount)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	std::atomic<int> nextTile(0);
+	int tileCount = (int)m_objects.size() * 6;
+	std::vector<std::thread> workers;
+
+	m_sceneBVH.Build();
+	LayoutAtlas();
+
+	if (threadCount < 1)
+	{
+		threadCount = 1;
+	}
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers.push_back(std::thread([this, &nextTile, tileCount]()
+			{
+				int tile = nextTile++;
+				while (tile < tileCount)
+				{
+					BakeTile(tile / 6, tile % 6);
+					tile = nextTile++;
+				}
+			}));
+	}
+	for (int i = 0; i < (int)workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+	std::cout << "Baked " << m_width << "x" << m_height << " lightmap for "
+		<< m_objects.size() << " shapes on " << threadCount << " threads in "
+		<< elapsed.count() << " ms" << std::endl;
+}
+
+/***********************************************************
+ *  LayoutAtlas()
+ *
+ *  This method is used for placing the block of every shape
+ *  in the atlas.  Tiles are sized by the world size of the
+ *  shape, and the blocks are packed in rows from the largest
+ *  down so each row wastes little space.
+ ***********************************************************/
+void LightmapBaker::LayoutAtlas()
+{
+	std::vector<int> order;
+	std::vector<glm::ivec2> origins;
+	int rowX = 0;
+	int rowY = 0;
+	int rowHeight = 0;
+
+	m_rects.resize(m_objects.size());
+	origins.resize(m_objects.size());
+
+	for (int i = 0; i < (int)m_objects.size(); i++)
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		m_sceneBVH.GetInstanceBounds(i, boundsMin, boundsMax);
+		glm::vec3 extent = boundsMax - boundsMin;
+		float size = std::max(extent.x, std::max(extent.y, extent.z)) * TEXELS_PER_UNIT;
+
+		int tileTexels = MIN_TILE_TEXELS;
+		while ((tileTexels < size) && (tileTexels < MAX_TILE_TEXELS))
+		{
+			tileTexels *= 2;
+		}
+		m_rects[i].tileTexels = tileTexels;
+		m_rects[i].border = 1.0f / (float)tileTexels;
+		order.push_back(i);
+	}
+
+	std::sort(order.begin(), order.end(), [this](int a, int b)
+		{
+			return(m_rects[a].tileTexels > m_rects[b].tileTexels);
+		});
+
+	// blocks are three tiles wide and two tiles high
+	for (int i = 0; i < (int)order.size(); i++)
+	{
+		int tileTexels = m_rects[order[i]].tileTexels;
+		if (rowX + tileTexels * 3 > ATLAS_WIDTH)
+		{
+			rowX = 0;
+			rowY += rowHeight;
+			rowHeight = 0;
+		}
+		origins[order[i]] = glm::ivec2(rowX, rowY);
+		rowX += tileTexels * 3;
+		rowHeight = std::max(rowHeight, tileTexels * 2);
+	}
+
+	m_width = ATLAS_WIDTH;
+	m_height = std::max(rowY + rowHeight, 1);
+	m_pixels.assign(m_width * m_height * 3, 0.0f);
+	m_coverage.assign(m_width * m_height, 0);
+
+	for (int i = 0; i < (int)m_objects.size(); i++)
+	{
+		int tileTexels = m_rects[i].tileTexels;
+		m_rects[i].rect = glm::vec4(
+			(float)origins[i].x / (float)m_width,
+			(float)origins[i].y / (float)m_height,
+			(float)(tileTexels * 3) / (float)m_width,
+			(float)(tileTexels * 2) / (float)m_height);
+	}
+}
+
+/***********************************************************
+ *  BakeTile()
+ *
+ *  This method is used for baking one of the six tiles of a
+ *  shape.  The tiles are laid out +X -X +Y on the bottom row
+ *  and -Y +Z -Z on the top row, and each covers one side of
+ *  the object space box.  For every texel a ray is cast at
+ *  the shape from that side of the box, and the light is
+ *  gathered where it lands.  The outer ring of texels is the
+ *  gutter, which repeats the edge of the tile so filtering
+ *  never reaches into the neighboring tile.  This must stay
+ *  in step with CalcLightmapCoordinate() in the fragment
+ *  shader.
+ ***********************************************************/
+void LightmapBaker::BakeTile(int object, int tile)
+{
+	const LIGHTMAP_RECT& lightmapRect = m_rects[object];
+	const BAKE_OBJECT& bakeObject = m_objects[object];
+	int tileTexels = lightmapRect.tileTexels;
+	int originX = (int)(lightmapRect.rect.x * m_width + 0.5f) + (tile % 3) * tileTexels;
+	int originY = (int)(lightmapRect.rect.y * m_height + 0.5f) + (tile / 3) * tileTexels;
+	int axis = tile / 2;
+	float side = ((tile % 2) == 0) ? 1.0f : -1.0f;
+	// the two box axes spanning the tile
+	int axisU = (axis == 0) ? 2 : 0;
+	int axisV = (axis == 1) ? 2 : 1;
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+	glm::vec3 localDirection = glm::vec3(0.0f);
+
+	SceneBVH::GetShapeBounds(bakeObject.shape, boundsMin, boundsMax);
+	localDirection[axis] = -side;
+	glm::vec3 direction = glm::mat3(bakeObject.model) * localDirection;
+	float margin = (boundsMax[axis] - boundsMin[axis]) * 0.01f;
+
+	for (int y = 0; y < tileTexels; y++)
+	{
+		for (int x = 0; x < tileTexels; x++)
+		{
+			float u = ((x + 0.5f) / tileTexels - lightmapRect.border) / (1.0f - 2.0f * lightmapRect.border);
+			float v = ((y + 0.5f) / tileTexels - lightmapRect.border) / (1.0f - 2.0f * lightmapRect.border);
+			glm::vec3 localOrigin;
+			SceneBVH::RAY_HIT hit;
+
+			u = glm::clamp(u, 0.0f, 1.0f);
+			v = glm::clamp(v, 0.0f, 1.0f);
+			localOrigin[axisU] = boundsMin[axisU] + (boundsMax[axisU] - boundsMin[axisU]) * u;
+			localOrigin[axisV] = boundsMin[axisV] + (boundsMax[axisV] - boundsMin[axisV]) * v;
+			localOrigin[axis] = (side > 0.0f) ? boundsMax[axis] + margin : boundsMin[axis] - margin;
+			glm::vec3 origin = glm::vec3(bakeObject.model * glm::vec4(localOrigin, 1.0f));
+
+			if (m_sceneBVH.IntersectInstance(object, origin, direction, 1.0e30f, hit) == true)
+			{
+				int texel = (originY + y) * m_width + originX + x;
+				glm::vec3 light = GatherLight(hit.position, hit.normal);
+				m_pixels[texel * 3 + 0] = light.r;
+				m_pixels[texel * 3 + 1] = light.g;
+				m_pixels[texel * 3 + 2] = light.b;
+				m_coverage[texel] = 1;
+			}
+		}
+	}
+
+	// spread into texels whose rays missed the shape, staying inside the tile
+	for (int pass = 0; pass < DILATE_PASSES; pass++)
+	{
+		std::vector<unsigned char> filled(tileTexels * tileTexels, 0);
+		for (int y = 0; y < tileTexels; y++)
+		{
+			for (int x = 0; x < tileTexels; x++)
+			{
+				int texel = (originY + y) * m_width + originX + x;
+				glm::vec3 sum = glm::vec3(0.0f);
+				int count = 0;
+
+				if (m_coverage[texel] != 0)
+				{
+					continue;
+				}
+				for (int neighbor = 0; neighbor < 4; neighbor++)
+				{
+					int nx = x + ((neighbor == 0) ? -1 : (neighbor == 1) ? 1 : 0);
+					int ny = y + ((neighbor == 2) ? -1 : (neighbor == 3) ? 1 : 0);
+					if ((nx < 0) || (ny < 0) || (nx >= tileTexels) || (ny >= tileTexels))
+					{
+						continue;
+					}
+					int other = (originY + ny) * m_width + originX + nx;
+					if (m_coverage[other] != 0)
+					{
+						sum += glm::vec3(m_pixels[other * 3 + 0], m_pixels[other * 3 + 1], m_pixels[other * 3 + 2]);
+						count++;
+					}
+				}
+				if (count > 0)
+				{
+					sum /= (float)count;
+					m_pixels[texel * 3 + 0] = sum.r;
+					m_pixels[texel * 3 + 1] = sum.g;
+					m_pixels[texel * 3 + 2] = sum.b;
+					filled[y * tileTexels + x] = 1;
+				}
+			}
+		}
+		// mark the filled texels only after the pass so it spreads one texel
+		for (int y = 0; y < tileTexels; y++)
+		{
+			for (int x = 0; x < tileTexels; x++)
+			{
+				if (filled[y * tileTexels + x] != 0)
+				{
+					m_coverage[(originY + y) * m_width + originX + x] = 1;
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  GatherLight()
+ *
+ *  This method is used for adding up the diffuse light that
+ *  arrives at a surface point from every static light that
+ *  is not blocked by another shape.  It matches the diffuse
+ *  terms of the lighting in the fragment shader.
+ ***********************************************************/
+glm::vec3 LightmapBaker::GatherLight(const glm::vec3& position, const glm::vec3& normal) const
+{
+	glm::vec3 light = glm::vec3(0.0f);
+	glm::vec3 origin = position + normal * SURFACE_OFFSET;
+
+	for (int i = 0; i < (int)m_lights.size(); i++)
+	{
+		glm::vec3 lightDirection;
+		float lightDistance;
+
+		GetLightDirection(i, origin, lightDirection, lightDistance);
+		float diffuse = glm::dot(normal, lightDirection) * GetRangeFalloff(i, lightDistance);
+		if (diffuse <= 0.0f)
+		{
+			continue;
+		}
+		if (m_sceneBVH.IsOccluded(origin, lightDirection, lightDistance) == false)
+		{
+			light += m_lights[i].diffuse * diffuse;
+		}
+	}
+
+	return(light);
+}
+
+/***********************************************************
+ *  SampleLight()
+ *
+ *  This method is used for getting the direction from a
+ *  point towards a static light, and the light it sends.
+ *  False is returned when another shape is in the way.
+ ***********************************************************/
+bool LightmapBaker::SampleLight(
+	int light,
+	const glm::vec3& origin,
+	glm::vec3& direction,
+	glm::vec3& diffuse) const
+{
+	float lightDistance;
+
+	GetLightDirection(light, origin, direction, lightDistance);
+	diffuse = m_lights[light].diffuse * GetRangeFalloff(light, lightDistance);
+
+	return(m_sceneBVH.IsOccluded(origin, direction, lightDistance) == false);
+}
+
+/***********************************************************
+ *  GetRangeFalloff()
+ *
+ *  This method is used for getting how much of a light is
+ *  left at a distance, fading smoothly to nothing at its
+ *  range.  It matches CalcRangeFalloff() in the shader.
+ ***********************************************************/
+float LightmapBaker::GetRangeFalloff(int light, float distance) const
+{
+	float range = m_lights[light].range;
+
+	if (range <= 0.0f)
+	{
+		return(1.0f);
+	}
+
+	float ratio = distance / range;
+	float falloff = glm::clamp(1.0f - ratio * ratio * ratio * ratio, 0.0f, 1.0f);
+	return(falloff * falloff);
+}
+
+/***********************************************************
+ *  GetLightDirection()
+ *
+ *  This method is used for getting the direction from a
+ *  point towards a static light and how far away it is.
+ ***********************************************************/
+void LightmapBaker::GetLightDirection(
+	int light,
+	const glm::vec3& origin,
+	glm::vec3& direction,
+	float& distance) const
+{
+	if (m_lights[light].bDirectional == true)
+	{
+		direction = -m_lights[light].vector;
+		distance = 1.0e30f;
+	}
+	else
+	{
+		glm::vec3 toLight = m_lights[light].vector - origin;
+		distance = glm::length(toLight);
+		direction = toLight / distance;
+	}
+}
+
+/***********************************************************
+ *  SaveToFile()
+ *
+ *  This method is used for saving the baked atlas so later
+ *  runs of the same scene can skip the bake.
+ ***********************************************************/
+bool LightmapBaker::SaveToFile(const char* filename, uint64_t sceneHash) const
+{
+	std::ofstream file(filename, std::ios::binary);
+	uint32_t objectCount = (uint32_t)m_rects.size();
+
+	if (!file)
+	{
+		std::cout << "Could not save lightmap:" << filename << std::endl;
+		return false;
+	}
+
+	file.write((const char*)&LIGHTMAP_FILE_MAGIC, sizeof(uint32_t));
+	file.write((const char*)&LIGHTMAP_FILE_VERSION, sizeof(uint32_t));
+	file.write((const char*)&sceneHash, sizeof(uint64_t));
+	file.write((const char*)&m_width, sizeof(int));
+	file.write((const char*)&m_height, sizeof(int));
+	file.write((const char*)&objectCount, sizeof(uint32_t));
+	file.write((const char*)m_rects.data(), sizeof(LIGHTMAP_RECT) * m_rects.size());
+	file.write((const char*)m_pixels.data(), sizeof(float) * m_pixels.size());
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  LoadFromFile()
+ *
+ *  This method is used for loading a saved atlas.  The file
+ *  is only used when it was baked from the same scene.
+ ***********************************************************/
+bool LightmapBaker::LoadFromFile(const char* filename, uint64_t sceneHash)
+{
+	std::ifstream file(filename, std::ios::binary);
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint64_t fileHash = 0;
+	int width = 0;
+	int height = 0;
+	uint32_t objectCount = 0;
+
+	if (!file)
+	{
+		return false;
+	}
+
+	file.read((char*)&magic, sizeof(uint32_t));
+	file.read((char*)&version, sizeof(uint32_t));
+	file.read((char*)&fileHash, sizeof(uint64_t));
+	file.read((char*)&width, sizeof(int));
+	file.read((char*)&height, sizeof(int));
+	file.read((char*)&objectCount, sizeof(uint32_t));
+
+	if ((!file) ||
+		(magic != LIGHTMAP_FILE_MAGIC) ||
+		(version != LIGHTMAP_FILE_VERSION) ||
+		(fileHash != sceneHash) ||
+		(objectCount != m_objects.size()) ||
+		(width <= 0) || (height <= 0))
+	{
+		return false;
+	}
+
+	m_rects.resize(objectCount);
+	m_pixels.resize(width * height * 3);
+	file.read((char*)m_rects.data(), sizeof(LIGHTMAP_RECT) * m_rects.size());
+	file.read((char*)m_pixels.data(), sizeof(float) * m_pixels.size());
+	if (!file)
+	{
+		m_rects.clear();
+		m_pixels.clear();
+		return false;
+	}
+
+	m_width = width;
+	m_height = height;
+	// the shapes are still needed for anything baked from the lightmap
+	m_sceneBVH.Build();
+	std::cout << "Loaded baked lightmap:" << filename << std::endl;
+	return true;
+}
@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmapbaker.h
+// ============
+// bake the lighting of static lights into a lightmap atlas on the CPU
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneBVH.h"
+
+#include <vector>
+
+/***********************************************************
+ *  LightmapBaker
+ *
+ *  This class contains the code for baking the diffuse light
+ *  of the static lights that reaches the static shapes.  Each
+ *  shape gets a block of the atlas split into six tiles, one
+ *  per side of its object space box, and every texel is found
+ *  by casting a ray at the shape from that side.  The light
+ *  at every texel is then gathered with shadow rays through
+ *  the BVH, spread over all of the CPU cores.
+ ***********************************************************/
+class LightmapBaker
+{
+public:
+	// constructor
+	LightmapBaker();
+	// destructor
+	~LightmapBaker();
+
+	// atlas block of one baked shape
+	struct LIGHTMAP_RECT
+	{
+		// offset and size of the block in atlas coordinates
+		glm::vec4 rect;
+		// width of the gutter around each tile, in tile coordinates
+		float border;
+		// texels along each side of a tile
+		int tileTexels;
+	};
+
+	// add a static light to bake
+	void AddDirectionalLight(const glm::vec3& direction, const glm::vec3& diffuse);
+	void AddPointLight(const glm::vec3& position, const glm::vec3& diffuse, float range);
+	// add a static shape that receives and casts baked light,
+	// returns the index of its atlas block
+	int AddObject(SceneManager::SHAPE_TYPE shape, const glm::mat4& model, const glm::vec3& albedo);
+
+	// lay out the atlas and bake all of the texels
+	void Bake(int threadCount);
+
+	// save and load a baked atlas, keyed by a hash of the scene
+	bool SaveToFile(const char* filename, uint64_t sceneHash) const;
+	bool LoadFromFile(const char* filename, uint64_t sceneHash);
+
+	// get the baked atlas as RGB floats
+	int GetWidth() const { return(m_width); }
+	int GetHeight() const { return(m_height); }
+	const float* GetPixels() const { return(m_pixels.data()); }
+	// get the atlas block of a baked shape
+	const LIGHTMAP_RECT& GetObjectRect(int object) const { return(m_rects[object]); }
+	int GetObjectCount() const { return((int)m_objects.size()); }
+	// get the flat color a baked shape reflects
+	const glm::vec3& GetObjectAlbedo(int object) const { return(m_objects[object].albedo); }
+	// get the placed static shapes
+	const SceneBVH& GetSceneBVH() const { return(m_sceneBVH); }
+
+	// get the direction towards a static light and the light
+	// it sends, false when another shape blocks it
+	int GetLightCount() const { return((int)m_lights.size()); }
+	bool SampleLight(
+		int light,
+		const glm::vec3& origin,
+		glm::vec3& direction,
+		glm::vec3& diffuse) const;
+	// gather the light arriving at a surface point
+	glm::vec3 GatherLight(const glm::vec3& position, const glm::vec3& normal) const;
+
+private:
+	// static light to bake
+	struct BAKE_LIGHT
+	{
+		// direction the light travels, or the position of a point light
+		glm::vec3 vector;
+		glm::vec3 diffuse;
+		// distance past which a point light adds nothing
+		float range;
+		bool bDirectional;
+	};
+
+	// static shape to bake
+	struct BAKE_OBJECT
+	{
+		SceneManager::SHAPE_TYPE shape;
+		glm::mat4 model;
+		glm::vec3 albedo;
+	};
+
+	std::vector<BAKE_LIGHT> m_lights;
+	std::vector<BAKE_OBJECT> m_objects;
+	// placed shapes used for finding the texels and for shadow rays
+	SceneBVH m_sceneBVH;
+	// atlas block of each shape
+	std::vector<LIGHTMAP_RECT> m_rects;
+	// atlas size and texels
+	int m_width;
+	int m_height;
+	std::vector<float> m_pixels;
+	// set for texels that were reached by a ray
+	std::vector<unsigned char> m_coverage;
+
+	// place the blocks of all of the shapes in the atlas
+	void LayoutAtlas();
+	// bake the texels of one tile of one shape
+	void BakeTile(int object, int tile);
+	// get how much of a light is left at a distance
+	float GetRangeFalloff(int light, float distance) const;
+	// get the direction and distance from a point to a light
+	void GetLightDirection(
+		int light,
+		const glm::vec3& origin,
+		glm::vec3& direction,
+		float& distance) const;
+};
@@ -9,6 +9,7 @@
 
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -22,12 +23,23 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "GLStateCache.h"
+#include "FrameCapture.h"
+#include "CameraPath.h"
+#include "BatchRenderer.h"
+#include "CameraRecording.h"
+#include "GoldenImageTest.h"
+#include "PerfHud.h"
+
+#include <thread>
 
 // Namespace for declaring global variables
 namespace
 {
 	// Macro for window title
 	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
+	// flakes falling when --snow is not followed by a count
+	const int DEFAULT_SNOW_FLAKES = 500000;
 
 	// Main GLFW window
 	GLFWwindow* g_Window = nullptr;
@@ -38,6 +50,39 @@ namespace
 	ShaderManager* g_ShaderManager = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+	// state cache object that filters redundant OpenGL state changes
+	GLStateCache* g_StateCache = nullptr;
+	// keep the camera from flying through the scene shapes
+	bool g_bCameraCollision = true;
+	// frames saved as images, created when recording starts
+	FrameCapture* g_FrameCapture = nullptr;
+	FrameCapture::IMAGE_FORMAT g_CaptureFormat = FrameCapture::FORMAT_QOI;
+	// start of the name of every saved frame
+	const char* const CAPTURE_FILE_PREFIX = "capture_";
+	// camera path rendered offscreen instead of opening the
+	// window, with the number and size of the frames
+	const char* g_BatchPathFile = nullptr;
+	int g_BatchFrameCount = 0;
+	int g_BatchWidth = 1920;
+	int g_BatchHeight = 1080;
+	// start of the name of every batch rendered frame
+	const char* const BATCH_FILE_PREFIX = "batch_";
+	// camera moves saved to a file at exit while recording, or
+	// played back instead of the input, in the window or offscreen
+	CameraRecording* g_CameraRecording = nullptr;
+	const char* g_RecordFile = nullptr;
+	const char* g_PlaybackFile = nullptr;
+	bool g_bPlaybackOffscreen = false;
+	// directory of the golden images the frames from its poses
+	// are checked against, and whether they are replaced
+	const char* g_GoldenDirectory = nullptr;
+	bool g_bGoldenUpdate = false;
+	// on-screen overlay of the frame times and OpenGL calls,
+	// measuring every frame so its graphs are full when shown
+	PerfHud* g_PerfHud = nullptr;
+	// size of the golden images - the same as the window
+	const int GOLDEN_WIDTH = 1000;
+	const int GOLDEN_HEIGHT = 800;
 }
 
 // Function declarations - all functions that are called manually
@@ -54,17 +99,34 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	int exitCode = EXIT_SUCCESS;
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
 		return(EXIT_FAILURE);
 	}
 
+	// a batch render only needs the OpenGL context, so the
+	// window is never shown
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--batch") == 0) || (strcmp(argv[i], "--batch-play") == 0) ||
+			(strcmp(argv[i], "--golden") == 0))
+		{
+			glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		}
+	}
+
 	// try to create a new shader manager object
 	g_ShaderManager = new ShaderManager();
+	// try to create a new state cache object - all OpenGL state
+	// changes are routed through it
+	g_StateCache = new GLStateCache();
 	// try to create a new view manager object
 	g_ViewManager = new ViewManager(
-		g_ShaderManager);
+		g_ShaderManager,
+		g_StateCache);
 
 	// try to create the main display window
 	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
@@ -79,12 +141,236 @@ int main(int argc, char* argv[])
 	g_ShaderManager->LoadShaders(
 		"shaders/vertexShader.glsl",
 		"shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
+	g_StateCache->UseProgram(g_ShaderManager->m_programID);
 
 	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
+	g_SceneManager = new SceneManager(g_ShaderManager, g_StateCache);
 	g_SceneManager->PrepareScene();
 
+	// try to create the performance overlay
+	g_PerfHud = new PerfHud(g_StateCache);
+	if (g_PerfHud->Initialize() == false)
+	{
+		delete g_PerfHud;
+		g_PerfHud = nullptr;
+	}
+
+	// process the command line options
+	for (int i = 1; i < argc; i++)
+	{
+		// blend transparent objects without sorting them
+		if (strcmp(argv[i], "--oit") == 0)
+		{
+			g_SceneManager->SetTransparencyMode(SceneManager::TRANSPARENCY_WEIGHTED_OIT);
+		}
+		// lay down the opaque depth before lighting
+		else if (strcmp(argv[i], "--depth-prepass") == 0)
+		{
+			g_SceneManager->SetDepthPrepass(true);
+		}
+		// cast shadows from the directional light
+		else if (strcmp(argv[i], "--shadows") == 0)
+		{
+			g_SceneManager->SetShadows(true);
+		}
+		// bake the static lights into a lightmap
+		else if (strcmp(argv[i], "--lightmaps") == 0)
+		{
+			g_SceneManager->SetLightmaps(true);
+		}
+		// light the shapes outside of the lightmap from baked probes
+		else if (strcmp(argv[i], "--probes") == 0)
+		{
+			g_SceneManager->SetIrradianceProbes(true);
+		}
+		// let it snow, optionally followed by the number of flakes
+		else if (strcmp(argv[i], "--snow") == 0)
+		{
+			int flakeCount = DEFAULT_SNOW_FLAKES;
+			if ((i + 1 < argc) && (atoi(argv[i + 1]) > 0))
+			{
+				flakeCount = atoi(argv[++i]);
+			}
+			g_SceneManager->SetSnow(true, flakeCount);
+		}
+		// play the keyframed animation of the ornaments, lights and moon
+		else if (strcmp(argv[i], "--animate") == 0)
+		{
+			g_SceneManager->SetAnimation(true);
+		}
+		// drop rigid ornaments, gifts and candy onto the scene
+		else if (strcmp(argv[i], "--physics") == 0)
+		{
+			g_SceneManager->SetPhysics(true);
+		}
+		// mirror the surroundings on the reflective materials
+		else if (strcmp(argv[i], "--reflections") == 0)
+		{
+			g_SceneManager->SetReflections(true);
+		}
+		// draw the quad view in a single pass where supported
+		else if (strcmp(argv[i], "--multiview") == 0)
+		{
+			g_SceneManager->SetMultiView(true);
+		}
+		// draw a heatmap in place of the lit scene - overdraw,
+		// lights per pixel, or mip for the trilinear mip level of
+		// the scene textures - in the window and the batch renders
+		else if ((strcmp(argv[i], "--debug-view") == 0) && (i + 1 < argc))
+		{
+			g_SceneManager->SetDebugView(DebugViewRenderer::FindView(argv[++i]));
+			g_ViewManager->SetDebugView(g_SceneManager->GetDebugView());
+		}
+		// save every frame as an image from the start, optionally
+		// followed by the format - png or qoi
+		else if (strcmp(argv[i], "--capture") == 0)
+		{
+			if ((i + 1 < argc) && (strcmp(argv[i + 1], "png") == 0))
+			{
+				g_CaptureFormat = FrameCapture::FORMAT_PNG;
+				i++;
+			}
+			else if ((i + 1 < argc) && (strcmp(argv[i + 1], "qoi") == 0))
+			{
+				g_CaptureFormat = FrameCapture::FORMAT_QOI;
+				i++;
+			}
+			g_ViewManager->SetCapturingFrames(true);
+		}
+		// pick the format of the saved frames - png or qoi
+		else if ((strcmp(argv[i], "--format") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_CaptureFormat = (strcmp(argv[i], "png") == 0) ?
+				FrameCapture::FORMAT_PNG : FrameCapture::FORMAT_QOI;
+		}
+		// render a camera path offscreen - the path file and the
+		// number of frames, optionally followed by the width and
+		// height
+		else if ((strcmp(argv[i], "--batch") == 0) && (i + 2 < argc))
+		{
+			g_BatchPathFile = argv[++i];
+			g_BatchFrameCount = atoi(argv[++i]);
+			if ((i + 2 < argc) && (atoi(argv[i + 1]) > 0) && (atoi(argv[i + 2]) > 0))
+			{
+				g_BatchWidth = atoi(argv[++i]);
+				g_BatchHeight = atoi(argv[++i]);
+			}
+		}
+		// save the camera moves to a file at exit
+		else if ((strcmp(argv[i], "--record") == 0) && (i + 1 < argc))
+		{
+			g_RecordFile = argv[++i];
+		}
+		// move the camera from a recording in the window
+		else if ((strcmp(argv[i], "--play") == 0) && (i + 1 < argc))
+		{
+			g_PlaybackFile = argv[++i];
+			g_bPlaybackOffscreen = false;
+		}
+		// play a recording back offscreen, optionally followed by
+		// the width and height, saving the frames with --capture
+		else if ((strcmp(argv[i], "--batch-play") == 0) && (i + 1 < argc))
+		{
+			g_PlaybackFile = argv[++i];
+			g_bPlaybackOffscreen = true;
+			if ((i + 2 < argc) && (atoi(argv[i + 1]) > 0) && (atoi(argv[i + 2]) > 0))
+			{
+				g_BatchWidth = atoi(argv[++i]);
+				g_BatchHeight = atoi(argv[++i]);
+			}
+		}
+		// check the frames from the poses in a directory against
+		// its golden images
+		else if ((strcmp(argv[i], "--golden") == 0) && (i + 1 < argc))
+		{
+			g_GoldenDirectory = argv[++i];
+		}
+		// replace the golden images with the new frames
+		else if (strcmp(argv[i], "--golden-update") == 0)
+		{
+			g_bGoldenUpdate = true;
+		}
+		// let the camera fly through the scene shapes
+		else if (strcmp(argv[i], "--no-collision") == 0)
+		{
+			g_bCameraCollision = false;
+		}
+	}
+
+	// render the camera path and exit without entering the loop
+	if (nullptr != g_BatchPathFile)
+	{
+		CameraPath path;
+		BatchRenderer batchRenderer(g_SceneManager, g_ViewManager, g_StateCache);
+
+		if ((path.LoadFromFile(g_BatchPathFile) == false) ||
+			(batchRenderer.Initialize(g_BatchWidth, g_BatchHeight) == false) ||
+			(batchRenderer.Render(path, g_BatchFrameCount, BATCH_FILE_PREFIX, g_CaptureFormat) == false))
+		{
+			std::cout << "The batch render did not complete" << std::endl;
+			exitCode = EXIT_FAILURE;
+		}
+		glfwSetWindowShouldClose(g_Window, GLFW_TRUE);
+	}
+
+	// check the frames against the golden images and exit,
+	// failing when any of them has changed
+	if (nullptr != g_GoldenDirectory)
+	{
+		CameraPath poses;
+		BatchRenderer batchRenderer(g_SceneManager, g_ViewManager, g_StateCache);
+		GoldenImageTest goldenTest(g_GoldenDirectory, g_bGoldenUpdate);
+
+		if ((poses.LoadFromFile(std::string(g_GoldenDirectory) + "/poses.txt") == false) ||
+			(batchRenderer.Initialize(GOLDEN_WIDTH, GOLDEN_HEIGHT) == false) ||
+			(batchRenderer.CheckGoldenImages(poses, "final", goldenTest) == false))
+		{
+			exitCode = EXIT_FAILURE;
+		}
+		std::cout << "GOLDEN: " << (goldenTest.GetCheckCount() - goldenTest.GetFailureCount())
+			<< " of " << goldenTest.GetCheckCount() << " frames match" << std::endl;
+		glfwSetWindowShouldClose(g_Window, GLFW_TRUE);
+	}
+
+	// play a recording back so every run draws the same views,
+	// offscreen and exiting, or in the window until it ends
+	if (nullptr != g_PlaybackFile)
+	{
+		g_CameraRecording = new CameraRecording();
+		if (g_CameraRecording->LoadFromFile(g_PlaybackFile) == false)
+		{
+			std::cout << "The camera recording could not be played" << std::endl;
+			exitCode = EXIT_FAILURE;
+			glfwSetWindowShouldClose(g_Window, GLFW_TRUE);
+		}
+		else if (g_bPlaybackOffscreen == true)
+		{
+			BatchRenderer batchRenderer(g_SceneManager, g_ViewManager, g_StateCache);
+			const char* filePrefix = g_ViewManager->IsCapturingFrames() ? BATCH_FILE_PREFIX : "";
+
+			if ((batchRenderer.Initialize(g_BatchWidth, g_BatchHeight) == false) ||
+				(batchRenderer.Play(*g_CameraRecording, filePrefix, g_CaptureFormat) == false))
+			{
+				std::cout << "The batch playback did not complete" << std::endl;
+				exitCode = EXIT_FAILURE;
+			}
+			g_ViewManager->SetCapturingFrames(false);
+			glfwSetWindowShouldClose(g_Window, GLFW_TRUE);
+		}
+		else
+		{
+			g_ViewManager->StartPlayback(g_CameraRecording);
+			g_SceneManager->SetFixedFrameTime(g_ViewManager->GetPlaybackFrameTime());
+		}
+	}
+	// record the camera moves from the first frame
+	else if (nullptr != g_RecordFile)
+	{
+		g_CameraRecording = new CameraRecording();
+		g_ViewManager->StartRecording(g_CameraRecording);
+	}
+
 	std::cout << "\n    Key Functions:    \n";
 	std::cout << "ESC - close window and exit\n";
 	std::cout << "W - zoom in\t" << "S - zoom out\n";
@@ -94,34 +380,180 @@ int main(int argc, char* argv[])
 	std::cout << "2 - side view (ortho)\n";
 	std::cout << "3 - top view (ortho)\n";
 	std::cout << "4 - perspective view\n";
+	std::cout << "5 - all four views at once (toggle)\n";
+	std::cout << "6 - performance overlay (toggle)\n";
+	std::cout << "7 - overdraw, lights and mip level heatmaps (cycle)\n";
+	std::cout << "R - save the frames as images (toggle)\n";
+	std::cout << "Left click - select the object under the crosshair\n";
+
 
+	// frames drawn while playing a recording back in the window
+	int playbackFrames = 0;
+	double playbackStart = glfwGetTime();
 
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
 	while (!glfwWindowShouldClose(g_Window))
 	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
+		// start counting the state changes for this frame
+		g_StateCache->ResetStats();
+		if (nullptr != g_PerfHud)
+		{
+			g_PerfHud->BeginFrame();
+		}
+
+		// Enable z-depth - only reaches OpenGL on the first frame
+		g_StateCache->SetDepthTest(true);
 
 		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		g_StateCache->SetClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+		// the camera collides with the shapes of the last frame
+		if (g_bCameraCollision == true)
+		{
+			g_ViewManager->SetCollisionScene(g_SceneManager->GetSceneBVH());
+		}
+
 		// convert from 3D object space to 2D view
 		g_ViewManager->PrepareSceneView();
+		g_SceneManager->SetCameraView(
+			g_ViewManager->GetViewMatrix(),
+			g_ViewManager->GetProjectionMatrix(),
+			g_ViewManager->GetViewPosition());
+
+		// the quad view draws the same shapes into four viewports
+		g_SceneManager->ClearViewports();
+		if (g_ViewManager->GetViewportCount() > 1)
+		{
+			for (int i = 0; i < g_ViewManager->GetViewportCount(); i++)
+			{
+				SceneManager::VIEWPORT_CAMERA viewport;
+				g_ViewManager->GetViewport(i, viewport.viewport,
+					viewport.view, viewport.projection, viewport.position);
+				g_SceneManager->AddViewport(viewport);
+			}
+		}
+
+		// switch to the heatmap picked with the debug view key,
+		// staying on the lit scene if it could not be set up
+		if (g_ViewManager->GetDebugView() != g_SceneManager->GetDebugView())
+		{
+			g_SceneManager->SetDebugView(g_ViewManager->GetDebugView());
+			g_ViewManager->SetDebugView(g_SceneManager->GetDebugView());
+		}
 
 		// refresh the 3D scene
 		g_SceneManager->RenderScene();
 
+		// select the shape under the crosshair when clicked
+		glm::vec3 pickOrigin;
+		glm::vec3 pickDirection;
+		if (g_ViewManager->GetPickRay(pickOrigin, pickDirection) == true)
+		{
+			g_SceneManager->PickObject(pickOrigin, pickDirection);
+		}
+		if (nullptr != g_PerfHud)
+		{
+			g_PerfHud->EndFrame(
+				g_SceneManager->GetVisibleObjectCount(),
+				g_SceneManager->GetCulledObjectCount());
+		}
+
+		// read the frame back for the image sequence while recording,
+		// writing out the frames still in flight when it stops
+		if (g_ViewManager->IsCapturingFrames() == true)
+		{
+			int width = 0;
+			int height = 0;
+
+			if (nullptr == g_FrameCapture)
+			{
+				int threadCount = (int)std::thread::hardware_concurrency() - 1;
+				g_FrameCapture = new FrameCapture();
+				g_FrameCapture->Initialize(CAPTURE_FILE_PREFIX, g_CaptureFormat, threadCount);
+			}
+			glfwGetFramebufferSize(g_Window, &width, &height);
+			g_FrameCapture->CaptureFrame(width, height);
+		}
+		else if (nullptr != g_FrameCapture)
+		{
+			g_FrameCapture->Finish();
+		}
+
+		// draw the overlay after the capture, so saved frames
+		// show only the scene
+		if ((nullptr != g_PerfHud) && (g_ViewManager->IsShowingPerfHud() == true))
+		{
+			int width = 0;
+			int height = 0;
+
+			glfwGetFramebufferSize(g_Window, &width, &height);
+			g_PerfHud->Draw(width, height);
+		}
 
 		// Flips the the back buffer with the front buffer every frame.
 		glfwSwapBuffers(g_Window);
 
 		// query the latest GLFW events
 		glfwPollEvents();
+
+		// a playback closes once every recorded step has been shown
+		if (g_ViewManager->IsPlayingBack() == true)
+		{
+			playbackFrames++;
+			if (g_ViewManager->IsPlaybackFinished() == true)
+			{
+				glfwSetWindowShouldClose(g_Window, GLFW_TRUE);
+			}
+		}
+	}
+
+	// report the playback in the window as a repeatable benchmark
+	if (playbackFrames > 0)
+	{
+		double elapsed = glfwGetTime() - playbackStart;
+		std::cout << "INFO: Played " << playbackFrames << " frames in " << elapsed << " seconds - "
+			<< (elapsed * 1000.0 / playbackFrames) << " milliseconds per frame" << std::endl;
+	}
+
+	// save the camera moves recorded since the start
+	if ((nullptr != g_CameraRecording) && (nullptr != g_RecordFile) && (nullptr == g_PlaybackFile))
+	{
+		g_ViewManager->StartRecording(NULL);
+		if (g_CameraRecording->SaveToFile(g_RecordFile) == true)
+		{
+			std::cout << "INFO: Recorded " << g_CameraRecording->GetStateCount()
+				<< " camera steps to " << g_RecordFile << std::endl;
+		}
+	}
+
+	// report the opaque overdraw so the depth pre-pass can be
+	// judged for this scene
+	std::cout << "INFO: Opaque fragments shaded per pixel: "
+		<< g_SceneManager->GetAverageOverdraw() << std::endl;
+
+	// the saved frames are written before the context goes away
+	if (NULL != g_FrameCapture)
+	{
+		g_FrameCapture->Finish();
+		std::cout << "INFO: Saved " << g_FrameCapture->GetFramesWritten() << " frames, "
+			<< g_FrameCapture->GetStallCount() << " of them waited on the GPU" << std::endl;
+		delete g_FrameCapture;
+		g_FrameCapture = NULL;
 	}
 
 	// clear the allocated manager objects from memory
+	if (NULL != g_PerfHud)
+	{
+		delete g_PerfHud;
+		g_PerfHud = NULL;
+	}
+	if (NULL != g_CameraRecording)
+	{
+		delete g_CameraRecording;
+		g_CameraRecording = NULL;
+	}
 	if (NULL != g_SceneManager)
 	{
 		delete g_SceneManager;
@@ -137,9 +569,14 @@ int main(int argc, char* argv[])
 		delete g_ShaderManager;
 		g_ShaderManager = NULL;
 	}
+	if (NULL != g_StateCache)
+	{
+		delete g_StateCache;
+		g_StateCache = NULL;
+	}
 
 	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
+	exit(exitCode); 
 }
 
 /***********************************************************
@@ -151,6 +588,11 @@ bool InitializeGLFW()
 {
 	// GLFW: initialize and configure library
 	// --------------------------------------
+#if (defined(SCENE_CONTEXT_EGL) || defined(SCENE_CONTEXT_OSMESA)) && defined(GLFW_PLATFORM_NULL)
+	// no display is needed when the context comes from EGL or
+	// OSMesa, so machines without one can still draw offscreen
+	glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
 	glfwInit();
 
 #ifdef __APPLE__
@@ -163,6 +605,14 @@ bool InitializeGLFW()
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+#if defined(SCENE_CONTEXT_EGL)
+	// create the context through EGL, which a GPU without a
+	// display can provide
+	glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+#elif defined(SCENE_CONTEXT_OSMESA)
+	// create the context in OSMesa, drawn on the CPU
+	glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
 #endif
 	// GLFW: end -------------------------------
 
@@ -182,6 +632,14 @@ bool InitializeGLEW()
 
 	// try to initialize the GLEW library
 	GLEWInitResult = glewInit();
+#if defined(SCENE_CONTEXT_EGL) || defined(SCENE_CONTEXT_OSMESA)
+	// without an X display GLEW cannot load the GLX extensions,
+	// but by then it has already loaded the OpenGL functions
+	if (GLEW_ERROR_NO_GLX_DISPLAY == GLEWInitResult)
+	{
+		GLEWInitResult = GLEW_OK;
+	}
+#endif
 	if (GLEW_OK != GLEWInitResult)
 	{
 		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
@@ -0,0 +1,187 @@
+///////////////////////////////////////////////////////////////////////////////
+// multiviewrenderer.cpp
+// ============
+// draw the basic shapes once per view in a single instanced draw
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MultiViewRenderer.h"
+
+#include <iostream>
+
+// declaration of the global variables and defines
+namespace
+{
+	// position, normal and texture coordinate of a captured
+	// vertex - must match the xfb_offset layouts of
+	// meshCaptureVertexShader.glsl
+	const int FLOATS_PER_VERTEX = 8;
+}
+
+/***********************************************************
+ *  MultiViewRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MultiViewRenderer::MultiViewRenderer(GLStateCache* pStateCache)
+{
+	m_pStateCache = pStateCache;
+	m_pCaptureShader = NULL;
+	m_primitiveQueryID = 0;
+}
+
+/***********************************************************
+ *  ~MultiViewRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MultiViewRenderer::~MultiViewRenderer()
+{
+	for (int i = 0; i < (int)m_meshes.size(); i++)
+	{
+		if (0 != m_meshes[i].vertexArrayID)
+		{
+			glDeleteVertexArrays(1, &m_meshes[i].vertexArrayID);
+			glDeleteBuffers(1, &m_meshes[i].vertexBufferID);
+		}
+	}
+	m_meshes.clear();
+	if (0 != m_primitiveQueryID)
+	{
+		glDeleteQueries(1, &m_primitiveQueryID);
+	}
+	if (NULL != m_pCaptureShader)
+	{
+		delete m_pCaptureShader;
+		m_pCaptureShader = NULL;
+	}
+	m_pStateCache = NULL;
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking that the viewports can
+ *  be set one by one, that the vertex shader can write the
+ *  viewport and layer, through any of the extensions that
+ *  allow it, and that the capture shader can lay out its
+ *  outputs in the buffer itself.
+ ***********************************************************/
+bool MultiViewRenderer::IsSupported()
+{
+	bool bViewportArray = (GLEW_ARB_viewport_array != 0);
+	bool bVertexShaderOutput =
+		(GLEW_ARB_shader_viewport_layer_array != 0) ||
+		(GLEW_NV_viewport_array2 != 0) ||
+		((GLEW_AMD_vertex_shader_layer != 0) && (GLEW_AMD_vertex_shader_viewport_index != 0));
+
+	bool bCaptureLayout = (GLEW_ARB_enhanced_layouts != 0);
+
+	return(bViewportArray && bVertexShaderOutput && bCaptureLayout);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the shader that writes
+ *  the mesh vertices into a buffer.  The vertex shader places
+ *  its outputs in the buffer with layout qualifiers, so the
+ *  shader manager builds it like any other.
+ ***********************************************************/
+bool MultiViewRenderer::Initialize()
+{
+	m_pCaptureShader = new ShaderManager();
+	m_pCaptureShader->LoadShaders(
+		"shaders/meshCaptureVertexShader.glsl",
+		"shaders/meshCaptureFragmentShader.glsl");
+	if (0 == m_pCaptureShader->m_programID)
+	{
+		std::cout << "Could not load the mesh capture shader" << std::endl;
+		return false;
+	}
+
+	glGenQueries(1, &m_primitiveQueryID);
+
+	return true;
+}
+
+/***********************************************************
+ *  CaptureMesh()
+ *
+ *  This method is used for capturing the triangles of a mesh
+ *  with rasterizing turned off.  The mesh is drawn once to
+ *  count its triangles so the buffer can be sized, then once
+ *  more into the buffer.  Strips and fans come out as plain
+ *  triangles, so the copy is larger than the indexed mesh,
+ *  but it draws the same surface with the same attributes.
+ ***********************************************************/
+bool MultiViewRenderer::CaptureMesh(int mesh, const std::function<void()>& drawMesh)
+{
+	CAPTURED_MESH captured;
+	GLuint triangleCount = 0;
+
+	if ((NULL == m_pCaptureShader) || (0 == m_pCaptureShader->m_programID))
+	{
+		return false;
+	}
+
+	m_pStateCache->UseProgram(m_pCaptureShader->m_programID);
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	glBeginQuery(GL_PRIMITIVES_GENERATED, m_primitiveQueryID);
+	drawMesh();
+	glEndQuery(GL_PRIMITIVES_GENERATED);
+	glGetQueryObjectuiv(m_primitiveQueryID, GL_QUERY_RESULT, &triangleCount);
+
+	captured.vertexCount = (GLsizei)(triangleCount * 3);
+	glGenBuffers(1, &captured.vertexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, captured.vertexBufferID);
+	glBufferData(GL_ARRAY_BUFFER,
+		captured.vertexCount * FLOATS_PER_VERTEX * sizeof(float), NULL, GL_STATIC_DRAW);
+
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, captured.vertexBufferID);
+	glBeginTransformFeedback(GL_TRIANGLES);
+	drawMesh();
+	glEndTransformFeedback();
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	// the same attribute locations as the shape meshes
+	glGenVertexArrays(1, &captured.vertexArrayID);
+	glBindVertexArray(captured.vertexArrayID);
+	glBindBuffer(GL_ARRAY_BUFFER, captured.vertexBufferID);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void*)(6 * sizeof(float)));
+	glBindVertexArray(0);
+	m_pStateCache->InvalidateVertexArray();
+
+	if (mesh >= (int)m_meshes.size())
+	{
+		CAPTURED_MESH empty = { 0, 0, 0 };
+		m_meshes.resize(mesh + 1, empty);
+	}
+	m_meshes[mesh] = captured;
+
+	return(captured.vertexCount > 0);
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing a captured mesh with one
+ *  instance for each view.
+ ***********************************************************/
+void MultiViewRenderer::DrawMesh(int mesh, int viewCount)
+{
+	if ((mesh >= (int)m_meshes.size()) || (0 == m_meshes[mesh].vertexArrayID))
+	{
+		return;
+	}
+
+	m_pStateCache->BindVertexArray(m_meshes[mesh].vertexArrayID);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, m_meshes[mesh].vertexCount, viewCount);
+}
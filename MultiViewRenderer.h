@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// multiviewrenderer.h
+// ============
+// draw the basic shapes once per view in a single instanced draw
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "GLStateCache.h"
+
+#include <GL/glew.h>
+
+#include <functional>
+#include <vector>
+
+/***********************************************************
+ *  MultiViewRenderer
+ *
+ *  This class contains the code for drawing a shape into
+ *  several views with one draw call.  The basic shape meshes
+ *  can only be drawn one at a time, so each mesh is drawn
+ *  once through transform feedback into a buffer of plain
+ *  triangles that can be drawn instanced.  Each instance is
+ *  one view - the scene vertex shader picks the camera by the
+ *  instance and writes the viewport or layer, so the number
+ *  of draw calls does not grow with the number of views.
+ *  This needs the viewport array, an extension letting the
+ *  vertex shader write the viewport and layer, and the
+ *  enhanced layouts that place the captured outputs.
+ ***********************************************************/
+class MultiViewRenderer
+{
+public:
+	// constructor
+	MultiViewRenderer(GLStateCache* pStateCache);
+	// destructor
+	~MultiViewRenderer();
+
+	// most views drawn together - must match MAX_VIEWS in
+	// vertexShader.glsl and fragmentShader.glsl
+	static const int MAX_VIEWS = 6;
+
+	// check whether the driver can pick the view in the vertex shader
+	static bool IsSupported();
+
+	// load the capture shader
+	bool Initialize();
+	// capture the triangles of a mesh drawn by the passed in function
+	bool CaptureMesh(int mesh, const std::function<void()>& drawMesh);
+	// draw a captured mesh once for each view
+	void DrawMesh(int mesh, int viewCount);
+
+private:
+	// buffer of plain triangles captured from a mesh
+	struct CAPTURED_MESH
+	{
+		GLuint vertexArrayID;
+		GLuint vertexBufferID;
+		GLsizei vertexCount;
+	};
+
+	// pointer to OpenGL state cache object
+	GLStateCache* m_pStateCache;
+	// shader passing the mesh vertices through into a buffer
+	ShaderManager* m_pCaptureShader;
+	// query counting the triangles of a mesh
+	GLuint m_primitiveQueryID;
+	// captured meshes by index, empty until captured
+	std::vector<CAPTURED_MESH> m_meshes;
+};
@@ -0,0 +1,244 @@
+///////////////////////////////////////////////////////////////////////////////
+// oitmanager.cpp
+// ============
+// manage weighted blended order-independent transparency - targets, composite
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OITManager.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  OITManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+OITManager::OITManager(GLStateCache* pStateCache)
+{
+	m_pStateCache = pStateCache;
+	m_pCompositeShader = NULL;
+	m_framebufferID = 0;
+	m_accumTextureID = 0;
+	m_revealageTextureID = 0;
+	m_depthBufferID = 0;
+	m_vertexArrayID = 0;
+	m_width = 0;
+	m_height = 0;
+	m_sceneFramebufferID = 0;
+}
+
+/***********************************************************
+ *  ~OITManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+OITManager::~OITManager()
+{
+	DestroyTargets();
+	if (0 != m_vertexArrayID)
+	{
+		glDeleteVertexArrays(1, &m_vertexArrayID);
+		m_vertexArrayID = 0;
+	}
+	if (NULL != m_pCompositeShader)
+	{
+		delete m_pCompositeShader;
+		m_pCompositeShader = NULL;
+	}
+	m_pStateCache = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the composite shader.
+ *  The targets are created on the first transparent pass,
+ *  once the size of the viewport is known.
+ ***********************************************************/
+bool OITManager::Initialize()
+{
+	m_pCompositeShader = new ShaderManager();
+	m_pCompositeShader->LoadShaders(
+		"shaders/oitCompositeVertexShader.glsl",
+		"shaders/oitCompositeFragmentShader.glsl");
+	if (0 == m_pCompositeShader->m_programID)
+	{
+		std::cout << "Could not load the transparency composite shader" << std::endl;
+		return false;
+	}
+
+	// the core profile needs a bound vertex array even when
+	// the vertices are generated in the shader
+	glGenVertexArrays(1, &m_vertexArrayID);
+
+	return true;
+}
+
+/***********************************************************
+ *  BeginTransparentPass()
+ *
+ *  This method is used for redirecting drawing into the
+ *  accumulation targets.  The depth of the opaque scene is
+ *  copied over so transparent fragments behind opaque ones
+ *  are still rejected.
+ ***********************************************************/
+void OITManager::BeginTransparentPass()
+{
+	GLint viewport[4];
+	const GLfloat clearAccum[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const GLfloat clearRevealage[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_sceneFramebufferID);
+
+	// the targets only grow, so the viewports of a quad view
+	// share them without recreating them for each one
+	int width = viewport[0] + viewport[2];
+	int height = viewport[1] + viewport[3];
+	if ((width > m_width) || (height > m_height))
+	{
+		CreateTargets(std::max(width, m_width), std::max(height, m_height));
+	}
+
+	// copy the opaque depth into the accumulation frame buffer
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_sceneFramebufferID);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebufferID);
+	glBlitFramebuffer(
+		0, 0, m_width, m_height,
+		0, 0, m_width, m_height,
+		GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+
+	glClearBufferfv(GL_COLOR, 0, clearAccum);
+	glClearBufferfv(GL_COLOR, 1, clearRevealage);
+
+	// color is summed, revealage is multiplied by (1 - alpha)
+	m_pStateCache->SetBlend(true);
+	m_pStateCache->SetBlendFuncIndexed(0, GL_ONE, GL_ONE);
+	m_pStateCache->SetBlendFuncIndexed(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+	m_pStateCache->SetDepthTest(true);
+	m_pStateCache->SetDepthMask(false);
+}
+
+/***********************************************************
+ *  EndTransparentPass()
+ *
+ *  This method is used for returning drawing to the frame
+ *  buffer of the scene.
+ ***********************************************************/
+void OITManager::EndTransparentPass()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebufferID);
+}
+
+/***********************************************************
+ *  Composite()
+ *
+ *  This method is used for blending the averaged transparent
+ *  color over the opaque scene, weighted by how much of the
+ *  background is still revealed.
+ ***********************************************************/
+void OITManager::Composite()
+{
+	if ((NULL == m_pCompositeShader) || (0 == m_framebufferID))
+	{
+		return;
+	}
+
+	m_pStateCache->UseProgram(m_pCompositeShader->m_programID);
+	m_pStateCache->BindTexture(ACCUM_TEXTURE_UNIT, GL_TEXTURE_2D, m_accumTextureID);
+	m_pStateCache->BindTexture(REVEALAGE_TEXTURE_UNIT, GL_TEXTURE_2D, m_revealageTextureID);
+	m_pCompositeShader->setSampler2DValue("accumTexture", ACCUM_TEXTURE_UNIT);
+	m_pCompositeShader->setSampler2DValue("revealageTexture", REVEALAGE_TEXTURE_UNIT);
+
+	m_pStateCache->SetBlend(true);
+	m_pStateCache->SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	m_pStateCache->SetDepthTest(false);
+
+	m_pStateCache->BindVertexArray(m_vertexArrayID);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	m_pStateCache->SetDepthTest(true);
+	m_pStateCache->SetDepthMask(true);
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method is used for creating the accumulation frame
+ *  buffer - a half float color target, a single channel
+ *  revealage target, and a depth buffer matching the format
+ *  of the window.
+ ***********************************************************/
+void OITManager::CreateTargets(int width, int height)
+{
+	GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+
+	DestroyTargets();
+
+	m_width = width;
+	m_height = height;
+
+	glGenTextures(1, &m_accumTextureID);
+	m_pStateCache->BindTexture(ACCUM_TEXTURE_UNIT, GL_TEXTURE_2D, m_accumTextureID);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glGenTextures(1, &m_revealageTextureID);
+	m_pStateCache->BindTexture(REVEALAGE_TEXTURE_UNIT, GL_TEXTURE_2D, m_revealageTextureID);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glGenRenderbuffers(1, &m_depthBufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+	glGenFramebuffers(1, &m_framebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_accumTextureID, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_revealageTextureID, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBufferID);
+	glDrawBuffers(2, drawBuffers);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Transparency frame buffer is incomplete" << std::endl;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebufferID);
+}
+
+/***********************************************************
+ *  DestroyTargets()
+ *
+ *  This method is used for freeing the accumulation targets.
+ ***********************************************************/
+void OITManager::DestroyTargets()
+{
+	if (0 != m_framebufferID)
+	{
+		glDeleteFramebuffers(1, &m_framebufferID);
+		m_framebufferID = 0;
+	}
+	if (0 != m_accumTextureID)
+	{
+		glDeleteTextures(1, &m_accumTextureID);
+		m_accumTextureID = 0;
+	}
+	if (0 != m_revealageTextureID)
+	{
+		glDeleteTextures(1, &m_revealageTextureID);
+		m_revealageTextureID = 0;
+	}
+	if (0 != m_depthBufferID)
+	{
+		glDeleteRenderbuffers(1, &m_depthBufferID);
+		m_depthBufferID = 0;
+	}
+	m_pStateCache->InvalidateTextures();
+	m_width = 0;
+	m_height = 0;
+}
@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////
+// oitmanager.h
+// ============
+// manage weighted blended order-independent transparency - targets, composite
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "GLStateCache.h"
+
+/***********************************************************
+ *  OITManager
+ *
+ *  This class contains the code for rendering transparent
+ *  objects without sorting.  Transparent fragments are
+ *  accumulated into a color target and a revealage target,
+ *  and a full screen composite blends the result over the
+ *  opaque scene.
+ ***********************************************************/
+class OITManager
+{
+public:
+	// constructor
+	OITManager(GLStateCache* pStateCache);
+	// destructor
+	~OITManager();
+
+	// load the composite shader
+	bool Initialize();
+
+	// redirect drawing into the accumulation targets
+	void BeginTransparentPass();
+	// return drawing to the scene frame buffer
+	void EndTransparentPass();
+	// blend the accumulated transparency over the scene
+	void Composite();
+
+private:
+	// texture units used for reading the targets in the composite
+	static const int ACCUM_TEXTURE_UNIT = GLStateCache::OIT_ACCUM_TEXTURE_UNIT;
+	static const int REVEALAGE_TEXTURE_UNIT = GLStateCache::OIT_REVEALAGE_TEXTURE_UNIT;
+
+	// pointer to OpenGL state cache object
+	GLStateCache* m_pStateCache;
+	// shader used for the full screen composite
+	ShaderManager* m_pCompositeShader;
+
+	// accumulation frame buffer and its attachments
+	GLuint m_framebufferID;
+	GLuint m_accumTextureID;
+	GLuint m_revealageTextureID;
+	GLuint m_depthBufferID;
+	// empty vertex array for the full screen triangle
+	GLuint m_vertexArrayID;
+	// size of the targets in pixels
+	int m_width;
+	int m_height;
+	// frame buffer the scene is drawn into
+	GLint m_sceneFramebufferID;
+
+	// create the targets, or recreate them at a new size
+	void CreateTargets(int width, int height);
+	// free the targets
+	void DestroyTargets();
+};
@@ -0,0 +1,535 @@
+///////////////////////////////////////////////////////////////////////////////
+// perfhud.cpp
+// ============
+// on-screen overlay of frame times, OpenGL calls and memory
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PerfHud.h"
+#include "GLCallCounter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// declaration of the global variables and defines
+namespace
+{
+	// characters of the glyph atlas, in the order of their
+	// columns below - lower case is drawn as upper case
+	const char* const FONT_CHARACTERS = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:/%-()";
+	// five columns of seven rows per glyph, the top row in the
+	// lowest bit
+	const unsigned char FONT_COLUMNS[][5] =
+	{
+		{ 0x00, 0x00, 0x00, 0x00, 0x00 },	// space
+		{ 0x3E, 0x51, 0x49, 0x45, 0x3E },	// 0
+		{ 0x00, 0x42, 0x7F, 0x40, 0x00 },	// 1
+		{ 0x42, 0x61, 0x51, 0x49, 0x46 },	// 2
+		{ 0x21, 0x41, 0x45, 0x4B, 0x31 },	// 3
+		{ 0x18, 0x14, 0x12, 0x7F, 0x10 },	// 4
+		{ 0x27, 0x45, 0x45, 0x45, 0x39 },	// 5
+		{ 0x3C, 0x4A, 0x49, 0x49, 0x30 },	// 6
+		{ 0x01, 0x71, 0x09, 0x05, 0x03 },	// 7
+		{ 0x36, 0x49, 0x49, 0x49, 0x36 },	// 8
+		{ 0x06, 0x49, 0x49, 0x29, 0x1E },	// 9
+		{ 0x7E, 0x11, 0x11, 0x11, 0x7E },	// A
+		{ 0x7F, 0x49, 0x49, 0x49, 0x36 },	// B
+		{ 0x3E, 0x41, 0x41, 0x41, 0x22 },	// C
+		{ 0x7F, 0x41, 0x41, 0x22, 0x1C },	// D
+		{ 0x7F, 0x49, 0x49, 0x49, 0x41 },	// E
+		{ 0x7F, 0x09, 0x09, 0x01, 0x01 },	// F
+		{ 0x3E, 0x41, 0x41, 0x51, 0x32 },	// G
+		{ 0x7F, 0x08, 0x08, 0x08, 0x7F },	// H
+		{ 0x00, 0x41, 0x7F, 0x41, 0x00 },	// I
+		{ 0x20, 0x40, 0x41, 0x3F, 0x01 },	// J
+		{ 0x7F, 0x08, 0x14, 0x22, 0x41 },	// K
+		{ 0x7F, 0x40, 0x40, 0x40, 0x40 },	// L
+		{ 0x7F, 0x02, 0x04, 0x02, 0x7F },	// M
+		{ 0x7F, 0x04, 0x08, 0x10, 0x7F },	// N
+		{ 0x3E, 0x41, 0x41, 0x41, 0x3E },	// O
+		{ 0x7F, 0x09, 0x09, 0x09, 0x06 },	// P
+		{ 0x3E, 0x41, 0x51, 0x21, 0x5E },	// Q
+		{ 0x7F, 0x09, 0x19, 0x29, 0x46 },	// R
+		{ 0x46, 0x49, 0x49, 0x49, 0x31 },	// S
+		{ 0x01, 0x01, 0x7F, 0x01, 0x01 },	// T
+		{ 0x3F, 0x40, 0x40, 0x40, 0x3F },	// U
+		{ 0x1F, 0x20, 0x40, 0x20, 0x1F },	// V
+		{ 0x7F, 0x20, 0x18, 0x20, 0x7F },	// W
+		{ 0x63, 0x14, 0x08, 0x14, 0x63 },	// X
+		{ 0x03, 0x04, 0x78, 0x04, 0x03 },	// Y
+		{ 0x61, 0x51, 0x49, 0x45, 0x43 },	// Z
+		{ 0x00, 0x60, 0x60, 0x00, 0x00 },	// .
+		{ 0x00, 0x36, 0x36, 0x00, 0x00 },	// :
+		{ 0x20, 0x10, 0x08, 0x04, 0x02 },	// /
+		{ 0x23, 0x13, 0x08, 0x64, 0x62 },	// %
+		{ 0x08, 0x08, 0x08, 0x08, 0x08 },	// -
+		{ 0x00, 0x1C, 0x22, 0x41, 0x00 },	// (
+		{ 0x00, 0x41, 0x22, 0x1C, 0x00 }	// )
+	};
+	const int FONT_GLYPH_COUNT = sizeof(FONT_COLUMNS) / sizeof(FONT_COLUMNS[0]);
+	// a glyph and its spacing in atlas texels, and the cell
+	// after the glyphs that is solid for the bars
+	const int CELL_WIDTH = 6;
+	const int CELL_HEIGHT = 8;
+	const int SOLID_CELL = FONT_GLYPH_COUNT;
+	const int ATLAS_WIDTH = (FONT_GLYPH_COUNT + 1) * CELL_WIDTH;
+	// screen pixels per atlas texel
+	const float TEXT_SCALE = 2.0f;
+	const float LINE_HEIGHT = (CELL_HEIGHT + 1) * TEXT_SCALE;
+
+	// size of the graphs in pixels, the time at their top and
+	// the time of a 60 frame per second frame
+	const float GRAPH_HEIGHT = 64.0f;
+	const float GRAPH_BAR_WIDTH = 3.0f;
+	const float GRAPH_MAX_TIME = 33.3f;
+	const float TARGET_FRAME_TIME = 16.7f;
+	// frames averaged for the times shown as text
+	const int AVERAGE_FRAMES = 30;
+
+	// colors of the overlay
+	const unsigned char PANEL_COLOR[4] = { 0, 0, 0, 160 };
+	const unsigned char TEXT_COLOR[4] = { 255, 255, 255, 255 };
+	const unsigned char FRAME_COLOR[4] = { 128, 128, 128, 255 };
+	const unsigned char CPU_COLOR[4] = { 64, 200, 255, 255 };
+	const unsigned char GPU_COLOR[4] = { 255, 160, 32, 255 };
+	const unsigned char TARGET_COLOR[4] = { 64, 255, 64, 200 };
+
+	/***********************************************************
+	 *  GetAverage()
+	 *
+	 *  This function is used for averaging the last entries of
+	 *  a history ring, ending at the passed in entry.
+	 ***********************************************************/
+	float GetAverage(const float* pHistory, int size, int last, int count)
+	{
+		float total = 0.0f;
+
+		for (int i = 0; i < count; i++)
+		{
+			total += pHistory[(last - i + size) % size];
+		}
+		return(total / (float)count);
+	}
+}
+
+/***********************************************************
+ *  PerfHud()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PerfHud::PerfHud(GLStateCache* pStateCache)
+{
+	m_pStateCache = pStateCache;
+	m_pHudShader = NULL;
+	m_atlasTextureID = 0;
+	m_vertexArrayID = 0;
+	m_vertexBufferID = 0;
+	for (int i = 0; i < HISTORY_SIZE; i++)
+	{
+		m_frameTimes[i] = 0.0f;
+		m_cpuTimes[i] = 0.0f;
+		m_gpuTimes[i] = 0.0f;
+	}
+	m_historyIndex = 0;
+	for (int i = 0; i < QUERY_COUNT; i++)
+	{
+		m_timerQueries[i] = 0;
+		m_queryHistoryIndex[i] = -1;
+	}
+	m_queryFrame = 0;
+	m_bQueryActive = false;
+	m_bFirstFrame = true;
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+/***********************************************************
+ *  ~PerfHud()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PerfHud::~PerfHud()
+{
+	if (0 != m_timerQueries[0])
+	{
+		glDeleteQueries(QUERY_COUNT, m_timerQueries);
+	}
+	if (0 != m_vertexBufferID)
+	{
+		glDeleteBuffers(1, &m_vertexBufferID);
+	}
+	if (0 != m_vertexArrayID)
+	{
+		glDeleteVertexArrays(1, &m_vertexArrayID);
+		m_pStateCache->InvalidateVertexArray();
+	}
+	if (0 != m_atlasTextureID)
+	{
+		glDeleteTextures(1, &m_atlasTextureID);
+		m_pStateCache->InvalidateTextures();
+	}
+	if (NULL != m_pHudShader)
+	{
+		delete m_pHudShader;
+		m_pHudShader = NULL;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the overlay shader and
+ *  creating the glyph atlas, the timer queries and the
+ *  vertex buffer the overlay is written into each frame.
+ ***********************************************************/
+bool PerfHud::Initialize()
+{
+	m_pHudShader = new ShaderManager();
+	m_pHudShader->LoadShaders(
+		"shaders/hudVertexShader.glsl",
+		"shaders/hudFragmentShader.glsl");
+	if (0 == m_pHudShader->m_programID)
+	{
+		std::cout << "Could not load the performance overlay shader" << std::endl;
+		return false;
+	}
+
+	CreateAtlas();
+	glGenQueries(QUERY_COUNT, m_timerQueries);
+
+	glGenVertexArrays(1, &m_vertexArrayID);
+	glGenBuffers(1, &m_vertexBufferID);
+	m_pStateCache->BindVertexArray(m_vertexArrayID);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(HUD_VERTEX), (void*)offsetof(HUD_VERTEX, x));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(HUD_VERTEX), (void*)offsetof(HUD_VERTEX, u));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(HUD_VERTEX), (void*)offsetof(HUD_VERTEX, color));
+	glEnableVertexAttribArray(2);
+
+	return true;
+}
+
+/***********************************************************
+ *  CreateAtlas()
+ *
+ *  This method is used for building the glyph atlas - one
+ *  row of cells holding the coverage of each glyph, and a
+ *  last cell that is fully covered for drawing the bars.
+ ***********************************************************/
+void PerfHud::CreateAtlas()
+{
+	std::vector<unsigned char> texels(ATLAS_WIDTH * CELL_HEIGHT, 0);
+
+	for (int glyph = 0; glyph < FONT_GLYPH_COUNT; glyph++)
+	{
+		for (int column = 0; column < 5; column++)
+		{
+			for (int row = 0; row < 7; row++)
+			{
+				if ((FONT_COLUMNS[glyph][column] >> row) & 1)
+				{
+					texels[row * ATLAS_WIDTH + glyph * CELL_WIDTH + column] = 255;
+				}
+			}
+		}
+	}
+	for (int row = 0; row < CELL_HEIGHT; row++)
+	{
+		memset(&texels[row * ATLAS_WIDTH + SOLID_CELL * CELL_WIDTH], 255, CELL_WIDTH);
+	}
+
+	glGenTextures(1, &m_atlasTextureID);
+	m_pStateCache->BindTexture(ATLAS_TEXTURE_UNIT, GL_TEXTURE_2D, m_atlasTextureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	// the rows of a one byte texture are not padded
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_WIDTH, CELL_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting the measurements of a
+ *  frame.  The time since the last frame started is the
+ *  frame time of the last frame, and a timer query is
+ *  started for the GPU time of this one.
+ ***********************************************************/
+void PerfHud::BeginFrame()
+{
+	m_frameStart = std::chrono::steady_clock::now();
+	if (m_bFirstFrame == false)
+	{
+		m_frameTimes[m_historyIndex] = std::chrono::duration<float, std::milli>(
+			m_frameStart - m_lastFrameStart).count();
+	}
+	m_lastFrameStart = m_frameStart;
+	m_bFirstFrame = false;
+
+	ReadTimerQueries();
+	m_historyIndex = (m_historyIndex + 1) % HISTORY_SIZE;
+	m_frameTimes[m_historyIndex] = 0.0f;
+	m_cpuTimes[m_historyIndex] = 0.0f;
+	m_gpuTimes[m_historyIndex] = 0.0f;
+
+	GLCallCounter::Reset();
+
+	if (0 != m_timerQueries[0])
+	{
+		int query = m_queryFrame % QUERY_COUNT;
+
+		// a query still running after a full ring of frames is
+		// waited on rather than lost
+		if (m_queryHistoryIndex[query] >= 0)
+		{
+			GLuint64 gpuTime = 0;
+			glGetQueryObjectui64v(m_timerQueries[query], GL_QUERY_RESULT, &gpuTime);
+			m_gpuTimes[m_queryHistoryIndex[query]] = (float)((double)gpuTime / 1.0e6);
+		}
+		m_queryHistoryIndex[query] = m_historyIndex;
+		glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[query]);
+		m_bQueryActive = true;
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for finishing the measurements of a
+ *  frame once the scene has been submitted - the CPU time to
+ *  submit it, and the OpenGL calls and state changes made.
+ ***********************************************************/
+void PerfHud::EndFrame(int visibleObjects, int culledObjects)
+{
+	if (m_bQueryActive == true)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		m_bQueryActive = false;
+		m_queryFrame++;
+	}
+	m_cpuTimes[m_historyIndex] = std::chrono::duration<float, std::milli>(
+		std::chrono::steady_clock::now() - m_frameStart).count();
+
+	const GLCallCounter::CALL_COUNTS& counts = GLCallCounter::GetCounts();
+	const GLStateCache::STATE_STATS& stateStats = m_pStateCache->GetStats();
+	m_stats.drawCalls = counts.drawCalls;
+	m_stats.triangles = counts.triangles;
+	m_stats.textureBinds = counts.textureBinds;
+	m_stats.uniformUploads = counts.uniformUploads;
+	m_stats.stateChanges = stateStats.programBinds + stateStats.vertexArrayBinds +
+		stateStats.textureBinds + stateStats.capabilityChanges;
+	m_stats.redundantCalls = stateStats.redundantCalls;
+	m_stats.visibleObjects = visibleObjects;
+	m_stats.culledObjects = culledObjects;
+}
+
+/***********************************************************
+ *  ReadTimerQueries()
+ *
+ *  This method is used for taking the GPU times of the
+ *  frames whose timer queries have finished, without
+ *  waiting on the ones that have not.
+ ***********************************************************/
+void PerfHud::ReadTimerQueries()
+{
+	for (int i = 0; i < QUERY_COUNT; i++)
+	{
+		GLint bAvailable = GL_FALSE;
+
+		if (m_queryHistoryIndex[i] < 0)
+		{
+			continue;
+		}
+		glGetQueryObjectiv(m_timerQueries[i], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+		if (bAvailable == GL_TRUE)
+		{
+			GLuint64 gpuTime = 0;
+			glGetQueryObjectui64v(m_timerQueries[i], GL_QUERY_RESULT, &gpuTime);
+			m_gpuTimes[m_queryHistoryIndex[i]] = (float)((double)gpuTime / 1.0e6);
+			m_queryHistoryIndex[i] = -1;
+		}
+	}
+}
+
+/***********************************************************
+ *  AddText()
+ *
+ *  This method is used for adding a quad for each character
+ *  of a line of text.
+ ***********************************************************/
+void PerfHud::AddText(float x, float y, const std::string& text, const unsigned char color[4])
+{
+	const float glyphWidth = CELL_WIDTH * TEXT_SCALE;
+	const float glyphHeight = CELL_HEIGHT * TEXT_SCALE;
+
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		// characters missing from the atlas are left blank
+		const char* pFound = strchr(FONT_CHARACTERS, toupper((unsigned char)text[i]));
+		int glyph = (NULL == pFound) ? 0 : (int)(pFound - FONT_CHARACTERS);
+		float left = x + i * glyphWidth;
+		float u0 = (float)(glyph * CELL_WIDTH) / ATLAS_WIDTH;
+		float u1 = (float)((glyph + 1) * CELL_WIDTH) / ATLAS_WIDTH;
+
+		if ((glyph == 0) || (glyph >= FONT_GLYPH_COUNT))
+		{
+			continue;
+		}
+
+		HUD_VERTEX corners[4] =
+		{
+			{ left, y, u0, 0.0f, { color[0], color[1], color[2], color[3] } },
+			{ left + glyphWidth, y, u1, 0.0f, { color[0], color[1], color[2], color[3] } },
+			{ left + glyphWidth, y + glyphHeight, u1, 1.0f, { color[0], color[1], color[2], color[3] } },
+			{ left, y + glyphHeight, u0, 1.0f, { color[0], color[1], color[2], color[3] } }
+		};
+		m_vertices.push_back(corners[0]);
+		m_vertices.push_back(corners[1]);
+		m_vertices.push_back(corners[2]);
+		m_vertices.push_back(corners[0]);
+		m_vertices.push_back(corners[2]);
+		m_vertices.push_back(corners[3]);
+	}
+}
+
+/***********************************************************
+ *  AddRect()
+ *
+ *  This method is used for adding a solid rectangle, which
+ *  samples the middle of the solid cell of the atlas.
+ ***********************************************************/
+void PerfHud::AddRect(float x, float y, float width, float height, const unsigned char color[4])
+{
+	float u = ((float)SOLID_CELL + 0.5f) * CELL_WIDTH / ATLAS_WIDTH;
+	HUD_VERTEX corners[4] =
+	{
+		{ x, y, u, 0.5f, { color[0], color[1], color[2], color[3] } },
+		{ x + width, y, u, 0.5f, { color[0], color[1], color[2], color[3] } },
+		{ x + width, y + height, u, 0.5f, { color[0], color[1], color[2], color[3] } },
+		{ x, y + height, u, 0.5f, { color[0], color[1], color[2], color[3] } }
+	};
+
+	m_vertices.push_back(corners[0]);
+	m_vertices.push_back(corners[1]);
+	m_vertices.push_back(corners[2]);
+	m_vertices.push_back(corners[0]);
+	m_vertices.push_back(corners[2]);
+	m_vertices.push_back(corners[3]);
+}
+
+/***********************************************************
+ *  AddGraphs()
+ *
+ *  This method is used for adding the time graphs, oldest
+ *  frame on the left.  Each frame is a grey bar of its frame
+ *  time with its CPU and GPU times side by side in front,
+ *  and the line marks a 60 frame per second frame.
+ ***********************************************************/
+void PerfHud::AddGraphs(float x, float y)
+{
+	float scale = GRAPH_HEIGHT / GRAPH_MAX_TIME;
+	float bottom = y + GRAPH_HEIGHT;
+
+	for (int i = 0; i < HISTORY_SIZE; i++)
+	{
+		// the frame being drawn has no times yet, so the graph
+		// ends at the one before it
+		int entry = (m_historyIndex + 1 + i) % HISTORY_SIZE;
+		float left = x + i * GRAPH_BAR_WIDTH;
+		float frameHeight = std::min(m_frameTimes[entry] * scale, GRAPH_HEIGHT);
+		float cpuHeight = std::min(m_cpuTimes[entry] * scale, GRAPH_HEIGHT);
+		float gpuHeight = std::min(m_gpuTimes[entry] * scale, GRAPH_HEIGHT);
+
+		AddRect(left, bottom - frameHeight, GRAPH_BAR_WIDTH, frameHeight, FRAME_COLOR);
+		AddRect(left, bottom - cpuHeight, 1.0f, cpuHeight, CPU_COLOR);
+		AddRect(left + 1.0f, bottom - gpuHeight, 1.0f, gpuHeight, GPU_COLOR);
+	}
+	AddRect(x, bottom - TARGET_FRAME_TIME * scale, HISTORY_SIZE * GRAPH_BAR_WIDTH, 1.0f, TARGET_COLOR);
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used for drawing the overlay in the top
+ *  left corner - the text and graphs are written into one
+ *  vertex buffer and drawn with a single draw call, blended
+ *  over the scene without the depth test.
+ ***********************************************************/
+void PerfHud::Draw(int width, int height)
+{
+	if ((NULL == m_pHudShader) || (width <= 0) || (height <= 0))
+	{
+		return;
+	}
+
+	// the last frame with all of its times is the one before
+	// the frame being drawn
+	int last = (m_historyIndex - 1 + HISTORY_SIZE) % HISTORY_SIZE;
+	float frameTime = GetAverage(m_frameTimes, HISTORY_SIZE, last, AVERAGE_FRAMES);
+	float cpuTime = GetAverage(m_cpuTimes, HISTORY_SIZE, last, AVERAGE_FRAMES);
+	float gpuTime = GetAverage(m_gpuTimes, HISTORY_SIZE, last - QUERY_COUNT, AVERAGE_FRAMES);
+	GLCallCounter::MEMORY_COUNTS memory = GLCallCounter::GetMemory();
+	char lines[10][64];
+
+	snprintf(lines[0], sizeof(lines[0]), "FRAME %5.1f MS %5.0f FPS", frameTime, (frameTime > 0.0f) ? 1000.0f / frameTime : 0.0f);
+	// the CPU and GPU labels are added in the colors of their graphs
+	snprintf(lines[1], sizeof(lines[1]), "    %5.1f MS       %5.1f MS", cpuTime, gpuTime);
+	snprintf(lines[2], sizeof(lines[2]), "DRAW CALLS     %lld", m_stats.drawCalls);
+	snprintf(lines[3], sizeof(lines[3]), "TRIANGLES      %lld", m_stats.triangles);
+	snprintf(lines[4], sizeof(lines[4]), "TEXTURE BINDS  %lld", m_stats.textureBinds);
+	snprintf(lines[5], sizeof(lines[5]), "UNIFORMS       %lld", m_stats.uniformUploads);
+	snprintf(lines[6], sizeof(lines[6]), "STATE CHANGES  %d (%d SKIPPED)", m_stats.stateChanges, m_stats.redundantCalls);
+	snprintf(lines[7], sizeof(lines[7]), "OBJECTS        %d (%d CULLED)", m_stats.visibleObjects, m_stats.culledObjects);
+	snprintf(lines[8], sizeof(lines[8]), "TEXTURE MEMORY %.1f MB", (double)memory.textureBytes / (1024.0 * 1024.0));
+	snprintf(lines[9], sizeof(lines[9]), "MESH MEMORY    %.1f MB", (double)memory.meshBytes / (1024.0 * 1024.0));
+
+	// panel, then the first two lines, the graphs and the rest
+	const float margin = 8.0f;
+	float panelWidth = std::max(HISTORY_SIZE * GRAPH_BAR_WIDTH, 30 * CELL_WIDTH * TEXT_SCALE) + 2.0f * margin;
+	float panelHeight = 10 * LINE_HEIGHT + GRAPH_HEIGHT + 4.0f * margin;
+	float x = 2.0f * margin;
+	float y = 2.0f * margin;
+
+	m_vertices.clear();
+	AddRect(margin, margin, panelWidth, panelHeight, PANEL_COLOR);
+	AddText(x, y, lines[0], TEXT_COLOR);
+	y += LINE_HEIGHT;
+	AddText(x, y, "CPU", CPU_COLOR);
+	AddText(x + 15 * CELL_WIDTH * TEXT_SCALE, y, "GPU", GPU_COLOR);
+	AddText(x, y, lines[1], TEXT_COLOR);
+	y += LINE_HEIGHT + margin;
+	AddGraphs(x, y);
+	y += GRAPH_HEIGHT + margin;
+	for (int i = 2; i < 10; i++)
+	{
+		AddText(x, y, lines[i], TEXT_COLOR);
+		y += LINE_HEIGHT;
+	}
+
+	m_pStateCache->UseProgram(m_pHudShader->m_programID);
+	m_pStateCache->BindTexture(ATLAS_TEXTURE_UNIT, GL_TEXTURE_2D, m_atlasTextureID);
+	m_pHudShader->setSampler2DValue("glyphAtlas", ATLAS_TEXTURE_UNIT);
+	m_pHudShader->setVec2Value("screenSize", glm::vec2((float)width, (float)height));
+
+	m_pStateCache->SetBlend(true);
+	m_pStateCache->SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	m_pStateCache->SetDepthTest(false);
+	glViewport(0, 0, width, height);
+
+	m_pStateCache->BindVertexArray(m_vertexArrayID);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+	// the buffer is replaced every frame rather than waited on
+	glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(HUD_VERTEX), m_vertices.data(), GL_STREAM_DRAW);
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)m_vertices.size());
+
+	m_pStateCache->SetBlend(false);
+	m_pStateCache->SetDepthTest(true);
+}
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+// perfhud.h
+// ============
+// on-screen overlay of frame times, OpenGL calls and memory
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "GLStateCache.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  PerfHud
+ *
+ *  This class contains the code for showing what each frame
+ *  costs while flying through the scene - graphs of the
+ *  frame, CPU and GPU times, the draw calls, triangles,
+ *  texture binds, uniform uploads and state changes of the
+ *  frame, the shapes drawn and culled, and the memory of the
+ *  textures and meshes.  The text is cut from a small glyph
+ *  atlas, and the text and graphs together are one vertex
+ *  buffer drawn with a single draw call.  The GPU time is
+ *  read from timer queries a few frames late, so measuring
+ *  it never waits for the GPU.
+ ***********************************************************/
+class PerfHud
+{
+public:
+	// constructor
+	PerfHud(GLStateCache* pStateCache);
+	// destructor
+	~PerfHud();
+
+	// load the overlay shader and create the glyph atlas
+	bool Initialize();
+
+	// start measuring a frame, before anything is drawn
+	void BeginFrame();
+	// finish measuring the frame once the scene is submitted,
+	// with the shapes drawn and culled by its views
+	void EndFrame(int visibleObjects, int culledObjects);
+	// draw the overlay over a frame buffer of the passed in size
+	void Draw(int width, int height);
+
+private:
+	// texture unit of the glyph atlas
+	static const int ATLAS_TEXTURE_UNIT = GLStateCache::HUD_ATLAS_TEXTURE_UNIT;
+	// frames kept for the graphs, and timer queries in flight
+	static const int HISTORY_SIZE = 120;
+	static const int QUERY_COUNT = 4;
+
+	// a corner of a glyph or a bar, in pixels from the top left
+	struct HUD_VERTEX
+	{
+		float x;
+		float y;
+		float u;
+		float v;
+		unsigned char color[4];
+	};
+
+	// counts of the last measured frame
+	struct FRAME_STATS
+	{
+		long long drawCalls;
+		long long triangles;
+		long long textureBinds;
+		long long uniformUploads;
+		int stateChanges;
+		int redundantCalls;
+		int visibleObjects;
+		int culledObjects;
+	};
+
+	// pointer to OpenGL state cache object
+	GLStateCache* m_pStateCache;
+	// shader drawing the overlay
+	ShaderManager* m_pHudShader;
+	// glyph atlas and the buffers of the overlay
+	GLuint m_atlasTextureID;
+	GLuint m_vertexArrayID;
+	GLuint m_vertexBufferID;
+	std::vector<HUD_VERTEX> m_vertices;
+
+	// frame, CPU and GPU times of the last frames in
+	// milliseconds, the next entry written, and the entry each
+	// timer query belongs to
+	float m_frameTimes[HISTORY_SIZE];
+	float m_cpuTimes[HISTORY_SIZE];
+	float m_gpuTimes[HISTORY_SIZE];
+	int m_historyIndex;
+	GLuint m_timerQueries[QUERY_COUNT];
+	int m_queryHistoryIndex[QUERY_COUNT];
+	int m_queryFrame;
+	bool m_bQueryActive;
+	std::chrono::steady_clock::time_point m_frameStart;
+	std::chrono::steady_clock::time_point m_lastFrameStart;
+	bool m_bFirstFrame;
+	FRAME_STATS m_stats;
+
+	// build the glyph atlas texture
+	void CreateAtlas();
+	// read the timer queries that have finished
+	void ReadTimerQueries();
+	// add a line of text at the passed in pixel position
+	void AddText(float x, float y, const std::string& text, const unsigned char color[4]);
+	// add a solid rectangle
+	void AddRect(float x, float y, float width, float height, const unsigned char color[4]);
+	// add the frame, CPU and GPU time graphs
+	void AddGraphs(float x, float y);
+};
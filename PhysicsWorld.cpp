@@ -0,0 +1,1146 @@
+///////////////////////////////////////////////////////////////////////////////
+// physicsworld.cpp
+// ============
+// rigid body simulation of spheres, boxes and capsules on worker threads
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PhysicsWorld.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+// declaration of the global variables and defines
+namespace
+{
+	// the bodies move in fixed steps, catching up on at most a
+	// few steps in one update
+	const float FIXED_TIME_STEP = 1.0f / 120.0f;
+	const int MAX_STEPS_PER_UPDATE = 8;
+	// passes over the contacts of each island per step
+	const int SOLVER_ITERATIONS = 10;
+	// part of the overlap pushed apart each step, and the
+	// overlap left alone so resting contacts do not jitter
+	const float BAUMGARTE_FACTOR = 0.2f;
+	const float PENETRATION_SLOP = 0.005f;
+	// closing speed below which bodies do not bounce
+	const float RESTITUTION_THRESHOLD = 1.0f;
+	// space added around the bounds so touching bodies pair up
+	const float BOUNDS_MARGIN = 0.02f;
+	// most contacts kept for one pair - a box has eight corners
+	const int MAX_CONTACTS_PER_PAIR = 8;
+	// loss of speed per second
+	const float LINEAR_DAMPING = 0.05f;
+	const float ANGULAR_DAMPING = 0.1f;
+	// speeds below which a body counts as still, and the time
+	// a whole island has to be still before it sleeps
+	const float SLEEP_LINEAR_SPEED = 0.05f;
+	const float SLEEP_ANGULAR_SPEED = 0.05f;
+	const float SLEEP_DELAY = 0.5f;
+	// work given to each thread before another one is started
+	const int MIN_PAIRS_PER_THREAD = 64;
+	const int MIN_ISLANDS_PER_THREAD = 4;
+
+	/***********************************************************
+	 *  ClosestPointOnSegment()
+	 *
+	 *  This function is used for finding the point of a line
+	 *  segment closest to a point.
+	 ***********************************************************/
+	glm::vec3 ClosestPointOnSegment(
+		const glm::vec3& point,
+		const glm::vec3& start,
+		const glm::vec3& end)
+	{
+		glm::vec3 segment = end - start;
+		float lengthSquared = glm::dot(segment, segment);
+		float t = 0.0f;
+
+		if (lengthSquared > 1.0e-12f)
+		{
+			t = glm::clamp(glm::dot(point - start, segment) / lengthSquared, 0.0f, 1.0f);
+		}
+
+		return(start + segment * t);
+	}
+
+	/***********************************************************
+	 *  ClosestPointsOnSegments()
+	 *
+	 *  This function is used for finding the closest points
+	 *  between two line segments, either of which may be a
+	 *  single point.
+	 ***********************************************************/
+	void ClosestPointsOnSegments(
+		const glm::vec3& startA,
+		const glm::vec3& endA,
+		const glm::vec3& startB,
+		const glm::vec3& endB,
+		glm::vec3& closestA,
+		glm::vec3& closestB)
+	{
+		const float EPSILON = 1.0e-12f;
+		glm::vec3 segmentA = endA - startA;
+		glm::vec3 segmentB = endB - startB;
+		glm::vec3 between = startA - startB;
+		float lengthA = glm::dot(segmentA, segmentA);
+		float lengthB = glm::dot(segmentB, segmentB);
+		float projectB = glm::dot(segmentB, between);
+		float s = 0.0f;
+		float t = 0.0f;
+
+		if ((lengthA <= EPSILON) && (lengthB <= EPSILON))
+		{
+			// both are points
+		}
+		else if (lengthA <= EPSILON)
+		{
+			t = glm::clamp(projectB / lengthB, 0.0f, 1.0f);
+		}
+		else
+		{
+			float projectA = glm::dot(segmentA, between);
+
+			if (lengthB <= EPSILON)
+			{
+				s = glm::clamp(-projectA / lengthA, 0.0f, 1.0f);
+			}
+			else
+			{
+				float along = glm::dot(segmentA, segmentB);
+				float denominator = lengthA * lengthB - along * along;
+
+				// parallel segments take any point, here the start
+				if (denominator > EPSILON)
+				{
+					s = glm::clamp((along * projectB - projectA * lengthB) / denominator, 0.0f, 1.0f);
+				}
+				t = (along * s + projectB) / lengthB;
+				if (t < 0.0f)
+				{
+					t = 0.0f;
+					s = glm::clamp(-projectA / lengthA, 0.0f, 1.0f);
+				}
+				else if (t > 1.0f)
+				{
+					t = 1.0f;
+					s = glm::clamp((along - projectA) / lengthA, 0.0f, 1.0f);
+				}
+			}
+		}
+
+		closestA = startA + segmentA * s;
+		closestB = startB + segmentB * t;
+	}
+}
+
+/***********************************************************
+ *  PhysicsWorld()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PhysicsWorld::PhysicsWorld(TransformStore* pTransforms)
+{
+	m_pTransforms = pTransforms;
+	m_gravity = glm::vec3(0.0f, -9.81f, 0.0f);
+	m_threadCount = (int)std::thread::hardware_concurrency();
+	if (m_threadCount < 1)
+	{
+		m_threadCount = 1;
+	}
+	m_islandCount = 0;
+	m_accumulator = 0.0f;
+	m_stepTime = 0.0;
+}
+
+/***********************************************************
+ *  ~PhysicsWorld()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PhysicsWorld::~PhysicsWorld()
+{
+	m_pTransforms = NULL;
+	m_pairs.clear();
+	m_pairContacts.clear();
+	m_contacts.clear();
+}
+
+/***********************************************************
+ *  AddSphere()
+ *
+ *  This method is used for adding a sphere body.
+ ***********************************************************/
+int PhysicsWorld::AddSphere(const glm::vec3& position, float radius, float mass, int node)
+{
+	return(AddBody(BODY_SPHERE, position, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f),
+		glm::vec3(radius, 0.0f, 0.0f), mass, node));
+}
+
+/***********************************************************
+ *  AddBox()
+ *
+ *  This method is used for adding a box body.
+ ***********************************************************/
+int PhysicsWorld::AddBox(const glm::vec3& position, const glm::vec3& halfExtents, const glm::vec4& rotation, float mass, int node)
+{
+	return(AddBody(BODY_BOX, position, rotation, halfExtents, mass, node));
+}
+
+/***********************************************************
+ *  AddCapsule()
+ *
+ *  This method is used for adding a capsule body.
+ ***********************************************************/
+int PhysicsWorld::AddCapsule(const glm::vec3& position, float radius, float halfHeight, const glm::vec4& rotation, float mass, int node)
+{
+	return(AddBody(BODY_CAPSULE, position, rotation,
+		glm::vec3(radius, halfHeight, 0.0f), mass, node));
+}
+
+/***********************************************************
+ *  AddBody()
+ *
+ *  This method is used for appending a body to every array
+ *  of the store.  The inertia comes from the shape filled
+ *  evenly with the mass - a capsule is taken as a cylinder
+ *  running the full length of its caps.
+ ***********************************************************/
+int PhysicsWorld::AddBody(
+	BODY_SHAPE shape,
+	const glm::vec3& position,
+	const glm::vec4& rotation,
+	const glm::vec3& extents,
+	float mass,
+	int node)
+{
+	int body = (int)m_shapes.size();
+	glm::vec3 inertia = glm::vec3(0.0f);
+
+	if (mass > 0.0f)
+	{
+		if (shape == BODY_SPHERE)
+		{
+			inertia = glm::vec3(0.4f * mass * extents.x * extents.x);
+		}
+		else if (shape == BODY_BOX)
+		{
+			glm::vec3 squared = extents * extents;
+			inertia = glm::vec3(
+				squared.y + squared.z,
+				squared.x + squared.z,
+				squared.x + squared.y) * (mass / 3.0f);
+		}
+		else
+		{
+			float radiusSquared = extents.x * extents.x;
+			float length = 2.0f * (extents.y + extents.x);
+			float across = mass * (3.0f * radiusSquared + length * length) / 12.0f;
+			inertia = glm::vec3(across, 0.5f * mass * radiusSquared, across);
+		}
+	}
+
+	m_shapes.push_back((uint8_t)shape);
+	m_positionX.push_back(position.x);
+	m_positionY.push_back(position.y);
+	m_positionZ.push_back(position.z);
+	m_rotationX.push_back(rotation.x);
+	m_rotationY.push_back(rotation.y);
+	m_rotationZ.push_back(rotation.z);
+	m_rotationW.push_back(rotation.w);
+	m_velocityX.push_back(0.0f);
+	m_velocityY.push_back(0.0f);
+	m_velocityZ.push_back(0.0f);
+	m_angularX.push_back(0.0f);
+	m_angularY.push_back(0.0f);
+	m_angularZ.push_back(0.0f);
+	m_inverseMass.push_back((mass > 0.0f) ? 1.0f / mass : 0.0f);
+	m_inverseInertiaX.push_back((inertia.x > 0.0f) ? 1.0f / inertia.x : 0.0f);
+	m_inverseInertiaY.push_back((inertia.y > 0.0f) ? 1.0f / inertia.y : 0.0f);
+	m_inverseInertiaZ.push_back((inertia.z > 0.0f) ? 1.0f / inertia.z : 0.0f);
+	m_extentX.push_back(extents.x);
+	m_extentY.push_back(extents.y);
+	m_extentZ.push_back(extents.z);
+	m_friction.push_back(0.5f);
+	m_restitution.push_back(0.2f);
+	m_nodes.push_back(node);
+	m_sleeping.push_back(0);
+	m_stillTime.push_back(0.0f);
+	m_boundsMin.push_back(glm::vec3(0.0f));
+	m_boundsMax.push_back(glm::vec3(0.0f));
+	m_sortedBodies.push_back(body);
+	m_worldInverseInertia.push_back(glm::mat3(0.0f));
+
+	if ((NULL != m_pTransforms) && (node >= 0))
+	{
+		m_pTransforms->SetTranslation(node, position);
+		m_pTransforms->SetRotation(node, rotation);
+	}
+
+	return(body);
+}
+
+/***********************************************************
+ *  SetMaterial()
+ *
+ *  This method is used for setting how much a body grips and
+ *  bounces.  The larger bounce of two touching bodies is
+ *  used, and the grip of the two is blended.
+ ***********************************************************/
+void PhysicsWorld::SetMaterial(int body, float friction, float restitution)
+{
+	m_friction[body] = friction;
+	m_restitution[body] = restitution;
+}
+
+/***********************************************************
+ *  SetVelocity()
+ *
+ *  This method is used for setting the velocity of a body.
+ ***********************************************************/
+void PhysicsWorld::SetVelocity(int body, const glm::vec3& linear, const glm::vec3& angular)
+{
+	m_velocityX[body] = linear.x;
+	m_velocityY[body] = linear.y;
+	m_velocityZ[body] = linear.z;
+	m_angularX[body] = angular.x;
+	m_angularY[body] = angular.y;
+	m_angularZ[body] = angular.z;
+	m_sleeping[body] = 0;
+	m_stillTime[body] = 0.0f;
+}
+
+/***********************************************************
+ *  SetThreadCount()
+ *
+ *  This method is used for setting the most threads a step
+ *  will use.
+ ***********************************************************/
+void PhysicsWorld::SetThreadCount(int threadCount)
+{
+	m_threadCount = std::max(threadCount, 1);
+}
+
+/***********************************************************
+ *  GetPosition()
+ *
+ *  This method is used for getting the center of a body.
+ ***********************************************************/
+glm::vec3 PhysicsWorld::GetPosition(int body) const
+{
+	return(glm::vec3(m_positionX[body], m_positionY[body], m_positionZ[body]));
+}
+
+/***********************************************************
+ *  GetRotation()
+ *
+ *  This method is used for getting the rotation of a body as
+ *  a matrix whose columns are its local axes.
+ ***********************************************************/
+glm::mat3 PhysicsWorld::GetRotation(int body) const
+{
+	return(glm::mat3_cast(glm::quat(
+		m_rotationW[body], m_rotationX[body], m_rotationY[body], m_rotationZ[body])));
+}
+
+/***********************************************************
+ *  GetPointVelocity()
+ *
+ *  This method is used for getting the velocity of a point
+ *  moving with a body.
+ ***********************************************************/
+glm::vec3 PhysicsWorld::GetPointVelocity(int body, const glm::vec3& offset) const
+{
+	glm::vec3 linear = glm::vec3(m_velocityX[body], m_velocityY[body], m_velocityZ[body]);
+	glm::vec3 angular = glm::vec3(m_angularX[body], m_angularY[body], m_angularZ[body]);
+
+	return(linear + glm::cross(angular, offset));
+}
+
+/***********************************************************
+ *  ApplyImpulse()
+ *
+ *  This method is used for changing the velocity of a body
+ *  by an impulse at a point.  Bodies that do not move are
+ *  never written, so islands sharing them can be solved on
+ *  different threads.
+ ***********************************************************/
+void PhysicsWorld::ApplyImpulse(int body, const glm::vec3& offset, const glm::vec3& impulse)
+{
+	if (m_inverseMass[body] <= 0.0f)
+	{
+		return;
+	}
+
+	glm::vec3 angular = m_worldInverseInertia[body] * glm::cross(offset, impulse);
+
+	m_velocityX[body] += impulse.x * m_inverseMass[body];
+	m_velocityY[body] += impulse.y * m_inverseMass[body];
+	m_velocityZ[body] += impulse.z * m_inverseMass[body];
+	m_angularX[body] += angular.x;
+	m_angularY[body] += angular.y;
+	m_angularZ[body] += angular.z;
+}
+
+/***********************************************************
+ *  GetSegment()
+ *
+ *  This method is used for getting the center line of a
+ *  sphere or capsule - a sphere is a segment of one point.
+ ***********************************************************/
+void PhysicsWorld::GetSegment(int body, glm::vec3& start, glm::vec3& end) const
+{
+	glm::vec3 center = GetPosition(body);
+
+	if (m_shapes[body] == BODY_CAPSULE)
+	{
+		glm::vec3 axis = GetRotation(body)[1] * m_extentY[body];
+		start = center - axis;
+		end = center + axis;
+	}
+	else
+	{
+		start = center;
+		end = center;
+	}
+}
+
+/***********************************************************
+ *  RunParallel()
+ *
+ *  This method is used for running a job on every item of a
+ *  range.  The items are handed out one at a time to the
+ *  calling thread and as many workers as the range is large
+ *  enough to keep busy, so small ranges start no threads.
+ ***********************************************************/
+template <typename JOB>
+void PhysicsWorld::RunParallel(int itemCount, int minItemsPerThread, JOB job)
+{
+	std::atomic<int> nextItem(0);
+	std::vector<std::thread> workers;
+	int threadCount = std::min(m_threadCount, itemCount / minItemsPerThread);
+
+	auto worker = [&nextItem, itemCount, &job]()
+		{
+			int item = nextItem++;
+			while (item < itemCount)
+			{
+				job(item);
+				item = nextItem++;
+			}
+		};
+
+	for (int i = 1; i < threadCount; i++)
+	{
+		workers.push_back(std::thread(worker));
+	}
+	worker();
+	for (int i = 0; i < (int)workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for advancing the bodies by the time
+ *  since the last update in fixed steps, so the result does
+ *  not depend on the frame rate.
+ ***********************************************************/
+void PhysicsWorld::Update(float elapsedTime)
+{
+	int steps = 0;
+
+	m_accumulator += elapsedTime;
+	while ((m_accumulator >= FIXED_TIME_STEP) && (steps < MAX_STEPS_PER_UPDATE))
+	{
+		Step(FIXED_TIME_STEP);
+		m_accumulator -= FIXED_TIME_STEP;
+		steps++;
+	}
+	// drop the time a long stall could not catch up on
+	if (steps == MAX_STEPS_PER_UPDATE)
+	{
+		m_accumulator = 0.0f;
+	}
+}
+
+/***********************************************************
+ *  Step()
+ *
+ *  This method is used for advancing the bodies by one step.
+ *  Gravity is added to the awake bodies, the touching pairs
+ *  are found and their contacts built on the worker threads,
+ *  and then every island is solved and moved on the worker
+ *  threads.  Islands share no moving bodies, so no locking
+ *  is needed.
+ ***********************************************************/
+void PhysicsWorld::Step(float deltaTime)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	float linearDamping = 1.0f / (1.0f + deltaTime * LINEAR_DAMPING);
+	float angularDamping = 1.0f / (1.0f + deltaTime * ANGULAR_DAMPING);
+
+	for (int body = 0; body < GetBodyCount(); body++)
+	{
+		if ((m_inverseMass[body] <= 0.0f) || (m_sleeping[body] != 0))
+		{
+			continue;
+		}
+
+		m_velocityX[body] = (m_velocityX[body] + m_gravity.x * deltaTime) * linearDamping;
+		m_velocityY[body] = (m_velocityY[body] + m_gravity.y * deltaTime) * linearDamping;
+		m_velocityZ[body] = (m_velocityZ[body] + m_gravity.z * deltaTime) * linearDamping;
+		m_angularX[body] *= angularDamping;
+		m_angularY[body] *= angularDamping;
+		m_angularZ[body] *= angularDamping;
+
+		// inertia turned into the world by the body rotation
+		glm::mat3 rotation = GetRotation(body);
+		glm::mat3 inverseInertia = glm::mat3(0.0f);
+		inverseInertia[0][0] = m_inverseInertiaX[body];
+		inverseInertia[1][1] = m_inverseInertiaY[body];
+		inverseInertia[2][2] = m_inverseInertiaZ[body];
+		m_worldInverseInertia[body] = rotation * inverseInertia * glm::transpose(rotation);
+	}
+
+	FindPairs();
+
+	m_pairContacts.resize(m_pairs.size() * MAX_CONTACTS_PER_PAIR);
+	m_pairContactCounts.assign(m_pairs.size(), 0);
+	RunParallel((int)m_pairs.size(), MIN_PAIRS_PER_THREAD, [this](int pair) { CollidePair(pair); });
+
+	m_contacts.clear();
+	for (int pair = 0; pair < (int)m_pairs.size(); pair++)
+	{
+		for (int i = 0; i < m_pairContactCounts[pair]; i++)
+		{
+			m_contacts.push_back(m_pairContacts[pair * MAX_CONTACTS_PER_PAIR + i]);
+		}
+	}
+
+	BuildIslands();
+	RunParallel(m_islandCount, MIN_ISLANDS_PER_THREAD, [this, deltaTime](int island) { SolveIsland(island, deltaTime); });
+
+	WriteTransforms();
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+	m_stepTime = elapsed.count();
+}
+
+/***********************************************************
+ *  FindPairs()
+ *
+ *  This method is used for finding the bodies whose bounds
+ *  overlap.  The bodies are kept sorted by their low x bound
+ *  from step to step, so the insertion sort only has to move
+ *  the few that passed each other.  Sweeping the sorted list
+ *  then only tests the bodies whose x ranges overlap.  Pairs
+ *  with no awake moving body are skipped.
+ ***********************************************************/
+void PhysicsWorld::FindPairs()
+{
+	for (int body = 0; body < GetBodyCount(); body++)
+	{
+		glm::vec3 center = GetPosition(body);
+		glm::vec3 extent;
+
+		if (m_shapes[body] == BODY_SPHERE)
+		{
+			extent = glm::vec3(m_extentX[body]);
+		}
+		else
+		{
+			glm::mat3 rotation = GetRotation(body);
+
+			if (m_shapes[body] == BODY_BOX)
+			{
+				extent = glm::abs(rotation[0]) * m_extentX[body] +
+					glm::abs(rotation[1]) * m_extentY[body] +
+					glm::abs(rotation[2]) * m_extentZ[body];
+			}
+			else
+			{
+				extent = glm::abs(rotation[1]) * m_extentY[body] + glm::vec3(m_extentX[body]);
+			}
+		}
+
+		m_boundsMin[body] = center - extent - BOUNDS_MARGIN;
+		m_boundsMax[body] = center + extent + BOUNDS_MARGIN;
+	}
+
+	for (int i = 1; i < (int)m_sortedBodies.size(); i++)
+	{
+		int body = m_sortedBodies[i];
+		int j = i - 1;
+
+		while ((j >= 0) && (m_boundsMin[m_sortedBodies[j]].x > m_boundsMin[body].x))
+		{
+			m_sortedBodies[j + 1] = m_sortedBodies[j];
+			j--;
+		}
+		m_sortedBodies[j + 1] = body;
+	}
+
+	m_pairs.clear();
+	for (int i = 0; i < (int)m_sortedBodies.size(); i++)
+	{
+		int bodyA = m_sortedBodies[i];
+		bool bActiveA = (m_inverseMass[bodyA] > 0.0f) && (m_sleeping[bodyA] == 0);
+
+		for (int j = i + 1; j < (int)m_sortedBodies.size(); j++)
+		{
+			int bodyB = m_sortedBodies[j];
+
+			if (m_boundsMin[bodyB].x > m_boundsMax[bodyA].x)
+			{
+				break;
+			}
+
+			bool bActiveB = (m_inverseMass[bodyB] > 0.0f) && (m_sleeping[bodyB] == 0);
+			if ((bActiveA == false) && (bActiveB == false))
+			{
+				continue;
+			}
+			if ((m_boundsMin[bodyA].y > m_boundsMax[bodyB].y) || (m_boundsMin[bodyB].y > m_boundsMax[bodyA].y) ||
+				(m_boundsMin[bodyA].z > m_boundsMax[bodyB].z) || (m_boundsMin[bodyB].z > m_boundsMax[bodyA].z))
+			{
+				continue;
+			}
+
+			// a sphere or capsule always comes before a box
+			if ((m_shapes[bodyA] == BODY_BOX) && (m_shapes[bodyB] != BODY_BOX))
+			{
+				m_pairs.push_back(std::make_pair(bodyB, bodyA));
+			}
+			else
+			{
+				m_pairs.push_back(std::make_pair(bodyA, bodyB));
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  CollidePair()
+ *
+ *  This method is used for building the contacts of a pair
+ *  into its own slots, so pairs can be handled on any thread.
+ ***********************************************************/
+void PhysicsWorld::CollidePair(int pair)
+{
+	int bodyA = m_pairs[pair].first;
+	int bodyB = m_pairs[pair].second;
+
+	if (m_shapes[bodyA] == BODY_BOX)
+	{
+		CollideBoxes(pair, bodyA, bodyB);
+	}
+	else if (m_shapes[bodyB] == BODY_BOX)
+	{
+		CollideSegmentBox(pair, bodyA, bodyB);
+	}
+	else
+	{
+		CollideSegments(pair, bodyA, bodyB);
+	}
+}
+
+/***********************************************************
+ *  AddContact()
+ *
+ *  This method is used for adding a contact to the slots of
+ *  a pair.  Contacts past the last slot are dropped.
+ ***********************************************************/
+void PhysicsWorld::AddContact(int pair, const glm::vec3& point, const glm::vec3& normal, float depth)
+{
+	int count = m_pairContactCounts[pair];
+
+	if (count >= MAX_CONTACTS_PER_PAIR)
+	{
+		return;
+	}
+
+	CONTACT& contact = m_pairContacts[pair * MAX_CONTACTS_PER_PAIR + count];
+	contact.bodyA = m_pairs[pair].first;
+	contact.bodyB = m_pairs[pair].second;
+	contact.point = point;
+	contact.normal = normal;
+	contact.depth = depth;
+	m_pairContactCounts[pair] = count + 1;
+}
+
+/***********************************************************
+ *  CollideSegments()
+ *
+ *  This method is used for the contact of two spheres or
+ *  capsules, found from the closest points of their center
+ *  lines.
+ ***********************************************************/
+void PhysicsWorld::CollideSegments(int pair, int bodyA, int bodyB)
+{
+	glm::vec3 startA, endA, startB, endB;
+	glm::vec3 closestA, closestB;
+	float radius = m_extentX[bodyA] + m_extentX[bodyB];
+
+	GetSegment(bodyA, startA, endA);
+	GetSegment(bodyB, startB, endB);
+	ClosestPointsOnSegments(startA, endA, startB, endB, closestA, closestB);
+
+	glm::vec3 between = closestA - closestB;
+	float distance = glm::length(between);
+	if (distance >= radius)
+	{
+		return;
+	}
+
+	glm::vec3 normal = (distance > 1.0e-6f) ? between / distance : glm::vec3(0.0f, 1.0f, 0.0f);
+	glm::vec3 point = ((closestA - normal * m_extentX[bodyA]) + (closestB + normal * m_extentX[bodyB])) * 0.5f;
+	AddContact(pair, point, normal, radius - distance);
+}
+
+/***********************************************************
+ *  CollideSegmentBox()
+ *
+ *  This method is used for the contacts of a sphere or
+ *  capsule against a box.  Points along the center line -
+ *  the ends, and for a capsule the point nearest the box
+ *  center - are each tested as a sphere against the box, so
+ *  a capsule lying on a box rests on both ends.
+ ***********************************************************/
+void PhysicsWorld::CollideSegmentBox(int pair, int bodyA, int bodyB)
+{
+	glm::vec3 start, end;
+	glm::vec3 samples[3];
+	int sampleCount = 1;
+	float radius = m_extentX[bodyA];
+	glm::vec3 center = GetPosition(bodyB);
+	glm::mat3 rotation = GetRotation(bodyB);
+	glm::vec3 halfExtents = GetExtents(bodyB);
+
+	GetSegment(bodyA, start, end);
+	samples[0] = start;
+	if (m_shapes[bodyA] == BODY_CAPSULE)
+	{
+		samples[1] = end;
+		samples[2] = ClosestPointOnSegment(center, start, end);
+		sampleCount = 3;
+	}
+
+	for (int i = 0; i < sampleCount; i++)
+	{
+		glm::vec3 local = glm::transpose(rotation) * (samples[i] - center);
+		glm::vec3 clamped = glm::clamp(local, -halfExtents, halfExtents);
+		glm::vec3 outside = local - clamped;
+		float distance = glm::length(outside);
+
+		if (distance > 1.0e-6f)
+		{
+			// center outside the box, pushed from the nearest point
+			if (distance < radius)
+			{
+				AddContact(pair, center + rotation * clamped, rotation * (outside / distance), radius - distance);
+			}
+		}
+		else
+		{
+			// center inside the box, pushed out the nearest face
+			glm::vec3 inside = halfExtents - glm::abs(local);
+			int axis = 0;
+
+			if (inside.y < inside[axis])
+			{
+				axis = 1;
+			}
+			if (inside.z < inside[axis])
+			{
+				axis = 2;
+			}
+
+			glm::vec3 normal = rotation[axis] * ((local[axis] < 0.0f) ? -1.0f : 1.0f);
+			AddContact(pair, samples[i], normal, inside[axis] + radius);
+		}
+	}
+}
+
+/***********************************************************
+ *  CollideBoxes()
+ *
+ *  This method is used for the contacts of two boxes, made
+ *  from the corners of each box that are inside the other.
+ *  Boxes crossing only edge to edge are missed until a
+ *  corner gets inside, which is enough for boxes landing on
+ *  and stacking on each other.
+ ***********************************************************/
+void PhysicsWorld::CollideBoxes(int pair, int bodyA, int bodyB)
+{
+	CollideCorners(pair, bodyA, bodyB, false);
+	CollideCorners(pair, bodyB, bodyA, true);
+}
+
+/***********************************************************
+ *  CollideCorners()
+ *
+ *  This method is used for adding a contact for every corner
+ *  of one box inside another, pushed out the nearest face.
+ *  The normal is flipped when the corners belong to the
+ *  second body of the pair.
+ ***********************************************************/
+void PhysicsWorld::CollideCorners(int pair, int cornerBody, int boxBody, bool bFlip)
+{
+	glm::vec3 cornerCenter = GetPosition(cornerBody);
+	glm::mat3 cornerRotation = GetRotation(cornerBody);
+	glm::vec3 cornerExtents = GetExtents(cornerBody);
+	glm::vec3 center = GetPosition(boxBody);
+	glm::mat3 rotation = GetRotation(boxBody);
+	glm::mat3 toLocal = glm::transpose(rotation);
+	glm::vec3 halfExtents = GetExtents(boxBody);
+
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 offset = glm::vec3(
+			(corner & 1) ? cornerExtents.x : -cornerExtents.x,
+			(corner & 2) ? cornerExtents.y : -cornerExtents.y,
+			(corner & 4) ? cornerExtents.z : -cornerExtents.z);
+		glm::vec3 point = cornerCenter + cornerRotation * offset;
+		glm::vec3 local = toLocal * (point - center);
+		glm::vec3 inside = halfExtents - glm::abs(local);
+
+		if ((inside.x <= 0.0f) || (inside.y <= 0.0f) || (inside.z <= 0.0f))
+		{
+			continue;
+		}
+
+		int axis = 0;
+		if (inside.y < inside[axis])
+		{
+			axis = 1;
+		}
+		if (inside.z < inside[axis])
+		{
+			axis = 2;
+		}
+
+		glm::vec3 normal = rotation[axis] * ((local[axis] < 0.0f) ? -1.0f : 1.0f);
+		if (bFlip == true)
+		{
+			normal = -normal;
+		}
+		AddContact(pair, point, normal, inside[axis]);
+	}
+}
+
+/***********************************************************
+ *  FindIslandRoot()
+ *
+ *  This method is used for finding the body at the root of
+ *  the island a body belongs to, halving the path on the way.
+ ***********************************************************/
+int PhysicsWorld::FindIslandRoot(int body)
+{
+	while (m_islandParents[body] != body)
+	{
+		m_islandParents[body] = m_islandParents[m_islandParents[body]];
+		body = m_islandParents[body];
+	}
+
+	return(body);
+}
+
+/***********************************************************
+ *  BuildIslands()
+ *
+ *  This method is used for joining the moving bodies that
+ *  touch into islands.  Bodies that do not move never join
+ *  islands, so a pile on the ground does not join with a
+ *  pile on the gift box.  A sleeping body touched by an
+ *  awake one wakes with the rest of its island.  The bodies
+ *  and contacts are then gathered island by island.
+ ***********************************************************/
+void PhysicsWorld::BuildIslands()
+{
+	int bodyCount = GetBodyCount();
+	std::vector<int> rootIslands(bodyCount, -1);
+	std::vector<uint8_t> awakeRoots(bodyCount, 0);
+
+	m_islandParents.resize(bodyCount);
+	for (int body = 0; body < bodyCount; body++)
+	{
+		m_islandParents[body] = body;
+	}
+	for (int i = 0; i < (int)m_contacts.size(); i++)
+	{
+		int bodyA = m_contacts[i].bodyA;
+		int bodyB = m_contacts[i].bodyB;
+
+		if ((m_inverseMass[bodyA] > 0.0f) && (m_inverseMass[bodyB] > 0.0f))
+		{
+			m_islandParents[FindIslandRoot(bodyA)] = FindIslandRoot(bodyB);
+		}
+	}
+
+	// islands with any awake body are simulated, and wake
+	for (int body = 0; body < bodyCount; body++)
+	{
+		if ((m_inverseMass[body] > 0.0f) && (m_sleeping[body] == 0))
+		{
+			awakeRoots[FindIslandRoot(body)] = 1;
+		}
+	}
+
+	m_islandCount = 0;
+	m_islandBodyStarts.assign(1, 0);
+	m_bodyIslands.assign(bodyCount, -1);
+	for (int body = 0; body < bodyCount; body++)
+	{
+		int root = FindIslandRoot(body);
+
+		if ((m_inverseMass[body] <= 0.0f) || (awakeRoots[root] == 0))
+		{
+			continue;
+		}
+		if (rootIslands[root] < 0)
+		{
+			rootIslands[root] = m_islandCount++;
+			m_islandBodyStarts.push_back(0);
+		}
+		m_bodyIslands[body] = rootIslands[root];
+		m_islandBodyStarts[rootIslands[root] + 1]++;
+		m_sleeping[body] = 0;
+	}
+
+	// gather the bodies and contacts island by island
+	m_islandContactStarts.assign(m_islandCount + 1, 0);
+	for (int i = 0; i < (int)m_contacts.size(); i++)
+	{
+		int island = m_bodyIslands[m_contacts[i].bodyA];
+		if (island < 0)
+		{
+			island = m_bodyIslands[m_contacts[i].bodyB];
+		}
+		if (island >= 0)
+		{
+			m_islandContactStarts[island + 1]++;
+		}
+	}
+	for (int island = 0; island < m_islandCount; island++)
+	{
+		m_islandBodyStarts[island + 1] += m_islandBodyStarts[island];
+		m_islandContactStarts[island + 1] += m_islandContactStarts[island];
+	}
+
+	std::vector<int> bodyCursors(m_islandBodyStarts.begin(), m_islandBodyStarts.end() - 1);
+	std::vector<int> contactCursors(m_islandContactStarts.begin(), m_islandContactStarts.end() - 1);
+	m_islandBodies.resize(m_islandBodyStarts[m_islandCount]);
+	m_islandContacts.resize(m_islandContactStarts[m_islandCount]);
+	for (int body = 0; body < bodyCount; body++)
+	{
+		if (m_bodyIslands[body] >= 0)
+		{
+			m_islandBodies[bodyCursors[m_bodyIslands[body]]++] = body;
+		}
+	}
+	for (int i = 0; i < (int)m_contacts.size(); i++)
+	{
+		int island = m_bodyIslands[m_contacts[i].bodyA];
+		if (island < 0)
+		{
+			island = m_bodyIslands[m_contacts[i].bodyB];
+		}
+		if (island >= 0)
+		{
+			m_islandContacts[contactCursors[island]++] = i;
+		}
+	}
+}
+
+/***********************************************************
+ *  SolveIsland()
+ *
+ *  This method is used for solving the contacts of an island
+ *  with sequential impulses and then moving its bodies.  Each
+ *  contact keeps the total impulse it has applied, clamped so
+ *  contacts only push and friction stays inside its cone.
+ *  Overlap is pushed apart a little each step, and contacts
+ *  closing fast enough bounce.  When every body of the island
+ *  has been still for a while the island goes to sleep.
+ ***********************************************************/
+void PhysicsWorld::SolveIsland(int island, float deltaTime)
+{
+	int contactStart = m_islandContactStarts[island];
+	int contactEnd = m_islandContactStarts[island + 1];
+
+	// set up the contacts from the velocities before solving
+	for (int i = contactStart; i < contactEnd; i++)
+	{
+		CONTACT& contact = m_contacts[m_islandContacts[i]];
+		int bodyA = contact.bodyA;
+		int bodyB = contact.bodyB;
+
+		contact.offsetA = contact.point - GetPosition(bodyA);
+		contact.offsetB = contact.point - GetPosition(bodyB);
+
+		// two directions across the normal for friction
+		glm::vec3 helper = (std::fabs(contact.normal.x) > 0.57f) ?
+			glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+		contact.tangent[0] = glm::normalize(glm::cross(contact.normal, helper));
+		contact.tangent[1] = glm::cross(contact.normal, contact.tangent[0]);
+
+		for (int direction = 0; direction < 3; direction++)
+		{
+			glm::vec3 axis = (direction == 0) ? contact.normal : contact.tangent[direction - 1];
+			glm::vec3 turnA = glm::cross(m_worldInverseInertia[bodyA] * glm::cross(contact.offsetA, axis), contact.offsetA);
+			glm::vec3 turnB = glm::cross(m_worldInverseInertia[bodyB] * glm::cross(contact.offsetB, axis), contact.offsetB);
+			float mass = m_inverseMass[bodyA] + m_inverseMass[bodyB] + glm::dot(turnA + turnB, axis);
+			mass = (mass > 0.0f) ? 1.0f / mass : 0.0f;
+
+			if (direction == 0)
+			{
+				contact.normalMass = mass;
+			}
+			else
+			{
+				contact.tangentMass[direction - 1] = mass;
+			}
+		}
+
+		float closingSpeed = glm::dot(
+			GetPointVelocity(bodyA, contact.offsetA) - GetPointVelocity(bodyB, contact.offsetB),
+			contact.normal);
+
+		contact.bias = (BAUMGARTE_FACTOR / deltaTime) * std::max(contact.depth - PENETRATION_SLOP, 0.0f);
+		if (closingSpeed < -RESTITUTION_THRESHOLD)
+		{
+			float restitution = std::max(m_restitution[bodyA], m_restitution[bodyB]);
+			contact.bias = std::max(contact.bias, -restitution * closingSpeed);
+		}
+		contact.friction = std::sqrt(m_friction[bodyA] * m_friction[bodyB]);
+		contact.normalImpulse = 0.0f;
+		contact.tangentImpulse[0] = 0.0f;
+		contact.tangentImpulse[1] = 0.0f;
+	}
+
+	for (int iteration = 0; iteration < SOLVER_ITERATIONS; iteration++)
+	{
+		for (int i = contactStart; i < contactEnd; i++)
+		{
+			CONTACT& contact = m_contacts[m_islandContacts[i]];
+			glm::vec3 relative = GetPointVelocity(contact.bodyA, contact.offsetA) -
+				GetPointVelocity(contact.bodyB, contact.offsetB);
+
+			// push apart, never pull together
+			float impulse = contact.normalMass * (contact.bias - glm::dot(relative, contact.normal));
+			float total = std::max(contact.normalImpulse + impulse, 0.0f);
+			impulse = total - contact.normalImpulse;
+			contact.normalImpulse = total;
+			ApplyImpulse(contact.bodyA, contact.offsetA, contact.normal * impulse);
+			ApplyImpulse(contact.bodyB, contact.offsetB, contact.normal * -impulse);
+
+			// friction, limited by how hard the contact pushes
+			float limit = contact.friction * contact.normalImpulse;
+			for (int direction = 0; direction < 2; direction++)
+			{
+				relative = GetPointVelocity(contact.bodyA, contact.offsetA) -
+					GetPointVelocity(contact.bodyB, contact.offsetB);
+				impulse = -contact.tangentMass[direction] * glm::dot(relative, contact.tangent[direction]);
+				total = glm::clamp(contact.tangentImpulse[direction] + impulse, -limit, limit);
+				impulse = total - contact.tangentImpulse[direction];
+				contact.tangentImpulse[direction] = total;
+				ApplyImpulse(contact.bodyA, contact.offsetA, contact.tangent[direction] * impulse);
+				ApplyImpulse(contact.bodyB, contact.offsetB, contact.tangent[direction] * -impulse);
+			}
+		}
+	}
+
+	// move the bodies and check whether the island is still
+	float islandStillTime = SLEEP_DELAY;
+	for (int i = m_islandBodyStarts[island]; i < m_islandBodyStarts[island + 1]; i++)
+	{
+		int body = m_islandBodies[i];
+		float wx = m_angularX[body];
+		float wy = m_angularY[body];
+		float wz = m_angularZ[body];
+		float qx = m_rotationX[body];
+		float qy = m_rotationY[body];
+		float qz = m_rotationZ[body];
+		float qw = m_rotationW[body];
+		float halfStep = 0.5f * deltaTime;
+
+		m_positionX[body] += m_velocityX[body] * deltaTime;
+		m_positionY[body] += m_velocityY[body] * deltaTime;
+		m_positionZ[body] += m_velocityZ[body] * deltaTime;
+
+		// turn by the angular velocity, then renormalize
+		float nx = qx + halfStep * (wx * qw + wy * qz - wz * qy);
+		float ny = qy + halfStep * (wy * qw + wz * qx - wx * qz);
+		float nz = qz + halfStep * (wz * qw + wx * qy - wy * qx);
+		float nw = qw - halfStep * (wx * qx + wy * qy + wz * qz);
+		float length = std::sqrt(nx * nx + ny * ny + nz * nz + nw * nw);
+		m_rotationX[body] = nx / length;
+		m_rotationY[body] = ny / length;
+		m_rotationZ[body] = nz / length;
+		m_rotationW[body] = nw / length;
+
+		float linearSpeed = m_velocityX[body] * m_velocityX[body] +
+			m_velocityY[body] * m_velocityY[body] + m_velocityZ[body] * m_velocityZ[body];
+		float angularSpeed = wx * wx + wy * wy + wz * wz;
+		if ((linearSpeed < SLEEP_LINEAR_SPEED * SLEEP_LINEAR_SPEED) &&
+			(angularSpeed < SLEEP_ANGULAR_SPEED * SLEEP_ANGULAR_SPEED))
+		{
+			m_stillTime[body] += deltaTime;
+		}
+		else
+		{
+			m_stillTime[body] = 0.0f;
+		}
+		islandStillTime = std::min(islandStillTime, m_stillTime[body]);
+	}
+
+	if (islandStillTime >= SLEEP_DELAY)
+	{
+		for (int i = m_islandBodyStarts[island]; i < m_islandBodyStarts[island + 1]; i++)
+		{
+			int body = m_islandBodies[i];
+
+			m_sleeping[body] = 1;
+			m_velocityX[body] = 0.0f;
+			m_velocityY[body] = 0.0f;
+			m_velocityZ[body] = 0.0f;
+			m_angularX[body] = 0.0f;
+			m_angularY[body] = 0.0f;
+			m_angularZ[body] = 0.0f;
+		}
+	}
+}
+
+/***********************************************************
+ *  WriteTransforms()
+ *
+ *  This method is used for writing the position and rotation
+ *  of the bodies moved this step into their nodes.
+ ***********************************************************/
+void PhysicsWorld::WriteTransforms()
+{
+	if (NULL == m_pTransforms)
+	{
+		return;
+	}
+
+	for (int i = 0; i < (int)m_islandBodies.size(); i++)
+	{
+		int body = m_islandBodies[i];
+
+		if (m_nodes[body] >= 0)
+		{
+			m_pTransforms->SetTranslation(m_nodes[body], GetPosition(body));
+			m_pTransforms->SetRotation(m_nodes[body], glm::vec4(
+				m_rotationX[body], m_rotationY[body], m_rotationZ[body], m_rotationW[body]));
+		}
+	}
+}
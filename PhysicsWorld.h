@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////////////////
+// physicsworld.h
+// ============
+// rigid body simulation of spheres, boxes and capsules on worker threads
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TransformStore.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  PhysicsWorld
+ *
+ *  This class contains the code for simulating rigid bodies.
+ *  The state of every body is kept as a structure of arrays.
+ *  Each fixed step finds the overlapping bounds by sweep and
+ *  prune along x, builds the contacts of the overlapping
+ *  pairs on the worker threads, splits the touching bodies
+ *  into islands, and solves the islands on the worker
+ *  threads with sequential impulses.  Islands that come to
+ *  rest are put to sleep until something touches them.  The
+ *  position and rotation of every moving body is written
+ *  into its node of the transform store.
+ ***********************************************************/
+class PhysicsWorld
+{
+public:
+	// constructor
+	PhysicsWorld(TransformStore* pTransforms);
+	// destructor
+	~PhysicsWorld();
+
+	// collision shape of a body
+	enum BODY_SHAPE
+	{
+		BODY_SPHERE,
+		BODY_BOX,
+		BODY_CAPSULE
+	};
+
+	// add a body, returning its index - bodies with no mass
+	// never move, and node is the transform store node the
+	// body is written into, -1 for none.  Rotations are
+	// quaternions stored as x, y, z, w
+	int AddSphere(const glm::vec3& position, float radius, float mass, int node);
+	int AddBox(const glm::vec3& position, const glm::vec3& halfExtents, const glm::vec4& rotation, float mass, int node);
+	// capsules run along their local y axis
+	int AddCapsule(const glm::vec3& position, float radius, float halfHeight, const glm::vec4& rotation, float mass, int node);
+
+	// set the surface of a body
+	void SetMaterial(int body, float friction, float restitution);
+	// set the velocity of a body and wake it
+	void SetVelocity(int body, const glm::vec3& linear, const glm::vec3& angular);
+	// set the acceleration of every moving body
+	void SetGravity(const glm::vec3& gravity) { m_gravity = gravity; }
+	// set the number of threads used for the contacts and islands
+	void SetThreadCount(int threadCount);
+
+	// advance the bodies by the elapsed time in fixed steps
+	void Update(float elapsedTime);
+	// advance the bodies by one step
+	void Step(float deltaTime);
+
+	// get the bodies
+	int GetBodyCount() const { return((int)m_shapes.size()); }
+	BODY_SHAPE GetShape(int body) const { return((BODY_SHAPE)m_shapes[body]); }
+	glm::vec3 GetExtents(int body) const { return(glm::vec3(m_extentX[body], m_extentY[body], m_extentZ[body])); }
+	int GetNode(int body) const { return(m_nodes[body]); }
+	bool IsSleeping(int body) const { return(m_sleeping[body] != 0); }
+	// get the counts of the last step
+	int GetContactCount() const { return((int)m_contacts.size()); }
+	int GetIslandCount() const { return(m_islandCount); }
+	// get the time taken by the last step in milliseconds
+	double GetStepTime() const { return(m_stepTime); }
+
+private:
+	// point where two bodies touch, the normal pointing from
+	// the second body to the first
+	struct CONTACT
+	{
+		int bodyA;
+		int bodyB;
+		glm::vec3 point;
+		glm::vec3 normal;
+		float depth;
+		// solver values, set up each step
+		glm::vec3 offsetA;
+		glm::vec3 offsetB;
+		glm::vec3 tangent[2];
+		float normalMass;
+		float tangentMass[2];
+		float bias;
+		float friction;
+		float normalImpulse;
+		float tangentImpulse[2];
+	};
+
+	// pointer to the transforms written by the bodies
+	TransformStore* m_pTransforms;
+
+	// body store - one array per component
+	std::vector<uint8_t> m_shapes;
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_positionZ;
+	std::vector<float> m_rotationX;
+	std::vector<float> m_rotationY;
+	std::vector<float> m_rotationZ;
+	std::vector<float> m_rotationW;
+	std::vector<float> m_velocityX;
+	std::vector<float> m_velocityY;
+	std::vector<float> m_velocityZ;
+	std::vector<float> m_angularX;
+	std::vector<float> m_angularY;
+	std::vector<float> m_angularZ;
+	std::vector<float> m_inverseMass;
+	// inverse inertia around the local axes
+	std::vector<float> m_inverseInertiaX;
+	std::vector<float> m_inverseInertiaY;
+	std::vector<float> m_inverseInertiaZ;
+	// box half extents, sphere and capsule radius in x and
+	// capsule half height in y
+	std::vector<float> m_extentX;
+	std::vector<float> m_extentY;
+	std::vector<float> m_extentZ;
+	std::vector<float> m_friction;
+	std::vector<float> m_restitution;
+	std::vector<int> m_nodes;
+	std::vector<uint8_t> m_sleeping;
+	// time each body has been nearly still
+	std::vector<float> m_stillTime;
+
+	// world bounds of every body, and the bodies ordered by
+	// the low x bound, kept from step to step
+	std::vector<glm::vec3> m_boundsMin;
+	std::vector<glm::vec3> m_boundsMax;
+	std::vector<int> m_sortedBodies;
+	// world inverse inertia of every body for this step
+	std::vector<glm::mat3> m_worldInverseInertia;
+
+	// pairs with overlapping bounds, the contacts found for
+	// each pair in fixed slots, then all of the contacts
+	std::vector<std::pair<int, int>> m_pairs;
+	std::vector<CONTACT> m_pairContacts;
+	std::vector<int> m_pairContactCounts;
+	std::vector<CONTACT> m_contacts;
+
+	// island of every body, -1 when it is not simulated, then
+	// the bodies and contacts of each island back to back
+	std::vector<int> m_islandParents;
+	std::vector<int> m_bodyIslands;
+	std::vector<int> m_islandBodyStarts;
+	std::vector<int> m_islandBodies;
+	std::vector<int> m_islandContactStarts;
+	std::vector<int> m_islandContacts;
+	int m_islandCount;
+
+	glm::vec3 m_gravity;
+	int m_threadCount;
+	// time not yet simulated by a whole step
+	float m_accumulator;
+	double m_stepTime;
+
+	// add a body with the passed in shape and mass
+	int AddBody(BODY_SHAPE shape, const glm::vec3& position, const glm::vec4& rotation,
+		const glm::vec3& extents, float mass, int node);
+	// get the position and rotation of a body
+	glm::vec3 GetPosition(int body) const;
+	glm::mat3 GetRotation(int body) const;
+	// get the velocity of a point offset from the center of a body
+	glm::vec3 GetPointVelocity(int body, const glm::vec3& offset) const;
+	// push a body at a point offset from its center
+	void ApplyImpulse(int body, const glm::vec3& offset, const glm::vec3& impulse);
+	// get the ends of the center line of a sphere or capsule
+	void GetSegment(int body, glm::vec3& start, glm::vec3& end) const;
+	// find the root of the island a body is joined to
+	int FindIslandRoot(int body);
+
+	// run a job over a range of items on the worker threads
+	template <typename JOB> void RunParallel(int itemCount, int minItemsPerThread, JOB job);
+
+	// find the pairs of bodies with overlapping bounds
+	void FindPairs();
+	// build the contacts of one pair
+	void CollidePair(int pair);
+	// group the touching bodies and their contacts into islands
+	void BuildIslands();
+	// solve the contacts of one island and move its bodies
+	void SolveIsland(int island, float deltaTime);
+	// write the moving bodies into the transform store
+	void WriteTransforms();
+
+	// add a contact to the slots of a pair
+	void AddContact(int pair, const glm::vec3& point, const glm::vec3& normal, float depth);
+	// contacts of a sphere or capsule against another one
+	void CollideSegments(int pair, int bodyA, int bodyB);
+	// contacts of a sphere or capsule against a box
+	void CollideSegmentBox(int pair, int bodyA, int bodyB);
+	// contacts of a box against another box
+	void CollideBoxes(int pair, int bodyA, int bodyB);
+	// contacts of the corners of one box inside another
+	void CollideCorners(int pair, int cornerBody, int boxBody, bool bFlip);
+};
@@ -0,0 +1,322 @@
+///////////////////////////////////////////////////////////////////////////////
+// reflectionprobes.cpp
+// ============
+// manage the environment cube maps sampled by the reflective materials
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ReflectionProbes.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <iostream>
+
+// declaration of the global variables and defines
+namespace
+{
+	// direction and up vector of each face, in the order of the
+	// cube map targets
+	const glm::vec3 FACE_DIRECTIONS[] =
+	{
+		glm::vec3(1.0f, 0.0f, 0.0f),
+		glm::vec3(-1.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 1.0f),
+		glm::vec3(0.0f, 0.0f, -1.0f)
+	};
+	const glm::vec3 FACE_UPS[] =
+	{
+		glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 1.0f),
+		glm::vec3(0.0f, 0.0f, -1.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f)
+	};
+
+	// distance covered by every face
+	const float PROBE_NEAR_PLANE = 0.1f;
+	const float PROBE_FAR_PLANE = 100.0f;
+}
+
+/***********************************************************
+ *  ReflectionProbes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ReflectionProbes::ReflectionProbes(GLStateCache* pStateCache)
+{
+	m_pStateCache = pStateCache;
+	m_resolution = 0;
+	m_faceProjection = glm::mat4(1.0f);
+	m_drawFramebufferID = 0;
+	m_readFramebufferID = 0;
+	m_sceneFramebufferID = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		m_sceneViewport[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~ReflectionProbes()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ReflectionProbes::~ReflectionProbes()
+{
+	GLuint framebuffers[] = { m_drawFramebufferID, m_readFramebufferID };
+
+	for (int i = 0; i < (int)m_probes.size(); i++)
+	{
+		GLuint textures[] = {
+			m_probes[i].staticColorID, m_probes[i].staticDepthID,
+			m_probes[i].environmentColorID, m_probes[i].environmentDepthID };
+
+		glDeleteTextures(4, textures);
+	}
+	m_probes.clear();
+	glDeleteFramebuffers(2, framebuffers);
+	m_pStateCache->InvalidateTextures();
+	m_pStateCache = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the frame buffers that
+ *  the faces are attached to.
+ ***********************************************************/
+bool ReflectionProbes::Initialize(int resolution)
+{
+	m_resolution = resolution;
+	m_faceProjection = glm::perspective(glm::radians(90.0f), 1.0f, PROBE_NEAR_PLANE, PROBE_FAR_PLANE);
+
+	glGenFramebuffers(1, &m_drawFramebufferID);
+	glGenFramebuffers(1, &m_readFramebufferID);
+
+	return((0 != m_drawFramebufferID) && (0 != m_readFramebufferID));
+}
+
+/***********************************************************
+ *  AddProbe()
+ *
+ *  This method is used for adding a probe at a position and
+ *  creating its cached and sampled cube maps.
+ ***********************************************************/
+int ReflectionProbes::AddProbe(const glm::vec3& position)
+{
+	PROBE probe;
+
+	probe.position = position;
+	CreateCubeMap(probe.staticColorID, probe.staticDepthID);
+	CreateCubeMap(probe.environmentColorID, probe.environmentDepthID);
+	m_probes.push_back(probe);
+
+	return((int)m_probes.size() - 1);
+}
+
+/***********************************************************
+ *  FindNearestProbe()
+ *
+ *  This method is used for finding the probe closest to a
+ *  position.
+ ***********************************************************/
+int ReflectionProbes::FindNearestProbe(const glm::vec3& position) const
+{
+	int nearest = -1;
+	float nearestDistance = 1.0e30f;
+
+	for (int i = 0; i < (int)m_probes.size(); i++)
+	{
+		glm::vec3 offset = m_probes[i].position - position;
+		float distance = glm::dot(offset, offset);
+		if (distance < nearestDistance)
+		{
+			nearest = i;
+			nearestDistance = distance;
+		}
+	}
+
+	return(nearest);
+}
+
+/***********************************************************
+ *  GetFaceView()
+ *
+ *  This method is used for getting the view matrix looking
+ *  out of one face of a probe.
+ ***********************************************************/
+glm::mat4 ReflectionProbes::GetFaceView(int probe, int face) const
+{
+	const glm::vec3& position = m_probes[probe].position;
+
+	return(glm::lookAt(position, position + FACE_DIRECTIONS[face], FACE_UPS[face]));
+}
+
+/***********************************************************
+ *  BeginStaticPass()
+ *
+ *  This method is used for starting to render the static
+ *  shapes into the cached map of a probe.  With a face of -1
+ *  the whole cube is attached, for shaders that pick the
+ *  face of each shape as its layer.
+ ***********************************************************/
+void ReflectionProbes::BeginStaticPass(int probe, int face)
+{
+	BeginPass();
+	AttachFace(GL_DRAW_FRAMEBUFFER, m_probes[probe].staticColorID, m_probes[probe].staticDepthID, face);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+/***********************************************************
+ *  CopyStaticFaces()
+ *
+ *  This method is used for copying every face of the cached
+ *  map into the sampled map, after the cached map has been
+ *  rendered again.
+ ***********************************************************/
+void ReflectionProbes::CopyStaticFaces(int probe)
+{
+	GLint sceneFramebufferID = 0;
+
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &sceneFramebufferID);
+	for (int face = 0; face < FACE_COUNT; face++)
+	{
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_readFramebufferID);
+		AttachFace(GL_READ_FRAMEBUFFER, m_probes[probe].staticColorID, m_probes[probe].staticDepthID, face);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_drawFramebufferID);
+		AttachFace(GL_DRAW_FRAMEBUFFER, m_probes[probe].environmentColorID, m_probes[probe].environmentDepthID, face);
+		glBlitFramebuffer(
+			0, 0, m_resolution, m_resolution,
+			0, 0, m_resolution, m_resolution,
+			GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebufferID);
+}
+
+/***********************************************************
+ *  BeginDynamicPass()
+ *
+ *  This method is used for starting to render the moving
+ *  shapes into one face of the sampled map.  The cached face
+ *  is copied in first, depth included, so only the moving
+ *  shapes need to be drawn.
+ ***********************************************************/
+void ReflectionProbes::BeginDynamicPass(int probe, int face)
+{
+	BeginPass();
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_readFramebufferID);
+	AttachFace(GL_READ_FRAMEBUFFER, m_probes[probe].staticColorID, m_probes[probe].staticDepthID, face);
+	AttachFace(GL_DRAW_FRAMEBUFFER, m_probes[probe].environmentColorID, m_probes[probe].environmentDepthID, face);
+	glBlitFramebuffer(
+		0, 0, m_resolution, m_resolution,
+		0, 0, m_resolution, m_resolution,
+		GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+}
+
+/***********************************************************
+ *  EndPass()
+ *
+ *  This method is used for returning to the frame buffer and
+ *  viewport of the scene.
+ ***********************************************************/
+void ReflectionProbes::EndPass()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebufferID);
+	glViewport(m_sceneViewport[0], m_sceneViewport[1], m_sceneViewport[2], m_sceneViewport[3]);
+}
+
+/***********************************************************
+ *  BindEnvironmentMap()
+ *
+ *  This method is used for binding the sampled map of a
+ *  probe for the scene shader.
+ ***********************************************************/
+void ReflectionProbes::BindEnvironmentMap(int probe)
+{
+	m_pStateCache->BindTexture(ENVIRONMENT_TEXTURE_UNIT, GL_TEXTURE_CUBE_MAP, m_probes[probe].environmentColorID);
+}
+
+/***********************************************************
+ *  CreateCubeMap()
+ *
+ *  This method is used for creating a color cube map and the
+ *  depth cube map drawn with it.
+ ***********************************************************/
+void ReflectionProbes::CreateCubeMap(GLuint& colorID, GLuint& depthID)
+{
+	glGenTextures(1, &colorID);
+	m_pStateCache->BindTexture(ENVIRONMENT_TEXTURE_UNIT, GL_TEXTURE_CUBE_MAP, colorID);
+	for (int face = 0; face < FACE_COUNT; face++)
+	{
+		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGBA8,
+			m_resolution, m_resolution, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	}
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+	glGenTextures(1, &depthID);
+	m_pStateCache->BindTexture(ENVIRONMENT_TEXTURE_UNIT, GL_TEXTURE_CUBE_MAP, depthID);
+	for (int face = 0; face < FACE_COUNT; face++)
+	{
+		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_DEPTH_COMPONENT24,
+			m_resolution, m_resolution, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+	}
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	m_pStateCache->BindTexture(ENVIRONMENT_TEXTURE_UNIT, GL_TEXTURE_CUBE_MAP, 0);
+}
+
+/***********************************************************
+ *  AttachFace()
+ *
+ *  This method is used for attaching one face of a color and
+ *  depth cube map pair to the bound frame buffer, or every
+ *  face as a layer when face is -1.
+ ***********************************************************/
+void ReflectionProbes::AttachFace(GLenum target, GLuint colorID, GLuint depthID, int face)
+{
+	if (face < 0)
+	{
+		glFramebufferTexture(target, GL_COLOR_ATTACHMENT0, colorID, 0);
+		glFramebufferTexture(target, GL_DEPTH_ATTACHMENT, depthID, 0);
+	}
+	else
+	{
+		glFramebufferTexture2D(target, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, colorID, 0);
+		glFramebufferTexture2D(target, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, depthID, 0);
+	}
+
+	if (glCheckFramebufferStatus(target) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Reflection probe frame buffer is incomplete" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  BeginPass()
+ *
+ *  This method is used for binding the draw frame buffer and
+ *  a face sized viewport, remembering those of the scene.
+ *  The sampled map is unbound so it is never read while it
+ *  is drawn into.
+ ***********************************************************/
+void ReflectionProbes::BeginPass()
+{
+	glGetIntegerv(GL_VIEWPORT, m_sceneViewport);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_sceneFramebufferID);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_drawFramebufferID);
+	glViewport(0, 0, m_resolution, m_resolution);
+
+	m_pStateCache->BindTexture(ENVIRONMENT_TEXTURE_UNIT, GL_TEXTURE_CUBE_MAP, 0);
+	m_pStateCache->SetDepthTest(true);
+	m_pStateCache->SetDepthMask(true);
+	m_pStateCache->SetDepthFunc(GL_LESS);
+}
@@ -0,0 +1,103 @@
+///////////////////////////////////////////////////////////////////////////////
+// reflectionprobes.h
+// ============
+// manage the environment cube maps sampled by the reflective materials
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLStateCache.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  ReflectionProbes
+ *
+ *  This class contains the code for the cube maps that the
+ *  reflective shapes sample their surroundings from.  Each
+ *  probe keeps a cached cube map of the static shapes, only
+ *  rendered again when they or the lights change, and the
+ *  cube map sampled by the scene shader.  Moving shapes are
+ *  added to the sampled map one face at a time, by copying
+ *  the cached face in and drawing the moving shapes over it,
+ *  so the cost of a frame does not grow with the probes.
+ ***********************************************************/
+class ReflectionProbes
+{
+public:
+	// constructor
+	ReflectionProbes(GLStateCache* pStateCache);
+	// destructor
+	~ReflectionProbes();
+
+	// texture unit the environment map is bound to for the scene shader
+	static const int ENVIRONMENT_TEXTURE_UNIT = GLStateCache::ENVIRONMENT_TEXTURE_UNIT;
+	// faces of a cube map
+	static const int FACE_COUNT = 6;
+
+	// create the frame buffers for faces of the passed in size
+	bool Initialize(int resolution);
+	// add a probe capturing the scene around a position
+	int AddProbe(const glm::vec3& position);
+
+	// get the probes
+	int GetProbeCount() const { return((int)m_probes.size()); }
+	const glm::vec3& GetPosition(int probe) const { return(m_probes[probe].position); }
+	// find the probe closest to a position, -1 when there are none
+	int FindNearestProbe(const glm::vec3& position) const;
+
+	// get the camera looking out of one face of a probe
+	glm::mat4 GetFaceView(int probe, int face) const;
+	const glm::mat4& GetFaceProjection() const { return(m_faceProjection); }
+
+	// start rendering the static shapes into one face of the
+	// cached map, or into every face as layers when face is -1
+	void BeginStaticPass(int probe, int face);
+	// copy every cached face into the sampled map
+	void CopyStaticFaces(int probe);
+	// start rendering the moving shapes into one face of the
+	// sampled map over a copy of the cached face
+	void BeginDynamicPass(int probe, int face);
+	// return to the scene frame buffer and viewport
+	void EndPass();
+
+	// bind the sampled map of a probe for the scene shader
+	void BindEnvironmentMap(int probe);
+
+private:
+	// cube maps of one probe, each with its own depth
+	struct PROBE
+	{
+		glm::vec3 position;
+		GLuint staticColorID;
+		GLuint staticDepthID;
+		GLuint environmentColorID;
+		GLuint environmentDepthID;
+	};
+
+	// pointer to OpenGL state cache object
+	GLStateCache* m_pStateCache;
+	std::vector<PROBE> m_probes;
+	int m_resolution;
+	// ninety degree view of every face
+	glm::mat4 m_faceProjection;
+
+	// frame buffers the faces are attached to for drawing and copying
+	GLuint m_drawFramebufferID;
+	GLuint m_readFramebufferID;
+
+	// frame buffer and viewport restored at the end of a pass
+	GLint m_sceneFramebufferID;
+	GLint m_sceneViewport[4];
+
+	// create a color and a depth cube map
+	void CreateCubeMap(GLuint& colorID, GLuint& depthID);
+	// attach one face of a cube map pair, or all of them when face is -1
+	void AttachFace(GLenum target, GLuint colorID, GLuint depthID, int face);
+	// bind the draw frame buffer sized to a face
+	void BeginPass();
+};
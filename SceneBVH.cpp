@@ -0,0 +1,1021 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebvh.cpp
+// ============
+// bounding volume hierarchy over the placed basic shapes - ray queries
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneBVH.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of the global variables and defines
+namespace
+{
+	// the unit shapes below match the vertex data that
+	// ShapeMeshes generates for each of the basic meshes
+	const float BOX_HALF_SIZE = 0.5f;
+	const float TAPERED_TOP_RADIUS = 0.5f;
+	const float TORUS_MAIN_RADIUS = 1.0f;
+	const float TORUS_TUBE_RADIUS = 0.2f;
+
+	// instances per leaf before a node is split
+	const int MAX_LEAF_INSTANCES = 2;
+	// deepest traversal stack needed by the tree
+	const int MAX_TRAVERSAL_DEPTH = 64;
+	// limits for marching rays against the torus
+	const int MAX_MARCH_STEPS = 96;
+	const float MARCH_EPSILON = 1.0e-4f;
+	// limits for sweeping spheres through the scene
+	const int MAX_SWEEP_STEPS = 64;
+	const float SWEEP_EPSILON = 1.0e-3f;
+	// offset used for the normal at a sweep contact
+	const float GRADIENT_OFFSET = 1.0e-3f;
+
+	// plane of a convex shape, the normal points outward
+	struct CONVEX_PLANE
+	{
+		glm::vec3 normal;
+		float distance;
+	};
+
+	const CONVEX_PLANE g_BoxPlanes[] =
+	{
+		{ glm::vec3(1.0f, 0.0f, 0.0f), BOX_HALF_SIZE },
+		{ glm::vec3(-1.0f, 0.0f, 0.0f), BOX_HALF_SIZE },
+		{ glm::vec3(0.0f, 1.0f, 0.0f), BOX_HALF_SIZE },
+		{ glm::vec3(0.0f, -1.0f, 0.0f), BOX_HALF_SIZE },
+		{ glm::vec3(0.0f, 0.0f, 1.0f), BOX_HALF_SIZE },
+		{ glm::vec3(0.0f, 0.0f, -1.0f), BOX_HALF_SIZE }
+	};
+
+	// square base at the bottom of the box, apex at the top center
+	const CONVEX_PLANE g_Pyramid4Planes[] =
+	{
+		{ glm::vec3(0.0f, -1.0f, 0.0f), 0.5f },
+		{ glm::vec3(2.0f, 1.0f, 0.0f), 0.5f },
+		{ glm::vec3(-2.0f, 1.0f, 0.0f), 0.5f },
+		{ glm::vec3(0.0f, 1.0f, 2.0f), 0.5f },
+		{ glm::vec3(0.0f, 1.0f, -2.0f), 0.5f }
+	};
+
+	// triangle in the XY plane pushed along Z
+	const CONVEX_PLANE g_PrismPlanes[] =
+	{
+		{ glm::vec3(0.0f, -1.0f, 0.0f), 0.5f },
+		{ glm::vec3(2.0f, 1.0f, 0.0f), 0.5f },
+		{ glm::vec3(-2.0f, 1.0f, 0.0f), 0.5f },
+		{ glm::vec3(0.0f, 0.0f, 1.0f), 0.5f },
+		{ glm::vec3(0.0f, 0.0f, -1.0f), 0.5f }
+	};
+
+	/***********************************************************
+	 *  IntersectBounds()
+	 *
+	 *  This function is used for clipping a ray against a box,
+	 *  returning the range of the ray inside of it.
+	 ***********************************************************/
+	bool IntersectBounds(
+		const glm::vec3& origin,
+		const glm::vec3& inverseDirection,
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax,
+		float maxDistance,
+		float& tNear,
+		float& tFar)
+	{
+		glm::vec3 t0 = (boundsMin - origin) * inverseDirection;
+		glm::vec3 t1 = (boundsMax - origin) * inverseDirection;
+		glm::vec3 tMin = glm::min(t0, t1);
+		glm::vec3 tMax = glm::max(t0, t1);
+
+		tNear = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+		tFar = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+		return(tNear <= tFar);
+	}
+
+	/***********************************************************
+	 *  IntersectConvex()
+	 *
+	 *  This function is used for intersecting a ray with a
+	 *  convex shape bounded by planes.
+	 ***********************************************************/
+	bool IntersectConvex(
+		const CONVEX_PLANE* planes,
+		int planeCount,
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		float& t,
+		glm::vec3& normal)
+	{
+		float tNear = 0.0f;
+		float tFar = maxDistance;
+		glm::vec3 nearNormal = glm::vec3(0.0f);
+		bool bInside = true;
+
+		for (int i = 0; i < planeCount; i++)
+		{
+			float distance = glm::dot(planes[i].normal, origin) - planes[i].distance;
+			float rate = glm::dot(planes[i].normal, direction);
+
+			if (distance > 0.0f)
+			{
+				bInside = false;
+			}
+			if (rate == 0.0f)
+			{
+				// parallel and outside of this plane
+				if (distance > 0.0f)
+				{
+					return(false);
+				}
+				continue;
+			}
+
+			float tPlane = -distance / rate;
+			if (rate < 0.0f)
+			{
+				// entering the half space
+				if (tPlane > tNear)
+				{
+					tNear = tPlane;
+					nearNormal = planes[i].normal;
+				}
+			}
+			else if (tPlane < tFar)
+			{
+				tFar = tPlane;
+			}
+			if (tNear > tFar)
+			{
+				return(false);
+			}
+		}
+
+		// rays starting inside of the shape are not counted as hits
+		if (bInside == true)
+		{
+			return(false);
+		}
+
+		t = tNear;
+		normal = glm::normalize(nearNormal);
+		return(true);
+	}
+
+	/***********************************************************
+	 *  IntersectSphere()
+	 *
+	 *  This function is used for intersecting a ray with the
+	 *  unit sphere.
+	 ***********************************************************/
+	bool IntersectSphere(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		float& t,
+		glm::vec3& normal)
+	{
+		float a = glm::dot(direction, direction);
+		float b = glm::dot(origin, direction);
+		float c = glm::dot(origin, origin) - 1.0f;
+		float discriminant = b * b - a * c;
+
+		if (discriminant < 0.0f)
+		{
+			return(false);
+		}
+
+		float root = std::sqrt(discriminant);
+		float tHit = (-b - root) / a;
+		if ((tHit < 0.0f) || (tHit > maxDistance))
+		{
+			return(false);
+		}
+
+		t = tHit;
+		normal = origin + direction * tHit;
+		return(true);
+	}
+
+	/***********************************************************
+	 *  IntersectFrustum()
+	 *
+	 *  This function is used for intersecting a ray with a
+	 *  capped cone frustum standing on the XZ plane - radius
+	 *  bottomRadius at a height of 0 and topRadius at 1.  The
+	 *  cylinder and the cone are both special cases of it.
+	 ***********************************************************/
+	bool IntersectFrustum(
+		float bottomRadius,
+		float topRadius,
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		float& t,
+		glm::vec3& normal)
+	{
+		float slope = topRadius - bottomRadius;
+		float originRadius = bottomRadius + slope * origin.y;
+		bool bHit = false;
+
+		// side of the shape - x^2 + z^2 = (r0 + slope * y)^2
+		float a = direction.x * direction.x + direction.z * direction.z
+			- slope * slope * direction.y * direction.y;
+		float b = origin.x * direction.x + origin.z * direction.z
+			- slope * direction.y * originRadius;
+		float c = origin.x * origin.x + origin.z * origin.z
+			- originRadius * originRadius;
+		float roots[2];
+		int rootCount = 0;
+
+		if (std::abs(a) > 1.0e-8f)
+		{
+			float discriminant = b * b - a * c;
+			if (discriminant >= 0.0f)
+			{
+				float root = std::sqrt(discriminant);
+				roots[0] = (-b - root) / a;
+				roots[1] = (-b + root) / a;
+				rootCount = 2;
+			}
+		}
+		else if (std::abs(b) > 1.0e-8f)
+		{
+			roots[0] = -c / (2.0f * b);
+			rootCount = 1;
+		}
+
+		for (int i = 0; i < rootCount; i++)
+		{
+			float tSide = roots[i];
+			if ((tSide < 0.0f) || (tSide > maxDistance))
+			{
+				continue;
+			}
+			glm::vec3 point = origin + direction * tSide;
+			float radius = bottomRadius + slope * point.y;
+			// the double cone reflected through the apex is not part of the shape
+			if ((point.y < 0.0f) || (point.y > 1.0f) || (radius < 0.0f))
+			{
+				continue;
+			}
+			maxDistance = tSide;
+			t = tSide;
+			normal = glm::normalize(glm::vec3(point.x, -slope * radius, point.z));
+			bHit = true;
+		}
+
+		// flat caps at the bottom and the top
+		if (direction.y != 0.0f)
+		{
+			for (int cap = 0; cap < 2; cap++)
+			{
+				float capRadius = (cap == 0) ? bottomRadius : topRadius;
+				if (capRadius <= 0.0f)
+				{
+					continue;
+				}
+				float tCap = ((float)cap - origin.y) / direction.y;
+				if ((tCap < 0.0f) || (tCap > maxDistance))
+				{
+					continue;
+				}
+				glm::vec3 point = origin + direction * tCap;
+				if (point.x * point.x + point.z * point.z <= capRadius * capRadius)
+				{
+					maxDistance = tCap;
+					t = tCap;
+					normal = glm::vec3(0.0f, (cap == 0) ? -1.0f : 1.0f, 0.0f);
+					bHit = true;
+				}
+			}
+		}
+
+		return(bHit);
+	}
+
+	/***********************************************************
+	 *  IntersectPlane()
+	 *
+	 *  This function is used for intersecting a ray with the
+	 *  unit plane lying on the XZ plane.
+	 ***********************************************************/
+	bool IntersectPlane(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		float& t,
+		glm::vec3& normal)
+	{
+		if (direction.y == 0.0f)
+		{
+			return(false);
+		}
+
+		float tHit = -origin.y / direction.y;
+		if ((tHit < 0.0f) || (tHit > maxDistance))
+		{
+			return(false);
+		}
+
+		glm::vec3 point = origin + direction * tHit;
+		if ((std::abs(point.x) > 1.0f) || (std::abs(point.z) > 1.0f))
+		{
+			return(false);
+		}
+
+		t = tHit;
+		normal = glm::vec3(0.0f, 1.0f, 0.0f);
+		return(true);
+	}
+
+	/***********************************************************
+	 *  TorusDistance()
+	 *
+	 *  This function is used for getting the distance from a
+	 *  point to the surface of the torus around the Z axis.
+	 ***********************************************************/
+	float TorusDistance(const glm::vec3& point)
+	{
+		glm::vec2 ring = glm::vec2(glm::length(glm::vec2(point.x, point.y)) - TORUS_MAIN_RADIUS, point.z);
+		return(glm::length(ring) - TORUS_TUBE_RADIUS);
+	}
+
+	/***********************************************************
+	 *  BoxDistance()
+	 *
+	 *  This function is used for getting the distance from a
+	 *  point to a box centered on the origin.
+	 ***********************************************************/
+	float BoxDistance(const glm::vec3& halfSize, const glm::vec3& point)
+	{
+		glm::vec3 offset = glm::abs(point) - halfSize;
+		float inside = std::min(std::max(offset.x, std::max(offset.y, offset.z)), 0.0f);
+		return(glm::length(glm::max(offset, glm::vec3(0.0f))) + inside);
+	}
+
+	/***********************************************************
+	 *  ConvexDistance()
+	 *
+	 *  This function is used for getting the distance from a
+	 *  point to a convex shape bounded by planes.  The farthest
+	 *  plane is exact in front of the faces and never more than
+	 *  the true distance near the edges.
+	 ***********************************************************/
+	float ConvexDistance(const CONVEX_PLANE* planes, int planeCount, const glm::vec3& point)
+	{
+		float distance = -1.0e30f;
+		for (int i = 0; i < planeCount; i++)
+		{
+			float length = glm::length(planes[i].normal);
+			distance = std::max(distance, (glm::dot(planes[i].normal, point) - planes[i].distance) / length);
+		}
+		return(distance);
+	}
+
+	/***********************************************************
+	 *  FrustumDistance()
+	 *
+	 *  This function is used for getting the distance from a
+	 *  point to the capped cone frustum of IntersectFrustum(),
+	 *  working in the plane through its axis.
+	 ***********************************************************/
+	float FrustumDistance(float bottomRadius, float topRadius, const glm::vec3& point)
+	{
+		// radius and height measured from the middle of the frustum
+		glm::vec2 q = glm::vec2(glm::length(glm::vec2(point.x, point.z)), point.y - 0.5f);
+		glm::vec2 topCorner = glm::vec2(topRadius, 0.5f);
+		glm::vec2 side = glm::vec2(topRadius - bottomRadius, 1.0f);
+		float capRadius = (q.y < 0.0f) ? bottomRadius : topRadius;
+		glm::vec2 toCap = glm::vec2(q.x - std::min(q.x, capRadius), std::abs(q.y) - 0.5f);
+		float along = glm::clamp(glm::dot(topCorner - q, side) / glm::dot(side, side), 0.0f, 1.0f);
+		glm::vec2 toSide = q - topCorner + side * along;
+		float sign = ((toSide.x < 0.0f) && (toCap.y < 0.0f)) ? -1.0f : 1.0f;
+		return(sign * std::sqrt(std::min(glm::dot(toCap, toCap), glm::dot(toSide, toSide))));
+	}
+
+	/***********************************************************
+	 *  ShapeDistance()
+	 *
+	 *  This function is used for getting the object space
+	 *  distance from a point to one of the basic unit shapes,
+	 *  negative inside of it.
+	 ***********************************************************/
+	float ShapeDistance(SceneManager::SHAPE_TYPE shape, const glm::vec3& point)
+	{
+		switch (shape)
+		{
+		case SceneManager::SHAPE_BOX:
+			return(BoxDistance(glm::vec3(BOX_HALF_SIZE), point));
+		case SceneManager::SHAPE_CONE:
+			return(FrustumDistance(1.0f, 0.0f, point));
+		case SceneManager::SHAPE_CYLINDER:
+			return(FrustumDistance(1.0f, 1.0f, point));
+		case SceneManager::SHAPE_PLANE:
+			return(BoxDistance(glm::vec3(1.0f, 0.0f, 1.0f), point));
+		case SceneManager::SHAPE_PRISM:
+			return(ConvexDistance(g_PrismPlanes, 5, point));
+		case SceneManager::SHAPE_PYRAMID4:
+			return(ConvexDistance(g_Pyramid4Planes, 5, point));
+		case SceneManager::SHAPE_SPHERE:
+			return(glm::length(point) - 1.0f);
+		case SceneManager::SHAPE_TAPERED_CYLINDER:
+			return(FrustumDistance(1.0f, TAPERED_TOP_RADIUS, point));
+		case SceneManager::SHAPE_TORUS:
+			return(TorusDistance(point));
+		}
+		return(1.0e30f);
+	}
+
+	/***********************************************************
+	 *  IntersectTorus()
+	 *
+	 *  This function is used for intersecting a ray with the
+	 *  torus by marching along it with the distance to the
+	 *  surface, which avoids solving the quartic.
+	 ***********************************************************/
+	bool IntersectTorus(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		float& t,
+		glm::vec3& normal)
+	{
+		float extent = TORUS_MAIN_RADIUS + TORUS_TUBE_RADIUS;
+		float tNear;
+		float tFar;
+		float length = glm::length(direction);
+
+		if (IntersectBounds(origin, 1.0f / direction,
+			glm::vec3(-extent, -extent, -TORUS_TUBE_RADIUS),
+			glm::vec3(extent, extent, TORUS_TUBE_RADIUS),
+			maxDistance, tNear, tFar) == false)
+		{
+			return(false);
+		}
+
+		float tMarch = tNear;
+		for (int step = 0; (step < MAX_MARCH_STEPS) && (tMarch <= tFar); step++)
+		{
+			glm::vec3 point = origin + direction * tMarch;
+			float distance = TorusDistance(point);
+			if (distance < MARCH_EPSILON)
+			{
+				glm::vec2 ringDirection = glm::normalize(glm::vec2(point.x, point.y));
+				glm::vec3 tubeCenter = glm::vec3(ringDirection * TORUS_MAIN_RADIUS, 0.0f);
+				t = tMarch;
+				normal = glm::normalize(point - tubeCenter);
+				return(true);
+			}
+			// distances are in object space, t is in units of the direction
+			tMarch += distance / length;
+		}
+
+		return(false);
+	}
+
+	/***********************************************************
+	 *  IntersectShape()
+	 *
+	 *  This function is used for intersecting an object space
+	 *  ray with one of the basic unit shapes.
+	 ***********************************************************/
+	bool IntersectShape(
+		SceneManager::SHAPE_TYPE shape,
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		float& t,
+		glm::vec3& normal)
+	{
+		switch (shape)
+		{
+		case SceneManager::SHAPE_BOX:
+			return(IntersectConvex(g_BoxPlanes, 6, origin, direction, maxDistance, t, normal));
+		case SceneManager::SHAPE_CONE:
+			return(IntersectFrustum(1.0f, 0.0f, origin, direction, maxDistance, t, normal));
+		case SceneManager::SHAPE_CYLINDER:
+			return(IntersectFrustum(1.0f, 1.0f, origin, direction, maxDistance, t, normal));
+		case SceneManager::SHAPE_PLANE:
+			return(IntersectPlane(origin, direction, maxDistance, t, normal));
+		case SceneManager::SHAPE_PRISM:
+			return(IntersectConvex(g_PrismPlanes, 5, origin, direction, maxDistance, t, normal));
+		case SceneManager::SHAPE_PYRAMID4:
+			return(IntersectConvex(g_Pyramid4Planes, 5, origin, direction, maxDistance, t, normal));
+		case SceneManager::SHAPE_SPHERE:
+			return(IntersectSphere(origin, direction, maxDistance, t, normal));
+		case SceneManager::SHAPE_TAPERED_CYLINDER:
+			return(IntersectFrustum(1.0f, TAPERED_TOP_RADIUS, origin, direction, maxDistance, t, normal));
+		case SceneManager::SHAPE_TORUS:
+			return(IntersectTorus(origin, direction, maxDistance, t, normal));
+		}
+		return(false);
+	}
+}
+
+/***********************************************************
+ *  SceneBVH()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneBVH::SceneBVH()
+{
+}
+
+/***********************************************************
+ *  ~SceneBVH()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneBVH::~SceneBVH()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all of the instances
+ *  and the tree built over them.
+ ***********************************************************/
+void SceneBVH::Clear()
+{
+	m_instances.clear();
+	m_instanceOrder.clear();
+	m_nodes.clear();
+}
+
+/***********************************************************
+ *  AddInstance()
+ *
+ *  This method is used for adding a placed shape.  Build()
+ *  must be called again before the instance is found by
+ *  the ray queries.
+ ***********************************************************/
+int SceneBVH::AddInstance(SceneManager::SHAPE_TYPE shape, const glm::mat4& model)
+{
+	BVH_INSTANCE instance;
+	glm::vec3 localMin;
+	glm::vec3 localMax;
+
+	instance.shape = shape;
+	instance.model = model;
+	instance.inverseModel = glm::inverse(model);
+	instance.normalMatrix = glm::transpose(glm::mat3(instance.inverseModel));
+	// the least a unit of object space is stretched to in the world
+	instance.minScale = std::min(
+		glm::length(glm::vec3(model[0])),
+		std::min(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+	// world box around the eight corners of the shape box
+	GetShapeBounds(shape, localMin, localMax);
+	instance.boundsMin = glm::vec3(1.0e30f);
+	instance.boundsMax = glm::vec3(-1.0e30f);
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec4 localCorner = glm::vec4(
+			(corner & 1) ? localMax.x : localMin.x,
+			(corner & 2) ? localMax.y : localMin.y,
+			(corner & 4) ? localMax.z : localMin.z,
+			1.0f);
+		glm::vec3 worldCorner = glm::vec3(model * localCorner);
+		instance.boundsMin = glm::min(instance.boundsMin, worldCorner);
+		instance.boundsMax = glm::max(instance.boundsMax, worldCorner);
+	}
+	instance.centroid = (instance.boundsMin + instance.boundsMax) * 0.5f;
+
+	m_instances.push_back(instance);
+	return((int)m_instances.size() - 1);
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for building the tree over all of
+ *  the added instances.
+ ***********************************************************/
+void SceneBVH::Build()
+{
+	m_nodes.clear();
+	m_instanceOrder.resize(m_instances.size());
+	for (int i = 0; i < (int)m_instances.size(); i++)
+	{
+		m_instanceOrder[i] = i;
+	}
+
+	if (m_instances.size() > 0)
+	{
+		m_nodes.reserve(m_instances.size() * 2);
+		BuildNode(0, (int)m_instances.size());
+	}
+}
+
+/***********************************************************
+ *  BuildNode()
+ *
+ *  This method is used for building the node covering a
+ *  range of instances.  Ranges are split at the middle
+ *  instance along the longest axis of their centroids.
+ ***********************************************************/
+int SceneBVH::BuildNode(int first, int count)
+{
+	int nodeIndex = (int)m_nodes.size();
+	BVH_NODE node;
+	glm::vec3 centroidMin = glm::vec3(1.0e30f);
+	glm::vec3 centroidMax = glm::vec3(-1.0e30f);
+
+	node.boundsMin = glm::vec3(1.0e30f);
+	node.boundsMax = glm::vec3(-1.0e30f);
+	node.secondChild = -1;
+	node.firstInstance = first;
+	node.instanceCount = count;
+
+	for (int i = first; i < first + count; i++)
+	{
+		const BVH_INSTANCE& instance = m_instances[m_instanceOrder[i]];
+		node.boundsMin = glm::min(node.boundsMin, instance.boundsMin);
+		node.boundsMax = glm::max(node.boundsMax, instance.boundsMax);
+		centroidMin = glm::min(centroidMin, instance.centroid);
+		centroidMax = glm::max(centroidMax, instance.centroid);
+	}
+	m_nodes.push_back(node);
+
+	if (count <= MAX_LEAF_INSTANCES)
+	{
+		return(nodeIndex);
+	}
+
+	glm::vec3 extent = centroidMax - centroidMin;
+	int axis = 0;
+	if (extent.y > extent[axis])
+	{
+		axis = 1;
+	}
+	if (extent.z > extent[axis])
+	{
+		axis = 2;
+	}
+
+	int half = count / 2;
+	std::nth_element(
+		m_instanceOrder.begin() + first,
+		m_instanceOrder.begin() + first + half,
+		m_instanceOrder.begin() + first + count,
+		[this, axis](int a, int b)
+		{
+			return(m_instances[a].centroid[axis] < m_instances[b].centroid[axis]);
+		});
+
+	// the first child directly follows its parent
+	BuildNode(first, half);
+	int secondChild = BuildNode(first + half, count - half);
+
+	m_nodes[nodeIndex].secondChild = secondChild;
+	m_nodes[nodeIndex].instanceCount = 0;
+	return(nodeIndex);
+}
+
+/***********************************************************
+ *  Intersect()
+ *
+ *  This method is used for finding the closest instance
+ *  hit by a ray within the maximum distance.
+ ***********************************************************/
+bool SceneBVH::Intersect(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	RAY_HIT& hit) const
+{
+	return(Traverse(origin, direction, maxDistance, false, hit));
+}
+
+/***********************************************************
+ *  IsOccluded()
+ *
+ *  This method is used for checking whether anything lies
+ *  along a ray, stopping at the first hit found.
+ ***********************************************************/
+bool SceneBVH::IsOccluded(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance) const
+{
+	RAY_HIT hit;
+	return(Traverse(origin, direction, maxDistance, true, hit));
+}
+
+/***********************************************************
+ *  IntersectInstance()
+ *
+ *  This method is used for intersecting a ray with a single
+ *  instance.  The ray is moved into object space so the exact
+ *  unit shape is tested, and the hit is moved back out.
+ ***********************************************************/
+bool SceneBVH::IntersectInstance(
+	int instance,
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	RAY_HIT& hit) const
+{
+	const BVH_INSTANCE& placed = m_instances[instance];
+	// affine transforms keep the ray parameter the same in both spaces
+	glm::vec3 localOrigin = glm::vec3(placed.inverseModel * glm::vec4(origin, 1.0f));
+	glm::vec3 localDirection = glm::mat3(placed.inverseModel) * direction;
+	float t;
+	glm::vec3 localNormal;
+
+	if (IntersectShape(placed.shape, localOrigin, localDirection, maxDistance, t, localNormal) == false)
+	{
+		return(false);
+	}
+
+	hit.distance = t;
+	hit.position = origin + direction * t;
+	hit.normal = glm::normalize(placed.normalMatrix * localNormal);
+	hit.instance = instance;
+	return(true);
+}
+
+/***********************************************************
+ *  Traverse()
+ *
+ *  This method is used for walking the tree along a ray,
+ *  visiting the nearer child first so the maximum distance
+ *  shrinks quickly.
+ ***********************************************************/
+bool SceneBVH::Traverse(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	bool bAnyHit,
+	RAY_HIT& hit) const
+{
+	int stack[MAX_TRAVERSAL_DEPTH];
+	int stackSize = 0;
+	bool bHit = false;
+	glm::vec3 inverseDirection = 1.0f / direction;
+
+	if (m_nodes.size() == 0)
+	{
+		return(false);
+	}
+
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		int nodeIndex = stack[--stackSize];
+		const BVH_NODE& node = m_nodes[nodeIndex];
+		float tNear;
+		float tFar;
+
+		if (IntersectBounds(origin, inverseDirection, node.boundsMin, node.boundsMax,
+			maxDistance, tNear, tFar) == false)
+		{
+			continue;
+		}
+
+		if (node.instanceCount > 0)
+		{
+			for (int i = node.firstInstance; i < node.firstInstance + node.instanceCount; i++)
+			{
+				RAY_HIT instanceHit;
+				if (IntersectInstance(m_instanceOrder[i], origin, direction, maxDistance, instanceHit) == true)
+				{
+					hit = instanceHit;
+					maxDistance = instanceHit.distance;
+					bHit = true;
+					if (bAnyHit == true)
+					{
+						return(true);
+					}
+				}
+			}
+			continue;
+		}
+
+		int firstChild = nodeIndex + 1;
+		int secondChild = node.secondChild;
+		glm::vec3 firstCenter = (m_nodes[firstChild].boundsMin + m_nodes[firstChild].boundsMax) * 0.5f;
+		glm::vec3 secondCenter = (m_nodes[secondChild].boundsMin + m_nodes[secondChild].boundsMax) * 0.5f;
+		// push the farther child first so the nearer one is popped next
+		if (glm::dot(direction, secondCenter - firstCenter) < 0.0f)
+		{
+			std::swap(firstChild, secondChild);
+		}
+		if (stackSize + 2 <= MAX_TRAVERSAL_DEPTH)
+		{
+			stack[stackSize++] = secondChild;
+			stack[stackSize++] = firstChild;
+		}
+	}
+
+	return(bHit);
+}
+
+/***********************************************************
+ *  SweepSphere()
+ *
+ *  This method is used for moving a sphere along a ray until
+ *  it touches the scene.  Only the instances whose boxes
+ *  overlap the box around the whole sweep are considered.
+ *  The sphere is stepped forward by its distance to the
+ *  nearest of them, which can never pass through a surface,
+ *  and the normal at the contact is taken from how that
+ *  distance changes around the center.
+ ***********************************************************/
+bool SceneBVH::SweepSphere(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	float radius,
+	RAY_HIT& hit) const
+{
+	std::vector<int> candidates;
+	glm::vec3 end = origin + direction * maxDistance;
+
+	FindOverlapping(
+		glm::min(origin, end) - glm::vec3(radius),
+		glm::max(origin, end) + glm::vec3(radius),
+		candidates);
+	if (candidates.size() == 0)
+	{
+		return(false);
+	}
+
+	float t = 0.0f;
+	for (int step = 0; step < MAX_SWEEP_STEPS; step++)
+	{
+		glm::vec3 center = origin + direction * t;
+		float nearestDistance = 1.0e30f;
+		int nearestInstance = -1;
+
+		for (int i = 0; i < (int)candidates.size(); i++)
+		{
+			float distance = GetInstanceDistance(candidates[i], center);
+			if (distance < nearestDistance)
+			{
+				nearestDistance = distance;
+				nearestInstance = candidates[i];
+			}
+		}
+
+		float gap = nearestDistance - radius;
+		if (gap < SWEEP_EPSILON)
+		{
+			glm::vec3 gradient;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				glm::vec3 offset = glm::vec3(0.0f);
+				offset[axis] = GRADIENT_OFFSET;
+				gradient[axis] = GetInstanceDistance(nearestInstance, center + offset) -
+					GetInstanceDistance(nearestInstance, center - offset);
+			}
+
+			// a flat spot in the distance only happens deep inside
+			if (glm::dot(gradient, gradient) < 1.0e-12f)
+			{
+				gradient = -direction;
+			}
+			hit.distance = (step == 0) ? std::min(gap, 0.0f) : t;
+			hit.normal = glm::normalize(gradient);
+			hit.position = center - hit.normal * nearestDistance;
+			hit.instance = nearestInstance;
+			return(true);
+		}
+
+		t += gap;
+		if (t > maxDistance)
+		{
+			return(false);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  FindOverlapping()
+ *
+ *  This method is used for collecting the instances whose
+ *  world boxes overlap a box.
+ ***********************************************************/
+void SceneBVH::FindOverlapping(
+	const glm::vec3& boundsMin,
+	const glm::vec3& boundsMax,
+	std::vector<int>& instances) const
+{
+	int stack[MAX_TRAVERSAL_DEPTH];
+	int stackSize = 0;
+
+	instances.clear();
+	if (m_nodes.size() == 0)
+	{
+		return;
+	}
+
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		int nodeIndex = stack[--stackSize];
+		const BVH_NODE& node = m_nodes[nodeIndex];
+
+		if ((node.boundsMin.x > boundsMax.x) || (node.boundsMax.x < boundsMin.x) ||
+			(node.boundsMin.y > boundsMax.y) || (node.boundsMax.y < boundsMin.y) ||
+			(node.boundsMin.z > boundsMax.z) || (node.boundsMax.z < boundsMin.z))
+		{
+			continue;
+		}
+
+		if (node.instanceCount > 0)
+		{
+			for (int i = node.firstInstance; i < node.firstInstance + node.instanceCount; i++)
+			{
+				instances.push_back(m_instanceOrder[i]);
+			}
+			continue;
+		}
+
+		if (stackSize + 2 <= MAX_TRAVERSAL_DEPTH)
+		{
+			stack[stackSize++] = node.secondChild;
+			stack[stackSize++] = nodeIndex + 1;
+		}
+	}
+}
+
+/***********************************************************
+ *  GetInstanceDistance()
+ *
+ *  This method is used for getting the distance from a world
+ *  point to an instance.  The distance is found to the unit
+ *  shape in object space and scaled by the shortest axis of
+ *  the instance, so a stretched shape is never reported as
+ *  farther away than it is.
+ ***********************************************************/
+float SceneBVH::GetInstanceDistance(int instance, const glm::vec3& point) const
+{
+	const BVH_INSTANCE& placed = m_instances[instance];
+	glm::vec3 localPoint = glm::vec3(placed.inverseModel * glm::vec4(point, 1.0f));
+
+	return(ShapeDistance(placed.shape, localPoint) * placed.minScale);
+}
+
+/***********************************************************
+ *  GetInstanceBounds()
+ *
+ *  This method is used for getting the world space box
+ *  around an instance.
+ ***********************************************************/
+void SceneBVH::GetInstanceBounds(int instance, glm::vec3& boundsMin, glm::vec3& boundsMax) const
+{
+	boundsMin = m_instances[instance].boundsMin;
+	boundsMax = m_instances[instance].boundsMax;
+}
+
+/***********************************************************
+ *  GetShapeBounds()
+ *
+ *  This method is used for getting the object space box
+ *  around one of the basic unit shapes.
+ ***********************************************************/
+void SceneBVH::GetShapeBounds(
+	SceneManager::SHAPE_TYPE shape,
+	glm::vec3& boundsMin,
+	glm::vec3& boundsMax)
+{
+	float torusExtent = TORUS_MAIN_RADIUS + TORUS_TUBE_RADIUS;
+
+	switch (shape)
+	{
+	case SceneManager::SHAPE_BOX:
+	case SceneManager::SHAPE_PRISM:
+	case SceneManager::SHAPE_PYRAMID4:
+		boundsMin = glm::vec3(-BOX_HALF_SIZE);
+		boundsMax = glm::vec3(BOX_HALF_SIZE);
+		break;
+	case SceneManager::SHAPE_CONE:
+	case SceneManager::SHAPE_CYLINDER:
+	case SceneManager::SHAPE_TAPERED_CYLINDER:
+		boundsMin = glm::vec3(-1.0f, 0.0f, -1.0f);
+		boundsMax = glm::vec3(1.0f, 1.0f, 1.0f);
+		break;
+	case SceneManager::SHAPE_PLANE:
+		// a little thickness keeps the box from collapsing
+		boundsMin = glm::vec3(-1.0f, -1.0e-3f, -1.0f);
+		boundsMax = glm::vec3(1.0f, 1.0e-3f, 1.0f);
+		break;
+	case SceneManager::SHAPE_SPHERE:
+		boundsMin = glm::vec3(-1.0f);
+		boundsMax = glm::vec3(1.0f);
+		break;
+	case SceneManager::SHAPE_TORUS:
+		boundsMin = glm::vec3(-torusExtent, -torusExtent, -TORUS_TUBE_RADIUS);
+		boundsMax = glm::vec3(torusExtent, torusExtent, TORUS_TUBE_RADIUS);
+		break;
+	}
+}
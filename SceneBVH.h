@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebvh.h
+// ============
+// bounding volume hierarchy over the placed basic shapes - ray queries
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+
+#include <vector>
+
+/***********************************************************
+ *  SceneBVH
+ *
+ *  This class contains the code for casting rays against the
+ *  basic shapes placed in the 3D scene.  Each placed shape is
+ *  an instance - a shape type and its model matrix - and the
+ *  rays are intersected with the exact shape in object space,
+ *  so no triangle data is needed.  A binary tree of bounding
+ *  boxes around the instances skips the ones a ray misses.
+ ***********************************************************/
+class SceneBVH
+{
+public:
+	// constructor
+	SceneBVH();
+	// destructor
+	~SceneBVH();
+
+	// closest intersection found along a ray
+	struct RAY_HIT
+	{
+		// distance along the ray, in units of the ray direction
+		float distance;
+		glm::vec3 position;
+		// world space normal facing out of the shape
+		glm::vec3 normal;
+		// index of the instance returned by AddInstance()
+		int instance;
+	};
+
+	// remove all of the instances and the tree
+	void Clear();
+	// add a placed shape, returns the index of the instance
+	int AddInstance(SceneManager::SHAPE_TYPE shape, const glm::mat4& model);
+	// build the tree over the added instances
+	void Build();
+
+	// find the closest instance hit by the ray
+	bool Intersect(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		RAY_HIT& hit) const;
+	// check whether anything is hit by the ray
+	bool IsOccluded(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance) const;
+	// intersect the ray with a single instance
+	bool IntersectInstance(
+		int instance,
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		RAY_HIT& hit) const;
+	// find where a sphere moving along a unit direction first
+	// touches the scene - the distance is negative when the
+	// sphere starts out that far inside of it
+	bool SweepSphere(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		float radius,
+		RAY_HIT& hit) const;
+
+	// find the instances whose boxes overlap a box
+	void FindOverlapping(
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax,
+		std::vector<int>& instances) const;
+	// get a world distance from a point to an instance that is
+	// never more than the true distance, negative inside of it
+	float GetInstanceDistance(int instance, const glm::vec3& point) const;
+
+	// get the number of instances
+	int GetInstanceCount() const { return((int)m_instances.size()); }
+	// get the world space box around an instance
+	void GetInstanceBounds(int instance, glm::vec3& boundsMin, glm::vec3& boundsMax) const;
+
+	// get the object space box around a basic shape
+	static void GetShapeBounds(
+		SceneManager::SHAPE_TYPE shape,
+		glm::vec3& boundsMin,
+		glm::vec3& boundsMax);
+
+private:
+	// placed shape with its transforms and world bounds
+	struct BVH_INSTANCE
+	{
+		SceneManager::SHAPE_TYPE shape;
+		glm::mat4 model;
+		glm::mat4 inverseModel;
+		// transforms object space normals into world space
+		glm::mat3 normalMatrix;
+		// shortest axis scale, turning object distances into
+		// world distances that are never too long
+		float minScale;
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		glm::vec3 centroid;
+	};
+
+	// node of the tree - leaves list a range of instances,
+	// inner nodes store their second child, the first child
+	// always directly follows the node
+	struct BVH_NODE
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		int secondChild;
+		int firstInstance;
+		int instanceCount;
+	};
+
+	// placed shapes in the order they were added
+	std::vector<BVH_INSTANCE> m_instances;
+	// instance indices reordered so every leaf is a contiguous range
+	std::vector<int> m_instanceOrder;
+	// tree nodes, the root is the first node
+	std::vector<BVH_NODE> m_nodes;
+
+	// recursively build the node covering a range of instances
+	int BuildNode(int first, int count);
+	// traverse the tree, stopping at the first hit when requested
+	bool Traverse(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		bool bAnyHit,
+		RAY_HIT& hit) const;
+};
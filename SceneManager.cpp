@@ -8,6 +8,11 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "LightmapBaker.h"
+#include "IrradianceProbes.h"
+#include "AnimationSystem.h"
+#include "SceneBVH.h"
+#include "MultiViewRenderer.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -16,6 +21,10 @@
 
 #include <glm/gtx/transform.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
 // declaration of global variables
 namespace
 {
@@ -24,6 +33,144 @@ namespace
 	const char* g_TextureValueName = "objectTexture";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+
+	// resolution of the directional light shadow maps
+	const int SHADOW_MAP_RESOLUTION = 2048;
+	// resolution of each face of the reflection probes
+	const int REFLECTION_PROBE_RESOLUTION = 256;
+	// file the baked lightmap is kept in between runs
+	const char* g_LightmapFileName = "scene.lightmap";
+	// blended probe coefficients sent for each shape
+	const char* g_ProbeIrradianceNames[] =
+	{
+		"probeIrradiance[0]", "probeIrradiance[1]", "probeIrradiance[2]",
+		"probeIrradiance[3]", "probeIrradiance[4]", "probeIrradiance[5]",
+		"probeIrradiance[6]", "probeIrradiance[7]", "probeIrradiance[8]"
+	};
+	// names of the basic shapes for reporting picked objects
+	const char* g_ShapeNames[] =
+	{
+		"box", "cone", "cylinder", "plane", "prism",
+		"pyramid", "sphere", "tapered cylinder", "torus"
+	};
+	// tint added to the picked shape
+	const glm::vec3 SELECTED_TINT = glm::vec3(1.6f, 1.6f, 0.8f);
+	// point lights in range sent for each shape
+	const char* g_PointLightIndexNames[] =
+	{
+		"pointLightIndices[0]", "pointLightIndices[1]",
+		"pointLightIndices[2]", "pointLightIndices[3]"
+	};
+
+	/***********************************************************
+	 *  GetWorldBounds()
+	 *
+	 *  This function is used for getting the world space box
+	 *  around a transformed basic shape.
+	 ***********************************************************/
+	void GetWorldBounds(
+		SceneManager::SHAPE_TYPE shape,
+		const glm::mat4& model,
+		glm::vec3& boundsMin,
+		glm::vec3& boundsMax)
+	{
+		glm::vec3 localMin;
+		glm::vec3 localMax;
+
+		SceneBVH::GetShapeBounds(shape, localMin, localMax);
+		boundsMin = glm::vec3(1.0e30f);
+		boundsMax = glm::vec3(-1.0e30f);
+		for (int corner = 0; corner < 8; corner++)
+		{
+			glm::vec4 localCorner = glm::vec4(
+				(corner & 1) ? localMax.x : localMin.x,
+				(corner & 2) ? localMax.y : localMin.y,
+				(corner & 4) ? localMax.z : localMin.z,
+				1.0f);
+			glm::vec3 worldCorner = glm::vec3(model * localCorner);
+			boundsMin = glm::min(boundsMin, worldCorner);
+			boundsMax = glm::max(boundsMax, worldCorner);
+		}
+	}
+
+	/***********************************************************
+	 *  AddFrustumPlanes()
+	 *
+	 *  This function is used for appending the six planes of a
+	 *  view frustum, taken from the rows of its view projection
+	 *  matrix, each facing into the frustum.
+	 ***********************************************************/
+	void AddFrustumPlanes(
+		const glm::mat4& viewProjection,
+		std::vector<glm::vec4>& planes)
+	{
+		glm::vec4 rows[4];
+
+		for (int row = 0; row < 4; row++)
+		{
+			rows[row] = glm::vec4(
+				viewProjection[0][row], viewProjection[1][row],
+				viewProjection[2][row], viewProjection[3][row]);
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			planes.push_back(rows[3] + rows[axis]);
+			planes.push_back(rows[3] - rows[axis]);
+		}
+	}
+
+	/***********************************************************
+	 *  IsInsideAnyFrustum()
+	 *
+	 *  This function is used for testing a world box against a
+	 *  list of frustums, six planes each.  The box is kept when
+	 *  it is not fully behind a plane of at least one of them,
+	 *  which tests it against the union of the views at once.
+	 ***********************************************************/
+	bool IsInsideAnyFrustum(
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax,
+		const std::vector<glm::vec4>& planes)
+	{
+		for (int frustum = 0; frustum + 6 <= (int)planes.size(); frustum += 6)
+		{
+			bool bInside = true;
+
+			for (int i = frustum; (i < frustum + 6) && (bInside == true); i++)
+			{
+				// the corner of the box furthest along the plane normal
+				glm::vec3 corner = glm::vec3(
+					(planes[i].x >= 0.0f) ? boundsMax.x : boundsMin.x,
+					(planes[i].y >= 0.0f) ? boundsMax.y : boundsMin.y,
+					(planes[i].z >= 0.0f) ? boundsMax.z : boundsMin.z);
+
+				bInside = (glm::dot(glm::vec3(planes[i]), corner) + planes[i].w >= 0.0f);
+			}
+			if (bInside == true)
+			{
+				return(true);
+			}
+		}
+
+		return(false);
+	}
+
+	/***********************************************************
+	 *  HashBytes()
+	 *
+	 *  This function is used for folding raw bytes into a
+	 *  running FNV-1a hash.
+	 ***********************************************************/
+	uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+		return(hash);
+	}
 }
 
 /***********************************************************
@@ -31,9 +178,10 @@ namespace
  *
  *  The constructor for the class
  ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
+SceneManager::SceneManager(ShaderManager *pShaderManager, GLStateCache* pStateCache)
 {
 	m_pShaderManager = pShaderManager;
+	m_pStateCache = pStateCache;
 	m_basicMeshes = new ShapeMeshes();
 
 	//initialize the texture collection
@@ -41,8 +189,84 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 	{
 		m_textureIDs[i].tag = "/0";
 		m_textureIDs[i].ID = -1;
+		m_textureIDs[i].bTranslucent = false;
 	}
 	m_loadedTextures = 0;
+	m_currentUseTexture = -1;
+	m_currentTextureSlot = -1;
+	m_currentMaterialIndex = -1;
+
+	//initialize the shader settings for the first queued draw
+	m_pendingDraw.shape = SHAPE_BOX;
+	m_pendingDraw.model = glm::mat4(1.0f);
+	m_pendingDraw.color = glm::vec4(1.0f);
+	m_pendingDraw.bUseTexture = false;
+	m_pendingDraw.textureSlot = -1;
+	m_pendingDraw.UVscale = glm::vec2(1.0f, 1.0f);
+	m_pendingDraw.materialIndex = -1;
+	m_pendingDraw.bTransparent = false;
+	m_pendingDraw.bDynamic = false;
+	m_pendingDraw.lightmapIndex = -1;
+	m_pendingDraw.pointLightCount = 0;
+	m_pendingDraw.tint = glm::vec3(1.0f);
+	m_pendingDraw.reflectionProbe = -1;
+
+	m_transparencyMode = TRANSPARENCY_SORTED;
+	m_pOITManager = NULL;
+	m_debugView = DebugViewRenderer::DEBUG_VIEW_NONE;
+	m_pDebugViewRenderer = NULL;
+
+	m_pShadowManager = NULL;
+	m_directionalLightDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+	m_staticShadowHash = 0;
+
+	m_pLightmapBaker = NULL;
+	m_bLightmaps = false;
+	m_lightmapHash = 0;
+	m_lightmapTextureSlot = -1;
+	m_currentLightmapIndex = -2;
+	m_pIrradianceProbes = NULL;
+	m_bIrradianceProbes = false;
+	m_currentUseProbeLight = -1;
+	m_pLightCuller = new LightCuller();
+	m_currentPointLightCount = -1;
+	m_directionalLightAmbient = glm::vec3(0.0f);
+	m_directionalLightDiffuse = glm::vec3(0.0f);
+
+	m_pSnowParticles = NULL;
+	m_pTransformStore = NULL;
+	m_pAnimationSystem = NULL;
+	m_pPhysicsWorld = NULL;
+	m_fixedFrameTime = 0.0f;
+	m_fixedAnimationTime = 0.0f;
+	m_pendingAnimationNode = -1;
+	m_bPendingBodyNode = false;
+	m_currentTint = glm::vec3(-1.0f);
+	m_pSceneBVH = NULL;
+	m_sceneBVHHash = 0;
+	m_pMultiViewRenderer = NULL;
+	m_pReflectionProbes = NULL;
+	m_reflectionHash = 0;
+	m_reflectionFace = 0;
+	m_bCapturingReflections = false;
+	m_currentReflectionProbe = -2;
+	m_selectedObject = -1;
+
+	m_pDepthShader = NULL;
+	m_bDepthPrepass = false;
+	m_overdrawQueries[0] = 0;
+	m_overdrawQueries[1] = 0;
+	m_overdrawPixels[0] = 0;
+	m_overdrawPixels[1] = 0;
+	m_overdrawFrame = 0;
+	m_totalShadedSamples = 0.0;
+	m_totalPixels = 0.0;
+	m_visibleObjectCount = 0;
+	m_culledObjectCount = 0;
+
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_viewPosition = glm::vec3(0.0f);
 }
 
 /***********************************************************
@@ -53,6 +277,80 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 SceneManager::~SceneManager()
 {
 	m_pShaderManager = NULL;
+	if (NULL != m_pOITManager)
+	{
+		delete m_pOITManager;
+		m_pOITManager = NULL;
+	}
+	if (NULL != m_pDebugViewRenderer)
+	{
+		delete m_pDebugViewRenderer;
+		m_pDebugViewRenderer = NULL;
+	}
+	if (NULL != m_pDepthShader)
+	{
+		delete m_pDepthShader;
+		m_pDepthShader = NULL;
+	}
+	if (NULL != m_pShadowManager)
+	{
+		delete m_pShadowManager;
+		m_pShadowManager = NULL;
+	}
+	if (NULL != m_pIrradianceProbes)
+	{
+		delete m_pIrradianceProbes;
+		m_pIrradianceProbes = NULL;
+	}
+	if (NULL != m_pLightmapBaker)
+	{
+		delete m_pLightmapBaker;
+		m_pLightmapBaker = NULL;
+	}
+	if (NULL != m_pLightCuller)
+	{
+		delete m_pLightCuller;
+		m_pLightCuller = NULL;
+	}
+	if (NULL != m_pSnowParticles)
+	{
+		delete m_pSnowParticles;
+		m_pSnowParticles = NULL;
+	}
+	if (NULL != m_pAnimationSystem)
+	{
+		delete m_pAnimationSystem;
+		m_pAnimationSystem = NULL;
+	}
+	if (NULL != m_pPhysicsWorld)
+	{
+		delete m_pPhysicsWorld;
+		m_pPhysicsWorld = NULL;
+	}
+	if (NULL != m_pTransformStore)
+	{
+		delete m_pTransformStore;
+		m_pTransformStore = NULL;
+	}
+	if (NULL != m_pSceneBVH)
+	{
+		delete m_pSceneBVH;
+		m_pSceneBVH = NULL;
+	}
+	if (NULL != m_pMultiViewRenderer)
+	{
+		delete m_pMultiViewRenderer;
+		m_pMultiViewRenderer = NULL;
+	}
+	if (NULL != m_pReflectionProbes)
+	{
+		delete m_pReflectionProbes;
+		m_pReflectionProbes = NULL;
+	}
+	if (0 != m_overdrawQueries[0])
+	{
+		glDeleteQueries(2, m_overdrawQueries);
+	}
 	if (NULL != m_basicMeshes)
 	{
 		delete m_basicMeshes;
@@ -76,6 +374,7 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 	int height = 0;
 	int colorChannels = 0;
 	GLuint textureID = 0;
+	bool bTranslucent = false;
 
 	// indicate to always flip images vertically when loaded
 	stbi_set_flip_vertically_on_load(true);
@@ -94,13 +393,14 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
 
 		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
+		m_pStateCache->BindTexture(0, GL_TEXTURE_2D, textureID);
 
 		// set the texture wrapping parameters
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		// set texture filtering parameters - minified textures are
+		// read from the mipmaps generated below
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 		// if the loaded image is in RGB format
@@ -108,7 +408,19 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
 		// if the loaded image is in RGBA format - it supports transparency
 		else if (colorChannels == 4)
+		{
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+
+			// an RGBA image only needs blending if some pixel is
+			// not fully opaque
+			for (int i = 3; (i < width * height * 4) && (bTranslucent == false); i += 4)
+			{
+				if (image[i] < 255)
+				{
+					bTranslucent = true;
+				}
+			}
+		}
 		else
 		{
 			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
@@ -120,257 +432,2012 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 
 		// free the image data from local memory
 		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+		m_pStateCache->BindTexture(0, GL_TEXTURE_2D, 0); // Unbind the texture
 
 		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
+		if (AddTexture(textureID, tag, bTranslucent) == false)
+		{
+			glDeleteTextures(1, &textureID);
+			std::cout << "Could not register image:" << filename << ", all texture slots are taken" << std::endl;
+			return false;
+		}
 
 		return true;
 	}
 
-	std::cout << "Could not load image:" << filename << std::endl;
-
-	// Error loading the image
-	return false;
+	std::cout << "Could not load image:" << filename << std::endl;
+
+	// Error loading the image
+	return false;
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for binding the loaded textures to
+ *  OpenGL texture memory slots.  There is one slot for each
+ *  unit below the first reserved unit.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		// bind textures on corresponding texture units - the
+		// state cache skips units that already hold the texture
+		m_pStateCache->BindTexture(i, GL_TEXTURE_2D, m_textureIDs[i].ID);
+	}
+}
+
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory in all the
+ *  used texture memory slots.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		// slots registered without a created texture hold zero
+		if (0 != m_textureIDs[i].ID)
+		{
+			glDeleteTextures(1, &m_textureIDs[i].ID);
+		}
+	}
+	m_loadedTextures = 0;
+	// the lightmap is created and baked again on its next update
+	m_lightmapTextureSlot = -1;
+	m_lightmapHash = 0;
+	// deleted textures are unbound by OpenGL
+	m_pStateCache->InvalidateTextures();
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for registering a created OpenGL
+ *  texture in the next available texture slot, associated
+ *  with the passed in tag.  Slot i is bound to unit i, so
+ *  the slots stop short of the units reserved for the
+ *  reflection, shadow, transparency and overlay passes.
+ ***********************************************************/
+bool SceneManager::AddTexture(uint32_t textureID, std::string tag, bool bTranslucent)
+{
+	const int slotCount = sizeof(m_textureIDs) / sizeof(m_textureIDs[0]);
+
+	if (m_loadedTextures >= slotCount)
+	{
+		return(false);
+	}
+
+	m_textureIDs[m_loadedTextures].ID = textureID;
+	m_textureIDs[m_loadedTextures].tag = tag;
+	m_textureIDs[m_loadedTextures].bTranslucent = bTranslucent;
+	m_loadedTextures++;
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting an ID for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureID(std::string tag)
+{
+	int textureID = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureID = m_textureIDs[index].ID;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(std::string tag)
+{
+	int textureSlot = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureSlot = index;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureSlot);
+}
+
+/***********************************************************
+ *  AddMaterial()
+ *
+ *  This method is used for adding a material to the defined
+ *  materials list, found afterwards by its tag.
+ ***********************************************************/
+void SceneManager::AddMaterial(const OBJECT_MATERIAL& material)
+{
+	m_objectMaterials.push_back(material);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for getting a material from the previously
+ *  defined materials list that is associated with the passed in tag.
+ ***********************************************************/
+bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+{
+	if (m_objectMaterials.size() == 0)
+	{
+		return(false);
+	}
+
+	int index = 0;
+	bool bFound = false;
+	while ((index < m_objectMaterials.size()) && (bFound == false))
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			bFound = true;
+			material.diffuseColor = m_objectMaterials[index].diffuseColor;
+			material.specularColor = m_objectMaterials[index].specularColor;
+			material.shininess = m_objectMaterials[index].shininess;
+		}
+		else
+		{
+			index++;
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index of a material
+ *  in the defined materials list, or -1 when the tag is not
+ *  defined.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(std::string tag)
+{
+	for (int index = 0; index < (int)m_objectMaterials.size(); index++)
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			return(index);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	// variables for this method
+	glm::mat4 modelView;
+	glm::mat4 scale;
+	glm::mat4 rotationX;
+	glm::mat4 rotationY;
+	glm::mat4 rotationZ;
+	glm::mat4 translation;
+
+	// set the scale value in the transform buffer
+	scale = glm::scale(scaleXYZ);
+	// set the rotation values in the transform buffer
+	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
+	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
+	// set the translation value in the transform buffer
+	translation = glm::translate(positionXYZ);
+
+	modelView = translation * rotationZ * rotationY * rotationX * scale;
+
+	// the model matrix is sent to the shader when the queued
+	// draw is submitted
+	m_pendingDraw.model = modelView;
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	m_pendingDraw.color = currentColor;
+	m_pendingDraw.bUseTexture = false;
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in ID into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	std::string textureTag)
+{
+	m_pendingDraw.bUseTexture = true;
+	m_pendingDraw.textureSlot = FindTextureSlot(textureTag);
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	m_pendingDraw.UVscale = glm::vec2(u, v);
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the material values
+ *  into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	std::string materialTag)
+{
+	int materialIndex = FindMaterialIndex(materialTag);
+
+	if (materialIndex >= 0)
+	{
+		m_pendingDraw.materialIndex = materialIndex;
+	}
+}
+
+/***********************************************************
+ *  DrawShape()
+ *
+ *  This method is used for queueing a basic shape to be drawn
+ *  with the shader settings from the previous Set* calls.
+ *  The draw is classified as opaque or transparent from the
+ *  alpha of its texture, or of its color when untextured.
+ ***********************************************************/
+void SceneManager::DrawShape(SHAPE_TYPE shape)
+{
+	m_pendingDraw.shape = shape;
+
+	if ((m_pendingDraw.bUseTexture == true) && (m_pendingDraw.textureSlot >= 0))
+	{
+		m_pendingDraw.bTransparent = m_textureIDs[m_pendingDraw.textureSlot].bTranslucent;
+	}
+	else
+	{
+		m_pendingDraw.bTransparent = (m_pendingDraw.color.a < 1.0f);
+	}
+
+	m_drawCommands.push_back(m_pendingDraw);
+
+	// animated shapes are moved around their own origin, shapes
+	// of a body are placed by it, and both are treated as moving
+	if ((m_pendingAnimationNode >= 0) && (NULL != m_pTransformStore))
+	{
+		DRAW_COMMAND& command = m_drawCommands.back();
+
+		if (m_bPendingBodyNode == true)
+		{
+			command.model = m_pTransformStore->GetModelMatrix(m_pendingAnimationNode) * command.model;
+		}
+		else
+		{
+			glm::vec3 origin = glm::vec3(command.model[3]);
+
+			command.model = glm::translate(origin) *
+				m_pTransformStore->GetModelMatrix(m_pendingAnimationNode) *
+				glm::translate(-origin) * command.model;
+		}
+		command.tint = glm::vec3(m_pTransformStore->GetColor(m_pendingAnimationNode));
+		command.bDynamic = true;
+	}
+	m_pendingAnimationNode = -1;
+	m_bPendingBodyNode = false;
+
+	// queued shapes keep their order from frame to frame, so the
+	// picked shape is found again by its index
+	if ((int)m_drawCommands.size() - 1 == m_selectedObject)
+	{
+		m_drawCommands.back().tint *= SELECTED_TINT;
+	}
+}
+
+/***********************************************************
+ *  SetShaderAnimation()
+ *
+ *  This method is used for applying the animated node with
+ *  the passed in tag to the next queued shape.  Nothing
+ *  changes when animation is off or the tag is not found.
+ ***********************************************************/
+void SceneManager::SetShaderAnimation(
+	std::string animationTag)
+{
+	if (NULL != m_pTransformStore)
+	{
+		m_pendingAnimationNode = m_pTransformStore->FindNode(animationTag);
+		m_bPendingBodyNode = false;
+	}
+}
+
+/***********************************************************
+ *  SetShaderBody()
+ *
+ *  This method is used for placing the next queued shape on
+ *  the rigid body written into the passed in node.  The
+ *  shape is set up around the origin, as part of the body.
+ ***********************************************************/
+void SceneManager::SetShaderBody(int node)
+{
+	if (NULL != m_pTransformStore)
+	{
+		m_pendingAnimationNode = node;
+		m_bPendingBodyNode = true;
+	}
+}
+
+/***********************************************************
+ *  AddTransformNode()
+ *
+ *  This method is used for getting the node with the passed
+ *  in tag, adding it when it is new.  The transform store is
+ *  shared by the animation and the rigid bodies, so turning
+ *  either on again finds its nodes already there.
+ ***********************************************************/
+int SceneManager::AddTransformNode(std::string tag)
+{
+	int node = m_pTransformStore->FindNode(tag);
+	if (node < 0)
+	{
+		node = m_pTransformStore->AddNode(tag);
+	}
+
+	return(node);
+}
+
+/***********************************************************
+ *  DrawPhysicsBodies()
+ *
+ *  This method is used for queuing the shapes of the moving
+ *  rigid bodies, each placed by the node its body writes.
+ *  A capsule is drawn as a cylinder between two spheres.
+ ***********************************************************/
+void SceneManager::DrawPhysicsBodies()
+{
+	for (int body = 0; body < m_pPhysicsWorld->GetBodyCount(); body++)
+	{
+		int node = m_pPhysicsWorld->GetNode(body);
+		glm::vec3 extents = m_pPhysicsWorld->GetExtents(body);
+
+		if (node < 0)
+		{
+			continue;
+		}
+
+		switch (m_pPhysicsWorld->GetShape(body))
+		{
+		case PhysicsWorld::BODY_SPHERE:
+			SetTransformations(glm::vec3(extents.x), 0.0f, 0.0f, 0.0f, glm::vec3(0.0f));
+			SetShaderTexture("ornaments");
+			SetShaderMaterial("ornament");
+			SetShaderBody(node);
+			DrawShape(SHAPE_SPHERE);
+			break;
+		case PhysicsWorld::BODY_BOX:
+			SetTransformations(extents * 2.0f, 0.0f, 0.0f, 0.0f, glm::vec3(0.0f));
+			SetShaderTexture("giftbox");
+			SetShaderMaterial("gift");
+			SetShaderBody(node);
+			DrawShape(SHAPE_BOX);
+			break;
+		case PhysicsWorld::BODY_CAPSULE:
+			SetTransformations(glm::vec3(extents.x, 2.0f * extents.y, extents.x), 0.0f, 0.0f, 0.0f,
+				glm::vec3(0.0f, -extents.y, 0.0f));
+			SetShaderTexture("purplelight");
+			SetShaderMaterial("silver");
+			SetShaderBody(node);
+			DrawShape(SHAPE_CYLINDER);
+			for (int end = -1; end <= 1; end += 2)
+			{
+				SetTransformations(glm::vec3(extents.x), 0.0f, 0.0f, 0.0f,
+					glm::vec3(0.0f, (float)end * extents.y, 0.0f));
+				SetShaderBody(node);
+				DrawShape(SHAPE_SPHERE);
+			}
+			break;
+		}
+	}
+}
+
+/***********************************************************
+ *  SubmitDrawCommands()
+ *
+ *  This method is used for drawing the queued shapes.  The
+ *  shapes outside of every view are culled, the opaque ones
+ *  are sorted front to back for the main camera, and the
+ *  shadow map, lightmap and point lights are brought up to
+ *  date - all once per frame.  The shapes are then drawn
+ *  into the main view, or into each viewport in turn with
+ *  only the camera changing between them.
+ ***********************************************************/
+void SceneManager::SubmitDrawCommands()
+{
+	std::vector<std::pair<float, int>> opaqueOrder;
+	std::vector<std::pair<float, int>> transparentOrder;
+	std::vector<glm::vec4> frustumPlanes;
+
+	opaqueOrder.reserve(m_drawCommands.size());
+	m_culledObjectCount = 0;
+
+	if (m_viewports.size() == 0)
+	{
+		AddFrustumPlanes(m_projectionMatrix * m_viewMatrix, frustumPlanes);
+	}
+	for (int i = 0; i < (int)m_viewports.size(); i++)
+	{
+		AddFrustumPlanes(m_viewports[i].projection * m_viewports[i].view, frustumPlanes);
+	}
+
+	for (int i = 0; i < (int)m_drawCommands.size(); i++)
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+
+		GetWorldBounds(m_drawCommands[i].shape, m_drawCommands[i].model, boundsMin, boundsMax);
+		if (IsInsideAnyFrustum(boundsMin, boundsMax, frustumPlanes) == false)
+		{
+			m_culledObjectCount++;
+			continue;
+		}
+
+		// distance in front of the camera along the view direction
+		glm::vec4 viewPosition = m_viewMatrix * m_drawCommands[i].model[3];
+		float depth = -viewPosition.z;
+
+		if (m_drawCommands[i].bTransparent == true)
+		{
+			transparentOrder.push_back(std::make_pair(depth, i));
+		}
+		else
+		{
+			opaqueOrder.push_back(std::make_pair(depth, i));
+		}
+	}
+
+	std::sort(opaqueOrder.begin(), opaqueOrder.end());
+	m_visibleObjectCount = (int)(opaqueOrder.size() + transparentOrder.size());
+
+	if (NULL != m_pShadowManager)
+	{
+		UpdateShadowMap();
+	}
+	if (m_bLightmaps == true)
+	{
+		UpdateLightmaps();
+	}
+	AssignPointLights();
+	if (NULL != m_pReflectionProbes)
+	{
+		UpdateReflectionProbes();
+	}
+
+	if (m_debugView != DebugViewRenderer::DEBUG_VIEW_NONE)
+	{
+		DrawDebugView(opaqueOrder, transparentOrder);
+	}
+	else if (m_viewports.size() == 0)
+	{
+		DrawView(opaqueOrder, transparentOrder, true);
+	}
+	else if ((NULL != m_pMultiViewRenderer) && ((int)m_viewports.size() <= MultiViewRenderer::MAX_VIEWS))
+	{
+		DrawViewsInstanced(opaqueOrder, transparentOrder);
+	}
+	else
+	{
+		glm::mat4 mainView = m_viewMatrix;
+		glm::mat4 mainProjection = m_projectionMatrix;
+		glm::vec3 mainPosition = m_viewPosition;
+		GLint sceneViewport[4];
+
+		glGetIntegerv(GL_VIEWPORT, sceneViewport);
+		for (int i = 0; i < (int)m_viewports.size(); i++)
+		{
+			const VIEWPORT_CAMERA& viewport = m_viewports[i];
+
+			glViewport(viewport.viewport[0], viewport.viewport[1], viewport.viewport[2], viewport.viewport[3]);
+			ApplyViewCamera(viewport.view, viewport.projection, viewport.position);
+			DrawView(opaqueOrder, transparentOrder, (i == 0));
+		}
+		glViewport(sceneViewport[0], sceneViewport[1], sceneViewport[2], sceneViewport[3]);
+		ApplyViewCamera(mainView, mainProjection, mainPosition);
+	}
+
+	// the shape meshes bind their own vertex arrays
+	m_pStateCache->InvalidateVertexArray();
+}
+
+/***********************************************************
+ *  DrawViewsInstanced()
+ *
+ *  This method is used for drawing the visible shapes into
+ *  every viewport in one pass.  The cameras are sent once,
+ *  and each shape is set up once and drawn with one instance
+ *  per view, the vertex shader sending each instance to its
+ *  own viewport.  The depth pre-pass has a single camera, so
+ *  it is skipped, and the sorted transparent shapes keep the
+ *  back to front order of the main camera.
+ ***********************************************************/
+void SceneManager::DrawViewsInstanced(
+	const std::vector<std::pair<float, int>>& opaqueOrder,
+	std::vector<std::pair<float, int>> transparentOrder)
+{
+	int viewCount = (int)m_viewports.size();
+	GLint sceneViewport[4];
+
+	glGetIntegerv(GL_VIEWPORT, sceneViewport);
+
+	m_pShaderManager->setIntValue("viewCount", viewCount);
+	m_pShaderManager->setBoolValue("bLayeredViews", false);
+	for (int i = 0; i < viewCount; i++)
+	{
+		std::string index = "[" + std::to_string(i) + "]";
+
+		m_pShaderManager->setMat4Value("viewMatrices" + index, m_viewports[i].view);
+		m_pShaderManager->setMat4Value("projectionMatrices" + index, m_viewports[i].projection);
+		m_pShaderManager->setVec3Value("viewPositions" + index, m_viewports[i].position);
+	}
+	SetViewportArray();
+
+	// opaque pass
+	m_pStateCache->SetBlend(false);
+	m_pStateCache->SetDepthMask(true);
+	for (int i = 0; i < (int)opaqueOrder.size(); i++)
+	{
+		ApplyDrawCommand(m_drawCommands[opaqueOrder[i].second]);
+		m_pMultiViewRenderer->DrawMesh(m_drawCommands[opaqueOrder[i].second].shape, viewCount);
+	}
+
+	// falling snow - its own shader, one draw per view
+	if (NULL != m_pSnowParticles)
+	{
+		for (int i = 0; i < viewCount; i++)
+		{
+			glViewport(m_viewports[i].viewport[0], m_viewports[i].viewport[1],
+				m_viewports[i].viewport[2], m_viewports[i].viewport[3]);
+			m_pSnowParticles->Draw(m_viewports[i].view, m_viewports[i].projection);
+		}
+		m_pStateCache->UseProgram(m_pShaderManager->m_programID);
+		SetViewportArray();
+	}
+
+	// transparent pass - order independent, with the targets
+	// sized and composited over the whole window
+	if ((transparentOrder.size() > 0) && (m_transparencyMode == TRANSPARENCY_WEIGHTED_OIT))
+	{
+		glViewport(sceneViewport[0], sceneViewport[1], sceneViewport[2], sceneViewport[3]);
+		m_pOITManager->BeginTransparentPass();
+		SetViewportArray();
+		m_pShaderManager->setBoolValue("bWeightedOIT", true);
+		for (int i = 0; i < (int)transparentOrder.size(); i++)
+		{
+			ApplyDrawCommand(m_drawCommands[transparentOrder[i].second]);
+			m_pMultiViewRenderer->DrawMesh(m_drawCommands[transparentOrder[i].second].shape, viewCount);
+		}
+		m_pShaderManager->setBoolValue("bWeightedOIT", false);
+		m_pOITManager->EndTransparentPass();
+
+		glViewport(sceneViewport[0], sceneViewport[1], sceneViewport[2], sceneViewport[3]);
+		m_pOITManager->Composite();
+		m_pStateCache->UseProgram(m_pShaderManager->m_programID);
+	}
+	// transparent pass - sorted back to front
+	else if (transparentOrder.size() > 0)
+	{
+		std::sort(transparentOrder.begin(), transparentOrder.end(),
+			[](const std::pair<float, int>& a, const std::pair<float, int>& b)
+			{
+				return(a.first > b.first);
+			});
+
+		m_pStateCache->SetBlend(true);
+		m_pStateCache->SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		m_pStateCache->SetDepthMask(false);
+		for (int i = 0; i < (int)transparentOrder.size(); i++)
+		{
+			ApplyDrawCommand(m_drawCommands[transparentOrder[i].second]);
+			m_pMultiViewRenderer->DrawMesh(m_drawCommands[transparentOrder[i].second].shape, viewCount);
+		}
+		m_pStateCache->SetDepthMask(true);
+	}
+
+	// setting the viewport sets every viewport of the array
+	m_pShaderManager->setIntValue("viewCount", 0);
+	glViewport(sceneViewport[0], sceneViewport[1], sceneViewport[2], sceneViewport[3]);
+}
+
+/***********************************************************
+ *  DrawDebugView()
+ *
+ *  This method is used for drawing the visible shapes into
+ *  the counts of the debug view.  The overdraw view adds one
+ *  for every fragment that passes the depth test, so the
+ *  front to back order and the depth pre-pass show the same
+ *  savings they give the lit scene - transparent shapes add
+ *  theirs on top.  The other views keep the value of the
+ *  front most fragment.  The quad view draws each viewport
+ *  in turn, and the snow is left out.
+ ***********************************************************/
+void SceneManager::DrawDebugView(
+	const std::vector<std::pair<float, int>>& opaqueOrder,
+	const std::vector<std::pair<float, int>>& transparentOrder)
+{
+	glm::mat4 mainView = m_viewMatrix;
+	glm::mat4 mainProjection = m_projectionMatrix;
+	glm::vec3 mainPosition = m_viewPosition;
+	GLint sceneViewport[4];
+	int viewCount = std::max((int)m_viewports.size(), 1);
+
+	glGetIntegerv(GL_VIEWPORT, sceneViewport);
+	m_pDebugViewRenderer->BeginPass();
+
+	for (int i = 0; i < viewCount; i++)
+	{
+		if (m_viewports.size() > 0)
+		{
+			const VIEWPORT_CAMERA& viewport = m_viewports[i];
+
+			glViewport(viewport.viewport[0], viewport.viewport[1], viewport.viewport[2], viewport.viewport[3]);
+			ApplyViewCamera(viewport.view, viewport.projection, viewport.position);
+		}
+
+		// blending is only turned on for the overdraw counts,
+		// after the pre-pass
+		m_pStateCache->SetBlend(false);
+		if (m_bDepthPrepass == true)
+		{
+			DrawDepthPrepass(opaqueOrder);
+			m_pStateCache->SetDepthFunc(GL_EQUAL);
+			m_pStateCache->SetDepthMask(false);
+		}
+		else
+		{
+			m_pStateCache->SetDepthMask(true);
+		}
+
+		m_pShaderManager->setIntValue("debugView", m_debugView);
+		if (m_debugView == DebugViewRenderer::DEBUG_VIEW_OVERDRAW)
+		{
+			m_pStateCache->SetBlend(true);
+			m_pStateCache->SetBlendFunc(GL_ONE, GL_ONE);
+		}
+		for (int j = 0; j < (int)opaqueOrder.size(); j++)
+		{
+			ApplyDrawCommand(m_drawCommands[opaqueOrder[j].second]);
+			DrawShapeMesh(m_drawCommands[opaqueOrder[j].second].shape);
+		}
+		m_pStateCache->SetDepthFunc(GL_LESS);
+
+		m_pStateCache->SetDepthMask(false);
+		for (int j = 0; j < (int)transparentOrder.size(); j++)
+		{
+			ApplyDrawCommand(m_drawCommands[transparentOrder[j].second]);
+			DrawShapeMesh(m_drawCommands[transparentOrder[j].second].shape);
+		}
+		m_pStateCache->SetDepthMask(true);
+		m_pShaderManager->setIntValue("debugView", DebugViewRenderer::DEBUG_VIEW_NONE);
+	}
+
+	if (m_viewports.size() > 0)
+	{
+		glViewport(sceneViewport[0], sceneViewport[1], sceneViewport[2], sceneViewport[3]);
+		ApplyViewCamera(mainView, mainProjection, mainPosition);
+	}
+
+	m_pDebugViewRenderer->EndPass();
+	m_pDebugViewRenderer->Resolve(m_debugView);
+	m_pStateCache->UseProgram(m_pShaderManager->m_programID);
+}
+
+/***********************************************************
+ *  SetViewportArray()
+ *
+ *  This method is used for setting the viewport of each view
+ *  by its index, as picked by the vertex shader.
+ ***********************************************************/
+void SceneManager::SetViewportArray()
+{
+	for (int i = 0; i < (int)m_viewports.size(); i++)
+	{
+		glViewportIndexedf(i,
+			(GLfloat)m_viewports[i].viewport[0], (GLfloat)m_viewports[i].viewport[1],
+			(GLfloat)m_viewports[i].viewport[2], (GLfloat)m_viewports[i].viewport[3]);
+	}
+}
+
+/***********************************************************
+ *  DrawView()
+ *
+ *  This method is used for drawing the visible shapes into
+ *  the current viewport with the current camera.  Opaque
+ *  shapes are drawn first with blending off so the depth
+ *  test can reject hidden fragments early.  Transparent
+ *  shapes follow with depth writes off, either sorted back
+ *  to front for this camera with alpha blending, or
+ *  unsorted into the weighted blended transparency targets.
+ ***********************************************************/
+void SceneManager::DrawView(
+	const std::vector<std::pair<float, int>>& opaqueOrder,
+	std::vector<std::pair<float, int>> transparentOrder,
+	bool bCountOverdraw)
+{
+	// opaque pass - after a depth pre-pass only the front most
+	// fragment of each pixel passes the GL_EQUAL test and is lit
+	m_pStateCache->SetBlend(false);
+	if (m_bDepthPrepass == true)
+	{
+		DrawDepthPrepass(opaqueOrder);
+		m_pStateCache->SetDepthFunc(GL_EQUAL);
+		m_pStateCache->SetDepthMask(false);
+	}
+	else
+	{
+		m_pStateCache->SetDepthMask(true);
+	}
+
+	if (bCountOverdraw == true)
+	{
+		BeginOverdrawQuery();
+	}
+	for (int i = 0; i < (int)opaqueOrder.size(); i++)
+	{
+		ApplyDrawCommand(m_drawCommands[opaqueOrder[i].second]);
+		DrawShapeMesh(m_drawCommands[opaqueOrder[i].second].shape);
+	}
+	if (bCountOverdraw == true)
+	{
+		EndOverdrawQuery();
+	}
+
+	m_pStateCache->SetDepthFunc(GL_LESS);
+
+	// falling snow - every flake in one instanced draw
+	if (NULL != m_pSnowParticles)
+	{
+		m_pSnowParticles->Draw(m_viewMatrix, m_projectionMatrix);
+		m_pStateCache->UseProgram(m_pShaderManager->m_programID);
+	}
+
+	// transparent pass - order independent
+	if ((transparentOrder.size() > 0) && (m_transparencyMode == TRANSPARENCY_WEIGHTED_OIT))
+	{
+		m_pOITManager->BeginTransparentPass();
+		m_pShaderManager->setBoolValue("bWeightedOIT", true);
+		for (int i = 0; i < (int)transparentOrder.size(); i++)
+		{
+			ApplyDrawCommand(m_drawCommands[transparentOrder[i].second]);
+			DrawShapeMesh(m_drawCommands[transparentOrder[i].second].shape);
+		}
+		m_pShaderManager->setBoolValue("bWeightedOIT", false);
+		m_pOITManager->EndTransparentPass();
+
+		m_pOITManager->Composite();
+		m_pStateCache->UseProgram(m_pShaderManager->m_programID);
+	}
+	// transparent pass - sorted back to front
+	else if (transparentOrder.size() > 0)
+	{
+		for (int i = 0; i < (int)transparentOrder.size(); i++)
+		{
+			glm::vec4 viewPosition = m_viewMatrix * m_drawCommands[transparentOrder[i].second].model[3];
+			transparentOrder[i].first = -viewPosition.z;
+		}
+		std::sort(transparentOrder.begin(), transparentOrder.end(),
+			[](const std::pair<float, int>& a, const std::pair<float, int>& b)
+			{
+				return(a.first > b.first);
+			});
+
+		m_pStateCache->SetBlend(true);
+		m_pStateCache->SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		m_pStateCache->SetDepthMask(false);
+		for (int i = 0; i < (int)transparentOrder.size(); i++)
+		{
+			ApplyDrawCommand(m_drawCommands[transparentOrder[i].second]);
+			DrawShapeMesh(m_drawCommands[transparentOrder[i].second].shape);
+		}
+		m_pStateCache->SetDepthMask(true);
+	}
+}
+
+/***********************************************************
+ *  UpdateShadowMap()
+ *
+ *  This method is used for refreshing the shadow map of the
+ *  directional light.  The static shapes are only rendered
+ *  again when they or the light have changed, detected with
+ *  a hash of their transforms.  Moving shapes are drawn over
+ *  a copy of the cached map every frame.
+ ***********************************************************/
+void SceneManager::UpdateShadowMap()
+{
+	uint64_t staticHash = 14695981039346656037ULL;
+	bool bHasDynamic = false;
+	glm::vec3 sceneMin = glm::vec3(1.0e30f);
+	glm::vec3 sceneMax = glm::vec3(-1.0e30f);
+
+	staticHash = HashBytes(staticHash, &m_directionalLightDirection, sizeof(glm::vec3));
+	for (int i = 0; i < (int)m_drawCommands.size(); i++)
+	{
+		const DRAW_COMMAND& command = m_drawCommands[i];
+		if (command.bDynamic == true)
+		{
+			bHasDynamic = true;
+			continue;
+		}
+		staticHash = HashBytes(staticHash, &command.model, sizeof(glm::mat4));
+		staticHash = HashBytes(staticHash, &command.shape, sizeof(SHAPE_TYPE));
+	}
+
+	if (staticHash != m_staticShadowHash)
+	{
+		// fit the light frustum around everything that casts
+		for (int i = 0; i < (int)m_drawCommands.size(); i++)
+		{
+			glm::vec3 boundsMin;
+			glm::vec3 boundsMax;
+			GetWorldBounds(m_drawCommands[i].shape, m_drawCommands[i].model, boundsMin, boundsMax);
+			sceneMin = glm::min(sceneMin, boundsMin);
+			sceneMax = glm::max(sceneMax, boundsMax);
+		}
+		m_pShadowManager->SetLightView(m_directionalLightDirection, sceneMin, sceneMax);
+
+		m_pShadowManager->BeginStaticPass();
+		for (int i = 0; i < (int)m_drawCommands.size(); i++)
+		{
+			if (m_drawCommands[i].bDynamic == false)
+			{
+				m_pShadowManager->SetModel(m_drawCommands[i].model);
+				DrawShapeMesh(m_drawCommands[i].shape);
+			}
+		}
+		m_pShadowManager->EndPass();
+
+		m_staticShadowHash = staticHash;
+	}
+
+	if (bHasDynamic == true)
+	{
+		m_pShadowManager->BeginDynamicPass();
+		for (int i = 0; i < (int)m_drawCommands.size(); i++)
+		{
+			if (m_drawCommands[i].bDynamic == true)
+			{
+				m_pShadowManager->SetModel(m_drawCommands[i].model);
+				DrawShapeMesh(m_drawCommands[i].shape);
+			}
+		}
+		m_pShadowManager->EndPass();
+	}
+
+	m_pShadowManager->BindShadowMap(bHasDynamic);
+	m_pStateCache->UseProgram(m_pShaderManager->m_programID);
+	m_pShaderManager->setMat4Value("lightSpaceMatrix", m_pShadowManager->GetLightSpaceMatrix());
+}
+
+/***********************************************************
+ *  UpdateLightmaps()
+ *
+ *  This method is used for baking the light of the static
+ *  lights onto the static opaque shapes.  The bake is only
+ *  run again when the shapes or the lights have changed,
+ *  and a bake saved by an earlier run of the same scene is
+ *  loaded instead when there is one.  The queued shapes are
+ *  then pointed at their blocks of the atlas.
+ ***********************************************************/
+void SceneManager::UpdateLightmaps()
+{
+	uint64_t sceneHash = 14695981039346656037ULL;
+
+	for (int i = 0; i < (int)m_drawCommands.size(); i++)
+	{
+		const DRAW_COMMAND& command = m_drawCommands[i];
+		if ((command.bDynamic == false) && (command.bTransparent == false))
+		{
+			sceneHash = HashBytes(sceneHash, &command.model, sizeof(glm::mat4));
+			sceneHash = HashBytes(sceneHash, &command.shape, sizeof(SHAPE_TYPE));
+		}
+	}
+	sceneHash = HashBytes(sceneHash, &m_directionalLightDirection, sizeof(glm::vec3));
+	sceneHash = HashBytes(sceneHash, &m_directionalLightDiffuse, sizeof(glm::vec3));
+	for (int i = 0; i < (int)m_pointLights.size(); i++)
+	{
+		sceneHash = HashBytes(sceneHash, &m_pointLights[i].position, sizeof(glm::vec3));
+		sceneHash = HashBytes(sceneHash, &m_pointLights[i].diffuse, sizeof(glm::vec3));
+		sceneHash = HashBytes(sceneHash, &m_pointLights[i].range, sizeof(float));
+	}
+
+	if (sceneHash != m_lightmapHash)
+	{
+		if (m_lightmapTextureSlot < 0)
+		{
+			GLuint textureID = 0;
+			glGenTextures(1, &textureID);
+			if (AddTexture(textureID, "lightmap", false) == false)
+			{
+				glDeleteTextures(1, &textureID);
+				std::cout << "No texture slot left for the lightmap" << std::endl;
+				m_bLightmaps = false;
+				return;
+			}
+			m_lightmapTextureSlot = m_loadedTextures - 1;
+		}
+
+		if (NULL != m_pLightmapBaker)
+		{
+			delete m_pLightmapBaker;
+		}
+		// the probes are baked from the shapes of the lightmap
+		if (NULL != m_pIrradianceProbes)
+		{
+			delete m_pIrradianceProbes;
+			m_pIrradianceProbes = NULL;
+		}
+		m_pLightmapBaker = new LightmapBaker();
+		m_pLightmapBaker->AddDirectionalLight(m_directionalLightDirection, m_directionalLightDiffuse);
+		for (int i = 0; i < (int)m_pointLights.size(); i++)
+		{
+			m_pLightmapBaker->AddPointLight(m_pointLights[i].position, m_pointLights[i].diffuse, m_pointLights[i].range);
+		}
+		for (int i = 0; i < (int)m_drawCommands.size(); i++)
+		{
+			const DRAW_COMMAND& command = m_drawCommands[i];
+			if ((command.bDynamic == false) && (command.bTransparent == false))
+			{
+				m_pLightmapBaker->AddObject(command.shape, command.model, glm::vec3(command.color));
+			}
+		}
+
+		if (m_pLightmapBaker->LoadFromFile(g_LightmapFileName, sceneHash) == false)
+		{
+			m_pLightmapBaker->Bake((int)std::thread::hardware_concurrency());
+			m_pLightmapBaker->SaveToFile(g_LightmapFileName, sceneHash);
+		}
+
+		m_pStateCache->BindTexture(m_lightmapTextureSlot, GL_TEXTURE_2D, m_textureIDs[m_lightmapTextureSlot].ID);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F,
+			m_pLightmapBaker->GetWidth(), m_pLightmapBaker->GetHeight(),
+			0, GL_RGB, GL_FLOAT, m_pLightmapBaker->GetPixels());
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		// ambient terms do not depend on the surface, so they stay uniform
+		glm::vec3 bakedAmbient = m_directionalLightAmbient;
+		for (int i = 0; i < (int)m_pointLights.size(); i++)
+		{
+			bakedAmbient += m_pointLights[i].ambient;
+		}
+		m_pShaderManager->setSampler2DValue("lightmapTexture", m_lightmapTextureSlot);
+		m_pShaderManager->setVec3Value("bakedAmbient", bakedAmbient);
+
+		m_lightmapHash = sceneHash;
+		m_currentLightmapIndex = -2;
+	}
+
+	if ((m_bIrradianceProbes == true) && (NULL == m_pIrradianceProbes))
+	{
+		m_pIrradianceProbes = new IrradianceProbes();
+		m_pIrradianceProbes->Bake(*m_pLightmapBaker, (int)std::thread::hardware_concurrency());
+		m_currentUseProbeLight = -1;
+	}
+
+	// the blocks are in the order the shapes were added to the baker
+	int object = 0;
+	for (int i = 0; i < (int)m_drawCommands.size(); i++)
+	{
+		DRAW_COMMAND& command = m_drawCommands[i];
+		if ((command.bDynamic == false) && (command.bTransparent == false))
+		{
+			command.lightmapIndex = object;
+			object++;
+		}
+	}
+}
+
+/***********************************************************
+ *  AssignPointLights()
+ *
+ *  This method is used for finding the point lights whose
+ *  range reaches each queued shape.  Only those lights are
+ *  looped over by the shader, so the cost of a shape follows
+ *  the number of lights around it rather than in the scene.
+ *  Shapes lit from the lightmap or the probes skip the point
+ *  lights entirely.
+ ***********************************************************/
+void SceneManager::AssignPointLights()
+{
+	for (int i = 0; i < (int)m_drawCommands.size(); i++)
+	{
+		DRAW_COMMAND& command = m_drawCommands[i];
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+
+		if ((command.lightmapIndex >= 0) || (NULL != m_pIrradianceProbes))
+		{
+			command.pointLightCount = 0;
+			continue;
+		}
+
+		GetWorldBounds(command.shape, command.model, boundsMin, boundsMax);
+		command.pointLightCount = m_pLightCuller->Query(boundsMin, boundsMax, command.pointLightIndices);
+	}
+}
+
+/***********************************************************
+ *  UpdateReflectionProbes()
+ *
+ *  This method is used for refreshing the environment maps
+ *  of the reflective shapes, each of which samples the probe
+ *  closest to it.  The cached maps of the static shapes are
+ *  only rendered again when the static shapes or the lights
+ *  have changed, detected with a hash.  Otherwise, when
+ *  there are moving shapes, they are drawn into one face of
+ *  one probe a frame, so every face is refreshed in turn at
+ *  a fixed cost.
+ ***********************************************************/
+void SceneManager::UpdateReflectionProbes()
+{
+	uint64_t staticHash = 14695981039346656037ULL;
+	bool bHasDynamic = false;
+	glm::mat4 mainView = m_viewMatrix;
+	glm::mat4 mainProjection = m_projectionMatrix;
+	glm::vec3 mainPosition = m_viewPosition;
+	int probeCount = m_pReflectionProbes->GetProbeCount();
+
+	for (int i = 0; i < (int)m_drawCommands.size(); i++)
+	{
+		DRAW_COMMAND& command = m_drawCommands[i];
+
+		command.reflectionProbe = -1;
+		if ((command.materialIndex >= 0) && (m_objectMaterials[command.materialIndex].reflectivity > 0.0f))
+		{
+			command.reflectionProbe = m_pReflectionProbes->FindNearestProbe(glm::vec3(command.model[3]));
+		}
+
+		if (command.bDynamic == true)
+		{
+			bHasDynamic = true;
+			continue;
+		}
+		staticHash = HashBytes(staticHash, &command.model, sizeof(glm::mat4));
+		staticHash = HashBytes(staticHash, &command.shape, sizeof(SHAPE_TYPE));
+		staticHash = HashBytes(staticHash, &command.color, sizeof(glm::vec4));
+		staticHash = HashBytes(staticHash, &command.textureSlot, sizeof(int));
+		staticHash = HashBytes(staticHash, &command.materialIndex, sizeof(int));
+	}
+	staticHash = HashBytes(staticHash, &m_directionalLightDirection, sizeof(glm::vec3));
+	staticHash = HashBytes(staticHash, &m_directionalLightDiffuse, sizeof(glm::vec3));
+	for (int i = 0; i < (int)m_pointLights.size(); i++)
+	{
+		staticHash = HashBytes(staticHash, &m_pointLights[i].position, sizeof(glm::vec3));
+		staticHash = HashBytes(staticHash, &m_pointLights[i].diffuse, sizeof(glm::vec3));
+		staticHash = HashBytes(staticHash, &m_pointLights[i].range, sizeof(float));
+	}
+	// the static shapes are lit differently once the lightmap is baked
+	staticHash = HashBytes(staticHash, &m_lightmapHash, sizeof(uint64_t));
+
+	m_bCapturingReflections = true;
+	if (staticHash != m_reflectionHash)
+	{
+		for (int probe = 0; probe < probeCount; probe++)
+		{
+			CaptureStaticProbe(probe);
+			m_pReflectionProbes->CopyStaticFaces(probe);
+		}
+		m_reflectionHash = staticHash;
+		m_reflectionFace = 0;
+	}
+	else if ((bHasDynamic == true) && (probeCount > 0))
+	{
+		int probe = m_reflectionFace / ReflectionProbes::FACE_COUNT;
+		int face = m_reflectionFace % ReflectionProbes::FACE_COUNT;
+
+		m_pReflectionProbes->BeginDynamicPass(probe, face);
+		ApplyViewCamera(
+			m_pReflectionProbes->GetFaceView(probe, face),
+			m_pReflectionProbes->GetFaceProjection(),
+			m_pReflectionProbes->GetPosition(probe));
+		DrawProbeShapes(probe, true, 0);
+		m_pReflectionProbes->EndPass();
+
+		m_reflectionFace = (m_reflectionFace + 1) % (probeCount * ReflectionProbes::FACE_COUNT);
+	}
+	m_bCapturingReflections = false;
+
+	ApplyViewCamera(mainView, mainProjection, mainPosition);
+	m_currentReflectionProbe = -2;
+}
+
+/***********************************************************
+ *  CaptureStaticProbe()
+ *
+ *  This method is used for rendering the static shapes into
+ *  every face of the cached map of a probe.  When the views
+ *  can be drawn together, the six faces are drawn in one
+ *  pass with each instance sent to its own face as a layer.
+ ***********************************************************/
+void SceneManager::CaptureStaticProbe(int probe)
+{
+	const glm::vec3& position = m_pReflectionProbes->GetPosition(probe);
+
+	if (NULL != m_pMultiViewRenderer)
+	{
+		m_pReflectionProbes->BeginStaticPass(probe, -1);
+		m_pShaderManager->setIntValue("viewCount", ReflectionProbes::FACE_COUNT);
+		m_pShaderManager->setBoolValue("bLayeredViews", true);
+		for (int face = 0; face < ReflectionProbes::FACE_COUNT; face++)
+		{
+			std::string index = "[" + std::to_string(face) + "]";
+
+			m_pShaderManager->setMat4Value("viewMatrices" + index, m_pReflectionProbes->GetFaceView(probe, face));
+			m_pShaderManager->setMat4Value("projectionMatrices" + index, m_pReflectionProbes->GetFaceProjection());
+			m_pShaderManager->setVec3Value("viewPositions" + index, position);
+		}
+		DrawProbeShapes(probe, false, ReflectionProbes::FACE_COUNT);
+		m_pShaderManager->setIntValue("viewCount", 0);
+		m_pShaderManager->setBoolValue("bLayeredViews", false);
+		m_pReflectionProbes->EndPass();
+		return;
+	}
+
+	for (int face = 0; face < ReflectionProbes::FACE_COUNT; face++)
+	{
+		m_pReflectionProbes->BeginStaticPass(probe, face);
+		ApplyViewCamera(
+			m_pReflectionProbes->GetFaceView(probe, face),
+			m_pReflectionProbes->GetFaceProjection(),
+			position);
+		DrawProbeShapes(probe, false, 0);
+		m_pReflectionProbes->EndPass();
+	}
+}
+
+/***********************************************************
+ *  DrawProbeShapes()
+ *
+ *  This method is used for drawing the static or the moving
+ *  shapes into a probe face, opaque first and then blended.
+ *  The shapes reflecting this probe surround it, so they are
+ *  left out.  With a view count the captured meshes are
+ *  drawn once per view.
+ ***********************************************************/
+void SceneManager::DrawProbeShapes(int probe, bool bDynamic, int viewCount)
+{
+	for (int pass = 0; pass < 2; pass++)
+	{
+		bool bTransparentPass = (pass == 1);
+
+		m_pStateCache->SetBlend(bTransparentPass);
+		m_pStateCache->SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		m_pStateCache->SetDepthMask(!bTransparentPass);
+		for (int i = 0; i < (int)m_drawCommands.size(); i++)
+		{
+			const DRAW_COMMAND& command = m_drawCommands[i];
+
+			if ((command.bDynamic != bDynamic) ||
+				(command.bTransparent != bTransparentPass) ||
+				(command.reflectionProbe == probe))
+			{
+				continue;
+			}
+
+			ApplyDrawCommand(command);
+			if (viewCount > 0)
+			{
+				m_pMultiViewRenderer->DrawMesh(command.shape, viewCount);
+			}
+			else
+			{
+				DrawShapeMesh(command.shape);
+			}
+		}
+	}
+	m_pStateCache->SetBlend(false);
+	m_pStateCache->SetDepthMask(true);
+}
+
+/***********************************************************
+ *  DrawDepthPrepass()
+ *
+ *  This method is used for filling the depth buffer with the
+ *  opaque shapes using a shader that only transforms the
+ *  vertex positions, with color writes masked off.
+ ***********************************************************/
+void SceneManager::DrawDepthPrepass(const std::vector<std::pair<float, int>>& opaqueOrder)
+{
+	m_pStateCache->UseProgram(m_pDepthShader->m_programID);
+	m_pDepthShader->setMat4Value("view", m_viewMatrix);
+	m_pDepthShader->setMat4Value("projection", m_projectionMatrix);
+
+	m_pStateCache->SetColorMask(false);
+	m_pStateCache->SetDepthMask(true);
+	m_pStateCache->SetDepthFunc(GL_LESS);
+
+	for (int i = 0; i < (int)opaqueOrder.size(); i++)
+	{
+		m_pDepthShader->setMat4Value(g_ModelName, m_drawCommands[opaqueOrder[i].second].model);
+		DrawShapeMesh(m_drawCommands[opaqueOrder[i].second].shape);
+	}
+
+	m_pStateCache->SetColorMask(true);
+	m_pStateCache->UseProgram(m_pShaderManager->m_programID);
+}
+
+/***********************************************************
+ *  BeginOverdrawQuery()
+ *
+ *  This method is used for starting the count of fragments
+ *  shaded by the opaque pass.  The query issued on the
+ *  previous frame is read back here if the result is ready,
+ *  so the count never stalls the pipeline.
+ ***********************************************************/
+void SceneManager::BeginOverdrawQuery()
+{
+	int current = m_overdrawFrame % 2;
+	int previous = 1 - current;
+	GLint viewport[4];
+
+	if (0 == m_overdrawQueries[0])
+	{
+		glGenQueries(2, m_overdrawQueries);
+	}
+
+	if (m_overdrawFrame > 0)
+	{
+		GLint bAvailable = 0;
+		glGetQueryObjectiv(m_overdrawQueries[previous], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+		if (bAvailable != 0)
+		{
+			GLuint samples = 0;
+			glGetQueryObjectuiv(m_overdrawQueries[previous], GL_QUERY_RESULT, &samples);
+			m_totalShadedSamples += samples;
+			m_totalPixels += m_overdrawPixels[previous];
+		}
+	}
+
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	m_overdrawPixels[current] = viewport[2] * viewport[3];
+	glBeginQuery(GL_SAMPLES_PASSED, m_overdrawQueries[current]);
+}
+
+/***********************************************************
+ *  EndOverdrawQuery()
+ *
+ *  This method is used for stopping the count of fragments
+ *  shaded by the opaque pass.
+ ***********************************************************/
+void SceneManager::EndOverdrawQuery()
+{
+	glEndQuery(GL_SAMPLES_PASSED);
+	m_overdrawFrame++;
+}
+
+/***********************************************************
+ *  ApplyDrawCommand()
+ *
+ *  This method is used for sending the settings of a queued
+ *  draw into the shader.  Texture and material values that
+ *  have not changed since the previous draw are not uploaded
+ *  again.
+ ***********************************************************/
+void SceneManager::ApplyDrawCommand(const DRAW_COMMAND& command)
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	m_pShaderManager->setMat4Value(g_ModelName, command.model);
+
+	if (command.bUseTexture == true)
+	{
+		// the texture itself stays bound to its slot from BindGLTextures()
+		if (m_currentUseTexture != 1)
+		{
+			m_pShaderManager->setIntValue(g_UseTextureName, true);
+			m_currentUseTexture = 1;
+		}
+		if (m_currentTextureSlot != command.textureSlot)
+		{
+			m_pShaderManager->setSampler2DValue(g_TextureValueName, command.textureSlot);
+			m_currentTextureSlot = command.textureSlot;
+		}
+	}
+	else if (m_currentUseTexture != 0)
+	{
+		m_pShaderManager->setIntValue(g_UseTextureName, false);
+		m_currentUseTexture = 0;
+	}
+
+	m_pShaderManager->setVec4Value(g_ColorValueName, command.color);
+	if (m_currentTint != command.tint)
+	{
+		m_pShaderManager->setVec3Value("materialTint", command.tint);
+		m_currentTint = command.tint;
+	}
+	m_pShaderManager->setVec2Value("UVscale", command.UVscale);
+
+	if ((command.materialIndex >= 0) && (m_currentMaterialIndex != command.materialIndex))
+	{
+		const OBJECT_MATERIAL& material = m_objectMaterials[command.materialIndex];
+
+		m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
+		m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
+		m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+		m_pShaderManager->setFloatValue("material.reflectivity", material.reflectivity);
+		m_currentMaterialIndex = command.materialIndex;
+	}
+
+	// no shape samples the probes while they are being drawn
+	int reflectionProbe = (m_bCapturingReflections == true) ? -1 : command.reflectionProbe;
+	if (m_currentReflectionProbe != reflectionProbe)
+	{
+		if (reflectionProbe >= 0)
+		{
+			m_pReflectionProbes->BindEnvironmentMap(reflectionProbe);
+		}
+		m_pShaderManager->setBoolValue("bUseReflection", reflectionProbe >= 0);
+		m_currentReflectionProbe = reflectionProbe;
+	}
+
+	if (m_currentLightmapIndex != command.lightmapIndex)
+	{
+		if ((command.lightmapIndex >= 0) && (NULL != m_pLightmapBaker))
+		{
+			const LightmapBaker::LIGHTMAP_RECT& lightmapRect = m_pLightmapBaker->GetObjectRect(command.lightmapIndex);
+			glm::vec3 boundsMin;
+			glm::vec3 boundsMax;
+
+			SceneBVH::GetShapeBounds(command.shape, boundsMin, boundsMax);
+			m_pShaderManager->setBoolValue("bUseLightmap", true);
+			m_pShaderManager->setVec4Value("lightmapRect", lightmapRect.rect);
+			m_pShaderManager->setFloatValue("lightmapBorder", lightmapRect.border);
+			m_pShaderManager->setVec3Value("lightmapBoundsMin", boundsMin);
+			m_pShaderManager->setVec3Value("lightmapBoundsMax", boundsMax);
+		}
+		else
+		{
+			m_pShaderManager->setBoolValue("bUseLightmap", false);
+		}
+		m_currentLightmapIndex = command.lightmapIndex;
+	}
+
+	bool bSameLights = (m_currentPointLightCount == command.pointLightCount);
+	for (int i = 0; (i < command.pointLightCount) && (bSameLights == true); i++)
+	{
+		bSameLights = (m_currentPointLightIndices[i] == command.pointLightIndices[i]);
+	}
+	if (bSameLights == false)
+	{
+		m_pShaderManager->setIntValue("pointLightCount", command.pointLightCount);
+		for (int i = 0; i < command.pointLightCount; i++)
+		{
+			m_pShaderManager->setIntValue(g_PointLightIndexNames[i], command.pointLightIndices[i]);
+			m_currentPointLightIndices[i] = command.pointLightIndices[i];
+		}
+		m_currentPointLightCount = command.pointLightCount;
+	}
+
+	// shapes without a lightmap block take their light from the
+	// probes, blended at the origin of the shape
+	int useProbeLight = ((command.lightmapIndex < 0) && (NULL != m_pIrradianceProbes)) ? 1 : 0;
+	if (useProbeLight == 1)
+	{
+		glm::vec3 coefficients[IrradianceProbes::SH_COEFFICIENTS];
+
+		m_pIrradianceProbes->Sample(glm::vec3(command.model[3]), coefficients);
+		for (int i = 0; i < IrradianceProbes::SH_COEFFICIENTS; i++)
+		{
+			m_pShaderManager->setVec3Value(g_ProbeIrradianceNames[i], coefficients[i]);
+		}
+	}
+	if (m_currentUseProbeLight != useProbeLight)
+	{
+		m_pShaderManager->setBoolValue("bUseProbeLight", useProbeLight == 1);
+		m_currentUseProbeLight = useProbeLight;
+	}
+}
+
+/***********************************************************
+ *  DrawShapeMesh()
+ *
+ *  This method is used for drawing the mesh of a basic shape.
+ ***********************************************************/
+void SceneManager::DrawShapeMesh(SHAPE_TYPE shape)
+{
+	switch (shape)
+	{
+	case SHAPE_BOX:
+		m_basicMeshes->DrawBoxMesh();
+		break;
+	case SHAPE_CONE:
+		m_basicMeshes->DrawConeMesh();
+		break;
+	case SHAPE_CYLINDER:
+		m_basicMeshes->DrawCylinderMesh();
+		break;
+	case SHAPE_PLANE:
+		m_basicMeshes->DrawPlaneMesh();
+		break;
+	case SHAPE_PRISM:
+		m_basicMeshes->DrawPrismMesh();
+		break;
+	case SHAPE_PYRAMID4:
+		m_basicMeshes->DrawPyramid4Mesh();
+		break;
+	case SHAPE_SPHERE:
+		m_basicMeshes->DrawSphereMesh();
+		break;
+	case SHAPE_TAPERED_CYLINDER:
+		m_basicMeshes->DrawTaperedCylinderMesh();
+		break;
+	case SHAPE_TORUS:
+		m_basicMeshes->DrawTorusMesh();
+		break;
+	}
+}
+
+/***********************************************************
+ *  SetTransparencyMode()
+ *
+ *  This method is used for selecting how transparent shapes
+ *  are blended.  Weighted blended transparency needs no
+ *  sorting, so its cost does not depend on how the
+ *  transparent shapes overlap.
+ ***********************************************************/
+void SceneManager::SetTransparencyMode(TRANSPARENCY_MODE mode)
+{
+	if ((mode == TRANSPARENCY_WEIGHTED_OIT) && (NULL == m_pOITManager))
+	{
+		m_pOITManager = new OITManager(m_pStateCache);
+		if (m_pOITManager->Initialize() == false)
+		{
+			// keep sorted blending when the composite shader is missing
+			delete m_pOITManager;
+			m_pOITManager = NULL;
+			return;
+		}
+		// the composite shader was made current while loading
+		m_pStateCache->Invalidate();
+		m_pStateCache->UseProgram(m_pShaderManager->m_programID);
+	}
+
+	m_transparencyMode = mode;
+}
+
+/***********************************************************
+ *  SetShadows()
+ *
+ *  This method is used for enabling or disabling shadows
+ *  from the directional light.
+ ***********************************************************/
+void SceneManager::SetShadows(bool bEnable)
+{
+	if ((bEnable == true) && (NULL == m_pShadowManager))
+	{
+		m_pShadowManager = new ShadowManager(m_pStateCache);
+		if (m_pShadowManager->Initialize(SHADOW_MAP_RESOLUTION) == false)
+		{
+			delete m_pShadowManager;
+			m_pShadowManager = NULL;
+			return;
+		}
+		// the shadow shader was made current while loading
+		m_pStateCache->Invalidate();
+		m_pStateCache->UseProgram(m_pShaderManager->m_programID);
+		// force the cached map to be rendered on the next frame
+		m_staticShadowHash = 0;
+	}
+	else if ((bEnable == false) && (NULL != m_pShadowManager))
+	{
+		delete m_pShadowManager;
+		m_pShadowManager = NULL;
+	}
+
+	m_pShaderManager->setBoolValue("bUseShadows", bEnable && (NULL != m_pShadowManager));
+}
+
+/***********************************************************
+ *  SetLightmaps()
+ *
+ *  This method is used for enabling or disabling baked light
+ *  for the static shapes.  The bake runs on the next frame,
+ *  once the shapes of the scene have been queued.
+ ***********************************************************/
+void SceneManager::SetLightmaps(bool bEnable)
+{
+	m_bLightmaps = bEnable;
+	m_currentLightmapIndex = -2;
+	m_pShaderManager->setBoolValue("bUseLightmap", false);
+}
+
+/***********************************************************
+ *  SetIrradianceProbes()
+ *
+ *  This method is used for enabling or disabling the probe
+ *  light for the shapes that are not in the lightmap.  The
+ *  probes are baked from the same shapes and lights, so the
+ *  lightmap is enabled along with them.
+ ***********************************************************/
+void SceneManager::SetIrradianceProbes(bool bEnable)
+{
+	m_bIrradianceProbes = bEnable;
+	if (bEnable == true)
+	{
+		SetLightmaps(true);
+	}
+	else if (NULL != m_pIrradianceProbes)
+	{
+		delete m_pIrradianceProbes;
+		m_pIrradianceProbes = NULL;
+	}
+	m_currentUseProbeLight = -1;
+}
+
+/***********************************************************
+ *  SetDepthPrepass()
+ *
+ *  This method is used for enabling or disabling the depth
+ *  pre-pass.  The pre-pass costs a second transform of the
+ *  opaque shapes but lights each pixel only once, so it pays
+ *  off when GetAverageOverdraw() is well above one.
+ ***********************************************************/
+void SceneManager::SetDepthPrepass(bool bEnable)
+{
+	if ((bEnable == true) && (NULL == m_pDepthShader))
+	{
+		m_pDepthShader = new ShaderManager();
+		m_pDepthShader->LoadShaders(
+			"shaders/depthVertexShader.glsl",
+			"shaders/depthFragmentShader.glsl");
+		if (0 == m_pDepthShader->m_programID)
+		{
+			std::cout << "Could not load the depth pre-pass shader" << std::endl;
+			delete m_pDepthShader;
+			m_pDepthShader = NULL;
+			return;
+		}
+		// the depth shader was made current while loading
+		m_pStateCache->Invalidate();
+		m_pStateCache->UseProgram(m_pShaderManager->m_programID);
+	}
+
+	m_bDepthPrepass = bEnable;
+}
+
+/***********************************************************
+ *  SetDebugView()
+ *
+ *  This method is used for replacing the lit scene with one
+ *  of the heatmaps of DebugViewRenderer, to see where large
+ *  surfaces and overlapping shapes cost fill rate.
+ ***********************************************************/
+void SceneManager::SetDebugView(DebugViewRenderer::DEBUG_VIEW view)
+{
+	if ((view != DebugViewRenderer::DEBUG_VIEW_NONE) && (NULL == m_pDebugViewRenderer))
+	{
+		m_pDebugViewRenderer = new DebugViewRenderer(m_pStateCache);
+		if (m_pDebugViewRenderer->Initialize() == false)
+		{
+			// keep drawing the lit scene when the shader is missing
+			delete m_pDebugViewRenderer;
+			m_pDebugViewRenderer = NULL;
+			return;
+		}
+		// the heatmap shader was made current while loading
+		m_pStateCache->Invalidate();
+		m_pStateCache->UseProgram(m_pShaderManager->m_programID);
+	}
+
+	m_debugView = view;
 }
 
 /***********************************************************
- *  BindGLTextures()
+ *  SetSnow()
  *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
+ *  This method is used for enabling or disabling the falling
+ *  snow.  The flakes fall over the ground plane from above
+ *  the top of the tree and are drawn as a single object.
  ***********************************************************/
-void SceneManager::BindGLTextures()
+void SceneManager::SetSnow(bool bEnable, int flakeCount)
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	if (NULL != m_pSnowParticles)
+	{
+		delete m_pSnowParticles;
+		m_pSnowParticles = NULL;
+	}
+	if (bEnable == false)
+	{
+		return;
+	}
+
+	m_pSnowParticles = new SnowParticles(m_pStateCache);
+	m_pSnowParticles->SetEmitterBounds(
+		glm::vec3(-20.0f, 0.0f, -10.0f),
+		glm::vec3(20.0f, 18.0f, 10.0f));
+	if (m_pSnowParticles->Initialize(flakeCount) == false)
 	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		delete m_pSnowParticles;
+		m_pSnowParticles = NULL;
 	}
+	// the snow shader was made current while loading
+	m_pStateCache->Invalidate();
+	m_pStateCache->UseProgram(m_pShaderManager->m_programID);
+	m_lastSnowUpdate = std::chrono::steady_clock::now();
 }
 
 /***********************************************************
- *  DestroyGLTextures()
+ *  SetAnimation()
  *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
+ *  This method is used for enabling or disabling the
+ *  keyframed animation of the scene objects.  The animated
+ *  shapes are drawn as moving shapes while it is on.
  ***********************************************************/
-void SceneManager::DestroyGLTextures()
+void SceneManager::SetAnimation(bool bEnable)
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	if (NULL != m_pAnimationSystem)
+	{
+		delete m_pAnimationSystem;
+		m_pAnimationSystem = NULL;
+	}
+	if (bEnable == false)
 	{
-		glGenTextures(1, &m_textureIDs[i].ID);
+		return;
 	}
+
+	if (NULL == m_pTransformStore)
+	{
+		m_pTransformStore = new TransformStore();
+	}
+	m_pAnimationSystem = new AnimationSystem(m_pTransformStore);
+	SetupSceneAnimation();
+	m_animationStart = std::chrono::steady_clock::now();
 }
 
 /***********************************************************
- *  FindTextureID()
+ *  SetPhysics()
  *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for enabling or disabling the rigid
+ *  bodies dropped onto the scene.  The bodies write their
+ *  transforms into the same store as the animation.
  ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
+void SceneManager::SetPhysics(bool bEnable)
 {
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
+	if (NULL != m_pPhysicsWorld)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
+		delete m_pPhysicsWorld;
+		m_pPhysicsWorld = NULL;
+	}
+	if (bEnable == false)
+	{
+		return;
 	}
 
-	return(textureID);
+	if (NULL == m_pTransformStore)
+	{
+		m_pTransformStore = new TransformStore();
+	}
+	m_pPhysicsWorld = new PhysicsWorld(m_pTransformStore);
+	SetupScenePhysics();
+	m_lastPhysicsUpdate = std::chrono::steady_clock::now();
 }
 
 /***********************************************************
- *  FindTextureSlot()
+ *  SetMultiView()
  *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for enabling or disabling drawing all
+ *  of the viewports in a single pass.  Every basic mesh is
+ *  captured once for instanced drawing.  When the driver
+ *  cannot pick the viewport in the vertex shader the
+ *  viewports are drawn one at a time as before.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+void SceneManager::SetMultiView(bool bEnable)
 {
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
+	if (NULL != m_pMultiViewRenderer)
+	{
+		delete m_pMultiViewRenderer;
+		m_pMultiViewRenderer = NULL;
+	}
+	if (bEnable == false)
+	{
+		return;
+	}
+	if (MultiViewRenderer::IsSupported() == false)
+	{
+		std::cout << "Single pass views are not supported - drawing the viewports one at a time" << std::endl;
+		return;
+	}
 
-	while ((index < m_loadedTextures) && (bFound == false))
+	bool bCaptured = true;
+	m_pMultiViewRenderer = new MultiViewRenderer(m_pStateCache);
+	if (m_pMultiViewRenderer->Initialize() == true)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		for (int shape = SHAPE_BOX; shape <= SHAPE_TORUS; shape++)
 		{
-			textureSlot = index;
-			bFound = true;
+			bCaptured = bCaptured && m_pMultiViewRenderer->CaptureMesh(shape,
+				[this, shape]() { DrawShapeMesh((SHAPE_TYPE)shape); });
 		}
-		else
-			index++;
 	}
+	else
+	{
+		bCaptured = false;
+	}
+	m_pStateCache->UseProgram(m_pShaderManager->m_programID);
 
-	return(textureSlot);
+	if (bCaptured == false)
+	{
+		delete m_pMultiViewRenderer;
+		m_pMultiViewRenderer = NULL;
+	}
 }
 
 /***********************************************************
- *  FindMaterial()
+ *  SetReflections()
  *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
+ *  This method is used for enabling or disabling the
+ *  environment reflections of the reflective materials.
+ *  The probes are captured on the next frame, once the
+ *  shapes of the scene have been queued.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+void SceneManager::SetReflections(bool bEnable)
 {
-	if (m_objectMaterials.size() == 0)
+	if (NULL != m_pReflectionProbes)
 	{
-		return(false);
+		delete m_pReflectionProbes;
+		m_pReflectionProbes = NULL;
 	}
-
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
+	m_currentReflectionProbe = -2;
+	if (bEnable == false)
 	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
+		return;
 	}
 
-	return(true);
+	m_pReflectionProbes = new ReflectionProbes(m_pStateCache);
+	if (m_pReflectionProbes->Initialize(REFLECTION_PROBE_RESOLUTION) == false)
+	{
+		std::cout << "Could not create the reflection probe frame buffers" << std::endl;
+		delete m_pReflectionProbes;
+		m_pReflectionProbes = NULL;
+		return;
+	}
+	SetupSceneReflections();
+	// force the probes to be captured on the next frame
+	m_reflectionHash = 0;
 }
 
 /***********************************************************
- *  SetTransformations()
+ *  SetFixedFrameTime()
  *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
+ *  This method is used for making the moving parts of the
+ *  scene repeat exactly from run to run.  The animation
+ *  starts over and it, the rigid bodies and the snow all
+ *  move on by the same time every frame, however long the
+ *  frame really took.
  ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
+void SceneManager::SetFixedFrameTime(float frameTime)
 {
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
+	m_fixedFrameTime = std::max(frameTime, 0.0f);
+	m_fixedAnimationTime = 0.0f;
 
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationZ * rotationY * rotationX * scale;
+	// the clock starts again from now when it is followed
+	m_animationStart = std::chrono::steady_clock::now();
+	m_lastPhysicsUpdate = m_animationStart;
+	m_lastSnowUpdate = m_animationStart;
+}
 
-	if (NULL != m_pShaderManager)
+/***********************************************************
+ *  GetAverageOverdraw()
+ *
+ *  This method is used for getting the average number of
+ *  fragments the opaque pass has shaded per pixel.  A value
+ *  of one means every pixel was lit exactly once.
+ ***********************************************************/
+float SceneManager::GetAverageOverdraw() const
+{
+	if (m_totalPixels <= 0.0)
 	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+		return(0.0f);
 	}
+
+	return((float)(m_totalShadedSamples / m_totalPixels));
 }
 
 /***********************************************************
- *  SetShaderColor()
+ *  UpdateSceneBVH()
  *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
+ *  This method is used for building the ray query tree over
+ *  the queued shapes.  The tree is only built again when a
+ *  hash of the shapes and their transforms has changed.
  ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
+void SceneManager::UpdateSceneBVH()
 {
-	// variables for this method
-	glm::vec4 currentColor;
+	uint64_t sceneHash = 14695981039346656037ULL;
 
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
+	for (int i = 0; i < (int)m_drawCommands.size(); i++)
+	{
+		sceneHash = HashBytes(sceneHash, &m_drawCommands[i].model, sizeof(glm::mat4));
+		sceneHash = HashBytes(sceneHash, &m_drawCommands[i].shape, sizeof(SHAPE_TYPE));
+	}
 
-	if (NULL != m_pShaderManager)
+	if (NULL == m_pSceneBVH)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+		m_pSceneBVH = new SceneBVH();
+	}
+	else if (sceneHash == m_sceneBVHHash)
+	{
+		return;
+	}
+
+	// instances are added in queue order so an instance index
+	// is also the index of the queued shape
+	m_pSceneBVH->Clear();
+	for (int i = 0; i < (int)m_drawCommands.size(); i++)
+	{
+		m_pSceneBVH->AddInstance(m_drawCommands[i].shape, m_drawCommands[i].model);
 	}
+	m_pSceneBVH->Build();
+	m_sceneBVHHash = sceneHash;
 }
 
 /***********************************************************
- *  SetShaderTexture()
+ *  GetSceneBVH()
  *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
+ *  This method is used for getting the ray query tree over
+ *  the shapes queued by the last rendered frame.
  ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
+const SceneBVH* SceneManager::GetSceneBVH()
+{
+	UpdateSceneBVH();
+	return(m_pSceneBVH);
+}
+
+/***********************************************************
+ *  PickObject()
+ *
+ *  This method is used for selecting the queued shape that a
+ *  ray hits first.  The tree skips the shapes whose boxes
+ *  the ray misses and the rest are intersected with the
+ *  exact shape, so no frame buffer readback is needed.  The
+ *  picked shape is reported and tinted from the next frame.
+ ***********************************************************/
+int SceneManager::PickObject(const glm::vec3& origin, const glm::vec3& direction)
 {
-	if (NULL != m_pShaderManager)
+	SceneBVH::RAY_HIT hit;
+
+	UpdateSceneBVH();
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	bool bHit = m_pSceneBVH->Intersect(origin, direction, 1.0e30f, hit);
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+
+	if (bHit == false)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
+		std::cout << "Picked nothing in " << elapsed.count() << " ms" << std::endl;
+		m_selectedObject = -1;
+		return(-1);
+	}
 
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+	const DRAW_COMMAND& command = m_drawCommands[hit.instance];
+	std::cout << "Picked object " << hit.instance << " - " << g_ShapeNames[command.shape];
+	if ((command.bUseTexture == true) && (command.textureSlot >= 0))
+	{
+		std::cout << ", texture \"" << m_textureIDs[command.textureSlot].tag << "\"";
+	}
+	if (command.materialIndex >= 0)
+	{
+		std::cout << ", material \"" << m_objectMaterials[command.materialIndex].tag << "\"";
 	}
+	std::cout << ", at (" << hit.position.x << ", " << hit.position.y << ", " << hit.position.z
+		<< ") in " << elapsed.count() << " ms" << std::endl;
+
+	m_selectedObject = hit.instance;
+	return(hit.instance);
 }
 
 /***********************************************************
- *  SetTextureUVScale()
+ *  SetCameraView()
  *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
+ *  This method is used for setting the camera that the
+ *  queued draws are ordered against.
  ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
+void SceneManager::SetCameraView(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& viewPosition)
 {
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+	m_viewPosition = viewPosition;
 }
 
 /***********************************************************
- *  SetShaderMaterial()
+ *  AddViewport()
  *
- *  This method is used for passing the material values
- *  into the shader.
+ *  This method is used for adding a view drawn into part of
+ *  the window from the same queued shapes.  With no added
+ *  viewports the main camera fills the window.
  ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+void SceneManager::AddViewport(const VIEWPORT_CAMERA& viewport)
 {
-	if (m_objectMaterials.size() > 0)
-	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
+	m_viewports.push_back(viewport);
+}
 
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
-	}
+/***********************************************************
+ *  ApplyViewCamera()
+ *
+ *  This method is used for switching the camera the shapes
+ *  are drawn with - the only state sent again between the
+ *  viewports of a frame.
+ ***********************************************************/
+void SceneManager::ApplyViewCamera(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& viewPosition)
+{
+	SetCameraView(view, projection, viewPosition);
+	m_pShaderManager->setMat4Value("view", view);
+	m_pShaderManager->setMat4Value("projection", projection);
+	m_pShaderManager->setVec3Value("viewPosition", viewPosition);
 }
 
 /**************************************************************/
@@ -455,6 +2522,7 @@ void SceneManager::DefineObjectMaterials()
 	bronzeMaterial.diffuseColor = glm::vec3(0.714f, 0.4284f, 0.1814f);
 	bronzeMaterial.specularColor = glm::vec3(0.393548f, 0.271906f, 0.166721f);
 	bronzeMaterial.shininess = 20.0;
+	bronzeMaterial.reflectivity = 0.0f;
 	bronzeMaterial.tag = "sand";
 
 	m_objectMaterials.push_back(bronzeMaterial);
@@ -463,6 +2531,7 @@ void SceneManager::DefineObjectMaterials()
 	silverMaterial.diffuseColor = glm::vec3();
 	silverMaterial.specularColor = glm::vec3();
 	silverMaterial.shininess = 52.0;
+	silverMaterial.reflectivity = 0.6f;
 	silverMaterial.tag = "silver";
 
 	m_objectMaterials.push_back(silverMaterial);
@@ -471,6 +2540,7 @@ void SceneManager::DefineObjectMaterials()
 	pearlMaterial.diffuseColor = glm::vec3(1.0f, 0.829f, 0.829f);
 	pearlMaterial.specularColor = glm::vec3(0.296648f, 0.296648f, 0.296648f);
 	pearlMaterial.shininess = 25.0;
+	pearlMaterial.reflectivity = 0.15f;
 	pearlMaterial.tag = "pearl";
 
 	m_objectMaterials.push_back(pearlMaterial);
@@ -479,6 +2549,7 @@ void SceneManager::DefineObjectMaterials()
 	copperMaterial.diffuseColor = glm::vec3(0.7038f, 0.27048f, 0.0828f);
 	copperMaterial.specularColor = glm::vec3(0.256777f, 0.137622f, 0.086014f);
 	copperMaterial.shininess = 10.0;
+	copperMaterial.reflectivity = 0.0f;
 	copperMaterial.tag = "carrot";
 
 	m_objectMaterials.push_back(copperMaterial);
@@ -487,6 +2558,7 @@ void SceneManager::DefineObjectMaterials()
 	blackMaterial.diffuseColor = glm::vec3(0.01f, 0.01f, 0.01f);
 	blackMaterial.specularColor = glm::vec3(0.50f, 0.50f, 0.50f);
 	blackMaterial.shininess = 25.0;
+	blackMaterial.reflectivity = 0.0f;
 	blackMaterial.tag = "hat";
 
 	m_objectMaterials.push_back(blackMaterial);
@@ -496,6 +2568,7 @@ void SceneManager::DefineObjectMaterials()
 	woodMaterial.diffuseColor = glm::vec3(0.2f, 0.2f, 0.2f);
 	woodMaterial.specularColor = glm::vec3(0.0f, 0.0f, 0.0f);
 	woodMaterial.shininess = 0.1;
+	woodMaterial.reflectivity = 0.0f;
 	woodMaterial.tag = "tree";
 
 	m_objectMaterials.push_back(woodMaterial);
@@ -504,6 +2577,7 @@ void SceneManager::DefineObjectMaterials()
 	redPlastic.diffuseColor = glm::vec3(0.5f, 0.0f, 0.0f);
 	redPlastic.specularColor = glm::vec3(0.7f, 0.6f, 0.6f);
 	redPlastic.shininess = 0.25;
+	redPlastic.reflectivity = 0.0f;
 	redPlastic.tag = "gift";
 
 	m_objectMaterials.push_back(redPlastic);
@@ -512,6 +2586,7 @@ void SceneManager::DefineObjectMaterials()
 	turqMaterial.diffuseColor = glm::vec3(0.396f, 0.74151f, 0.69102f);
 	turqMaterial.specularColor = glm::vec3(0.297254f, 0.30829f, 0.306678f);
 	turqMaterial.shininess = 25.0;
+	turqMaterial.reflectivity = 0.35f;
 	turqMaterial.tag = "ornament";
 
 	m_objectMaterials.push_back(turqMaterial);
@@ -520,6 +2595,7 @@ void SceneManager::DefineObjectMaterials()
 	goldMaterial.diffuseColor = glm::vec3(0.75164f, 0.60648f, 0.22648f);
 	goldMaterial.specularColor = glm::vec3(0.628281f, 0.555802f, 0.366065f);
 	goldMaterial.shininess = 50.0;
+	goldMaterial.reflectivity = 0.0f;
 	goldMaterial.tag = "lights";
 
 	m_objectMaterials.push_back(goldMaterial);
@@ -537,35 +2613,37 @@ void SceneManager::SetupSceneLights()
 	m_pShaderManager->setBoolValue(g_UseLightingName, true);
 
 	//directional light
-	m_pShaderManager->setVec3Value("directionalLight.direction", -13.0f, 17.0f, -7.0f);
-	m_pShaderManager->setVec3Value("directionalLight.ambient", 1.0f, 1.0f, 1.0f);
+	SetupDirectionalLight(
+		glm::vec3(-13.0f, 17.0f, -7.0f),
+		glm::vec3(1.0f, 1.0f, 1.0f),
+		glm::vec3(0.6f, 0.6f, 0.6f),
+		glm::vec3(0.2f, 0.2f, 0.2f));
 	m_pShaderManager->setVec4Value("directionalLight.ambientColor", 0.373f, 0.5431, 0.91f, 1.0f);
-	m_pShaderManager->setVec3Value("directionalLight.diffuse", 0.6f, 0.6f, 0.6f);
-	m_pShaderManager->setVec3Value("directionalLight.specular", 0.2f, 0.2f, 0.2f);
-	m_pShaderManager->setBoolValue("directionalLight.bActive", true);
 
 
 	//point light 1
-	m_pShaderManager->setVec3Value("pointLights[0].position", 7.0f,5.0f, 0.0f);
-	m_pShaderManager->setVec3Value("pointLights[0].ambient", 0.05f, 0.05f, 0.05f);
-	m_pShaderManager->setVec3Value("pointLights[0].diffuse", 0.3f, 0.3f, 0.3f);
-	m_pShaderManager->setVec3Value("pointLights[0].specular", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setBoolValue("pointLights[0].bActive", true);
+	SetupPointLight(0,
+		glm::vec3(7.0f, 5.0f, 0.0f),
+		glm::vec3(0.05f, 0.05f, 0.05f),
+		glm::vec3(0.3f, 0.3f, 0.3f),
+		glm::vec3(0.1f, 0.1f, 0.1f),
+		20.0f);
 	
 	//point light 2
-	m_pShaderManager->setVec3Value("pointLights[1].position", 6.0f, 4.5f, -8.0f);
-	m_pShaderManager->setVec3Value("pointLights[1].ambient", 0.05f, 0.05f, 0.05f);
-	m_pShaderManager->setVec3Value("pointLights[1].diffuse", 0.06f, 0.06f, 0.06f);
-	m_pShaderManager->setVec3Value("pointLights[1].specular", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setBoolValue("pointLights[1].bActive", true);
-
-	//point light 3
-	m_pShaderManager->setVec3Value("pointLights[2].position", -1.0f, 4.5f, 0.75f);
-	m_pShaderManager->setVec3Value("pointLights[2].ambient", 0.05f, 0.05f, 0.05f);
-	m_pShaderManager->setVec3Value("pointLights[2].ambientColor", 0.7134f, 0.348f, 0.87f); 
-	m_pShaderManager->setVec3Value("pointLights[2].diffuse", 0.06f, 0.06f, 0.06f);
-	m_pShaderManager->setVec3Value("pointLights[2].specular", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setBoolValue("pointLights[2].bActive", true);
+	SetupPointLight(1,
+		glm::vec3(6.0f, 4.5f, -8.0f),
+		glm::vec3(0.05f, 0.05f, 0.05f),
+		glm::vec3(0.06f, 0.06f, 0.06f),
+		glm::vec3(0.1f, 0.1f, 0.1f),
+		12.0f);
+
+	//point light 3, with a purple ambient
+	SetupPointLight(2,
+		glm::vec3(-1.0f, 4.5f, 0.75f),
+		glm::vec3(0.7134f, 0.348f, 0.87f),
+		glm::vec3(0.06f, 0.06f, 0.06f),
+		glm::vec3(0.1f, 0.1f, 0.1f),
+		12.0f);
 	
 
 	
@@ -575,6 +2653,196 @@ void SceneManager::SetupSceneLights()
 	
 
 
+}
+
+/***************************************************************
+*  SetupSceneAnimation()
+*
+*  This method is called to add the animated nodes and their
+*  keyframed tracks - the ornaments sway, the tree lights
+*  twinkle, and the moon slowly turns and bobs.
+****************************************************************/
+void SceneManager::SetupSceneAnimation()
+{
+	const glm::vec3 swayAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	const glm::vec3 moonAxis = glm::vec3(0.0f, 1.0f, 0.0f);
+	const glm::vec4 brightTint = glm::vec4(1.4f, 1.4f, 1.4f, 1.0f);
+	const glm::vec4 dimTint = glm::vec4(0.35f, 0.35f, 0.35f, 1.0f);
+	int node;
+	int track;
+
+	//ornaments swing back and forth, each at its own pace
+	for (int i = 0; i < 5; i++)
+	{
+		float period = 2.4f + 0.35f * (float)i;
+
+		node = AddTransformNode("ornament" + std::to_string(i));
+		track = m_pAnimationSystem->AddTrack(node, TransformStore::CHANNEL_ROTATION, true);
+		m_pAnimationSystem->AddKeyframe(track, 0.0f, AnimationSystem::AxisAngle(swayAxis, -12.0f));
+		m_pAnimationSystem->AddKeyframe(track, 0.5f * period, AnimationSystem::AxisAngle(swayAxis, 12.0f));
+		m_pAnimationSystem->AddKeyframe(track, period, AnimationSystem::AxisAngle(swayAxis, -12.0f));
+	}
+
+	//tree lights fade between bright and dim, out of step
+	for (int i = 0; i < 14; i++)
+	{
+		float period = 1.2f + 0.15f * (float)((i * 5) % 14);
+		float offset = period * (float)(i % 4) * 0.25f;
+
+		node = AddTransformNode("treelight" + std::to_string(i));
+		track = m_pAnimationSystem->AddTrack(node, TransformStore::CHANNEL_COLOR, true);
+		m_pAnimationSystem->AddKeyframe(track, offset, brightTint);
+		m_pAnimationSystem->AddKeyframe(track, offset + 0.5f * period, dimTint);
+		m_pAnimationSystem->AddKeyframe(track, offset + period, brightTint);
+	}
+
+	//the moon turns once a minute and bobs gently
+	node = AddTransformNode("moon");
+	track = m_pAnimationSystem->AddTrack(node, TransformStore::CHANNEL_ROTATION, true);
+	for (int i = 0; i <= 3; i++)
+	{
+		m_pAnimationSystem->AddKeyframe(track, 20.0f * (float)i, AnimationSystem::AxisAngle(moonAxis, 120.0f * (float)i));
+	}
+	track = m_pAnimationSystem->AddTrack(node, TransformStore::CHANNEL_TRANSLATION, true);
+	m_pAnimationSystem->AddKeyframe(track, 0.0f, glm::vec4(0.0f));
+	m_pAnimationSystem->AddKeyframe(track, 4.0f, glm::vec4(0.0f, 0.4f, 0.0f, 0.0f));
+	m_pAnimationSystem->AddKeyframe(track, 8.0f, glm::vec4(0.0f));
+}
+
+/***************************************************************
+*  SetupScenePhysics()
+*
+*  This method is called to add the rigid bodies - the ground,
+*  gift box and snowman as colliders that never move, and a
+*  shower of ornaments, small gifts and candy sticks dropped
+*  from above onto them.
+****************************************************************/
+void SceneManager::SetupScenePhysics()
+{
+	const glm::vec4 noRotation = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	int body;
+
+	//colliders matching the ground, gift box and snowman
+	body = m_pPhysicsWorld->AddBox(glm::vec3(0.0f, -0.5f, 0.0f), glm::vec3(20.0f, 0.5f, 10.0f), noRotation, 0.0f, -1);
+	m_pPhysicsWorld->SetMaterial(body, 0.6f, 0.1f);
+	m_pPhysicsWorld->AddBox(glm::vec3(7.0f, 1.0f, 8.0f), glm::vec3(1.25f, 0.75f, 0.75f), noRotation, 0.0f, -1);
+	m_pPhysicsWorld->AddSphere(glm::vec3(6.0f, 2.0f, 5.0f), 2.5f, 0.0f, -1);
+	m_pPhysicsWorld->AddSphere(glm::vec3(6.0f, 5.0f, 5.0f), 2.0f, 0.0f, -1);
+	m_pPhysicsWorld->AddSphere(glm::vec3(6.0f, 7.5f, 5.0f), 1.5f, 0.0f, -1);
+
+	//bodies dropped in layers over the gift box and snowman,
+	//each nudged and spun a little so the piles differ
+	for (int i = 0; i < 36; i++)
+	{
+		float column = (float)(i % 4);
+		float row = (float)((i / 4) % 3);
+		float layer = (float)(i / 12);
+		glm::vec3 position = glm::vec3(
+			5.0f + 0.9f * column + 0.15f * std::sin(1.7f * (float)i),
+			9.0f + 1.2f * layer + 0.3f * row,
+			6.0f + 0.9f * row + 0.15f * std::cos(2.3f * (float)i));
+		glm::vec4 rotation = AnimationSystem::AxisAngle(
+			glm::normalize(glm::vec3(1.0f, column + 1.0f, row + 1.0f)), 37.0f * (float)i);
+		int node = AddTransformNode("body" + std::to_string(i));
+
+		if (i % 3 == 0)
+		{
+			body = m_pPhysicsWorld->AddBox(position, glm::vec3(0.3f, 0.2f, 0.25f), rotation, 0.5f, node);
+		}
+		else if (i % 3 == 1)
+		{
+			body = m_pPhysicsWorld->AddSphere(position, 0.3f, 0.2f, node);
+			m_pPhysicsWorld->SetMaterial(body, 0.3f, 0.5f);
+		}
+		else
+		{
+			body = m_pPhysicsWorld->AddCapsule(position, 0.12f, 0.3f, rotation, 0.15f, node);
+		}
+		m_pPhysicsWorld->SetVelocity(body, glm::vec3(0.0f),
+			glm::vec3(std::sin((float)i), 0.0f, std::cos((float)i)));
+	}
+}
+/***************************************************************
+*  SetupSceneReflections()
+*
+*  This method is called to add the reflection probes - one
+*  inside the snowman, one in front of the ornaments on the
+*  tree and one inside the moon.  Each reflective shape
+*  mirrors the probe closest to it.
+****************************************************************/
+void SceneManager::SetupSceneReflections()
+{
+	m_pReflectionProbes->AddProbe(glm::vec3(6.0f, 4.5f, 5.0f));
+	m_pReflectionProbes->AddProbe(glm::vec3(-2.5f, 6.0f, 3.0f));
+	m_pReflectionProbes->AddProbe(glm::vec3(-13.0f, 17.0f, -7.0f));
+}
+
+/***************************************************************
+*  SetupDirectionalLight()
+*
+*  This method is used for setting the directional light into
+*  the shader, and recording it for the baked lighting.
+****************************************************************/
+void SceneManager::SetupDirectionalLight(
+	glm::vec3 direction,
+	glm::vec3 ambient,
+	glm::vec3 diffuse,
+	glm::vec3 specular)
+{
+	m_directionalLightDirection = direction;
+	m_directionalLightAmbient = ambient;
+	m_directionalLightDiffuse = diffuse;
+
+	m_pShaderManager->setVec3Value("directionalLight.direction", direction);
+	m_pShaderManager->setVec3Value("directionalLight.ambient", ambient);
+	m_pShaderManager->setVec3Value("directionalLight.diffuse", diffuse);
+	m_pShaderManager->setVec3Value("directionalLight.specular", specular);
+	m_pShaderManager->setBoolValue("directionalLight.bActive", true);
+}
+
+/***************************************************************
+*  SetupPointLight()
+*
+*  This method is used for setting one of the point lights
+*  into the shader, and recording it for the baked lighting
+*  and for finding the shapes within its range.
+****************************************************************/
+void SceneManager::SetupPointLight(
+	int index,
+	glm::vec3 position,
+	glm::vec3 ambient,
+	glm::vec3 diffuse,
+	glm::vec3 specular,
+	float range)
+{
+	std::string lightName = "pointLights[" + std::to_string(index) + "].";
+	POINT_LIGHT pointLight;
+
+	pointLight.position = position;
+	pointLight.ambient = ambient;
+	pointLight.diffuse = diffuse;
+	pointLight.specular = specular;
+	pointLight.range = range;
+	m_pointLights.push_back(pointLight);
+
+	m_pLightCuller->AddLight(index, position, range);
+	m_pLightCuller->Build();
+
+	m_pShaderManager->setVec3Value(lightName + "position", position);
+	m_pShaderManager->setVec3Value(lightName + "ambient", ambient);
+	m_pShaderManager->setVec3Value(lightName + "diffuse", diffuse);
+	m_pShaderManager->setVec3Value(lightName + "specular", specular);
+	m_pShaderManager->setFloatValue(lightName + "range", range);
+	m_pShaderManager->setBoolValue(lightName + "bActive", true);
+
+	// the ambient terms are not faded by the range, so every shape
+	// gets them all, culled lights included
+	glm::vec3 pointLightAmbient = glm::vec3(0.0f);
+	for (int i = 0; i < (int)m_pointLights.size(); i++)
+	{
+		pointLightAmbient += m_pointLights[i].ambient;
+	}
+	m_pShaderManager->setVec3Value("pointLightAmbient", pointLightAmbient);
 }
 /***********************************************************
  *  PrepareScene()
@@ -601,6 +2869,10 @@ void SceneManager::PrepareScene()
 	DefineObjectMaterials();
 	//add and define the light sources for the scene
 	SetupSceneLights();
+	//the shadow sampler must never share a unit with the scene textures
+	m_pShaderManager->setSampler2DValue("shadowMap", ShadowManager::SHADOW_TEXTURE_UNIT);
+	//and neither may the environment cube map sampler
+	m_pShaderManager->setIntValue("environmentMap", ReflectionProbes::ENVIRONMENT_TEXTURE_UNIT);
 
 	//load mesh shapes for scene
 	m_basicMeshes->LoadPlaneMesh();
@@ -629,6 +2901,24 @@ void SceneManager::RenderScene()
 	float ZrotationDegrees = 0.0f;
 	glm::vec3 positionXYZ;
 
+	// the shapes below are queued and drawn together at the end
+	m_drawCommands.clear();
+
+	// move every animated node to the current time at once
+	if (NULL != m_pAnimationSystem)
+	{
+		std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - m_animationStart;
+		if (m_fixedFrameTime > 0.0f)
+		{
+			m_pAnimationSystem->Evaluate(m_fixedAnimationTime);
+			m_fixedAnimationTime += m_fixedFrameTime;
+		}
+		else
+		{
+			m_pAnimationSystem->Evaluate(elapsed.count());
+		}
+	}
+
 	/*** Set needed transformations before drawing the basic mesh.  ***/
 	/*** This same ordering of code should be used for transforming ***/
 	/*** and drawing all the basic 3D shapes.						***/
@@ -656,7 +2946,7 @@ void SceneManager::RenderScene()
 	SetShaderTexture("ground");
 	SetShaderMaterial("sand");
 	//SetTextureUVScale(1.0, 1.0); // draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	DrawShape(SHAPE_PLANE);
 
 	//background mesh plane
 	//XYZ scale for mesh
@@ -681,7 +2971,7 @@ void SceneManager::RenderScene()
 	//set color values
 	SetShaderColor(0.1187f, 0.0986f, 0.34f, 1.0f);//Dark blue
 	SetShaderTexture("snow");
-	m_basicMeshes->DrawPlaneMesh();
+	DrawShape(SHAPE_PLANE);
 
 	/****************************************************************/
 	
@@ -705,7 +2995,7 @@ void SceneManager::RenderScene()
 	
 	SetShaderTexture("snowman");
 	SetShaderMaterial("pearl");
-	m_basicMeshes->DrawSphereMesh();
+	DrawShape(SHAPE_SPHERE);
 
 
 	//Second sphere
@@ -729,7 +3019,7 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("snowman");
 	SetShaderMaterial("pearl");
-	m_basicMeshes->DrawSphereMesh();
+	DrawShape(SHAPE_SPHERE);
 
 	//third sphere
 	
@@ -754,7 +3044,7 @@ void SceneManager::RenderScene()
 	
 	SetShaderTexture("snowman");
 	SetShaderMaterial("pearl");
-	m_basicMeshes->DrawSphereMesh();
+	DrawShape(SHAPE_SPHERE);
 
 	//carrot nose
 	//XYZ scale for mesh
@@ -781,7 +3071,7 @@ void SceneManager::RenderScene()
 	SetShaderTexture("nose");
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("carrot");
-	m_basicMeshes->DrawConeMesh();
+	DrawShape(SHAPE_CONE);
 
 	//render tophat
 	//cylinder for the top hat
@@ -807,7 +3097,7 @@ void SceneManager::RenderScene()
 	
 	SetShaderTexture("tophat");
 	SetShaderMaterial("hat");
-	m_basicMeshes->DrawCylinderMesh();
+	DrawShape(SHAPE_CYLINDER);
 
 	//cylinder for the brim of the tophat
 	
@@ -832,7 +3122,7 @@ void SceneManager::RenderScene()
 	
 	SetShaderTexture("tophat");
 	SetShaderMaterial("hat");
-	m_basicMeshes->DrawCylinderMesh();
+	DrawShape(SHAPE_CYLINDER);
 
 	//Christmas tree
 	//XYZ scale for mesh
@@ -856,7 +3146,7 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("tree");
 	SetShaderMaterial("tree");
-	m_basicMeshes->DrawConeMesh();
+	DrawShape(SHAPE_CONE);
 
 	//Christmas present box
 	//XYZ scale for mesh
@@ -880,7 +3170,7 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("giftbox");
 	SetShaderMaterial("gift");
-	m_basicMeshes->DrawBoxMesh();
+	DrawShape(SHAPE_BOX);
 
 	//moon
 	//XYZ scale for mesh
@@ -905,7 +3195,8 @@ void SceneManager::RenderScene()
 	//set shader texture
 	SetShaderTexture("moon");
 	SetShaderMaterial("silver");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("moon");
+	DrawShape(SHAPE_SPHERE);
 
 	//turret
 	//XYZ scale for mesh
@@ -929,7 +3220,7 @@ void SceneManager::RenderScene()
 	
 	SetShaderTexture("turret");
 	SetShaderMaterial("sand");
-	m_basicMeshes->DrawTorusMesh();
+	DrawShape(SHAPE_TORUS);
 
 	//christmas lights
 	//XYZ scale for mesh
@@ -953,7 +3244,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight0");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -976,7 +3268,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight1");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -999,7 +3292,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight2");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -1022,7 +3316,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight3");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -1045,7 +3340,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight4");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -1068,7 +3364,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight5");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -1091,7 +3388,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight6");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -1114,7 +3412,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight7");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -1137,7 +3436,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight8");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -1160,7 +3460,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight9");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -1183,7 +3484,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight10");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -1206,7 +3508,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight11");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -1229,7 +3532,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight12");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -1252,7 +3556,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("purplelight");
 	SetShaderMaterial("lights");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("treelight13");
+	DrawShape(SHAPE_SPHERE);
 
 	//ornaments
 	//XYZ scale for mesh
@@ -1276,7 +3581,8 @@ void SceneManager::RenderScene()
 	
 	SetShaderTexture("ornaments");
 	SetShaderMaterial("ornament");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("ornament0");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.3f, 0.3f, 0.3f);
@@ -1298,7 +3604,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("ornaments");
 	SetShaderMaterial("ornament");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("ornament1");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.3f, 0.3f, 0.3f);
@@ -1320,7 +3627,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("ornaments");
 	SetShaderMaterial("ornament");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("ornament2");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.3f, 0.3f, 0.3f);
@@ -1342,7 +3650,8 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("ornaments");
 	SetShaderMaterial("ornament");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("ornament3");
+	DrawShape(SHAPE_SPHERE);
 
 	//XYZ scale for mesh
 	scaleXYZ = glm::vec3(0.3f, 0.3f, 0.3f);
@@ -1364,5 +3673,29 @@ void SceneManager::RenderScene()
 
 	SetShaderTexture("ornaments");
 	SetShaderMaterial("ornament");
-	m_basicMeshes->DrawSphereMesh();
+	SetShaderAnimation("ornament4");
+	DrawShape(SHAPE_SPHERE);
+
+	// advance the rigid bodies by the time since the last frame
+	// and queue their shapes
+	if (NULL != m_pPhysicsWorld)
+	{
+		std::chrono::steady_clock::time_point frameTime = std::chrono::steady_clock::now();
+		std::chrono::duration<float> elapsed = frameTime - m_lastPhysicsUpdate;
+		m_lastPhysicsUpdate = frameTime;
+		m_pPhysicsWorld->Update((m_fixedFrameTime > 0.0f) ? m_fixedFrameTime : elapsed.count());
+		DrawPhysicsBodies();
+	}
+
+	// advance the falling snow by the time since the last frame
+	if (NULL != m_pSnowParticles)
+	{
+		std::chrono::steady_clock::time_point frameTime = std::chrono::steady_clock::now();
+		std::chrono::duration<float> elapsed = frameTime - m_lastSnowUpdate;
+		m_lastSnowUpdate = frameTime;
+		m_pSnowParticles->Update((m_fixedFrameTime > 0.0f) ? m_fixedFrameTime : elapsed.count());
+	}
+
+	// draw the queued shapes in opaque and transparent passes
+	SubmitDrawCommands();
 }
@@ -11,10 +11,25 @@
 
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "GLStateCache.h"
+#include "OITManager.h"
+#include "DebugViewRenderer.h"
+#include "ShadowManager.h"
+#include "LightCuller.h"
+#include "SnowParticles.h"
+#include "AnimationSystem.h"
+#include "PhysicsWorld.h"
+#include "ReflectionProbes.h"
 
+#include <chrono>
 #include <string>
 #include <vector>
 
+class LightmapBaker;
+class IrradianceProbes;
+class SceneBVH;
+class MultiViewRenderer;
+
 /***********************************************************
  *  SceneManager
  *
@@ -25,7 +40,7 @@ class SceneManager
 {
 public:
 	// constructor
-	SceneManager(ShaderManager *pShaderManager);
+	SceneManager(ShaderManager *pShaderManager, GLStateCache* pStateCache);
 	// destructor
 	~SceneManager();
 
@@ -33,6 +48,8 @@ public:
 	{
 		std::string tag;
 		uint32_t ID;
+		// true when the image has alpha values below fully opaque
+		bool bTranslucent;
 	};
 
 	struct OBJECT_MATERIAL
@@ -40,30 +57,89 @@ public:
 		glm::vec3 diffuseColor;
 		glm::vec3 specularColor;
 		float shininess;
+		// share of the surroundings mirrored by the surface
+		float reflectivity;
 		std::string tag;
 	};
 
-private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
-	// defined object materials
-	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	struct POINT_LIGHT
+	{
+		glm::vec3 position;
+		glm::vec3 ambient;
+		glm::vec3 diffuse;
+		glm::vec3 specular;
+		// distance past which the light adds nothing
+		float range;
+	};
+
+	// basic shape meshes that can be queued for drawing
+	enum SHAPE_TYPE
+	{
+		SHAPE_BOX,
+		SHAPE_CONE,
+		SHAPE_CYLINDER,
+		SHAPE_PLANE,
+		SHAPE_PRISM,
+		SHAPE_PYRAMID4,
+		SHAPE_SPHERE,
+		SHAPE_TAPERED_CYLINDER,
+		SHAPE_TORUS
+	};
+
+	// how the transparent draws are blended
+	enum TRANSPARENCY_MODE
+	{
+		TRANSPARENCY_SORTED,
+		TRANSPARENCY_WEIGHTED_OIT
+	};
+
+	// everything the shader needs for one queued draw
+	struct DRAW_COMMAND
+	{
+		SHAPE_TYPE shape;
+		glm::mat4 model;
+		glm::vec4 color;
+		bool bUseTexture;
+		int textureSlot;
+		glm::vec2 UVscale;
+		int materialIndex;
+		bool bTransparent;
+		// moving shapes are kept out of the cached shadow map - set
+		// for the shapes placed by an animated node or a body
+		bool bDynamic;
+		// atlas block of the baked light, -1 when lit per pixel
+		int lightmapIndex;
+		// point lights in range of the shape, by index in the shader
+		int pointLightCount;
+		int pointLightIndices[LightCuller::MAX_LIGHTS_PER_OBJECT];
+		// animated color multiplied into the lit result
+		glm::vec3 tint;
+		// probe the surroundings are reflected from, -1 for none
+		int reflectionProbe;
+	};
+
+	// camera and window area of one of several views drawn
+	// from the same queued shapes
+	struct VIEWPORT_CAMERA
+	{
+		// x, y, width and height in pixels
+		int viewport[4];
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec3 position;
+	};
 
 	// load texture images and convert to OpenGL texture data
 	bool CreateGLTexture(const char* filename, std::string tag);
-	// bind loaded OpenGL textures to slots in memory
-	void BindGLTextures();
-	// free the loaded OpenGL textures
+	// register a created OpenGL texture by tag in the next free
+	// slot - false when all the slots are taken
+	bool AddTexture(uint32_t textureID, std::string tag, bool bTranslucent);
+	// free the loaded OpenGL textures and empty their slots
 	void DestroyGLTextures();
-	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
+	// find the slot of a loaded texture by tag
 	int FindTextureSlot(std::string tag);
+	// add a material to the ones found by tag
+	void AddMaterial(const OBJECT_MATERIAL& material);
 	// find a defined material by tag
 	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
 
@@ -76,6 +152,138 @@ private:
 		float ZrotationDegrees,
 		glm::vec3 positionXYZ);
 
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// pointer to OpenGL state cache object
+	GLStateCache* m_pStateCache;
+	// pointer to basic shapes object
+	ShapeMeshes* m_basicMeshes;
+	// total number of loaded textures
+	int m_loadedTextures;
+	// loaded textures info, one slot for each texture unit
+	// below the units reserved for the passes
+	TEXTURE_INFO m_textureIDs[GLStateCache::FIRST_RESERVED_TEXTURE_UNIT];
+	// defined object materials
+	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// texture uniforms last sent to the shader, -1 when unknown
+	int m_currentUseTexture;
+	int m_currentTextureSlot;
+	// material last sent to the shader, -1 when unknown
+	int m_currentMaterialIndex;
+	// shader state collected by the Set* methods for the next draw
+	DRAW_COMMAND m_pendingDraw;
+	// draws queued for the current frame
+	std::vector<DRAW_COMMAND> m_drawCommands;
+	// how the transparent draws are blended
+	TRANSPARENCY_MODE m_transparencyMode;
+	// weighted blended transparency targets, created on first use
+	OITManager* m_pOITManager;
+	// heatmap view replacing the lit scene, and its targets,
+	// created on first use
+	DebugViewRenderer::DEBUG_VIEW m_debugView;
+	DebugViewRenderer* m_pDebugViewRenderer;
+	// depth only shader and switch for the depth pre-pass
+	ShaderManager* m_pDepthShader;
+	bool m_bDepthPrepass;
+	// occlusion queries counting the fragments shaded by the
+	// opaque pass, alternated so results are read a frame late
+	GLuint m_overdrawQueries[2];
+	int m_overdrawPixels[2];
+	int m_overdrawFrame;
+	double m_totalShadedSamples;
+	double m_totalPixels;
+	// queued shapes inside and outside of the views last frame
+	int m_visibleObjectCount;
+	int m_culledObjectCount;
+	// directional light shadow map, created when shadows are enabled
+	ShadowManager* m_pShadowManager;
+	// direction the directional light travels
+	glm::vec3 m_directionalLightDirection;
+	// fingerprint of the static shapes and light in the cached shadow map
+	uint64_t m_staticShadowHash;
+	// baked light of the static lights, created when lightmaps are enabled
+	LightmapBaker* m_pLightmapBaker;
+	bool m_bLightmaps;
+	// fingerprint of the static shapes and lights in the lightmap
+	uint64_t m_lightmapHash;
+	// texture slot holding the lightmap atlas, -1 before the first bake
+	int m_lightmapTextureSlot;
+	// lightmap block last sent to the shader, -2 when unknown
+	int m_currentLightmapIndex;
+	// probes lighting the shapes without a lightmap block
+	IrradianceProbes* m_pIrradianceProbes;
+	bool m_bIrradianceProbes;
+	// probe lighting switch last sent to the shader, -1 when unknown
+	int m_currentUseProbeLight;
+	// tree of point light ranges for finding the lights of each shape
+	LightCuller* m_pLightCuller;
+	// point light list last sent to the shader, count -1 when unknown
+	int m_currentPointLightCount;
+	int m_currentPointLightIndices[LightCuller::MAX_LIGHTS_PER_OBJECT];
+	// static lights recorded by SetupSceneLights()
+	glm::vec3 m_directionalLightAmbient;
+	glm::vec3 m_directionalLightDiffuse;
+	std::vector<POINT_LIGHT> m_pointLights;
+	// falling snow, created when snow is enabled
+	SnowParticles* m_pSnowParticles;
+	// time the snow was last advanced
+	std::chrono::steady_clock::time_point m_lastSnowUpdate;
+	// transforms of the animated objects and the tracks driving
+	// them, created when animation is enabled
+	TransformStore* m_pTransformStore;
+	AnimationSystem* m_pAnimationSystem;
+	std::chrono::steady_clock::time_point m_animationStart;
+	// rigid bodies written into the same transforms, created
+	// when physics is enabled
+	PhysicsWorld* m_pPhysicsWorld;
+	std::chrono::steady_clock::time_point m_lastPhysicsUpdate;
+	// time the scene moves on each frame, 0 to follow the clock,
+	// and the animation time reached by the fixed frames
+	float m_fixedFrameTime;
+	float m_fixedAnimationTime;
+	// animated node applied to the next queued shape, -1 for none,
+	// and whether the node places the shape rather than moving it
+	int m_pendingAnimationNode;
+	bool m_bPendingBodyNode;
+	// tint last sent to the shader, negative when unknown
+	glm::vec3 m_currentTint;
+	// tree over the queued shapes for ray queries, rebuilt when
+	// the shapes have changed since it was last used
+	SceneBVH* m_pSceneBVH;
+	uint64_t m_sceneBVHHash;
+	// queued shape picked with the mouse, -1 for none
+	int m_selectedObject;
+	// views drawn side by side this frame, empty when the main
+	// camera fills the window
+	std::vector<VIEWPORT_CAMERA> m_viewports;
+	// environment maps of the reflective materials, created
+	// when reflections are enabled
+	ReflectionProbes* m_pReflectionProbes;
+	// fingerprint of the static shapes and lights in the cached
+	// maps, and the next face given the moving shapes
+	uint64_t m_reflectionHash;
+	int m_reflectionFace;
+	// set while the probes are drawn so no shape samples them
+	bool m_bCapturingReflections;
+	// probe last bound for the shader, -2 when unknown
+	int m_currentReflectionProbe;
+	// instanced copies of the meshes for drawing every view in
+	// one pass, created when single pass views are enabled and
+	// supported
+	MultiViewRenderer* m_pMultiViewRenderer;
+	// camera used for sorting the queued draws
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	glm::vec3 m_viewPosition;
+
+	// bind loaded OpenGL textures to slots in memory
+	void BindGLTextures();
+	// find a loaded texture by tag
+	int FindTextureID(std::string tag);
+	// find the index of a defined material by tag
+	int FindMaterialIndex(std::string tag);
+
 	// set the color values into the shader
 	void SetShaderColor(
 		float redColorValue,
@@ -95,6 +303,80 @@ private:
 	void SetShaderMaterial(
 		std::string materialTag);
 
+	// move and tint the next shape by an animated node
+	void SetShaderAnimation(
+		std::string animationTag);
+	// place the next shape, set up around the origin, on the
+	// body written into a node
+	void SetShaderBody(int node);
+	// find or add a node of the transform store
+	int AddTransformNode(std::string tag);
+	// queue the shapes of the rigid bodies
+	void DrawPhysicsBodies();
+
+	// queue a shape to be drawn with the current shader settings
+	void DrawShape(SHAPE_TYPE shape);
+	// draw the queued shapes - opaque first, then transparent
+	void SubmitDrawCommands();
+	// draw the visible shapes with the current camera
+	void DrawView(
+		const std::vector<std::pair<float, int>>& opaqueOrder,
+		std::vector<std::pair<float, int>> transparentOrder,
+		bool bCountOverdraw);
+	// draw the visible shapes into every viewport at once
+	void DrawViewsInstanced(
+		const std::vector<std::pair<float, int>>& opaqueOrder,
+		std::vector<std::pair<float, int>> transparentOrder);
+	// draw the visible shapes into the debug view counts, with
+	// every camera, and resolve them into the heatmap
+	void DrawDebugView(
+		const std::vector<std::pair<float, int>>& opaqueOrder,
+		const std::vector<std::pair<float, int>>& transparentOrder);
+	// set the viewport of each view for the instanced draws
+	void SetViewportArray();
+	// send a camera into the shader for the following draws
+	void ApplyViewCamera(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		const glm::vec3& viewPosition);
+	// send the settings for a queued draw into the shader
+	void ApplyDrawCommand(const DRAW_COMMAND& command);
+	// draw the mesh for a basic shape
+	void DrawShapeMesh(SHAPE_TYPE shape);
+	// refresh the shadow map of the directional light
+	void UpdateShadowMap();
+	// bake the lightmap when the static scene has changed
+	void UpdateLightmaps();
+	// find the point lights in range of each queued shape
+	void AssignPointLights();
+	// refresh the environment maps of the reflective shapes
+	void UpdateReflectionProbes();
+	// render every face of the cached map of a probe
+	void CaptureStaticProbe(int probe);
+	// draw the static or moving shapes seen by a probe
+	void DrawProbeShapes(int probe, bool bDynamic, int viewCount);
+	// rebuild the ray query tree when the queued shapes changed
+	void UpdateSceneBVH();
+	// fill the depth buffer with the opaque shapes
+	void DrawDepthPrepass(const std::vector<std::pair<float, int>>& opaqueOrder);
+	// start and stop counting the fragments shaded by the opaque pass
+	void BeginOverdrawQuery();
+	void EndOverdrawQuery();
+
+	// set a light into the shader and record it
+	void SetupDirectionalLight(
+		glm::vec3 direction,
+		glm::vec3 ambient,
+		glm::vec3 diffuse,
+		glm::vec3 specular);
+	void SetupPointLight(
+		int index,
+		glm::vec3 position,
+		glm::vec3 ambient,
+		glm::vec3 diffuse,
+		glm::vec3 specular,
+		float range);
+
 public:
 
 	// The following methods are for the students to 
@@ -102,12 +384,71 @@ public:
 	void PrepareScene();
 	void RenderScene();
 
+	// select sorted blending or weighted blended transparency
+	void SetTransparencyMode(TRANSPARENCY_MODE mode);
+	// enable or disable shadows from the directional light
+	void SetShadows(bool bEnable);
+	// enable or disable baked light for the static shapes
+	void SetLightmaps(bool bEnable);
+	// enable or disable baked probe light for the other shapes
+	void SetIrradianceProbes(bool bEnable);
+	// enable or disable the depth pre-pass for opaque shapes
+	void SetDepthPrepass(bool bEnable);
+	// replace the lit scene with a heatmap of the overdraw, the
+	// lights per pixel or the mip level, or go back to the scene
+	void SetDebugView(DebugViewRenderer::DEBUG_VIEW view);
+	DebugViewRenderer::DEBUG_VIEW GetDebugView() const { return(m_debugView); }
+	// enable or disable falling snow with the passed in number of flakes
+	void SetSnow(bool bEnable, int flakeCount);
+	// enable or disable the keyframed animation of the scene objects
+	void SetAnimation(bool bEnable);
+	// enable or disable rigid bodies dropped onto the scene
+	void SetPhysics(bool bEnable);
+	// enable or disable drawing all viewports in a single pass
+	void SetMultiView(bool bEnable);
+	// enable or disable environment reflections on the
+	// reflective materials
+	void SetReflections(bool bEnable);
+	// move the animation, physics and snow on by the passed in
+	// time every frame instead of the time that passed, 0 to
+	// follow the clock again
+	void SetFixedFrameTime(float frameTime);
+	// get the average number of fragments shaded per pixel by
+	// the opaque pass since the scene was prepared
+	float GetAverageOverdraw() const;
+	// get the number of queued shapes drawn and culled by the
+	// views last frame
+	int GetVisibleObjectCount() const { return(m_visibleObjectCount); }
+	int GetCulledObjectCount() const { return(m_culledObjectCount); }
+
+	// get the ray query tree over the last queued shapes
+	const SceneBVH* GetSceneBVH();
+	// select the closest queued shape hit by a ray, returning
+	// its index or -1 when nothing is hit
+	int PickObject(const glm::vec3& origin, const glm::vec3& direction);
+
+	// set the camera used for ordering the draws
+	void SetCameraView(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		const glm::vec3& viewPosition);
+	// add a view drawn into part of the window this frame, or
+	// clear them so the main camera fills the window again
+	void AddViewport(const VIEWPORT_CAMERA& viewport);
+	void ClearViewports() { m_viewports.clear(); }
+
 	//loads textures from image files
 	void LoadSceneTextures();
 	//pre-define the object materials for lighting
 	void DefineObjectMaterials();
 	//pre-set light sources for 3D scene
 	void SetupSceneLights();
+	//pre-set keyframed tracks for the animated objects
+	void SetupSceneAnimation();
+	//pre-set the colliders and falling rigid bodies
+	void SetupScenePhysics();
+	//pre-set the probes the reflective materials sample
+	void SetupSceneReflections();
 	
 
 };
\ No newline at end of file
@@ -0,0 +1,263 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowmanager.cpp
+// ============
+// manage the directional light shadow map - cached static and per-frame dynamic
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShadowManager.h"
+
+#include <glm/gtx/transform.hpp>
+
+/***********************************************************
+ *  ShadowManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShadowManager::ShadowManager(GLStateCache* pStateCache)
+{
+	m_pStateCache = pStateCache;
+	m_pDepthShader = NULL;
+	m_staticFramebufferID = 0;
+	m_staticDepthTextureID = 0;
+	m_dynamicFramebufferID = 0;
+	m_dynamicDepthTextureID = 0;
+	m_resolution = 0;
+	m_lightSpaceMatrix = glm::mat4(1.0f);
+	m_sceneFramebufferID = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		m_sceneViewport[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~ShadowManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShadowManager::~ShadowManager()
+{
+	GLuint framebuffers[] = { m_staticFramebufferID, m_dynamicFramebufferID };
+	GLuint textures[] = { m_staticDepthTextureID, m_dynamicDepthTextureID };
+
+	glDeleteFramebuffers(2, framebuffers);
+	glDeleteTextures(2, textures);
+	m_pStateCache->InvalidateTextures();
+
+	if (NULL != m_pDepthShader)
+	{
+		delete m_pDepthShader;
+		m_pDepthShader = NULL;
+	}
+	m_pStateCache = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the depth shader and
+ *  creating the cached and per-frame shadow maps.
+ ***********************************************************/
+bool ShadowManager::Initialize(int resolution)
+{
+	m_pDepthShader = new ShaderManager();
+	m_pDepthShader->LoadShaders(
+		"shaders/depthVertexShader.glsl",
+		"shaders/depthFragmentShader.glsl");
+	if (0 == m_pDepthShader->m_programID)
+	{
+		std::cout << "Could not load the shadow map shader" << std::endl;
+		return false;
+	}
+
+	m_resolution = resolution;
+	CreateShadowMap(m_staticFramebufferID, m_staticDepthTextureID);
+	CreateShadowMap(m_dynamicFramebufferID, m_dynamicDepthTextureID);
+
+	return true;
+}
+
+/***********************************************************
+ *  SetLightView()
+ *
+ *  This method is used for fitting an orthographic light
+ *  frustum tightly around the passed in world bounds, looking
+ *  along the direction the light travels.
+ ***********************************************************/
+void ShadowManager::SetLightView(
+	const glm::vec3& lightDirection,
+	const glm::vec3& boundsMin,
+	const glm::vec3& boundsMax)
+{
+	glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+	glm::vec3 direction = glm::normalize(lightDirection);
+	float radius = glm::length(boundsMax - boundsMin) * 0.5f;
+	glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+
+	// avoid a degenerate view when the light points straight up or down
+	if (glm::abs(glm::dot(direction, up)) > 0.99f)
+	{
+		up = glm::vec3(0.0f, 0.0f, 1.0f);
+	}
+
+	glm::mat4 lightView = glm::lookAt(center - direction * radius, center, up);
+
+	// bound the eight corners of the box in light space
+	glm::vec3 lightMin = glm::vec3(1.0e30f);
+	glm::vec3 lightMax = glm::vec3(-1.0e30f);
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec4 worldCorner = glm::vec4(
+			(corner & 1) ? boundsMax.x : boundsMin.x,
+			(corner & 2) ? boundsMax.y : boundsMin.y,
+			(corner & 4) ? boundsMax.z : boundsMin.z,
+			1.0f);
+		glm::vec3 lightCorner = glm::vec3(lightView * worldCorner);
+		lightMin = glm::min(lightMin, lightCorner);
+		lightMax = glm::max(lightMax, lightCorner);
+	}
+
+	// the view looks down -Z, so the near and far planes are negated
+	glm::mat4 lightProjection = glm::ortho(
+		lightMin.x, lightMax.x,
+		lightMin.y, lightMax.y,
+		-lightMax.z, -lightMin.z);
+
+	m_lightSpaceMatrix = lightProjection * lightView;
+}
+
+/***********************************************************
+ *  BeginStaticPass()
+ *
+ *  This method is used for starting to render the static
+ *  shapes into the cached shadow map.
+ ***********************************************************/
+void ShadowManager::BeginStaticPass()
+{
+	BeginPass(m_staticFramebufferID);
+	glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+/***********************************************************
+ *  BeginDynamicPass()
+ *
+ *  This method is used for starting to render the moving
+ *  shapes.  The cached static depth is copied in first so
+ *  only the moving shapes need to be drawn.
+ ***********************************************************/
+void ShadowManager::BeginDynamicPass()
+{
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_sceneFramebufferID);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_staticFramebufferID);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_dynamicFramebufferID);
+	glBlitFramebuffer(
+		0, 0, m_resolution, m_resolution,
+		0, 0, m_resolution, m_resolution,
+		GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+	BeginPass(m_dynamicFramebufferID);
+}
+
+/***********************************************************
+ *  SetModel()
+ *
+ *  This method is used for setting the model matrix of the
+ *  next shape drawn into the shadow map.
+ ***********************************************************/
+void ShadowManager::SetModel(const glm::mat4& model)
+{
+	m_pDepthShader->setMat4Value("model", model);
+}
+
+/***********************************************************
+ *  EndPass()
+ *
+ *  This method is used for returning to the frame buffer and
+ *  viewport of the scene.
+ ***********************************************************/
+void ShadowManager::EndPass()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebufferID);
+	glViewport(m_sceneViewport[0], m_sceneViewport[1], m_sceneViewport[2], m_sceneViewport[3]);
+	m_pStateCache->SetColorMask(true);
+}
+
+/***********************************************************
+ *  BindShadowMap()
+ *
+ *  This method is used for binding the shadow map that the
+ *  scene shader samples.
+ ***********************************************************/
+void ShadowManager::BindShadowMap(bool bDynamic)
+{
+	m_pStateCache->BindTexture(
+		SHADOW_TEXTURE_UNIT,
+		GL_TEXTURE_2D,
+		(bDynamic == true) ? m_dynamicDepthTextureID : m_staticDepthTextureID);
+}
+
+/***********************************************************
+ *  CreateShadowMap()
+ *
+ *  This method is used for creating a depth texture set up
+ *  for hardware depth comparison, and a frame buffer with
+ *  only that texture attached.
+ ***********************************************************/
+void ShadowManager::CreateShadowMap(GLuint& framebufferID, GLuint& depthTextureID)
+{
+	const GLfloat borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+	glGenTextures(1, &depthTextureID);
+	m_pStateCache->BindTexture(SHADOW_TEXTURE_UNIT, GL_TEXTURE_2D, depthTextureID);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, m_resolution, m_resolution, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+	// linear filtering with comparison gives 2x2 percentage closer filtering
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	// everything outside of the light frustum is lit
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+	glGenFramebuffers(1, &framebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebufferID);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTextureID, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Shadow map frame buffer is incomplete" << std::endl;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/***********************************************************
+ *  BeginPass()
+ *
+ *  This method is used for binding a shadow map frame buffer
+ *  with the depth shader and the light matrices.
+ ***********************************************************/
+void ShadowManager::BeginPass(GLuint framebufferID)
+{
+	glGetIntegerv(GL_VIEWPORT, m_sceneViewport);
+	if (framebufferID == m_staticFramebufferID)
+	{
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_sceneFramebufferID);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, framebufferID);
+	glViewport(0, 0, m_resolution, m_resolution);
+
+	m_pStateCache->UseProgram(m_pDepthShader->m_programID);
+	m_pDepthShader->setMat4Value("view", glm::mat4(1.0f));
+	m_pDepthShader->setMat4Value("projection", m_lightSpaceMatrix);
+
+	m_pStateCache->SetColorMask(false);
+	m_pStateCache->SetDepthTest(true);
+	m_pStateCache->SetDepthMask(true);
+	m_pStateCache->SetDepthFunc(GL_LESS);
+}
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowmanager.h
+// ============
+// manage the directional light shadow map - cached static and per-frame dynamic
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "GLStateCache.h"
+
+/***********************************************************
+ *  ShadowManager
+ *
+ *  This class contains the code for rendering the shadow map
+ *  of the directional light.  Static shapes are rendered into
+ *  a cached depth map only when they or the light change.
+ *  When there are moving shapes, the cached map is copied
+ *  into a second map each frame and only the moving shapes
+ *  are rendered on top of it.
+ ***********************************************************/
+class ShadowManager
+{
+public:
+	// constructor
+	ShadowManager(GLStateCache* pStateCache);
+	// destructor
+	~ShadowManager();
+
+	// texture unit the shadow map is bound to for the scene shader
+	static const int SHADOW_TEXTURE_UNIT = GLStateCache::SHADOW_TEXTURE_UNIT;
+
+	// load the depth shader and create the shadow maps
+	bool Initialize(int resolution);
+
+	// fit the light frustum around the passed in world bounds
+	void SetLightView(
+		const glm::vec3& lightDirection,
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax);
+	// get the matrix from world space into light clip space
+	const glm::mat4& GetLightSpaceMatrix() const { return(m_lightSpaceMatrix); }
+
+	// start rendering the static shapes into the cached map
+	void BeginStaticPass();
+	// start rendering the moving shapes over a copy of the cached map
+	void BeginDynamicPass();
+	// set the model matrix for the next shape in either pass
+	void SetModel(const glm::mat4& model);
+	// return to the scene frame buffer and viewport
+	void EndPass();
+
+	// bind the map to use for the scene - the dynamic map only
+	// when moving shapes were rendered this frame
+	void BindShadowMap(bool bDynamic);
+
+private:
+	// pointer to OpenGL state cache object
+	GLStateCache* m_pStateCache;
+	// depth only shader used for both passes
+	ShaderManager* m_pDepthShader;
+
+	// cached map for static shapes and per-frame map for all shapes
+	GLuint m_staticFramebufferID;
+	GLuint m_staticDepthTextureID;
+	GLuint m_dynamicFramebufferID;
+	GLuint m_dynamicDepthTextureID;
+	int m_resolution;
+
+	// light view and projection combined
+	glm::mat4 m_lightSpaceMatrix;
+
+	// frame buffer and viewport restored at the end of a pass
+	GLint m_sceneFramebufferID;
+	GLint m_sceneViewport[4];
+
+	// create one depth texture and its frame buffer
+	void CreateShadowMap(GLuint& framebufferID, GLuint& depthTextureID);
+	// bind a shadow map frame buffer and the depth shader
+	void BeginPass(GLuint framebufferID);
+};
@@ -0,0 +1,402 @@
+///////////////////////////////////////////////////////////////////////////////
+// snowparticles.cpp
+// ============
+// falling snow particle system - SIMD update of a pooled SoA store, one draw
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SnowParticles.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define SNOW_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+// declaration of the global variables and defines
+namespace
+{
+	const float PI = 3.14159265f;
+	// range of the speed the flakes settle to while falling
+	const float MIN_FALL_SPEED = 0.8f;
+	const float MAX_FALL_SPEED = 1.6f;
+	// range of the flake radius in world units
+	const float MIN_FLAKE_SIZE = 0.015f;
+	const float MAX_FLAKE_SIZE = 0.04f;
+	// how quickly the flakes follow the wind and turbulence
+	const float AIR_DRAG = 1.5f;
+	// strength and rate of the swirling turbulence
+	const float TURBULENCE_STRENGTH = 0.6f;
+	const float TURBULENCE_FREQUENCY_X = 1.3f;
+	const float TURBULENCE_FREQUENCY_Z = 0.9f;
+	// the running time is wrapped to keep the sine arguments precise
+	const float TIME_WRAP = 1000.0f;
+
+	/***********************************************************
+	 *  FastSin()
+	 *
+	 *  This function is used for approximating the sine with a
+	 *  parabola refined once, which is plenty for turbulence.
+	 *  The SSE version below uses the same steps.
+	 ***********************************************************/
+	float FastSin(float x)
+	{
+		x -= 2.0f * PI * std::floor(x / (2.0f * PI) + 0.5f);
+		float y = (4.0f / PI) * x - (4.0f / (PI * PI)) * x * std::fabs(x);
+		return(0.225f * (y * std::fabs(y) - y) + y);
+	}
+
+#ifdef SNOW_USE_SSE
+	/***********************************************************
+	 *  FastSin4()
+	 *
+	 *  This function is used for approximating the sine of four
+	 *  values at once.
+	 ***********************************************************/
+	__m128 FastSin4(__m128 x)
+	{
+		const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+		__m128 turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.0f / (2.0f * PI)))));
+		x = _mm_sub_ps(x, _mm_mul_ps(turns, _mm_set1_ps(2.0f * PI)));
+
+		__m128 y = _mm_sub_ps(
+			_mm_mul_ps(_mm_set1_ps(4.0f / PI), x),
+			_mm_mul_ps(_mm_set1_ps(4.0f / (PI * PI)), _mm_mul_ps(x, _mm_and_ps(x, absMask))));
+		__m128 refined = _mm_sub_ps(_mm_mul_ps(y, _mm_and_ps(y, absMask)), y);
+		return(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.225f), refined), y));
+	}
+#endif
+}
+
+/***********************************************************
+ *  SnowParticles()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SnowParticles::SnowParticles(GLStateCache* pStateCache)
+{
+	m_pStateCache = pStateCache;
+	m_pSnowShader = NULL;
+	m_vertexArrayID = 0;
+	m_instanceBufferID = 0;
+	m_capacity = 0;
+	m_liveCount = 0;
+	m_spawnRemainder = 0.0f;
+	m_boundsMin = glm::vec3(-20.0f, 0.0f, -10.0f);
+	m_boundsMax = glm::vec3(20.0f, 18.0f, 10.0f);
+	m_wind = glm::vec3(0.3f, 0.0f, 0.1f);
+	m_time = 0.0f;
+	m_randomState = 0x9e3779b9u;
+	m_updateTime = 0.0;
+}
+
+/***********************************************************
+ *  ~SnowParticles()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SnowParticles::~SnowParticles()
+{
+	if (0 != m_instanceBufferID)
+	{
+		glDeleteBuffers(1, &m_instanceBufferID);
+		m_instanceBufferID = 0;
+	}
+	if (0 != m_vertexArrayID)
+	{
+		glDeleteVertexArrays(1, &m_vertexArrayID);
+		m_vertexArrayID = 0;
+	}
+	if (NULL != m_pSnowShader)
+	{
+		delete m_pSnowShader;
+		m_pSnowShader = NULL;
+	}
+	m_pStateCache = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for loading the snow shader, sizing
+ *  the particle store and the instance buffer for the pool,
+ *  and filling the emitter with flakes so the scene starts
+ *  out snowing.
+ ***********************************************************/
+bool SnowParticles::Initialize(int maxFlakes)
+{
+	m_pSnowShader = new ShaderManager();
+	m_pSnowShader->LoadShaders(
+		"shaders/snowVertexShader.glsl",
+		"shaders/snowFragmentShader.glsl");
+	if (0 == m_pSnowShader->m_programID)
+	{
+		std::cout << "Could not load the snow shader" << std::endl;
+		return false;
+	}
+
+	// the SIMD loops always move whole groups of four
+	m_capacity = (std::max(maxFlakes, 0) + 3) & ~3;
+	m_positionX.assign(m_capacity, 0.0f);
+	m_positionY.assign(m_capacity, 0.0f);
+	m_positionZ.assign(m_capacity, 0.0f);
+	m_velocityX.assign(m_capacity, 0.0f);
+	m_velocityY.assign(m_capacity, 0.0f);
+	m_velocityZ.assign(m_capacity, 0.0f);
+	m_phase.assign(m_capacity, 0.0f);
+	m_size.assign(m_capacity, 0.0f);
+	m_liveCount = 0;
+
+	// one buffer holds the attribute arrays back to back, so
+	// each array of the store is uploaded without repacking
+	glGenVertexArrays(1, &m_vertexArrayID);
+	glGenBuffers(1, &m_instanceBufferID);
+	m_pStateCache->BindVertexArray(m_vertexArrayID);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferID);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_capacity * ATTRIBUTE_COUNT * sizeof(float), NULL, GL_STREAM_DRAW);
+	for (int attribute = 0; attribute < ATTRIBUTE_COUNT; attribute++)
+	{
+		glEnableVertexAttribArray(attribute);
+		glVertexAttribPointer(attribute, 1, GL_FLOAT, GL_FALSE, 0,
+			(void*)((size_t)attribute * m_capacity * sizeof(float)));
+		glVertexAttribDivisor(attribute, 1);
+	}
+
+	SpawnFlakes(m_capacity, m_boundsMax.y - m_boundsMin.y);
+
+	return true;
+}
+
+/***********************************************************
+ *  SetEmitterBounds()
+ *
+ *  This method is used for setting the box the flakes fall
+ *  through.
+ ***********************************************************/
+void SnowParticles::SetEmitterBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	m_boundsMin = boundsMin;
+	m_boundsMax = boundsMax;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for advancing the snow by a time
+ *  step.  Flakes are spawned at the rate that keeps the pool
+ *  full on average, moved, and the ones that landed are
+ *  returned to the pool.
+ ***********************************************************/
+void SnowParticles::Update(float deltaTime)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	// a long stall should not bunch the flakes up into a sheet
+	deltaTime = std::min(std::max(deltaTime, 0.0f), 0.1f);
+	m_time = std::fmod(m_time + deltaTime, TIME_WRAP);
+
+	float height = m_boundsMax.y - m_boundsMin.y;
+	float averageFallTime = height / (0.5f * (MIN_FALL_SPEED + MAX_FALL_SPEED));
+	float spawnCount = m_spawnRemainder + (float)m_capacity * deltaTime / std::max(averageFallTime, 0.001f);
+	int spawnWhole = (int)spawnCount;
+	m_spawnRemainder = spawnCount - (float)spawnWhole;
+
+	// spread the new flakes over the distance fallen this step
+	SpawnFlakes(spawnWhole, MAX_FALL_SPEED * deltaTime);
+	IntegrateFlakes(deltaTime);
+	KillFlakes();
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+	m_updateTime = elapsed.count();
+}
+
+/***********************************************************
+ *  SpawnFlakes()
+ *
+ *  This method is used for taking flakes from the pool and
+ *  placing them at random across the top of the emitter,
+ *  up to the passed in distance below it.
+ ***********************************************************/
+void SnowParticles::SpawnFlakes(int count, float heightSpread)
+{
+	count = std::min(count, m_capacity - m_liveCount);
+	for (int i = m_liveCount; i < m_liveCount + count; i++)
+	{
+		float fallSpeed = MIN_FALL_SPEED + (MAX_FALL_SPEED - MIN_FALL_SPEED) * Random();
+
+		m_positionX[i] = m_boundsMin.x + (m_boundsMax.x - m_boundsMin.x) * Random();
+		m_positionY[i] = m_boundsMax.y - heightSpread * Random();
+		m_positionZ[i] = m_boundsMin.z + (m_boundsMax.z - m_boundsMin.z) * Random();
+		m_velocityX[i] = m_wind.x;
+		m_velocityY[i] = -fallSpeed;
+		m_velocityZ[i] = m_wind.z;
+		m_phase[i] = 2.0f * PI * Random();
+		// larger flakes catch more air and fall slower
+		m_size[i] = MIN_FLAKE_SIZE + (MAX_FLAKE_SIZE - MIN_FLAKE_SIZE) *
+			(MAX_FALL_SPEED - fallSpeed) / (MAX_FALL_SPEED - MIN_FALL_SPEED);
+	}
+	m_liveCount += count;
+}
+
+/***********************************************************
+ *  IntegrateFlakes()
+ *
+ *  This method is used for moving the live flakes.  Each
+ *  flake falls at its own steady speed while its horizontal
+ *  velocity is pulled toward the wind plus a swirl that
+ *  depends on its phase.  Four flakes are moved at a time,
+ *  including the padding past the last live flake, which is
+ *  harmless since it is never drawn.
+ ***********************************************************/
+void SnowParticles::IntegrateFlakes(float deltaTime)
+{
+	float pull = std::min(AIR_DRAG * deltaTime, 1.0f);
+	float angleX = m_time * TURBULENCE_FREQUENCY_X;
+	float angleZ = m_time * TURBULENCE_FREQUENCY_Z;
+	int groupEnd = (m_liveCount + 3) & ~3;
+
+#ifdef SNOW_USE_SSE
+	const __m128 pull4 = _mm_set1_ps(pull);
+	const __m128 deltaTime4 = _mm_set1_ps(deltaTime);
+	const __m128 windX4 = _mm_set1_ps(m_wind.x);
+	const __m128 windZ4 = _mm_set1_ps(m_wind.z);
+	const __m128 strength4 = _mm_set1_ps(TURBULENCE_STRENGTH);
+	const __m128 angleX4 = _mm_set1_ps(angleX);
+	const __m128 angleZ4 = _mm_set1_ps(angleZ);
+	const __m128 phaseScale4 = _mm_set1_ps(1.7f);
+
+	for (int i = 0; i < groupEnd; i += 4)
+	{
+		__m128 phase = _mm_loadu_ps(&m_phase[i]);
+		__m128 turbulenceX = _mm_mul_ps(strength4, FastSin4(_mm_add_ps(angleX4, phase)));
+		__m128 turbulenceZ = _mm_mul_ps(strength4, FastSin4(_mm_add_ps(angleZ4, _mm_mul_ps(phase, phaseScale4))));
+
+		__m128 velocityX = _mm_loadu_ps(&m_velocityX[i]);
+		__m128 velocityY = _mm_loadu_ps(&m_velocityY[i]);
+		__m128 velocityZ = _mm_loadu_ps(&m_velocityZ[i]);
+		velocityX = _mm_add_ps(velocityX, _mm_mul_ps(_mm_sub_ps(_mm_add_ps(windX4, turbulenceX), velocityX), pull4));
+		velocityZ = _mm_add_ps(velocityZ, _mm_mul_ps(_mm_sub_ps(_mm_add_ps(windZ4, turbulenceZ), velocityZ), pull4));
+		_mm_storeu_ps(&m_velocityX[i], velocityX);
+		_mm_storeu_ps(&m_velocityZ[i], velocityZ);
+
+		_mm_storeu_ps(&m_positionX[i], _mm_add_ps(_mm_loadu_ps(&m_positionX[i]), _mm_mul_ps(velocityX, deltaTime4)));
+		_mm_storeu_ps(&m_positionY[i], _mm_add_ps(_mm_loadu_ps(&m_positionY[i]), _mm_mul_ps(velocityY, deltaTime4)));
+		_mm_storeu_ps(&m_positionZ[i], _mm_add_ps(_mm_loadu_ps(&m_positionZ[i]), _mm_mul_ps(velocityZ, deltaTime4)));
+	}
+#else
+	for (int i = 0; i < groupEnd; i++)
+	{
+		float turbulenceX = TURBULENCE_STRENGTH * FastSin(angleX + m_phase[i]);
+		float turbulenceZ = TURBULENCE_STRENGTH * FastSin(angleZ + m_phase[i] * 1.7f);
+
+		m_velocityX[i] += (m_wind.x + turbulenceX - m_velocityX[i]) * pull;
+		m_velocityZ[i] += (m_wind.z + turbulenceZ - m_velocityZ[i]) * pull;
+		m_positionX[i] += m_velocityX[i] * deltaTime;
+		m_positionY[i] += m_velocityY[i] * deltaTime;
+		m_positionZ[i] += m_velocityZ[i] * deltaTime;
+	}
+#endif
+}
+
+/***********************************************************
+ *  KillFlakes()
+ *
+ *  This method is used for returning the flakes that fell
+ *  below the emitter to the pool.  The last live flake is
+ *  moved into the freed entry so the live flakes stay packed
+ *  at the front of the arrays.  Groups of four with nothing
+ *  to kill are skipped with a single compare.
+ ***********************************************************/
+void SnowParticles::KillFlakes()
+{
+	int i = 0;
+	while (i < m_liveCount)
+	{
+#ifdef SNOW_USE_SSE
+		if ((i + 4 <= m_liveCount) &&
+			(_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(&m_positionY[i]), _mm_set1_ps(m_boundsMin.y))) == 0))
+		{
+			i += 4;
+			continue;
+		}
+#endif
+		if (m_positionY[i] >= m_boundsMin.y)
+		{
+			i++;
+			continue;
+		}
+
+		int last = --m_liveCount;
+		m_positionX[i] = m_positionX[last];
+		m_positionY[i] = m_positionY[last];
+		m_positionZ[i] = m_positionZ[last];
+		m_velocityX[i] = m_velocityX[last];
+		m_velocityY[i] = m_velocityY[last];
+		m_velocityZ[i] = m_velocityZ[last];
+		m_phase[i] = m_phase[last];
+		m_size[i] = m_size[last];
+	}
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used for uploading the live part of each
+ *  array into the instance buffer and drawing every flake
+ *  with one instanced draw of a four vertex strip.
+ ***********************************************************/
+void SnowParticles::Draw(const glm::mat4& view, const glm::mat4& projection)
+{
+	const float* attributeArrays[ATTRIBUTE_COUNT] =
+	{
+		m_positionX.data(),
+		m_positionY.data(),
+		m_positionZ.data(),
+		m_size.data()
+	};
+
+	if ((NULL == m_pSnowShader) || (m_liveCount == 0))
+	{
+		return;
+	}
+
+	m_pStateCache->BindVertexArray(m_vertexArrayID);
+	glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferID);
+	// orphan last frame's storage so the upload never waits on the draw reading it
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_capacity * ATTRIBUTE_COUNT * sizeof(float), NULL, GL_STREAM_DRAW);
+	for (int attribute = 0; attribute < ATTRIBUTE_COUNT; attribute++)
+	{
+		glBufferSubData(GL_ARRAY_BUFFER,
+			(GLintptr)attribute * m_capacity * sizeof(float),
+			(GLsizeiptr)m_liveCount * sizeof(float),
+			attributeArrays[attribute]);
+	}
+
+	m_pStateCache->UseProgram(m_pSnowShader->m_programID);
+	m_pSnowShader->setMat4Value("view", view);
+	m_pSnowShader->setMat4Value("projection", projection);
+
+	// the flakes are cut out in the shader, so they sort with depth alone
+	m_pStateCache->SetBlend(false);
+	m_pStateCache->SetDepthTest(true);
+	m_pStateCache->SetDepthMask(true);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, m_liveCount);
+}
+
+/***********************************************************
+ *  Random()
+ *
+ *  This method is used for getting a random value from zero
+ *  to one with a xorshift generator.
+ ***********************************************************/
+float SnowParticles::Random()
+{
+	m_randomState ^= m_randomState << 13;
+	m_randomState ^= m_randomState >> 17;
+	m_randomState ^= m_randomState << 5;
+	return((float)(m_randomState >> 8) * (1.0f / 16777216.0f));
+}
@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+// snowparticles.h
+// ============
+// falling snow particle system - SIMD update of a pooled SoA store, one draw
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "GLStateCache.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  SnowParticles
+ *
+ *  This class contains the code for simulating and drawing
+ *  falling snow.  The flakes are kept as a structure of
+ *  arrays so four of them are moved at a time with SSE.
+ *  Flakes that reach the ground go back to the pool and are
+ *  spawned again at the top of the emitter.  All of the live
+ *  flakes are drawn as camera facing quads in a single
+ *  instanced draw, reading the position arrays directly.
+ ***********************************************************/
+class SnowParticles
+{
+public:
+	// constructor
+	SnowParticles(GLStateCache* pStateCache);
+	// destructor
+	~SnowParticles();
+
+	// load the snow shader and create the particle store
+	bool Initialize(int maxFlakes);
+
+	// set the box the flakes fall through - spawned at the
+	// top, killed at the bottom
+	void SetEmitterBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+	// set the steady horizontal wind
+	void SetWind(const glm::vec3& wind) { m_wind = wind; }
+
+	// spawn, move and kill the flakes for a time step
+	void Update(float deltaTime);
+	// draw the live flakes
+	void Draw(const glm::mat4& view, const glm::mat4& projection);
+
+	// get the number of flakes currently falling
+	int GetLiveCount() const { return(m_liveCount); }
+	// get the time taken by the last update in milliseconds
+	double GetUpdateTime() const { return(m_updateTime); }
+
+private:
+	// vertex attribute locations of the per-flake arrays
+	enum FLAKE_ATTRIBUTE
+	{
+		ATTRIBUTE_POSITION_X,
+		ATTRIBUTE_POSITION_Y,
+		ATTRIBUTE_POSITION_Z,
+		ATTRIBUTE_SIZE,
+		ATTRIBUTE_COUNT
+	};
+
+	// pointer to OpenGL state cache object
+	GLStateCache* m_pStateCache;
+	// shader used for drawing the flakes
+	ShaderManager* m_pSnowShader;
+	// vertex array and the buffer holding the attribute arrays
+	// back to back, each sized for every flake in the pool
+	GLuint m_vertexArrayID;
+	GLuint m_instanceBufferID;
+
+	// flake store - the first m_liveCount entries are falling,
+	// the rest are the free pool, padded to a multiple of four
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_positionZ;
+	std::vector<float> m_velocityX;
+	std::vector<float> m_velocityY;
+	std::vector<float> m_velocityZ;
+	std::vector<float> m_phase;
+	std::vector<float> m_size;
+	int m_capacity;
+	int m_liveCount;
+	// fraction of a flake left over from the last spawn
+	float m_spawnRemainder;
+
+	// emitter box and forces
+	glm::vec3 m_boundsMin;
+	glm::vec3 m_boundsMax;
+	glm::vec3 m_wind;
+	// running time driving the turbulence
+	float m_time;
+	// state of the random number generator
+	uint32_t m_randomState;
+	// time taken by the last update in milliseconds
+	double m_updateTime;
+
+	// add new flakes from the pool at the top of the emitter,
+	// spread down to the passed in distance below it
+	void SpawnFlakes(int count, float heightSpread);
+	// move all of the live flakes
+	void IntegrateFlakes(float deltaTime);
+	// return the flakes below the emitter to the pool
+	void KillFlakes();
+	// get a random value from zero to one
+	float Random();
+};
@@ -0,0 +1,171 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformstore.cpp
+// ============
+// structure of arrays holding the transforms and colors of the moving objects
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformStore.h"
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
+
+// declaration of the global variables and defines
+namespace
+{
+	// value of each channel for a node that has not been moved
+	const float IDENTITY_VALUES[TransformStore::CHANNEL_COUNT][4] =
+	{
+		{ 0.0f, 0.0f, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, 0.0f, 1.0f },
+		{ 1.0f, 1.0f, 1.0f, 0.0f },
+		{ 1.0f, 1.0f, 1.0f, 1.0f }
+	};
+}
+
+/***********************************************************
+ *  TransformStore()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TransformStore::TransformStore()
+{
+}
+
+/***********************************************************
+ *  ~TransformStore()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TransformStore::~TransformStore()
+{
+	m_tags.clear();
+	m_modelMatrices.clear();
+}
+
+/***********************************************************
+ *  AddNode()
+ *
+ *  This method is used for adding a node at the identity
+ *  transform with a white color, and returning its index.
+ ***********************************************************/
+int TransformStore::AddNode(std::string tag)
+{
+	int node = (int)m_tags.size();
+
+	m_tags.push_back(tag);
+	for (int channel = 0; channel < CHANNEL_COUNT; channel++)
+	{
+		for (int component = 0; component < 4; component++)
+		{
+			m_components[channel][component].push_back(IDENTITY_VALUES[channel][component]);
+		}
+	}
+	m_dirty.push_back(0);
+	m_modelMatrices.push_back(glm::mat4(1.0f));
+
+	return(node);
+}
+
+/***********************************************************
+ *  FindNode()
+ *
+ *  This method is used for finding the index of a node from
+ *  its tag.
+ ***********************************************************/
+int TransformStore::FindNode(std::string tag) const
+{
+	int node = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < (int)m_tags.size()) && (bFound == false))
+	{
+		if (m_tags[index].compare(tag) == 0)
+		{
+			node = index;
+			bFound = true;
+		}
+		else
+		{
+			index++;
+		}
+	}
+
+	return(node);
+}
+
+/***********************************************************
+ *  SetTranslation()
+ *
+ *  This method is used for setting the translation of a
+ *  single node.
+ ***********************************************************/
+void TransformStore::SetTranslation(int node, const glm::vec3& translation)
+{
+	m_components[CHANNEL_TRANSLATION][0][node] = translation.x;
+	m_components[CHANNEL_TRANSLATION][1][node] = translation.y;
+	m_components[CHANNEL_TRANSLATION][2][node] = translation.z;
+	m_dirty[node] = 1;
+}
+
+/***********************************************************
+ *  SetRotation()
+ *
+ *  This method is used for setting the rotation quaternion
+ *  of a single node, stored as x, y, z, w.
+ ***********************************************************/
+void TransformStore::SetRotation(int node, const glm::vec4& rotation)
+{
+	for (int component = 0; component < 4; component++)
+	{
+		m_components[CHANNEL_ROTATION][component][node] = rotation[component];
+	}
+	m_dirty[node] = 1;
+}
+
+/***********************************************************
+ *  GetModelMatrix()
+ *
+ *  This method is used for getting the translation, rotation
+ *  and scale of a node as a matrix.  The matrix is cached
+ *  and only rebuilt after the node has been written.
+ ***********************************************************/
+const glm::mat4& TransformStore::GetModelMatrix(int node)
+{
+	if (m_dirty[node] != 0)
+	{
+		glm::vec3 translation = glm::vec3(
+			m_components[CHANNEL_TRANSLATION][0][node],
+			m_components[CHANNEL_TRANSLATION][1][node],
+			m_components[CHANNEL_TRANSLATION][2][node]);
+		glm::quat rotation = glm::quat(
+			m_components[CHANNEL_ROTATION][3][node],
+			m_components[CHANNEL_ROTATION][0][node],
+			m_components[CHANNEL_ROTATION][1][node],
+			m_components[CHANNEL_ROTATION][2][node]);
+		glm::vec3 scale = glm::vec3(
+			m_components[CHANNEL_SCALE][0][node],
+			m_components[CHANNEL_SCALE][1][node],
+			m_components[CHANNEL_SCALE][2][node]);
+
+		m_modelMatrices[node] = glm::translate(translation) * glm::mat4_cast(rotation) * glm::scale(scale);
+		m_dirty[node] = 0;
+	}
+
+	return(m_modelMatrices[node]);
+}
+
+/***********************************************************
+ *  GetColor()
+ *
+ *  This method is used for getting the color of a node.
+ ***********************************************************/
+glm::vec4 TransformStore::GetColor(int node) const
+{
+	return(glm::vec4(
+		m_components[CHANNEL_COLOR][0][node],
+		m_components[CHANNEL_COLOR][1][node],
+		m_components[CHANNEL_COLOR][2][node],
+		m_components[CHANNEL_COLOR][3][node]));
+}
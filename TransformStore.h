@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformstore.h
+// ============
+// structure of arrays holding the transforms and colors of the moving objects
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TransformStore
+ *
+ *  This class contains the transforms of the scene objects
+ *  that are moved at run time.  Every component of every
+ *  channel - translation, rotation quaternion, scale and
+ *  color - is kept in its own array indexed by node, so the
+ *  systems driving them can write whole batches at a time.
+ *  A node is flagged dirty when written and its model matrix
+ *  is only rebuilt when it is next read.
+ ***********************************************************/
+class TransformStore
+{
+public:
+	// constructor
+	TransformStore();
+	// destructor
+	~TransformStore();
+
+	// channels kept for every node, four components each
+	enum TRANSFORM_CHANNEL
+	{
+		CHANNEL_TRANSLATION,
+		CHANNEL_ROTATION,
+		CHANNEL_SCALE,
+		CHANNEL_COLOR,
+		CHANNEL_COUNT
+	};
+
+	// add a node with no offset, rotation or tint
+	int AddNode(std::string tag);
+	// find a node by tag, -1 when there is none
+	int FindNode(std::string tag) const;
+	// get the number of nodes
+	int GetNodeCount() const { return((int)m_tags.size()); }
+
+	// get the array of one component of a channel for all nodes
+	float* GetComponent(TRANSFORM_CHANNEL channel, int component) { return(m_components[channel][component].data()); }
+	// flag a node as changed after writing its components
+	void MarkDirty(int node) { m_dirty[node] = 1; }
+
+	// set the translation and rotation of a node
+	void SetTranslation(int node, const glm::vec3& translation);
+	void SetRotation(int node, const glm::vec4& rotation);
+
+	// get the matrix of a node, rebuilt when it is dirty
+	const glm::mat4& GetModelMatrix(int node);
+	// get the color of a node
+	glm::vec4 GetColor(int node) const;
+
+private:
+	// tag of every node
+	std::vector<std::string> m_tags;
+	// one array per component of each channel
+	std::vector<float> m_components[CHANNEL_COUNT][4];
+	// nodes written since their matrix was last built
+	std::vector<uint8_t> m_dirty;
+	// matrix built from the components of every node
+	std::vector<glm::mat4> m_modelMatrices;
+};
@@ -8,12 +8,15 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "ViewManager.h"
+#include "SceneBVH.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>    
 
+#include <algorithm>
+
 // declaration of the global variables and defines
 namespace
 {
@@ -31,14 +34,68 @@ namespace
 	float gLastX = WINDOW_WIDTH / 2.0f;
 	float gLastY = WINDOW_HEIGHT / 2.0f;
 	bool gFirstMouse = true;
+	// set when the left mouse button is clicked, cleared when
+	// the pick ray is taken
+	bool gPickRequested = false;
 
 	// time between current frame and last frame
 	float gDeltaTime = 0.0f; 
 	float gLastFrame = 0.0f;
 
+	// camera movement runs at a fixed rate, catching up on at
+	// most a few steps in one frame
+	const float FIXED_TIME_STEP = 1.0f / 120.0f;
+	const int MAX_STEPS_PER_FRAME = 8;
+	float gStepAccumulator = 0.0f;
+	// size of the camera when colliding with the scene, and
+	// the gap kept between it and the surfaces
+	const float CAMERA_RADIUS = 0.3f;
+	const float CAMERA_SKIN = 0.01f;
+	const int MAX_CAMERA_SLIDES = 3;
+
 	// the following variable is false when orthographic projection
 	// is off and true when it is on
 	bool bOrthographicProjection = false;
+
+	// the following variable is true when the front, side, top
+	// and perspective views are drawn at once, and the key state
+	// is kept so holding the key only toggles once
+	bool bQuadView = false;
+	bool gQuadViewKeyDown = false;
+	// the following variable is true while the frames are saved
+	// as an image sequence, with the key state kept the same way
+	bool bCaptureFrames = false;
+	bool gCaptureKeyDown = false;
+	// the following variable is true while the performance
+	// overlay is drawn over the scene, with the key state kept
+	// the same way
+	bool bPerfHud = false;
+	bool gPerfHudKeyDown = false;
+	// the following variable is the heatmap drawn in place of
+	// the lit scene, stepped through with its key kept the same
+	// way
+	DebugViewRenderer::DEBUG_VIEW debugView = DebugViewRenderer::DEBUG_VIEW_NONE;
+	bool gDebugViewKeyDown = false;
+	// fixed cameras of the front, side and top quad views, the
+	// same as the 1, 2 and 3 keys
+	const glm::vec3 QUAD_VIEW_POSITIONS[3] =
+	{
+		glm::vec3(0.0f, 4.0f, 10.0f),
+		glm::vec3(10.0f, 4.0f, 0.0f),
+		glm::vec3(0.0f, 7.0f, 0.0f)
+	};
+	const glm::vec3 QUAD_VIEW_FRONTS[3] =
+	{
+		glm::vec3(0.0f, 0.0f, -1.0f),
+		glm::vec3(-1.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, -1.0f, 0.0f)
+	};
+	const glm::vec3 QUAD_VIEW_UPS[3] =
+	{
+		glm::vec3(0.0f, 1.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f),
+		glm::vec3(-1.0f, 0.0f, 0.0f)
+	};
 }
 
 /***********************************************************
@@ -47,11 +104,20 @@ namespace
  *  The constructor for the class
  ***********************************************************/
 ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
+	ShaderManager *pShaderManager,
+	GLStateCache* pStateCache)
 {
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
+	m_pStateCache = pStateCache;
 	m_pWindow = NULL;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_viewportCount = 1;
+	m_pCollisionBVH = NULL;
+	m_pRecording = NULL;
+	m_pPlayback = NULL;
+	m_playbackStep = 0;
 	g_pCamera = new Camera();
 	// default camera view parameters
 	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
@@ -70,7 +136,10 @@ ViewManager::~ViewManager()
 {
 	// free up allocated memory
 	m_pShaderManager = NULL;
+	m_pStateCache = NULL;
 	m_pWindow = NULL;
+	m_pRecording = NULL;
+	m_pPlayback = NULL;
 	if (NULL != g_pCamera)
 	{
 		delete g_pCamera;
@@ -109,10 +178,13 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 
 	//this callback is used to receive mouse scroll wheel events
 	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Wheel_Callback);
+
+	// this callback is used to receive mouse clicks for picking
+	glfwSetMouseButtonCallback(window, &ViewManager::Mouse_Button_Callback);
 	
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	// set the blend function for supporting tranparent rendering - blending
+	// itself is only enabled by the scene manager for the transparent pass
+	m_pStateCache->SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	m_pWindow = window;
 
@@ -153,6 +225,22 @@ void ViewManager::Mouse_Scroll_Wheel_Callback(GLFWwindow* window, double x, doub
 	g_pCamera->ProcessMouseScroll(yScrollDistance);
 }
 
+/***********************************************************
+ *  Mouse_Button_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  a mouse button is pressed or released within the active
+ *  GLFW display window.
+ ***********************************************************/
+void ViewManager::Mouse_Button_Callback(GLFWwindow* window, int button, int action, int mods)
+{
+	// the pick itself waits for the next frame's matrices
+	if ((button == GLFW_MOUSE_BUTTON_LEFT) && (action == GLFW_PRESS))
+	{
+		gPickRequested = true;
+	}
+}
+
 
 
 /***********************************************************
@@ -169,33 +257,29 @@ void ViewManager::ProcessKeyboardEvents()
 		glfwSetWindowShouldClose(m_pWindow, true);
 	}
 
-	// process camera zooming in and out
-	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
-	}
-
-	// process camera panning left and right
-	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
+	// move the camera in fixed time steps, so how far it gets
+	// into a collision does not depend on the frame rate
+	gStepAccumulator += gDeltaTime;
+	int steps = 0;
+	while ((gStepAccumulator >= FIXED_TIME_STEP) && (steps < MAX_STEPS_PER_FRAME))
 	{
-		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
+		glm::vec3 startPosition = g_pCamera->Position;
+
+		ProcessMovementKeys(FIXED_TIME_STEP);
+		MoveCamera(startPosition);
+		if (NULL != m_pRecording)
+		{
+			CameraRecording::CAMERA_STATE state;
+			GetCameraState(state);
+			m_pRecording->AddState(state);
+		}
+		gStepAccumulator -= FIXED_TIME_STEP;
+		steps++;
 	}
-	//process camera panning up and down
-	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
+	// drop the time a long stall could not catch up on
+	if (steps == MAX_STEPS_PER_FRAME)
 	{
-		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
+		gStepAccumulator = 0.0f;
 	}
 	//Toggle orthographic projection with "O" key
 	if (glfwGetKey(m_pWindow, GLFW_KEY_1) == GLFW_PRESS)
@@ -233,6 +317,126 @@ void ViewManager::ProcessKeyboardEvents()
 		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
 		g_pCamera->Zoom = 80;
 	}
+	// toggle drawing all four views at once with "5"
+	bool bQuadViewKeyDown = (glfwGetKey(m_pWindow, GLFW_KEY_5) == GLFW_PRESS);
+	if ((bQuadViewKeyDown == true) && (gQuadViewKeyDown == false))
+	{
+		bQuadView = !bQuadView;
+	}
+	gQuadViewKeyDown = bQuadViewKeyDown;
+	// toggle the performance overlay with "6"
+	bool bPerfHudKeyDown = (glfwGetKey(m_pWindow, GLFW_KEY_6) == GLFW_PRESS);
+	if ((bPerfHudKeyDown == true) && (gPerfHudKeyDown == false))
+	{
+		bPerfHud = !bPerfHud;
+	}
+	gPerfHudKeyDown = bPerfHudKeyDown;
+	// step through the overdraw, lights and mip level heatmaps
+	// and back to the lit scene with "7"
+	bool bDebugViewKeyDown = (glfwGetKey(m_pWindow, GLFW_KEY_7) == GLFW_PRESS);
+	if ((bDebugViewKeyDown == true) && (gDebugViewKeyDown == false))
+	{
+		debugView = (DebugViewRenderer::DEBUG_VIEW)((debugView + 1) % DebugViewRenderer::DEBUG_VIEW_COUNT);
+		std::cout << "INFO: Debug view - " << DebugViewRenderer::GetViewName(debugView) << std::endl;
+	}
+	gDebugViewKeyDown = bDebugViewKeyDown;
+	// toggle saving the frames as images with "R"
+	bool bCaptureKeyDown = (glfwGetKey(m_pWindow, GLFW_KEY_R) == GLFW_PRESS);
+	if ((bCaptureKeyDown == true) && (gCaptureKeyDown == false))
+	{
+		bCaptureFrames = !bCaptureFrames;
+	}
+	gCaptureKeyDown = bCaptureKeyDown;
+}
+
+/***********************************************************
+ *  ProcessMovementKeys()
+ *
+ *  This method is called to move the camera by the held
+ *  movement keys over a time step.
+ ***********************************************************/
+void ViewManager::ProcessMovementKeys(float deltaTime)
+{
+	// process camera zooming in and out
+	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(FORWARD, deltaTime);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(BACKWARD, deltaTime);
+	}
+
+	// process camera panning left and right
+	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(LEFT, deltaTime);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(RIGHT, deltaTime);
+	}
+	//process camera panning up and down
+	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(UP, deltaTime);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(DOWN, deltaTime);
+	}
+}
+
+/***********************************************************
+ *  MoveCamera()
+ *
+ *  This method is used for replaying the move the keys made
+ *  from the start position as a sphere swept through the
+ *  scene.  When the sphere touches a shape it stops there
+ *  and the rest of the move slides along the surface, a few
+ *  times over so it can follow into corners.
+ ***********************************************************/
+void ViewManager::MoveCamera(const glm::vec3& startPosition)
+{
+	if (NULL == m_pCollisionBVH)
+	{
+		return;
+	}
+
+	glm::vec3 position = startPosition;
+	glm::vec3 motion = g_pCamera->Position - startPosition;
+
+	for (int slide = 0; slide < MAX_CAMERA_SLIDES; slide++)
+	{
+		float length = glm::length(motion);
+		if (length < 1.0e-6f)
+		{
+			break;
+		}
+
+		glm::vec3 direction = motion / length;
+		SceneBVH::RAY_HIT hit;
+		if (m_pCollisionBVH->SweepSphere(position, direction, length, CAMERA_RADIUS, hit) == false)
+		{
+			position += motion;
+			break;
+		}
+
+		// already overlapping a shape - push straight out of it
+		if (hit.distance < 0.0f)
+		{
+			position += hit.normal * (CAMERA_SKIN - hit.distance);
+			continue;
+		}
+
+		// stop just short of the contact and slide the remainder
+		float travel = std::max(hit.distance - CAMERA_SKIN, 0.0f);
+		position += direction * travel;
+		motion = direction * (length - travel);
+		motion -= hit.normal * std::min(glm::dot(motion, hit.normal), 0.0f);
+	}
+
+	g_pCamera->Position = position;
 }
 
 /***********************************************************
@@ -244,9 +448,6 @@ void ViewManager::ProcessKeyboardEvents()
  ***********************************************************/
 void ViewManager::PrepareSceneView()
 {
-	glm::mat4 view;
-	glm::mat4 projection;
-
 	// per-frame timing
 	float currentFrame = glfwGetTime();
 	gDeltaTime = currentFrame - gLastFrame;
@@ -255,21 +456,44 @@ void ViewManager::PrepareSceneView()
 	// process any keyboard events that may be waiting in the 
 	// event queue
 	ProcessKeyboardEvents();
+	// a playback moves the camera the same steps every frame,
+	// whatever the keys did and however long the frame took
+	if (NULL != m_pPlayback)
+	{
+		AdvancePlayback();
+	}
+
+	PrepareCameraView(WINDOW_WIDTH, WINDOW_HEIGHT);
+	PrepareQuadViews();
+}
+
+/***********************************************************
+ *  PrepareCameraView()
+ *
+ *  This method is used for setting the view and projection
+ *  of the camera into the shader for an image of the passed
+ *  in size, without processing any input.
+ ***********************************************************/
+void ViewManager::PrepareCameraView(int width, int height)
+{
+	glm::mat4 view;
+	glm::mat4 projection;
 
 	// get the current view matrix from the camera
 	view = g_pCamera->GetViewMatrix();
 
 	if (bOrthographicProjection) {
 		float orthoScale = 10.0f;
-		float aspectRatio = static_cast<float>(WINDOW_WIDTH) / WINDOW_HEIGHT;
+		float aspectRatio = static_cast<float>(width) / height;
 		projection = glm::ortho(-orthoScale * aspectRatio, orthoScale * aspectRatio, -orthoScale, orthoScale, 0.1f, 100.0f);
 	}
 	else {
-		projection = glm::perspective(glm::radians(g_pCamera->Zoom), static_cast<float>(WINDOW_WIDTH) / WINDOW_HEIGHT, 0.1f, 100.0f);
+		projection = glm::perspective(glm::radians(g_pCamera->Zoom), static_cast<float>(width) / height, 0.1f, 100.0f);
 	}
 
-	// define the current projection matrix
-	projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
+	// keep the matrices for the scene manager
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
 
 	// if the shader manager object is valid
 	if (NULL != m_pShaderManager)
@@ -284,4 +508,312 @@ void ViewManager::PrepareSceneView()
 		m_pShaderManager->setVec3Value("spotLight.position", g_pCamera->Position);
 		m_pShaderManager->setVec3Value("spotLight.direction", g_pCamera->Front);
 	}
-}
\ No newline at end of file
+}
+
+/***********************************************************
+ *  SetCameraPose()
+ *
+ *  This method is used for placing the camera, as when it
+ *  follows a camera path rather than the input.
+ ***********************************************************/
+void ViewManager::SetCameraPose(
+	const glm::vec3& position,
+	const glm::vec3& front,
+	float zoom)
+{
+	g_pCamera->Position = position;
+	g_pCamera->Front = front;
+	g_pCamera->Zoom = zoom;
+}
+
+/***********************************************************
+ *  GetCameraState()
+ *
+ *  This method is used for getting everything that sets
+ *  the view of the camera.
+ ***********************************************************/
+void ViewManager::GetCameraState(CameraRecording::CAMERA_STATE& state) const
+{
+	state.position = g_pCamera->Position;
+	state.front = g_pCamera->Front;
+	state.up = g_pCamera->Up;
+	state.zoom = g_pCamera->Zoom;
+	state.bOrthographic = bOrthographicProjection;
+}
+
+/***********************************************************
+ *  SetCameraState()
+ *
+ *  This method is used for placing the camera and picking
+ *  its projection.
+ ***********************************************************/
+void ViewManager::SetCameraState(const CameraRecording::CAMERA_STATE& state)
+{
+	g_pCamera->Position = state.position;
+	g_pCamera->Front = state.front;
+	g_pCamera->Up = state.up;
+	g_pCamera->Zoom = state.zoom;
+	bOrthographicProjection = state.bOrthographic;
+}
+
+/***********************************************************
+ *  StartRecording()
+ *
+ *  This method is used for starting a new recording, which
+ *  takes the state of the camera after every fixed time
+ *  step of the movement.
+ ***********************************************************/
+void ViewManager::StartRecording(CameraRecording* pRecording)
+{
+	m_pRecording = pRecording;
+	if (NULL != m_pRecording)
+	{
+		m_pRecording->Clear(FIXED_TIME_STEP);
+	}
+}
+
+/***********************************************************
+ *  StartPlayback()
+ *
+ *  This method is used for starting to play a recording
+ *  back from its first state.
+ ***********************************************************/
+void ViewManager::StartPlayback(const CameraRecording* pRecording)
+{
+	m_pPlayback = pRecording;
+	m_playbackStep = 0;
+}
+
+/***********************************************************
+ *  AdvancePlayback()
+ *
+ *  This method is used for placing the camera at the next
+ *  state of the playback.  Every frame moves on by the same
+ *  number of recorded steps rather than by the time that
+ *  passed, so each run draws exactly the same views.
+ ***********************************************************/
+bool ViewManager::AdvancePlayback()
+{
+	if ((NULL == m_pPlayback) || (m_playbackStep >= m_pPlayback->GetStateCount()))
+	{
+		return(false);
+	}
+
+	SetCameraState(m_pPlayback->GetState(m_playbackStep));
+	m_playbackStep += PLAYBACK_STEPS_PER_FRAME;
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsPlaybackFinished()
+ *
+ *  This method is used for checking whether every state of
+ *  the playback has been shown.
+ ***********************************************************/
+bool ViewManager::IsPlaybackFinished() const
+{
+	return((NULL != m_pPlayback) && (m_playbackStep >= m_pPlayback->GetStateCount()));
+}
+
+/***********************************************************
+ *  GetPlaybackFrameTime()
+ *
+ *  This method is used for getting the recorded time that
+ *  passes between two frames of the playback, 0 when not
+ *  playing back.
+ ***********************************************************/
+float ViewManager::GetPlaybackFrameTime() const
+{
+	if (NULL == m_pPlayback)
+	{
+		return(0.0f);
+	}
+
+	return(m_pPlayback->GetTimeStep() * PLAYBACK_STEPS_PER_FRAME);
+}
+
+/***********************************************************
+ *  PrepareQuadViews()
+ *
+ *  This method is used for setting up the cameras of the
+ *  quad view - front, side and top orthographic views from
+ *  the fixed cameras of the 1 to 3 keys in the top left, top
+ *  right and bottom left of the window, and the moving
+ *  perspective camera in the bottom right.  The orthographic
+ *  views reach behind their cameras so the tall shapes are
+ *  not cut off from above.
+ ***********************************************************/
+void ViewManager::PrepareQuadViews()
+{
+	int width = WINDOW_WIDTH;
+	int height = WINDOW_HEIGHT;
+
+	if (bQuadView == false)
+	{
+		m_viewportCount = 1;
+		return;
+	}
+
+	glfwGetFramebufferSize(m_pWindow, &width, &height);
+	int halfWidth = width / 2;
+	int halfHeight = height / 2;
+	float aspectRatio = (float)halfWidth / (float)std::max(halfHeight, 1);
+	float orthoScale = 10.0f;
+
+	for (int i = 0; i < 4; i++)
+	{
+		m_quadViewports[i][0] = ((i % 2) == 0) ? 0 : halfWidth;
+		m_quadViewports[i][1] = (i < 2) ? halfHeight : 0;
+		m_quadViewports[i][2] = halfWidth;
+		m_quadViewports[i][3] = halfHeight;
+
+		if (i < 3)
+		{
+			m_quadPositions[i] = QUAD_VIEW_POSITIONS[i];
+			m_quadViewMatrices[i] = glm::lookAt(
+				QUAD_VIEW_POSITIONS[i],
+				QUAD_VIEW_POSITIONS[i] + QUAD_VIEW_FRONTS[i],
+				QUAD_VIEW_UPS[i]);
+			m_quadProjectionMatrices[i] = glm::ortho(
+				-orthoScale * aspectRatio, orthoScale * aspectRatio,
+				-orthoScale, orthoScale, -50.0f, 100.0f);
+		}
+		else
+		{
+			m_quadPositions[i] = g_pCamera->Position;
+			m_quadViewMatrices[i] = m_viewMatrix;
+			m_quadProjectionMatrices[i] = glm::perspective(
+				glm::radians(g_pCamera->Zoom), aspectRatio, 0.1f, 100.0f);
+		}
+	}
+	m_viewportCount = 4;
+}
+
+/***********************************************************
+ *  GetViewport()
+ *
+ *  This method is used for getting the window area and the
+ *  camera of one of the quad views.
+ ***********************************************************/
+void ViewManager::GetViewport(
+	int index,
+	int viewport[4],
+	glm::mat4& view,
+	glm::mat4& projection,
+	glm::vec3& position) const
+{
+	for (int i = 0; i < 4; i++)
+	{
+		viewport[i] = m_quadViewports[index][i];
+	}
+	view = m_quadViewMatrices[index];
+	projection = m_quadProjectionMatrices[index];
+	position = m_quadPositions[index];
+}
+
+/***********************************************************
+ *  GetViewPosition()
+ *
+ *  This method is used for getting the current position of
+ *  the camera.
+ ***********************************************************/
+glm::vec3 ViewManager::GetViewPosition() const
+{
+	return(g_pCamera->Position);
+}
+
+/***********************************************************
+ *  IsCapturingFrames()
+ *
+ *  This method is used for checking whether the frames are
+ *  being saved as images, toggled by the record key.
+ ***********************************************************/
+bool ViewManager::IsCapturingFrames() const
+{
+	return(bCaptureFrames);
+}
+
+/***********************************************************
+ *  SetCapturingFrames()
+ *
+ *  This method is used for starting or stopping saving the
+ *  frames as images.
+ ***********************************************************/
+void ViewManager::SetCapturingFrames(bool bCapture)
+{
+	bCaptureFrames = bCapture;
+}
+
+/***********************************************************
+ *  IsShowingPerfHud()
+ *
+ *  This method is used for checking whether the performance
+ *  overlay is shown, toggled by the 6 key.
+ ***********************************************************/
+bool ViewManager::IsShowingPerfHud() const
+{
+	return(bPerfHud);
+}
+
+/***********************************************************
+ *  SetShowingPerfHud()
+ *
+ *  This method is used for showing or hiding the performance
+ *  overlay.
+ ***********************************************************/
+void ViewManager::SetShowingPerfHud(bool bShow)
+{
+	bPerfHud = bShow;
+}
+
+/***********************************************************
+ *  GetDebugView()
+ *
+ *  This method is used for getting the heatmap drawn in
+ *  place of the lit scene, stepped through by the 7 key.
+ ***********************************************************/
+DebugViewRenderer::DEBUG_VIEW ViewManager::GetDebugView() const
+{
+	return(debugView);
+}
+
+/***********************************************************
+ *  SetDebugView()
+ *
+ *  This method is used for selecting the heatmap drawn in
+ *  place of the lit scene.
+ ***********************************************************/
+void ViewManager::SetDebugView(DebugViewRenderer::DEBUG_VIEW view)
+{
+	debugView = view;
+}
+
+/***********************************************************
+ *  GetPickRay()
+ *
+ *  This method is used for getting the ray from the camera
+ *  through the center of the view when the left mouse button
+ *  was clicked since the last call.  The cursor is captured
+ *  for looking around, so the center of the view is where
+ *  the mouse points.  The near and far points are taken back
+ *  through the last view and projection, which works for the
+ *  orthographic views as well.
+ ***********************************************************/
+bool ViewManager::GetPickRay(glm::vec3& origin, glm::vec3& direction)
+{
+	if (gPickRequested == false)
+	{
+		return(false);
+	}
+	gPickRequested = false;
+
+	glm::mat4 inverseViewProjection = glm::inverse(m_projectionMatrix * m_viewMatrix);
+	glm::vec4 nearPoint = inverseViewProjection * glm::vec4(0.0f, 0.0f, -1.0f, 1.0f);
+	glm::vec4 farPoint = inverseViewProjection * glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+	origin = glm::vec3(nearPoint) / nearPoint.w;
+	direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+
+	return(true);
+}
@@ -10,17 +10,26 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "GLStateCache.h"
 #include "camera.h"
+#include "CameraRecording.h"
+#include "DebugViewRenderer.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
 
 // GLFW library
 #include "GLFW/glfw3.h" 
 
+class SceneBVH;
+
 class ViewManager
 {
 public:
 	// constructor
 	ViewManager(
-		ShaderManager* pShaderManager);
+		ShaderManager* pShaderManager,
+		GLStateCache* pStateCache);
 	// destructor
 	~ViewManager();
 
@@ -30,14 +39,44 @@ public:
 	//mouse scroll wheel callback for mouse interaction
 	static void Mouse_Scroll_Wheel_Callback(GLFWwindow* window, double x, double yScrollDistance);
 
+	// mouse button callback for picking objects in the 3D scene
+	static void Mouse_Button_Callback(GLFWwindow* window, int button, int action, int mods);
+
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
+	// pointer to OpenGL state cache object
+	GLStateCache* m_pStateCache;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// view and projection matrices from the last prepared view
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	// shapes the camera collides with, NULL to fly freely
+	const SceneBVH* m_pCollisionBVH;
+	// number of views drawn this frame, and the window area and
+	// camera of each quad view
+	int m_viewportCount;
+	int m_quadViewports[4][4];
+	glm::mat4 m_quadViewMatrices[4];
+	glm::mat4 m_quadProjectionMatrices[4];
+	glm::vec3 m_quadPositions[4];
+	// states added at every time step while recording, NULL
+	// when not recording
+	CameraRecording* m_pRecording;
+	// states moving the camera in place of the input, NULL when
+	// not playing back, and the next state shown
+	const CameraRecording* m_pPlayback;
+	int m_playbackStep;
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
+	// move the camera by the held movement keys
+	void ProcessMovementKeys(float deltaTime);
+	// sweep the camera from where it was through the scene
+	void MoveCamera(const glm::vec3& startPosition);
+	// set up the cameras of the quad view when it is on
+	void PrepareQuadViews();
 
 public:
 	// create the initial OpenGL display window
@@ -45,4 +84,70 @@ public:
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+	// send the camera into the shader for an image of the passed
+	// in size without processing input
+	void PrepareCameraView(int width, int height);
+	// place the camera
+	void SetCameraPose(
+		const glm::vec3& position,
+		const glm::vec3& front,
+		float zoom);
+
+	// recorded time steps shown each frame of a playback
+	static const int PLAYBACK_STEPS_PER_FRAME = 2;
+
+	// get or set the full state of the camera
+	void GetCameraState(CameraRecording::CAMERA_STATE& state) const;
+	void SetCameraState(const CameraRecording::CAMERA_STATE& state);
+	// add the camera to the recording after every time step,
+	// NULL to stop
+	void StartRecording(CameraRecording* pRecording);
+	// move the camera from the recording instead of the input,
+	// NULL to stop
+	void StartPlayback(const CameraRecording* pRecording);
+	// show the states of the next frame of the playback, false
+	// once they have all been shown
+	bool AdvancePlayback();
+	// check whether a playback is running, and whether it has
+	// shown all of its states
+	bool IsPlayingBack() const { return(NULL != m_pPlayback); }
+	bool IsPlaybackFinished() const;
+	// get the scene time that passes in each frame of the playback
+	float GetPlaybackFrameTime() const;
+
+	// get the matrices and camera position from the last prepared view
+	const glm::mat4& GetViewMatrix() const { return(m_viewMatrix); }
+	const glm::mat4& GetProjectionMatrix() const { return(m_projectionMatrix); }
+	glm::vec3 GetViewPosition() const;
+
+	// set the shapes the camera collides with, NULL to fly freely
+	void SetCollisionScene(const SceneBVH* pSceneBVH) { m_pCollisionBVH = pSceneBVH; }
+
+	// get the ray through the crosshair when the scene was
+	// clicked since the last call
+	bool GetPickRay(glm::vec3& origin, glm::vec3& direction);
+
+	// check or set whether the frames are saved as images
+	bool IsCapturingFrames() const;
+	void SetCapturingFrames(bool bCapture);
+
+	// check or set whether the performance overlay is shown
+	bool IsShowingPerfHud() const;
+	void SetShowingPerfHud(bool bShow);
+
+	// get or set the heatmap drawn in place of the lit scene
+	DebugViewRenderer::DEBUG_VIEW GetDebugView() const;
+	void SetDebugView(DebugViewRenderer::DEBUG_VIEW view);
+
+	// get the number of views drawn this frame - 4 in the quad
+	// view, otherwise 1 for the main camera alone
+	int GetViewportCount() const { return(m_viewportCount); }
+	// get the window area, x, y, width and height, and the
+	// camera of a quad view
+	void GetViewport(
+		int index,
+		int viewport[4],
+		glm::mat4& view,
+		glm::mat4& projection,
+		glm::vec3& position) const;
 };
\ No newline at end of file
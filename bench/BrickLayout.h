@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+// bricklayout.h
+// ============
+// the bricks of the 8-2 assignment, for stepping it without a window
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "BrickWorld.h"
+
+#include <vector>
+
+/***********************************************************
+ *  CreateBricks()
+ *
+ *  This function is used for building the same 26 bricks
+ *  the 8-2 assignment places, in the order it checks them.
+ ***********************************************************/
+inline std::vector<Brick> CreateBricks()
+{
+	std::vector<Brick> bricks;
+
+	bricks.push_back(Brick(DESTRUCTABLE, 0.5, -0.33, 0.20, 1, 1, 0));
+	bricks.push_back(Brick(DESTRUCTABLE, -0.5, 0.20, 0.20, 0, 1, 0));
+	bricks.push_back(Brick(DESTRUCTABLE, -0.5, -0.33, 0.20, 0, 1, 1));
+	bricks.push_back(Brick(REFLECTIVE, 0.7, 0.6, 0.20, 1, 0.5, 0.5));
+	bricks.push_back(Brick(DESTRUCTABLE, -0.9, 0.80, 0.20, 1, 1, 1));
+	bricks.push_back(Brick(DESTRUCTABLE, 0.9, 0.80, 0.20, 0, 1, 1));
+	bricks.push_back(Brick(DESTRUCTABLE, -0.7, 0.80, 0.20, 0, 1, 0));
+	bricks.push_back(Brick(DESTRUCTABLE, 0.7, 0.80, 0.20, 1, 1, 1));
+	bricks.push_back(Brick(DESTRUCTABLE, 0.5, 0.20, 0.20, 1, 0, 0));
+	bricks.push_back(Brick(REFLECTIVE, -0.7, 0.60, 0.20, 1, 0.5, 0.5));
+	bricks.push_back(Brick(REFLECTIVE, -0.5, 0.40, 0.20, 1, 0.5, 0.5));
+	bricks.push_back(Brick(REFLECTIVE, 0.5, 0.40, 0.20, 1, 0.5, 0.5));
+	bricks.push_back(Brick(REFLECTIVE, -0.3, 0.20, 0.20, 1, 0.5, 0.5));
+	bricks.push_back(Brick(REFLECTIVE, 0.3, 0.20, 0.20, 1, 0.5, 0.5));
+	bricks.push_back(Brick(DESTRUCTABLE, 0.0, 0.20, 0.20, 0, 1, 1));
+	bricks.push_back(Brick(DESTRUCTABLE, -0.9, 0.00, 0.20, 1, 1, 1));
+	bricks.push_back(Brick(DESTRUCTABLE, -0.7, 0.00, 0.20, 0, 1, 0));
+	bricks.push_back(Brick(DESTRUCTABLE, -0.5, 0.00, 0.20, 0, 1, 1));
+	bricks.push_back(Brick(DESTRUCTABLE, -0.3, 0.00, 0.20, 1, 1, 1));
+	bricks.push_back(Brick(DESTRUCTABLE, -0.1, 0.00, 0.20, 0, 1, 0));
+	bricks.push_back(Brick(DESTRUCTABLE, 0.1, 0.00, 0.20, 0, 1, 1));
+	bricks.push_back(Brick(DESTRUCTABLE, 0.3, 0.00, 0.20, 1, 1, 1));
+	bricks.push_back(Brick(DESTRUCTABLE, 0.5, 0.00, 0.20, 0, 1, 0));
+	bricks.push_back(Brick(DESTRUCTABLE, 0.7, 0.00, 0.20, 0, 1, 1));
+	bricks.push_back(Brick(DESTRUCTABLE, 0.9, 0.00, 0.20, 1, 1, 1));
+	// the circle launcher
+	bricks.push_back(Brick(REFLECTIVE, 0, -0.8, 0.25, 1, 0.5, 0.5));
+
+	return(bricks);
+}
+
+/***********************************************************
+ *  LaunchCircle()
+ *
+ *  This function is used for making a circle the way the
+ *  space key does in the 8-2 assignment.
+ ***********************************************************/
+inline Circle LaunchCircle()
+{
+	double r = rand() / 10000;
+	double g = rand() / 10000;
+	double b = rand() / 10000;
+
+	return(Circle(0, -0.8, 02, 3, 0.03, r, g, b));
+}
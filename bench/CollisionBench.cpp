@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////////
+// collisionbench.cpp
+// ============
+// step the 8-2 brick simulation without a window and report what it costs
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_SUCCESS, srand
+#include <cstring>          // strcmp
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "BrickLayout.h"
+
+// Namespace for declaring global variables
+namespace
+{
+	// circles launched, one a step as when space is held, and
+	// the steps measured once they are all out
+	const int DEFAULT_CIRCLES = 1000;
+	const int DEFAULT_STEPS = 2000;
+	// the same seed each run so the circles take the same paths
+	const unsigned int RANDOM_SEED = 8;
+
+	/***********************************************************
+	 *  StepWorld()
+	 *
+	 *  This function is used for moving every circle one step,
+	 *  checked against every brick the way the 8-2 main loop
+	 *  does before it draws.
+	 ***********************************************************/
+	void StepWorld(std::vector<Circle>& world, std::vector<Brick>& bricks)
+	{
+		for (size_t i = 0; i < world.size(); i++)
+		{
+			for (size_t j = 0; j < bricks.size(); j++)
+			{
+				world[i].CheckCollision(&bricks[j]);
+			}
+			world[i].MoveOneStep();
+		}
+	}
+}
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the benchmark has been
+ *  launched.  It launches the circles, then times the steps
+ *  of the full world and reports the time of each step and
+ *  of each circle against the bricks.  The results are
+ *  printed as a line of text, or as JSON with --json.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int circleCount = DEFAULT_CIRCLES;
+	int stepCount = DEFAULT_STEPS;
+	bool bJson = false;
+
+	// process the command line options
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--circles") == 0) && (i + 1 < argc))
+		{
+			circleCount = std::max(atoi(argv[++i]), 1);
+		}
+		else if ((strcmp(argv[i], "--steps") == 0) && (i + 1 < argc))
+		{
+			stepCount = std::max(atoi(argv[++i]), 1);
+		}
+		else if (strcmp(argv[i], "--json") == 0)
+		{
+			bJson = true;
+		}
+	}
+
+	srand(RANDOM_SEED);
+	std::vector<Brick> bricks = CreateBricks();
+	std::vector<Circle> world;
+
+	// launch the circles, stepping the world as they come out
+	world.reserve(circleCount);
+	for (int i = 0; i < circleCount; i++)
+	{
+		world.push_back(LaunchCircle());
+		StepWorld(world, bricks);
+	}
+
+	std::vector<double> stepTimes;
+	double totalTime = 0.0;
+	for (int i = 0; i < stepCount; i++)
+	{
+		auto stepStart = std::chrono::steady_clock::now();
+		StepWorld(world, bricks);
+		double stepTime = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - stepStart).count();
+		stepTimes.push_back(stepTime);
+		totalTime += stepTime;
+	}
+
+	int bricksLeft = 0;
+	for (size_t j = 0; j < bricks.size(); j++)
+	{
+		if (bricks[j].onoff == ON)
+		{
+			bricksLeft++;
+		}
+	}
+
+	std::sort(stepTimes.begin(), stepTimes.end());
+	double medianStepTime = stepTimes[stepTimes.size() / 2];
+	double circleTime = totalTime * 1.0e6 / ((double)stepCount * circleCount);
+
+	if (bJson == true)
+	{
+		std::cout << "{\"simulation\": \"8-2\""
+			<< ", \"circles\": " << circleCount
+			<< ", \"steps\": " << stepCount
+			<< ", \"step_ms\": " << totalTime / stepCount
+			<< ", \"step_ms_median\": " << medianStepTime
+			<< ", \"circle_step_ns\": " << circleTime
+			<< ", \"bricks_left\": " << bricksLeft
+			<< "}" << std::endl;
+	}
+	else
+	{
+		std::cout << "8-2: " << circleCount << " circles, step " << totalTime / stepCount
+			<< " ms (median " << medianStepTime << "), " << circleTime
+			<< " ns per circle, " << bricksLeft << " of " << bricks.size()
+			<< " bricks left" << std::endl;
+	}
+
+	return(EXIT_SUCCESS);
+}
@@ -0,0 +1,340 @@
+///////////////////////////////////////////////////////////////////////////////
+// glcallcounter.cpp
+// ============
+// count the draw calls, uniform uploads and texture binds of a scene
+// and the memory of its textures and buffers
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#define GL_CALL_COUNTER_IMPLEMENTATION
+#include "GLCallCounter.h"
+
+#include <map>
+#include <set>
+#include <utility>
+
+// declaration of the global variables and defines
+namespace
+{
+	// counts since the last reset - the scenes draw from a
+	// single thread
+	GLCallCounter::CALL_COUNTS g_Counts = { 0, 0, 0, 0 };
+
+	// bytes of each image of each texture, by texture and then
+	// by face and level, and the textures with generated mipmaps
+	std::map<std::pair<GLuint, int>, long long> g_TextureImageBytes;
+	std::set<GLuint> g_MipmappedTextures;
+	// bytes of each vertex and index buffer
+	std::map<GLuint, long long> g_MeshBufferBytes;
+
+	/***********************************************************
+	 *  CountTriangles()
+	 *
+	 *  This function is used for adding the triangles of a
+	 *  draw to the counts.
+	 ***********************************************************/
+	void CountTriangles(GLenum mode, GLsizei count, GLsizei instanceCount)
+	{
+		long long triangles = 0;
+
+		if (mode == GL_TRIANGLES)
+		{
+			triangles = count / 3;
+		}
+		else if (((mode == GL_TRIANGLE_STRIP) || (mode == GL_TRIANGLE_FAN)) && (count > 2))
+		{
+			triangles = count - 2;
+		}
+		g_Counts.triangles += triangles * instanceCount;
+	}
+
+	/***********************************************************
+	 *  GetBytesPerTexel()
+	 *
+	 *  This function is used for getting the size of a texel
+	 *  of an internal format the way drivers store it, with
+	 *  three channel formats padded to four.
+	 ***********************************************************/
+	long long GetBytesPerTexel(GLint internalFormat)
+	{
+		switch (internalFormat)
+		{
+		case GL_R8:
+		case GL_RED:
+			return(1);
+		case GL_RG8:
+		case GL_R16F:
+			return(2);
+		case GL_RGB16F:
+		case GL_RGBA16F:
+		case GL_RG32F:
+			return(8);
+		case GL_RGB32F:
+		case GL_RGBA32F:
+			return(16);
+		default:
+			// 8 bit color, 32 bit float and the depth formats
+			return(4);
+		}
+	}
+
+	/***********************************************************
+	 *  GetBoundTexture()
+	 *
+	 *  This function is used for getting the texture bound to
+	 *  the active unit for a texture image target, and the cube
+	 *  face the target names.
+	 ***********************************************************/
+	GLuint GetBoundTexture(GLenum target, int& face)
+	{
+		GLint texture = 0;
+
+		face = 0;
+		if ((target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X) && (target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z))
+		{
+			face = (int)(target - GL_TEXTURE_CUBE_MAP_POSITIVE_X);
+			glGetIntegerv(GL_TEXTURE_BINDING_CUBE_MAP, &texture);
+		}
+		else if (target == GL_TEXTURE_2D)
+		{
+			glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+		}
+		return((GLuint)texture);
+	}
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for clearing the counts, as at the
+ *  start of a frame.
+ ***********************************************************/
+void GLCallCounter::Reset()
+{
+	g_Counts.drawCalls = 0;
+	g_Counts.uniformUploads = 0;
+	g_Counts.textureBinds = 0;
+	g_Counts.triangles = 0;
+}
+
+/***********************************************************
+ *  GetCounts()
+ *
+ *  This method is used for getting the counts since the
+ *  last reset.
+ ***********************************************************/
+const GLCallCounter::CALL_COUNTS& GLCallCounter::GetCounts()
+{
+	return(g_Counts);
+}
+
+/***********************************************************
+ *  GetMemory()
+ *
+ *  This method is used for getting the memory held by the
+ *  textures and the vertex and index buffers.  A texture
+ *  with generated mipmaps holds a third more than its top
+ *  level.
+ ***********************************************************/
+GLCallCounter::MEMORY_COUNTS GLCallCounter::GetMemory()
+{
+	MEMORY_COUNTS memory = { 0, 0 };
+
+	for (const auto& image : g_TextureImageBytes)
+	{
+		bool bMipmapped = (g_MipmappedTextures.count(image.first.first) > 0);
+		memory.textureBytes += bMipmapped ? (image.second * 4 / 3) : image.second;
+	}
+	for (const auto& buffer : g_MeshBufferBytes)
+	{
+		memory.meshBytes += buffer.second;
+	}
+
+	return(memory);
+}
+
+/***********************************************************
+ *  Draw calls
+ ***********************************************************/
+void GLCallCounter::DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	g_Counts.drawCalls++;
+	CountTriangles(mode, count, 1);
+	glDrawArrays(mode, first, count);
+}
+
+void GLCallCounter::DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+	g_Counts.drawCalls++;
+	CountTriangles(mode, count, 1);
+	glDrawElements(mode, count, type, indices);
+}
+
+void GLCallCounter::DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount)
+{
+	g_Counts.drawCalls++;
+	CountTriangles(mode, count, instanceCount);
+	glDrawArraysInstanced(mode, first, count, instanceCount);
+}
+
+void GLCallCounter::DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount)
+{
+	g_Counts.drawCalls++;
+	CountTriangles(mode, count, instanceCount);
+	glDrawElementsInstanced(mode, count, type, indices, instanceCount);
+}
+
+/***********************************************************
+ *  Texture binds
+ ***********************************************************/
+void GLCallCounter::BindTexture(GLenum target, GLuint texture)
+{
+	g_Counts.textureBinds++;
+	glBindTexture(target, texture);
+}
+
+/***********************************************************
+ *  Uniform uploads
+ ***********************************************************/
+void GLCallCounter::Uniform1i(GLint location, GLint v0)
+{
+	g_Counts.uniformUploads++;
+	glUniform1i(location, v0);
+}
+
+void GLCallCounter::Uniform1f(GLint location, GLfloat v0)
+{
+	g_Counts.uniformUploads++;
+	glUniform1f(location, v0);
+}
+
+void GLCallCounter::Uniform2f(GLint location, GLfloat v0, GLfloat v1)
+{
+	g_Counts.uniformUploads++;
+	glUniform2f(location, v0, v1);
+}
+
+void GLCallCounter::Uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+	g_Counts.uniformUploads++;
+	glUniform3f(location, v0, v1, v2);
+}
+
+void GLCallCounter::Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+	g_Counts.uniformUploads++;
+	glUniform4f(location, v0, v1, v2, v3);
+}
+
+void GLCallCounter::Uniform1iv(GLint location, GLsizei count, const GLint* value)
+{
+	g_Counts.uniformUploads++;
+	glUniform1iv(location, count, value);
+}
+
+void GLCallCounter::Uniform1fv(GLint location, GLsizei count, const GLfloat* value)
+{
+	g_Counts.uniformUploads++;
+	glUniform1fv(location, count, value);
+}
+
+void GLCallCounter::Uniform2fv(GLint location, GLsizei count, const GLfloat* value)
+{
+	g_Counts.uniformUploads++;
+	glUniform2fv(location, count, value);
+}
+
+void GLCallCounter::Uniform3fv(GLint location, GLsizei count, const GLfloat* value)
+{
+	g_Counts.uniformUploads++;
+	glUniform3fv(location, count, value);
+}
+
+void GLCallCounter::Uniform4fv(GLint location, GLsizei count, const GLfloat* value)
+{
+	g_Counts.uniformUploads++;
+	glUniform4fv(location, count, value);
+}
+
+void GLCallCounter::UniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+	g_Counts.uniformUploads++;
+	glUniformMatrix3fv(location, count, transpose, value);
+}
+
+void GLCallCounter::UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+	g_Counts.uniformUploads++;
+	glUniformMatrix4fv(location, count, transpose, value);
+}
+
+/***********************************************************
+ *  Texture memory
+ ***********************************************************/
+void GLCallCounter::TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+{
+	int face = 0;
+	GLuint texture = GetBoundTexture(target, face);
+
+	if (0 != texture)
+	{
+		g_TextureImageBytes[std::make_pair(texture, face * 32 + level)] =
+			(long long)width * height * GetBytesPerTexel(internalFormat);
+	}
+	glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+void GLCallCounter::GenerateMipmap(GLenum target)
+{
+	int face = 0;
+	GLuint texture = GetBoundTexture((target == GL_TEXTURE_CUBE_MAP) ? GL_TEXTURE_CUBE_MAP_POSITIVE_X : target, face);
+
+	if (0 != texture)
+	{
+		g_MipmappedTextures.insert(texture);
+	}
+	glGenerateMipmap(target);
+}
+
+void GLCallCounter::DeleteTextures(GLsizei count, const GLuint* textures)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		g_TextureImageBytes.erase(
+			g_TextureImageBytes.lower_bound(std::make_pair(textures[i], 0)),
+			g_TextureImageBytes.lower_bound(std::make_pair(textures[i] + 1, 0)));
+		g_MipmappedTextures.erase(textures[i]);
+	}
+	glDeleteTextures(count, textures);
+}
+
+/***********************************************************
+ *  Mesh memory
+ ***********************************************************/
+void GLCallCounter::BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+	GLint buffer = 0;
+
+	if (target == GL_ARRAY_BUFFER)
+	{
+		glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &buffer);
+	}
+	else if (target == GL_ELEMENT_ARRAY_BUFFER)
+	{
+		glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &buffer);
+	}
+	if (0 != buffer)
+	{
+		g_MeshBufferBytes[(GLuint)buffer] = (long long)size;
+	}
+	glBufferData(target, size, data, usage);
+}
+
+void GLCallCounter::DeleteBuffers(GLsizei count, const GLuint* buffers)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		g_MeshBufferBytes.erase(buffers[i]);
+	}
+	glDeleteBuffers(count, buffers);
+}
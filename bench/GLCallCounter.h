@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////
+// glcallcounter.h
+// ============
+// count the draw calls, uniform uploads and texture binds of a scene
+// and the memory of its textures and buffers
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  GLCallCounter
+ *
+ *  This class contains the code for counting the OpenGL
+ *  calls that cost the most per frame.  The benchmark and
+ *  application builds include this header ahead of every
+ *  source of a scene, so the calls below go through the
+ *  counter and on to OpenGL without any change to the scene
+ *  code.  Every milestone and the final scene are counted
+ *  the same way, whether or not they have a state cache of
+ *  their own.  The texture images and buffers created are
+ *  followed as well, for the memory they hold.
+ ***********************************************************/
+class GLCallCounter
+{
+public:
+	struct CALL_COUNTS
+	{
+		long long drawCalls;
+		long long uniformUploads;
+		long long textureBinds;
+		// triangles drawn, strips and fans included
+		long long triangles;
+	};
+
+	struct MEMORY_COUNTS
+	{
+		// bytes of the texture images and their mipmaps
+		long long textureBytes;
+		// bytes of the vertex and index buffers
+		long long meshBytes;
+	};
+
+	// clear the counts
+	static void Reset();
+	// get the counts since the last reset
+	static const CALL_COUNTS& GetCounts();
+	// get the memory held by the textures and buffers now
+	static MEMORY_COUNTS GetMemory();
+
+	// the counted calls
+	static void DrawArrays(GLenum mode, GLint first, GLsizei count);
+	static void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+	static void DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount);
+	static void DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount);
+	static void BindTexture(GLenum target, GLuint texture);
+	static void Uniform1i(GLint location, GLint v0);
+	static void Uniform1f(GLint location, GLfloat v0);
+	static void Uniform2f(GLint location, GLfloat v0, GLfloat v1);
+	static void Uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+	static void Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+	static void Uniform1iv(GLint location, GLsizei count, const GLint* value);
+	static void Uniform1fv(GLint location, GLsizei count, const GLfloat* value);
+	static void Uniform2fv(GLint location, GLsizei count, const GLfloat* value);
+	static void Uniform3fv(GLint location, GLsizei count, const GLfloat* value);
+	static void Uniform4fv(GLint location, GLsizei count, const GLfloat* value);
+	static void UniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+	static void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+	static void TexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels);
+	static void GenerateMipmap(GLenum target);
+	static void DeleteTextures(GLsizei count, const GLuint* textures);
+	static void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+	static void DeleteBuffers(GLsizei count, const GLuint* buffers);
+};
+
+// the counter itself is built without the redirection so it
+// reaches OpenGL
+#ifndef GL_CALL_COUNTER_IMPLEMENTATION
+#undef glDrawArrays
+#undef glDrawElements
+#undef glDrawArraysInstanced
+#undef glDrawElementsInstanced
+#undef glBindTexture
+#undef glUniform1i
+#undef glUniform1f
+#undef glUniform2f
+#undef glUniform3f
+#undef glUniform4f
+#undef glUniform1iv
+#undef glUniform1fv
+#undef glUniform2fv
+#undef glUniform3fv
+#undef glUniform4fv
+#undef glUniformMatrix3fv
+#undef glUniformMatrix4fv
+#undef glTexImage2D
+#undef glGenerateMipmap
+#undef glDeleteTextures
+#undef glBufferData
+#undef glDeleteBuffers
+#define glDrawArrays(mode, first, count) GLCallCounter::DrawArrays(mode, first, count)
+#define glDrawElements(mode, count, type, indices) GLCallCounter::DrawElements(mode, count, type, indices)
+#define glDrawArraysInstanced(mode, first, count, instanceCount) GLCallCounter::DrawArraysInstanced(mode, first, count, instanceCount)
+#define glDrawElementsInstanced(mode, count, type, indices, instanceCount) GLCallCounter::DrawElementsInstanced(mode, count, type, indices, instanceCount)
+#define glBindTexture(target, texture) GLCallCounter::BindTexture(target, texture)
+#define glUniform1i(location, v0) GLCallCounter::Uniform1i(location, v0)
+#define glUniform1f(location, v0) GLCallCounter::Uniform1f(location, v0)
+#define glUniform2f(location, v0, v1) GLCallCounter::Uniform2f(location, v0, v1)
+#define glUniform3f(location, v0, v1, v2) GLCallCounter::Uniform3f(location, v0, v1, v2)
+#define glUniform4f(location, v0, v1, v2, v3) GLCallCounter::Uniform4f(location, v0, v1, v2, v3)
+#define glUniform1iv(location, count, value) GLCallCounter::Uniform1iv(location, count, value)
+#define glUniform1fv(location, count, value) GLCallCounter::Uniform1fv(location, count, value)
+#define glUniform2fv(location, count, value) GLCallCounter::Uniform2fv(location, count, value)
+#define glUniform3fv(location, count, value) GLCallCounter::Uniform3fv(location, count, value)
+#define glUniform4fv(location, count, value) GLCallCounter::Uniform4fv(location, count, value)
+#define glUniformMatrix3fv(location, count, transpose, value) GLCallCounter::UniformMatrix3fv(location, count, transpose, value)
+#define glUniformMatrix4fv(location, count, transpose, value) GLCallCounter::UniformMatrix4fv(location, count, transpose, value)
+#define glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels) GLCallCounter::TexImage2D(target, level, internalFormat, width, height, border, format, type, pixels)
+#define glGenerateMipmap(target) GLCallCounter::GenerateMipmap(target)
+#define glDeleteTextures(count, textures) GLCallCounter::DeleteTextures(count, textures)
+#define glBufferData(target, size, data, usage) GLCallCounter::BufferData(target, size, data, usage)
+#define glDeleteBuffers(count, buffers) GLCallCounter::DeleteBuffers(count, buffers)
+#endif
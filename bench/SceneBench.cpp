@@ -0,0 +1,330 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebench.cpp
+// ============
+// draw one of the scenes in a hidden window and report what it costs
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include <GL/glew.h>        // GLEW library
+#include "GLFW/glfw3.h"     // GLFW library
+
+#include "GLCallCounter.h"
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "ShaderManager.h"
+#ifdef SCENE_BENCH_FINAL
+#include "GLStateCache.h"
+#endif
+
+// name the scene is reported under, set by the build
+#ifndef SCENE_BENCH_NAME
+#define SCENE_BENCH_NAME "scene"
+#endif
+
+// Namespace for declaring global variables
+namespace
+{
+	// frames drawn before measuring, and frames measured
+	const int DEFAULT_WARMUP_FRAMES = 30;
+	const int DEFAULT_FRAMES = 300;
+
+	// the managers of the scene being measured
+	ShaderManager* g_ShaderManager = nullptr;
+	ViewManager* g_ViewManager = nullptr;
+	SceneManager* g_SceneManager = nullptr;
+#ifdef SCENE_BENCH_FINAL
+	GLStateCache* g_StateCache = nullptr;
+#endif
+
+	// totals over the measured frames
+	struct FRAME_TOTALS
+	{
+		double frameTime;
+		double cpuTime;
+		double gpuTime;
+		long long drawCalls;
+		long long uniformUploads;
+		long long textureBinds;
+	};
+
+	/***********************************************************
+	 *  DrawFrame()
+	 *
+	 *  This function is used for drawing one frame of the scene
+	 *  the way its own main loop does.
+	 ***********************************************************/
+	void DrawFrame()
+	{
+#ifdef SCENE_BENCH_FINAL
+		g_StateCache->ResetStats();
+		g_StateCache->SetDepthTest(true);
+		g_StateCache->SetClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		g_ViewManager->SetCollisionScene(g_SceneManager->GetSceneBVH());
+		g_ViewManager->PrepareSceneView();
+		g_SceneManager->SetCameraView(
+			g_ViewManager->GetViewMatrix(),
+			g_ViewManager->GetProjectionMatrix(),
+			g_ViewManager->GetViewPosition());
+		g_SceneManager->ClearViewports();
+		g_SceneManager->RenderScene();
+#else
+		glEnable(GL_DEPTH_TEST);
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		g_ViewManager->PrepareSceneView();
+		g_SceneManager->RenderScene();
+#endif
+	}
+
+#ifdef SCENE_BENCH_FINAL
+	/***********************************************************
+	 *  EnableFeature()
+	 *
+	 *  This function is used for turning on a feature of the
+	 *  final scene from its command line option, the same as
+	 *  the application.
+	 ***********************************************************/
+	bool EnableFeature(const char* option)
+	{
+		if (strcmp(option, "--oit") == 0)
+		{
+			g_SceneManager->SetTransparencyMode(SceneManager::TRANSPARENCY_WEIGHTED_OIT);
+		}
+		else if (strcmp(option, "--depth-prepass") == 0)
+		{
+			g_SceneManager->SetDepthPrepass(true);
+		}
+		else if (strcmp(option, "--shadows") == 0)
+		{
+			g_SceneManager->SetShadows(true);
+		}
+		else if (strcmp(option, "--lightmaps") == 0)
+		{
+			g_SceneManager->SetLightmaps(true);
+		}
+		else if (strcmp(option, "--probes") == 0)
+		{
+			g_SceneManager->SetIrradianceProbes(true);
+		}
+		else if (strcmp(option, "--reflections") == 0)
+		{
+			g_SceneManager->SetReflections(true);
+		}
+		else if (strcmp(option, "--snow") == 0)
+		{
+			g_SceneManager->SetSnow(true, 500000);
+		}
+		else if (strcmp(option, "--animate") == 0)
+		{
+			g_SceneManager->SetAnimation(true);
+		}
+		else if (strcmp(option, "--physics") == 0)
+		{
+			g_SceneManager->SetPhysics(true);
+		}
+		else
+		{
+			return(false);
+		}
+
+		return(true);
+	}
+#endif
+}
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the benchmark has been
+ *  launched.  It times the start of the scene - the shaders,
+ *  the meshes and the textures - and then the frames, with
+ *  the CPU time to queue each frame, the GPU time to draw it
+ *  and the OpenGL calls it made.  The results are printed as
+ *  a line of text, or as JSON with --json.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	int warmupFrames = DEFAULT_WARMUP_FRAMES;
+	int frameCount = DEFAULT_FRAMES;
+	bool bJson = false;
+
+	// process the command line options
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--frames") == 0) && (i + 1 < argc))
+		{
+			frameCount = std::max(atoi(argv[++i]), 1);
+		}
+		else if ((strcmp(argv[i], "--warmup") == 0) && (i + 1 < argc))
+		{
+			warmupFrames = std::max(atoi(argv[++i]), 0);
+		}
+		else if (strcmp(argv[i], "--json") == 0)
+		{
+			bJson = true;
+		}
+	}
+
+	// GLFW: initialize a hidden window of the application's version
+#if (defined(SCENE_CONTEXT_EGL) || defined(SCENE_CONTEXT_OSMESA)) && defined(GLFW_PLATFORM_NULL)
+	glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+	glfwInit();
+#ifdef __APPLE__
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#else
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#if defined(SCENE_CONTEXT_EGL)
+	glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+#elif defined(SCENE_CONTEXT_OSMESA)
+	glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+#endif
+
+	g_ShaderManager = new ShaderManager();
+#ifdef SCENE_BENCH_FINAL
+	g_StateCache = new GLStateCache();
+	g_ViewManager = new ViewManager(g_ShaderManager, g_StateCache);
+#else
+	g_ViewManager = new ViewManager(g_ShaderManager);
+#endif
+	GLFWwindow* window = g_ViewManager->CreateDisplayWindow(SCENE_BENCH_NAME);
+	GLenum glewResult = (NULL != window) ? glewInit() : GLEW_OK;
+#if defined(SCENE_CONTEXT_EGL) || defined(SCENE_CONTEXT_OSMESA)
+	// GLX is missing without a display, the OpenGL functions are not
+	if (GLEW_ERROR_NO_GLX_DISPLAY == glewResult)
+	{
+		glewResult = GLEW_OK;
+	}
+#endif
+	if ((NULL == window) || (glewResult != GLEW_OK))
+	{
+		std::cout << "Could not create the OpenGL context for " << SCENE_BENCH_NAME << std::endl;
+		return(EXIT_FAILURE);
+	}
+	// the frames are timed, not the display
+	glfwSwapInterval(0);
+
+	// startup - everything the scene loads before its first frame
+	auto startupStart = std::chrono::steady_clock::now();
+	g_ShaderManager->LoadShaders(
+		"shaders/vertexShader.glsl",
+		"shaders/fragmentShader.glsl");
+#ifdef SCENE_BENCH_FINAL
+	g_StateCache->UseProgram(g_ShaderManager->m_programID);
+	g_SceneManager = new SceneManager(g_ShaderManager, g_StateCache);
+	g_SceneManager->PrepareScene();
+	for (int i = 1; i < argc; i++)
+	{
+		EnableFeature(argv[i]);
+	}
+#else
+	g_ShaderManager->use();
+	g_SceneManager = new SceneManager(g_ShaderManager);
+	g_SceneManager->PrepareScene();
+#endif
+	glFinish();
+	double startupTime = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - startupStart).count();
+
+	for (int i = 0; i < warmupFrames; i++)
+	{
+		DrawFrame();
+		glfwSwapBuffers(window);
+		glfwPollEvents();
+	}
+
+	GLuint timerQuery = 0;
+	FRAME_TOTALS totals = { 0.0, 0.0, 0.0, 0, 0, 0 };
+	std::vector<double> frameTimes;
+
+	glGenQueries(1, &timerQuery);
+	for (int i = 0; i < frameCount; i++)
+	{
+		GLuint64 gpuTime = 0;
+
+		GLCallCounter::Reset();
+		auto frameStart = std::chrono::steady_clock::now();
+		glBeginQuery(GL_TIME_ELAPSED, timerQuery);
+		DrawFrame();
+		glEndQuery(GL_TIME_ELAPSED);
+		auto submitEnd = std::chrono::steady_clock::now();
+
+		// wait for the frame so each one is timed on its own
+		glfwSwapBuffers(window);
+		glFinish();
+		auto frameEnd = std::chrono::steady_clock::now();
+		glfwPollEvents();
+
+		glGetQueryObjectui64v(timerQuery, GL_QUERY_RESULT, &gpuTime);
+		double frameTime = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+		frameTimes.push_back(frameTime);
+		totals.frameTime += frameTime;
+		totals.cpuTime += std::chrono::duration<double, std::milli>(submitEnd - frameStart).count();
+		totals.gpuTime += (double)gpuTime / 1.0e6;
+		totals.drawCalls += GLCallCounter::GetCounts().drawCalls;
+		totals.uniformUploads += GLCallCounter::GetCounts().uniformUploads;
+		totals.textureBinds += GLCallCounter::GetCounts().textureBinds;
+	}
+	glDeleteQueries(1, &timerQuery);
+
+	std::sort(frameTimes.begin(), frameTimes.end());
+	double medianFrameTime = frameTimes[frameTimes.size() / 2];
+	double worstFrameTime = frameTimes[std::min((size_t)(frameTimes.size() * 0.99), frameTimes.size() - 1)];
+
+	if (bJson == true)
+	{
+		std::cout << "{\"scene\": \"" << SCENE_BENCH_NAME << "\""
+			<< ", \"frames\": " << frameCount
+			<< ", \"startup_ms\": " << startupTime
+			<< ", \"frame_ms\": " << totals.frameTime / frameCount
+			<< ", \"frame_ms_median\": " << medianFrameTime
+			<< ", \"frame_ms_p99\": " << worstFrameTime
+			<< ", \"cpu_ms\": " << totals.cpuTime / frameCount
+			<< ", \"gpu_ms\": " << totals.gpuTime / frameCount
+			<< ", \"draw_calls\": " << (double)totals.drawCalls / frameCount
+			<< ", \"uniform_uploads\": " << (double)totals.uniformUploads / frameCount
+			<< ", \"texture_binds\": " << (double)totals.textureBinds / frameCount
+			<< "}" << std::endl;
+	}
+	else
+	{
+		std::cout << SCENE_BENCH_NAME << ": startup " << startupTime << " ms, frame "
+			<< totals.frameTime / frameCount << " ms (median " << medianFrameTime
+			<< ", 99th " << worstFrameTime << "), cpu " << totals.cpuTime / frameCount
+			<< " ms, gpu " << totals.gpuTime / frameCount << " ms, "
+			<< (double)totals.drawCalls / frameCount << " draw calls, "
+			<< (double)totals.uniformUploads / frameCount << " uniform uploads, "
+			<< (double)totals.textureBinds / frameCount << " texture binds per frame" << std::endl;
+	}
+
+	// clear the allocated manager objects from memory
+	delete g_SceneManager;
+	g_SceneManager = NULL;
+	delete g_ViewManager;
+	g_ViewManager = NULL;
+	delete g_ShaderManager;
+	g_ShaderManager = NULL;
+#ifdef SCENE_BENCH_FINAL
+	delete g_StateCache;
+	g_StateCache = NULL;
+#endif
+	glfwTerminate();
+
+	return(EXIT_SUCCESS);
+}
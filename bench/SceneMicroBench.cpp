@@ -0,0 +1,466 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenemicrobench.cpp
+// ============
+// time the hot paths of the final scene and the 8-2 simulation on their own
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_FAILURE, srand
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>        // GLEW library
+#include "GLFW/glfw3.h"     // GLFW library
+#include <benchmark/benchmark.h>
+
+#include "SceneManager.h"
+#include "stb_image.h"
+#include "BrickLayout.h"
+
+// Namespace for declaring global variables
+namespace
+{
+	// the textures the final scene loads, in the order it loads them
+	const char* TEXTURE_FILES[] =
+	{
+		"textures/sand.jpg",
+		"textures/snowbackground.png",
+		"textures/snowman2.jpg",
+		"textures/carrotnose.jpg",
+		"textures/tophat.jpg",
+		"textures/wrappingpaper.jpg",
+		"textures/tree.jpg",
+		"textures/moon.jpg",
+		"textures/turret.jpg",
+		"textures/purplelights.jpg",
+		"textures/ornament.jpg"
+	};
+	const int TEXTURE_FILE_COUNT = sizeof(TEXTURE_FILES) / sizeof(TEXTURE_FILES[0]);
+
+	// the shapes the final scene loads
+	enum MESH_GENERATOR
+	{
+		MESH_PLANE,
+		MESH_BOX,
+		MESH_CYLINDER,
+		MESH_CONE,
+		MESH_PRISM,
+		MESH_PYRAMID4,
+		MESH_SPHERE,
+		MESH_TAPERED_CYLINDER,
+		MESH_TORUS,
+		MESH_GENERATOR_COUNT
+	};
+	const char* MESH_NAMES[MESH_GENERATOR_COUNT] =
+	{
+		"plane", "box", "cylinder", "cone", "prism", "pyramid4",
+		"sphere", "tapered cylinder", "torus"
+	};
+
+	// set once the hidden window has an OpenGL context
+	bool g_bContext = false;
+
+	// sends the output of CreateGLTexture() nowhere while it is timed
+	class NullBuffer : public std::streambuf
+	{
+	protected:
+		int overflow(int c) override { return(c); }
+	};
+}
+
+/***********************************************************
+ *  SceneManagerBench
+ *
+ *  This class contains the code for setting up a scene
+ *  manager for the benchmarks, with its texture and
+ *  material tables filled to the size measured.
+ ***********************************************************/
+class SceneManagerBench
+{
+public:
+	// constructor
+	SceneManagerBench()
+	{
+		m_pStateCache = new GLStateCache();
+		m_pSceneManager = new SceneManager(NULL, m_pStateCache);
+	}
+	// destructor
+	~SceneManagerBench()
+	{
+		delete m_pSceneManager;
+		m_pSceneManager = NULL;
+		delete m_pStateCache;
+		m_pStateCache = NULL;
+	}
+
+	// fill the texture table with tagged entries
+	void AddTextures(int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			// no OpenGL texture is needed for the lookups
+			m_pSceneManager->AddTexture(0, "texture" + std::to_string(i), false);
+		}
+	}
+
+	// fill the material list with tagged entries
+	void AddMaterials(int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			SceneManager::OBJECT_MATERIAL material;
+			material.diffuseColor = glm::vec3(0.5f);
+			material.specularColor = glm::vec3(0.2f);
+			material.shininess = 8.0f;
+			material.reflectivity = 0.0f;
+			material.tag = "material" + std::to_string(i);
+			m_pSceneManager->AddMaterial(material);
+		}
+	}
+
+	int FindTextureSlot(const std::string& tag)
+	{
+		return(m_pSceneManager->FindTextureSlot(tag));
+	}
+
+	bool FindMaterial(const std::string& tag, SceneManager::OBJECT_MATERIAL& material)
+	{
+		return(m_pSceneManager->FindMaterial(tag, material));
+	}
+
+	void SetTransformations(glm::vec3 scaleXYZ, float x, float y, float z, glm::vec3 positionXYZ)
+	{
+		m_pSceneManager->SetTransformations(scaleXYZ, x, y, z, positionXYZ);
+	}
+
+	// load a texture the way the scene does and free it again,
+	// so every iteration fills the same slot
+	bool CreateGLTexture(const char* filename)
+	{
+		bool bLoaded = m_pSceneManager->CreateGLTexture(filename, "bench");
+		if (bLoaded == true)
+		{
+			m_pSceneManager->DestroyGLTextures();
+		}
+		return(bLoaded);
+	}
+
+private:
+	GLStateCache* m_pStateCache;
+	SceneManager* m_pSceneManager;
+};
+
+/***********************************************************
+ *  BM_SetTransformations()
+ *
+ *  This function is used for timing the model matrices of
+ *  a frame of shapes, each placed, turned and scaled.
+ ***********************************************************/
+static void BM_SetTransformations(benchmark::State& state)
+{
+	SceneManagerBench bench;
+	int shapeCount = (int)state.range(0);
+
+	for (auto _ : state)
+	{
+		for (int i = 0; i < shapeCount; i++)
+		{
+			float offset = (float)i * 0.25f;
+			bench.SetTransformations(
+				glm::vec3(1.0f + offset, 2.0f, 1.0f),
+				offset, 45.0f + offset, 10.0f,
+				glm::vec3(offset, 0.0f, -offset));
+			// the matrix is kept in the scene manager
+			benchmark::ClobberMemory();
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * shapeCount);
+}
+BENCHMARK(BM_SetTransformations)->RangeMultiplier(4)->Range(16, 4096);
+
+/***********************************************************
+ *  BM_FindTextureSlot()
+ *
+ *  This function is used for timing the lookup of the last
+ *  texture of a table of the given size, the longest search.
+ ***********************************************************/
+static void BM_FindTextureSlot(benchmark::State& state)
+{
+	SceneManagerBench bench;
+	int textureCount = (int)state.range(0);
+	std::string tag = "texture" + std::to_string(textureCount - 1);
+
+	bench.AddTextures(textureCount);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(bench.FindTextureSlot(tag));
+	}
+}
+// the scene keeps up to 12 textures, the units below the
+// reserved ones
+BENCHMARK(BM_FindTextureSlot)->Arg(1)->Arg(4)->Arg(11)->Arg(GLStateCache::FIRST_RESERVED_TEXTURE_UNIT);
+
+/***********************************************************
+ *  BM_FindMaterial()
+ *
+ *  This function is used for timing the lookup of the last
+ *  material of a list of the given size.
+ ***********************************************************/
+static void BM_FindMaterial(benchmark::State& state)
+{
+	SceneManagerBench bench;
+	int materialCount = (int)state.range(0);
+	std::string tag = "material" + std::to_string(materialCount - 1);
+	SceneManager::OBJECT_MATERIAL material;
+
+	bench.AddMaterials(materialCount);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(bench.FindMaterial(tag, material));
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_FindMaterial)->RangeMultiplier(4)->Range(4, 256);
+
+/***********************************************************
+ *  BM_LoadMesh()
+ *
+ *  This function is used for timing one of the shape mesh
+ *  generators, building the vertices and uploading them.
+ *  The shapes have a fixed tessellation, so the shape is
+ *  the parameter.
+ ***********************************************************/
+static void BM_LoadMesh(benchmark::State& state)
+{
+	if (g_bContext == false)
+	{
+		state.SkipWithError("no OpenGL context");
+		return;
+	}
+
+	MESH_GENERATOR generator = (MESH_GENERATOR)state.range(0);
+	state.SetLabel(MESH_NAMES[generator]);
+	for (auto _ : state)
+	{
+		ShapeMeshes* pMeshes = new ShapeMeshes();
+		switch (generator)
+		{
+		case MESH_PLANE: pMeshes->LoadPlaneMesh(); break;
+		case MESH_BOX: pMeshes->LoadBoxMesh(); break;
+		case MESH_CYLINDER: pMeshes->LoadCylinderMesh(); break;
+		case MESH_CONE: pMeshes->LoadConeMesh(); break;
+		case MESH_PRISM: pMeshes->LoadPrismMesh(); break;
+		case MESH_PYRAMID4: pMeshes->LoadPyramid4Mesh(); break;
+		case MESH_SPHERE: pMeshes->LoadSphereMesh(); break;
+		case MESH_TAPERED_CYLINDER: pMeshes->LoadTaperedCylinderMesh(); break;
+		case MESH_TORUS: pMeshes->LoadTorusMesh(); break;
+		default: break;
+		}
+		delete pMeshes;
+	}
+}
+BENCHMARK(BM_LoadMesh)->DenseRange(0, MESH_GENERATOR_COUNT - 1);
+
+/***********************************************************
+ *  BM_DecodeTexture()
+ *
+ *  This function is used for timing the image decode that
+ *  starts CreateGLTexture(), for each texture of the scene.
+ ***********************************************************/
+static void BM_DecodeTexture(benchmark::State& state)
+{
+	const char* filename = TEXTURE_FILES[state.range(0)];
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	state.SetLabel(filename);
+	stbi_set_flip_vertically_on_load(true);
+	for (auto _ : state)
+	{
+		unsigned char* image = stbi_load(filename, &width, &height, &colorChannels, 0);
+		if (NULL == image)
+		{
+			state.SkipWithError("could not load the texture");
+			break;
+		}
+		stbi_image_free(image);
+	}
+	state.SetBytesProcessed(state.iterations() * (int64_t)width * height * colorChannels);
+}
+BENCHMARK(BM_DecodeTexture)->DenseRange(0, TEXTURE_FILE_COUNT - 1)->Unit(benchmark::kMillisecond);
+
+/***********************************************************
+ *  BM_CreateGLTexture()
+ *
+ *  This function is used for timing the whole load of each
+ *  texture of the scene - the decode, the upload and the
+ *  mipmaps.
+ ***********************************************************/
+static void BM_CreateGLTexture(benchmark::State& state)
+{
+	if (g_bContext == false)
+	{
+		state.SkipWithError("no OpenGL context");
+		return;
+	}
+
+	SceneManagerBench bench;
+	const char* filename = TEXTURE_FILES[state.range(0)];
+	NullBuffer nullBuffer;
+	std::streambuf* pCout = std::cout.rdbuf(&nullBuffer);
+
+	state.SetLabel(filename);
+	for (auto _ : state)
+	{
+		if (bench.CreateGLTexture(filename) == false)
+		{
+			state.SkipWithError("could not load the texture");
+			break;
+		}
+		// include the upload, not just the queuing of it
+		glFinish();
+	}
+	std::cout.rdbuf(pCout);
+}
+BENCHMARK(BM_CreateGLTexture)->DenseRange(0, TEXTURE_FILE_COUNT - 1)->Unit(benchmark::kMillisecond);
+
+/***********************************************************
+ *  CreateCircles()
+ *
+ *  This function is used for scattering circles over the
+ *  8-2 field, the same ones each run.
+ ***********************************************************/
+static std::vector<Circle> CreateCircles(int count)
+{
+	std::vector<Circle> world;
+
+	srand(8);
+	world.reserve(count);
+	for (int i = 0; i < count; i++)
+	{
+		Circle circle = LaunchCircle();
+		circle.x = ((float)(rand() % 2000) / 1000.0f) - 1.0f;
+		circle.y = ((float)(rand() % 2000) / 1000.0f) - 1.0f;
+		circle.direction = circle.GetRandomDirection();
+		world.push_back(circle);
+	}
+
+	return(world);
+}
+
+/***********************************************************
+ *  BM_CheckCollision()
+ *
+ *  This function is used for timing every circle checked
+ *  against every brick, with the bricks rebuilt each pass
+ *  so none stay knocked out.
+ ***********************************************************/
+static void BM_CheckCollision(benchmark::State& state)
+{
+	std::vector<Circle> world = CreateCircles((int)state.range(0));
+	const std::vector<Brick> layout = CreateBricks();
+
+	for (auto _ : state)
+	{
+		std::vector<Brick> bricks = layout;
+		for (size_t i = 0; i < world.size(); i++)
+		{
+			for (size_t j = 0; j < bricks.size(); j++)
+			{
+				world[i].CheckCollision(&bricks[j]);
+			}
+		}
+		benchmark::DoNotOptimize(world.data());
+	}
+	state.SetItemsProcessed(state.iterations() * world.size() * layout.size());
+}
+BENCHMARK(BM_CheckCollision)->RangeMultiplier(4)->Range(16, 4096);
+
+/***********************************************************
+ *  BM_MoveOneStep()
+ *
+ *  This function is used for timing one step of every
+ *  circle.
+ ***********************************************************/
+static void BM_MoveOneStep(benchmark::State& state)
+{
+	std::vector<Circle> world = CreateCircles((int)state.range(0));
+
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < world.size(); i++)
+		{
+			world[i].MoveOneStep();
+		}
+		benchmark::DoNotOptimize(world.data());
+	}
+	state.SetItemsProcessed(state.iterations() * world.size());
+}
+BENCHMARK(BM_MoveOneStep)->RangeMultiplier(4)->Range(16, 4096);
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the benchmarks have been
+ *  launched.  A hidden window supplies the OpenGL context
+ *  for the meshes and textures; without one those are
+ *  skipped and the rest still run.  The usual Google
+ *  Benchmark options apply, --benchmark_format=json among
+ *  them.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// GLFW: initialize a hidden window of the application's version
+#if (defined(SCENE_CONTEXT_EGL) || defined(SCENE_CONTEXT_OSMESA)) && defined(GLFW_PLATFORM_NULL)
+	glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+	GLFWwindow* window = NULL;
+	if (glfwInit() == GLFW_TRUE)
+	{
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#if defined(SCENE_CONTEXT_EGL)
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+#elif defined(SCENE_CONTEXT_OSMESA)
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+#endif
+		window = glfwCreateWindow(64, 64, "scene microbench", NULL, NULL);
+	}
+	if (NULL != window)
+	{
+		glfwMakeContextCurrent(window);
+		GLenum glewResult = glewInit();
+#if defined(SCENE_CONTEXT_EGL) || defined(SCENE_CONTEXT_OSMESA)
+		if (GLEW_ERROR_NO_GLX_DISPLAY == glewResult)
+		{
+			glewResult = GLEW_OK;
+		}
+#endif
+		g_bContext = (GLEW_OK == glewResult);
+	}
+	if (g_bContext == false)
+	{
+		std::cerr << "Could not create the OpenGL context, the mesh and texture benchmarks are skipped" << std::endl;
+	}
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	if (NULL != window)
+	{
+		glfwDestroyWindow(window);
+	}
+	glfwTerminate();
+
+	return(EXIT_SUCCESS);
+}
@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+#
+# compare_baseline.py
+# ============
+# compare a run of the microbenchmarks against a stored baseline
+#
+# python3 compare_baseline.py baseline.json current.json [--threshold 0.05]
+#
+# Both files are the JSON of --benchmark_out.  With repetitions each
+# benchmark is judged by its median run, and its noise is the spread of
+# the runs of the two files, so a change counts only when it is larger
+# than both the threshold and the noise.  The exit code is 1 when any
+# benchmark got slower.
+
+import argparse
+import json
+import math
+import os
+import statistics
+import sys
+
+# time units of Google Benchmark, in nanoseconds
+TIME_UNITS = {"ns": 1.0, "us": 1.0e3, "ms": 1.0e6, "s": 1.0e9}
+
+
+def load_runs(filename, metric):
+    """Read the times of every run, grouped by benchmark name."""
+    with open(filename) as file:
+        results = json.load(file)
+
+    runs = {}
+    for benchmark in results.get("benchmarks", []):
+        # the mean, median and deviation rows are worked out here
+        if benchmark.get("run_type", "iteration") != "iteration":
+            continue
+        if benchmark.get("error_occurred", False):
+            continue
+        name = benchmark.get("run_name", benchmark["name"])
+        scale = TIME_UNITS[benchmark.get("time_unit", "ns")]
+        runs.setdefault(name, []).append(benchmark[metric] * scale)
+
+    return runs
+
+
+def summarize(times):
+    """Get the median of the runs and their spread relative to it."""
+    median = statistics.median(times)
+    if (len(times) < 2) or (median <= 0.0):
+        return median, 0.0
+    return median, statistics.stdev(times) / median
+
+
+def format_time(nanoseconds):
+    for unit in ("s", "ms", "us"):
+        if nanoseconds >= TIME_UNITS[unit]:
+            return "%.3f %s" % (nanoseconds / TIME_UNITS[unit], unit)
+    return "%.1f ns" % nanoseconds
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flag microbenchmarks slower than the baseline")
+    parser.add_argument("baseline", help="stored --benchmark_out JSON")
+    parser.add_argument("current", help="new --benchmark_out JSON")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="smallest change that counts, as a fraction (default 0.05)")
+    parser.add_argument("--metric", choices=("real_time", "cpu_time"), default="real_time",
+                        help="time compared (default real_time, which includes the GPU waits)")
+    args = parser.parse_args()
+
+    if not os.path.isfile(args.baseline):
+        print("No baseline at %s - run bench_micro_baseline first" % args.baseline)
+        return 1
+    if not os.path.isfile(args.current):
+        print("No results at %s - run bench_micro first" % args.current)
+        return 1
+
+    baseline = load_runs(args.baseline, args.metric)
+    current = load_runs(args.current, args.metric)
+
+    regressions = 0
+    width = max([len(name) for name in current] + [9])
+    print("%-*s %12s %12s %8s %8s" % (width, "benchmark", "baseline", "current", "change", "noise"))
+    for name, times in current.items():
+        if name not in baseline:
+            print("%-*s %12s %12s    (new)" % (width, name, "-", format_time(statistics.median(times))))
+            continue
+
+        base_time, base_spread = summarize(baseline[name])
+        current_time, current_spread = summarize(times)
+        if base_time <= 0.0:
+            continue
+
+        change = (current_time - base_time) / base_time
+        # twice the combined spread of the two runs covers most of
+        # what repeating an unchanged build would give
+        noise = max(args.threshold, 2.0 * math.hypot(base_spread, current_spread))
+        if change > noise:
+            verdict = "SLOWER"
+            regressions += 1
+        elif change < -noise:
+            verdict = "faster"
+        else:
+            verdict = ""
+        print("%-*s %12s %12s %+7.1f%% %7.1f%% %s" % (
+            width, name, format_time(base_time), format_time(current_time),
+            change * 100.0, noise * 100.0, verdict))
+
+    for name in baseline:
+        if name not in current:
+            print("%-*s %12s %12s    (missing)" % (width, name, format_time(statistics.median(baseline[name])), "-"))
+
+    print("%d of %d benchmarks slower than the baseline" % (regressions, len(current)))
+    return 1 if regressions > 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,65 @@
+# build options shared by the application and the benchmarks
+#
+#   SCENE_ENABLE_LTO          link time optimization in optimized builds
+#   SCENE_NATIVE_ARCH         -march=native, for timing on this machine only
+#   SCENE_HEADLESS_CONTEXT    EGL or OSMesa contexts for machines without a
+#                             display - EGL needs a GPU and a GLEW built with
+#                             EGL, OSMesa draws on the CPU.  Both take the
+#                             null platform of GLFW 3.4 or later.
+
+include_guard(GLOBAL)
+
+if(NOT CMAKE_BUILD_TYPE AND NOT CMAKE_CONFIGURATION_TYPES)
+	set(CMAKE_BUILD_TYPE Release CACHE STRING "Build type" FORCE)
+	set_property(CACHE CMAKE_BUILD_TYPE PROPERTY STRINGS Debug Release RelWithDebInfo MinSizeRel)
+endif()
+
+option(SCENE_ENABLE_LTO "Link time optimization in Release and RelWithDebInfo builds" ON)
+option(SCENE_NATIVE_ARCH "Compile for the instruction set of this machine" OFF)
+set(SCENE_HEADLESS_CONTEXT "NONE" CACHE STRING "Context for runs without a display: NONE, EGL or OSMESA")
+set_property(CACHE SCENE_HEADLESS_CONTEXT PROPERTY STRINGS NONE EGL OSMESA)
+
+if(SCENE_ENABLE_LTO)
+	include(CheckIPOSupported)
+	check_ipo_supported(RESULT SCENE_LTO_SUPPORTED OUTPUT SCENE_LTO_ERROR LANGUAGES CXX)
+	if(SCENE_LTO_SUPPORTED)
+		set(CMAKE_INTERPROCEDURAL_OPTIMIZATION_RELEASE ON)
+		set(CMAKE_INTERPROCEDURAL_OPTIMIZATION_RELWITHDEBINFO ON)
+	else()
+		message(STATUS "Link time optimization is not supported: ${SCENE_LTO_ERROR}")
+	endif()
+endif()
+
+if(SCENE_NATIVE_ARCH)
+	if(MSVC)
+		message(STATUS "SCENE_NATIVE_ARCH is ignored by MSVC, use /arch instead")
+	else()
+		add_compile_options(-march=native)
+	endif()
+endif()
+
+string(TOUPPER "${SCENE_HEADLESS_CONTEXT}" SCENE_HEADLESS_CONTEXT_UPPER)
+if(SCENE_HEADLESS_CONTEXT_UPPER STREQUAL "EGL")
+	add_compile_definitions(SCENE_CONTEXT_EGL)
+elseif(SCENE_HEADLESS_CONTEXT_UPPER STREQUAL "OSMESA")
+	add_compile_definitions(SCENE_CONTEXT_OSMESA)
+elseif(NOT SCENE_HEADLESS_CONTEXT_UPPER STREQUAL "NONE")
+	message(FATAL_ERROR "SCENE_HEADLESS_CONTEXT must be NONE, EGL or OSMESA")
+endif()
+
+# the course folders the Visual Studio projects reach outside the repo for,
+# ..\..\Utilities and ..\..\3DShapes from each project
+get_filename_component(SCENE_ROOT_DIR "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+set(UTILITIES_DIR "${SCENE_ROOT_DIR}/../Utilities" CACHE PATH "Directory of ShaderManager, camera.h and stb_image.h")
+set(SHAPES_DIR "${SCENE_ROOT_DIR}/../3DShapes" CACHE PATH "Directory of ShapeMeshes")
+
+foreach(requiredFile "${UTILITIES_DIR}/ShaderManager.cpp" "${SHAPES_DIR}/ShapeMeshes.cpp")
+	if(NOT EXISTS "${requiredFile}")
+		message(FATAL_ERROR "${requiredFile} was not found, set UTILITIES_DIR and SHAPES_DIR to the course folders")
+	endif()
+endforeach()
+
+find_package(OpenGL REQUIRED)
+find_package(glfw3 3.3 REQUIRED)
+find_package(GLEW REQUIRED)
+find_package(Threads REQUIRED)
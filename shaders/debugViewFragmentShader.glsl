@@ -0,0 +1,64 @@
+#version 330 core
+out vec4 fragmentColor;
+
+in vec2 fragmentTextureCoordinate;
+
+// must match DebugViewRenderer::DEBUG_VIEW
+#define DEBUG_VIEW_OVERDRAW 1
+#define DEBUG_VIEW_LIGHTS 2
+#define DEBUG_VIEW_MIP_LEVEL 3
+
+// counts at the red end of each heatmap - fragments shaded per
+// pixel, lights evaluated (directional, four point lights and the
+// spot light), and mip level sampled
+#define MAX_OVERDRAW 8.0f
+#define MAX_LIGHTS 6.0f
+#define MAX_MIP_LEVEL 10.0f
+
+uniform sampler2D countTexture;
+uniform int debugView;
+
+// blue through cyan, green and yellow to red as t goes from 0 to 1
+vec3 CalcHeatColor(float t)
+{
+    t = clamp(t, 0.0f, 1.0f);
+    return clamp(vec3(1.5f - abs(4.0f * t - 3.0f),
+                      1.5f - abs(4.0f * t - 2.0f),
+                      1.5f - abs(4.0f * t - 1.0f)), 0.0f, 1.0f);
+}
+
+void main()
+{
+    float count = texelFetch(countTexture, ivec2(gl_FragCoord.xy), 0).r;
+
+    // nothing was drawn over this pixel
+    if(count == 0.0f)
+    {
+        fragmentColor = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        return;
+    }
+    // drawn, but the view has nothing to show - an untextured
+    // shape in the mip level view
+    if(count < 0.0f)
+    {
+        fragmentColor = vec4(0.25f, 0.25f, 0.25f, 1.0f);
+        return;
+    }
+
+    // the lights and mip level are written one higher, so that
+    // zero stays free for the background
+    if(debugView == DEBUG_VIEW_OVERDRAW)
+    {
+        // white beyond the end of the scale
+        fragmentColor = (count > MAX_OVERDRAW) ? vec4(1.0f) :
+            vec4(CalcHeatColor((count - 1.0f) / (MAX_OVERDRAW - 1.0f)), 1.0f);
+    }
+    else if(debugView == DEBUG_VIEW_LIGHTS)
+    {
+        fragmentColor = vec4(CalcHeatColor((count - 1.0f) / MAX_LIGHTS), 1.0f);
+    }
+    else
+    {
+        fragmentColor = vec4(CalcHeatColor((count - 1.0f) / MAX_MIP_LEVEL), 1.0f);
+    }
+}
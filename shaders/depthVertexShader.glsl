@@ -0,0 +1,14 @@
+#version 330 core
+layout (location = 0) in vec3 inVertexPosition;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+// must match vertexShader.glsl exactly so the main pass can test GL_EQUAL
+invariant gl_Position;
+
+void main()
+{
+   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,481 @@
+#version 330 core
+layout (location = 0) out vec4 fragmentColor;
+// second target used by the weighted blended transparency pass
+layout (location = 1) out float fragmentRevealage;
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+in vec4 fragmentPositionLightSpace;
+in vec3 fragmentObjectPosition;
+in vec3 fragmentObjectNormal;
+in vec3 fragmentWorldNormal;
+flat in int fragmentViewIndex;
+
+struct Material {
+    vec3 diffuseColor;
+    vec3 specularColor;
+    float shininess;
+    // share of the surroundings mirrored by the surface
+    float reflectivity;
+}; 
+
+struct DirectionalLight {
+    vec3 direction;
+	
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    bool bActive;
+};
+
+struct PointLight {
+    vec3 position;
+    float range;
+    
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    bool bActive;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    float cutOff;
+    float outerCutOff;
+  
+    float constant;
+    float linear;
+    float quadratic;
+    float range;
+  
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;       
+
+    bool bActive;
+};
+
+#define TOTAL_POINT_LIGHTS 5
+// must match LightCuller::MAX_LIGHTS_PER_OBJECT
+#define MAX_OBJECT_LIGHTS 4
+
+uniform bool bUseTexture=false;
+uniform bool bUseLighting=false;
+uniform bool bWeightedOIT=false;
+uniform vec4 objectColor = vec4(1.0f);
+// animated color multiplied into the result
+uniform vec3 materialTint = vec3(1.0f);
+uniform vec3 viewPosition;
+// must match MultiViewRenderer::MAX_VIEWS
+#define MAX_VIEWS 6
+// camera of each view when the views are drawn together
+uniform int viewCount = 0;
+uniform vec3 viewPositions[MAX_VIEWS];
+uniform DirectionalLight directionalLight;
+uniform PointLight pointLights[TOTAL_POINT_LIGHTS];
+// point lights whose range reaches this shape
+uniform int pointLightCount = 0;
+uniform int pointLightIndices[MAX_OBJECT_LIGHTS];
+// ambient terms of every active point light added together - they
+// reach every shape, whatever its range and culling
+uniform vec3 pointLightAmbient = vec3(0.0f);
+uniform SpotLight spotLight;
+uniform Material material;
+uniform sampler2D objectTexture;
+uniform vec2 UVscale = vec2(1.0f, 1.0f);
+uniform bool bUseShadows=false;
+uniform sampler2DShadow shadowMap;
+// baked light of the static lights - the block of the atlas for
+// this shape, the gutter width inside each tile, and the object
+// space box that the six tiles are projected from
+uniform bool bUseLightmap=false;
+uniform sampler2D lightmapTexture;
+uniform vec4 lightmapRect;
+uniform float lightmapBorder;
+uniform vec3 lightmapBoundsMin;
+uniform vec3 lightmapBoundsMax;
+uniform vec3 bakedAmbient;
+// second order spherical harmonics irradiance blended from the
+// probes around the shape, already convolved with the cosine lobe
+uniform bool bUseProbeLight=false;
+uniform vec3 probeIrradiance[9];
+// surroundings captured by the reflection probe closest to the shape
+uniform bool bUseReflection=false;
+uniform samplerCube environmentMap;
+// debug views write a count for DebugViewRenderer in place of the
+// color - must match DebugViewRenderer::DEBUG_VIEW
+#define DEBUG_VIEW_NONE 0
+#define DEBUG_VIEW_OVERDRAW 1
+#define DEBUG_VIEW_LIGHTS 2
+#define DEBUG_VIEW_MIP_LEVEL 3
+uniform int debugView = DEBUG_VIEW_NONE;
+
+// the scaled texture coordinate to use in calculations
+vec2 fragmentTextureCoordinateScaled = fragmentTextureCoordinate * UVscale;
+// lights evaluated for this fragment, for the lights debug view
+int lightsEvaluated = 0;
+
+// function prototypes
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir);
+float CalcDirectionalShadow(vec3 normal, vec3 lightDirection);
+vec3 CalcBakedLight();
+vec3 CalcProbeLight(vec3 normal);
+vec2 CalcLightmapCoordinate();
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+float CalcRangeFalloff(float distance, float range);
+float CalcMipLevel();
+
+void main()
+{   
+    if(bUseLighting == true)
+    {
+        vec3 phongResult = vec3(0.0f);
+        // properties
+        vec3 norm = normalize(fragmentVertexNormal);
+        vec3 cameraPosition = (viewCount > 0) ? viewPositions[fragmentViewIndex] : viewPosition;
+        vec3 viewDir = normalize(cameraPosition - fragmentPosition);
+    
+        // == =====================================================
+        // Our lighting is set up in 3 phases: directional, point lights and an optional flashlight
+        // For each phase, a calculate function is defined that calculates the corresponding color
+        // per light source. In the main() function we take all the calculated colors and sum them 
+        // up for this fragment's final color.
+        // == =====================================================
+        // phase 1: directional lighting
+        if((directionalLight.bActive == true) && (bUseLightmap == false) && (bUseProbeLight == false))
+        {
+            phongResult += CalcDirectionalLight(directionalLight, norm, viewDir);
+            lightsEvaluated++;
+        }
+        // phase 2: point lights in range of this shape
+        for(int i = 0; i < pointLightCount; i++)
+        {
+            int lightIndex = pointLightIndices[i];
+	    if((pointLights[lightIndex].bActive == true) && (bUseLightmap == false) && (bUseProbeLight == false))
+            {
+                phongResult += CalcPointLight(pointLights[lightIndex], norm, fragmentPosition, viewDir);   
+                lightsEvaluated++;
+            }
+        } 
+        if((bUseLightmap == false) && (bUseProbeLight == false))
+        {
+            vec3 surfaceColor = (bUseTexture == true) ?
+                vec3(texture(objectTexture, fragmentTextureCoordinateScaled)) : vec3(objectColor);
+            phongResult += pointLightAmbient * surfaceColor;
+        }
+        // static lights baked into the lightmap or the probes replace phases 1 and 2
+        if(bUseLightmap == true)
+        {
+            phongResult += CalcBakedLight();
+        }
+        else if(bUseProbeLight == true)
+        {
+            phongResult += CalcProbeLight(normalize(fragmentWorldNormal));
+        }
+        // phase 3: spot light
+        if(spotLight.bActive == true)
+        {
+            phongResult += CalcSpotLight(spotLight, norm, fragmentPosition, viewDir);    
+            lightsEvaluated++;
+        }
+        // phase 4: reflection of the surroundings
+        if(bUseReflection == true)
+        {
+            vec3 reflectDir = reflect(-viewDir, normalize(fragmentWorldNormal));
+            phongResult = mix(phongResult, texture(environmentMap, reflectDir).rgb, material.reflectivity);
+        }
+    
+        if(bUseTexture == true)
+        {
+            fragmentColor = vec4(phongResult, (texture(objectTexture, fragmentTextureCoordinateScaled)).a);
+        }
+        else
+        {
+            fragmentColor = vec4(phongResult, objectColor.a);
+        }
+    }
+    else
+    {
+        if(bUseTexture == true)
+        {
+            fragmentColor = texture(objectTexture, fragmentTextureCoordinateScaled);
+        }
+        else
+        {
+            fragmentColor = objectColor;
+        }
+    }
+    fragmentColor.rgb *= materialTint;
+
+    // debug views - one per fragment, summed by additive blending,
+    // or the lights evaluated or mip level sampled plus one, with
+    // -1 for an untextured shape
+    if(debugView != DEBUG_VIEW_NONE)
+    {
+        float count = 1.0f;
+        if(debugView == DEBUG_VIEW_LIGHTS)
+        {
+            count = float(lightsEvaluated) + 1.0f;
+        }
+        else if(debugView == DEBUG_VIEW_MIP_LEVEL)
+        {
+            count = (bUseTexture == true) ? CalcMipLevel() + 1.0f : -1.0f;
+        }
+        fragmentColor = vec4(count, 0.0f, 0.0f, 1.0f);
+        return;
+    }
+
+    // weighted blended order-independent transparency - the color is
+    // accumulated with a depth based weight and the alpha coverage is
+    // written into the revealage target, both resolved by the composite
+    if(bWeightedOIT == true)
+    {
+        float alpha = fragmentColor.a;
+        float weight = clamp(pow(min(1.0, alpha * 10.0) + 0.01, 3.0) * 1e8 *
+                             pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+        fragmentColor = vec4(fragmentColor.rgb * alpha, alpha) * weight;
+        fragmentRevealage = alpha;
+    }
+}
+
+// calculates the color when using a directional light.
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir)
+{
+    vec3 ambient = vec3(0.0f);
+    vec3 diffuse = vec3(0.0f);
+    vec3 specular = vec3(0.0f);
+
+    vec3 lightDirection = normalize(-light.direction);
+    // diffuse shading
+    float diff = max(dot(normal, lightDirection), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDirection, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    // combine results
+    if(bUseTexture == true)
+    {
+        ambient = light.ambient * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
+        diffuse = light.diffuse * diff * material.diffuseColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
+        specular = light.specular * spec * material.specularColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
+    }
+    else
+    {
+        ambient = light.ambient * vec3(objectColor);
+        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
+        specular = light.specular * spec * material.specularColor * vec3(objectColor);
+    }
+
+    // the ambient term is not shadowed
+    float shadow = 0.0f;
+    if(bUseShadows == true)
+    {
+        shadow = CalcDirectionalShadow(normal, lightDirection);
+    }
+    
+    return (ambient + (1.0f - shadow) * (diffuse + specular));
+}
+
+// calculates how much of the fragment is hidden from the directional light,
+// filtered over a 3x3 block of hardware compared shadow map samples
+float CalcDirectionalShadow(vec3 normal, vec3 lightDirection)
+{
+    vec3 projected = fragmentPositionLightSpace.xyz / fragmentPositionLightSpace.w;
+    projected = projected * 0.5f + 0.5f;
+
+    // beyond the far plane of the light frustum
+    if(projected.z > 1.0f)
+    {
+        return 0.0f;
+    }
+
+    // slope scaled bias against self shadowing
+    float bias = max(0.005f * (1.0f - dot(normal, lightDirection)), 0.0005f);
+    vec2 texelSize = 1.0f / vec2(textureSize(shadowMap, 0));
+    float lit = 0.0f;
+    for(int x = -1; x <= 1; x++)
+    {
+        for(int y = -1; y <= 1; y++)
+        {
+            lit += texture(shadowMap, vec3(projected.xy + vec2(x, y) * texelSize, projected.z - bias));
+        }
+    }
+
+    return 1.0f - lit / 9.0f;
+}
+
+// calculates the color from the baked diffuse light and the
+// ambient terms of the static lights
+vec3 CalcBakedLight()
+{
+    vec3 surfaceColor = vec3(objectColor);
+    if(bUseTexture == true)
+    {
+        surfaceColor = vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
+    }
+
+    vec3 irradiance = texture(lightmapTexture, CalcLightmapCoordinate()).rgb;
+    return (bakedAmbient + irradiance * material.diffuseColor) * surfaceColor;
+}
+
+// calculates the color from the probe irradiance and the ambient
+// terms of the static lights - same order of the basis functions
+// as IrradianceProbes
+vec3 CalcProbeLight(vec3 normal)
+{
+    vec3 surfaceColor = vec3(objectColor);
+    if(bUseTexture == true)
+    {
+        surfaceColor = vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
+    }
+
+    vec3 irradiance = probeIrradiance[0] * 0.282095f
+        + probeIrradiance[1] * (0.488603f * normal.y)
+        + probeIrradiance[2] * (0.488603f * normal.z)
+        + probeIrradiance[3] * (0.488603f * normal.x)
+        + probeIrradiance[4] * (1.092548f * normal.x * normal.y)
+        + probeIrradiance[5] * (1.092548f * normal.y * normal.z)
+        + probeIrradiance[6] * (0.315392f * (3.0f * normal.z * normal.z - 1.0f))
+        + probeIrradiance[7] * (1.092548f * normal.x * normal.z)
+        + probeIrradiance[8] * (0.546274f * (normal.x * normal.x - normal.y * normal.y));
+
+    return (bakedAmbient + max(irradiance, 0.0f) * material.diffuseColor) * surfaceColor;
+}
+
+// finds the lightmap texel of the fragment - the atlas block of the
+// shape has six tiles, +X -X +Y on the bottom row and -Y +Z -Z on the
+// top, and the tile facing the normal is projected onto the surface.
+// this must stay in step with LightmapBaker::BakeTile()
+vec2 CalcLightmapCoordinate()
+{
+    vec3 boxPosition = (fragmentObjectPosition - lightmapBoundsMin) / (lightmapBoundsMax - lightmapBoundsMin);
+    vec3 facing = abs(fragmentObjectNormal);
+    int tile;
+    vec2 tileCoordinate;
+
+    if((facing.x >= facing.y) && (facing.x >= facing.z))
+    {
+        tile = (fragmentObjectNormal.x >= 0.0f) ? 0 : 1;
+        tileCoordinate = boxPosition.zy;
+    }
+    else if(facing.y >= facing.z)
+    {
+        tile = (fragmentObjectNormal.y >= 0.0f) ? 2 : 3;
+        tileCoordinate = boxPosition.xz;
+    }
+    else
+    {
+        tile = (fragmentObjectNormal.z >= 0.0f) ? 4 : 5;
+        tileCoordinate = boxPosition.xy;
+    }
+
+    // keep inside the gutter so filtering stays within the tile
+    tileCoordinate = lightmapBorder + clamp(tileCoordinate, 0.0f, 1.0f) * (1.0f - 2.0f * lightmapBorder);
+    vec2 blockCoordinate = (vec2(tile % 3, tile / 3) + tileCoordinate) / vec2(3.0f, 2.0f);
+    return lightmapRect.xy + blockCoordinate * lightmapRect.zw;
+}
+
+// calculates the color when using a point light.
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    vec3 diffuse = vec3(0.0f);
+    vec3 specular= vec3(0.0f);
+
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    // Calculate specular component
+    float specularComponent = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+   
+    // combine results - the ambient term is added in main() for all
+    // the point lights at once, so the range does not fade it
+    if(bUseTexture == true)
+    {
+        diffuse = light.diffuse * diff * material.diffuseColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
+        specular = light.specular * specularComponent * material.specularColor;
+    }
+    else
+    {
+        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
+        specular = light.specular * specularComponent * material.specularColor;
+    }
+    
+    return (diffuse + specular) * CalcRangeFalloff(length(light.position - fragPos), light.range);
+}
+
+// calculates the color when using a spot light.
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    vec3 ambient = vec3(0.0f);
+    vec3 diffuse = vec3(0.0f);
+    vec3 specular = vec3(0.0f);
+
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    // attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    attenuation *= CalcRangeFalloff(distance, light.range);
+    // spotlight intensity
+    float theta = dot(lightDir, normalize(-light.direction)); 
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    // combine results
+    if(bUseTexture == true)
+    {
+        ambient = light.ambient * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
+        diffuse = light.diffuse * diff * material.diffuseColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
+        specular = light.specular * spec * material.specularColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
+    }
+    else
+    {
+        ambient = light.ambient * vec3(objectColor);
+        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
+        specular = light.specular * spec * material.specularColor * vec3(objectColor);
+    }
+    
+    ambient *= attenuation * intensity;
+    diffuse *= attenuation * intensity;
+    specular *= attenuation * intensity;
+    return (ambient + diffuse + specular);
+}
+
+// calculates how much of a light is left at a distance, fading smoothly
+// to nothing at its range - a range of zero never fades.  this must
+// match LightmapBaker::GetRangeFalloff()
+float CalcRangeFalloff(float distance, float range)
+{
+    if(range <= 0.0f)
+    {
+        return 1.0f;
+    }
+
+    float ratio = distance / range;
+    float falloff = clamp(1.0f - ratio * ratio * ratio * ratio, 0.0f, 1.0f);
+    return falloff * falloff;
+}
+
+// estimates the mip level the object texture is sampled from, by how
+// many texels the fragment covers - the same as the hardware before
+// anisotropic filtering.  the scene textures are created with
+// GL_LINEAR_MIPMAP_LINEAR, so this is the level the GPU reads, blended
+// with the next one by its fraction
+float CalcMipLevel()
+{
+    vec2 textureSizeTexels = vec2(textureSize(objectTexture, 0));
+    vec2 texelX = dFdx(fragmentTextureCoordinateScaled * textureSizeTexels);
+    vec2 texelY = dFdy(fragmentTextureCoordinateScaled * textureSizeTexels);
+    float level = 0.5f * log2(max(dot(texelX, texelX), dot(texelY, texelY)));
+
+    return clamp(level, 0.0f, floor(log2(max(textureSizeTexels.x, textureSizeTexels.y))));
+}
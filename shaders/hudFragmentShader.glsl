@@ -0,0 +1,14 @@
+#version 330 core
+in vec2 fragmentTextureCoordinate;
+in vec4 fragmentColor;
+
+layout (location = 0) out vec4 outColor;
+
+uniform sampler2D glyphAtlas;
+
+void main()
+{
+   // the atlas holds coverage only - bars sample its solid cell
+   float coverage = texture(glyphAtlas, fragmentTextureCoordinate).r;
+   outColor = vec4(fragmentColor.rgb, fragmentColor.a * coverage);
+}
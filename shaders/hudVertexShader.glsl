@@ -0,0 +1,18 @@
+#version 330 core
+// corners of the overlay glyphs and bars, in pixels from the top left of the window
+layout (location = 0) in vec2 inPosition;
+layout (location = 1) in vec2 inTextureCoordinate;
+layout (location = 2) in vec4 inColor;
+
+out vec2 fragmentTextureCoordinate;
+out vec4 fragmentColor;
+
+uniform vec2 screenSize;
+
+void main()
+{
+   vec2 position = inPosition / screenSize * 2.0f - 1.0f;
+   gl_Position = vec4(position.x, -position.y, 0.0f, 1.0f);
+   fragmentTextureCoordinate = inTextureCoordinate;
+   fragmentColor = inColor;
+}
@@ -0,0 +1,9 @@
+#version 330 core
+out vec4 fragmentColor;
+
+// never runs - the meshes are captured with rasterizing turned
+// off, but the shader manager builds a program from both stages
+void main()
+{
+    fragmentColor = vec4(0.0f);
+}
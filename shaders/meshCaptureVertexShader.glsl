@@ -0,0 +1,20 @@
+#version 330 core
+// lay the captured outputs out in the buffer in the shader,
+// so the program links like any other
+#extension GL_ARB_enhanced_layouts : require
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+// written back into the captured buffer in the same layout
+layout (xfb_buffer = 0, xfb_offset = 0) out vec3 capturedPosition;
+layout (xfb_buffer = 0, xfb_offset = 12) out vec3 capturedNormal;
+layout (xfb_buffer = 0, xfb_offset = 24) out vec2 capturedTextureCoordinate;
+
+void main()
+{
+   capturedPosition = inVertexPosition;
+   capturedNormal = inVertexNormal;
+   capturedTextureCoordinate = inTextureCoordinate;
+   gl_Position = vec4(inVertexPosition, 1.0f);
+}
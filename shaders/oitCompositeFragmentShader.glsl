@@ -0,0 +1,25 @@
+#version 330 core
+out vec4 fragmentColor;
+
+in vec2 fragmentTextureCoordinate;
+
+uniform sampler2D accumTexture;
+uniform sampler2D revealageTexture;
+
+void main()
+{
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float revealage = texelFetch(revealageTexture, texel, 0).r;
+
+    // nothing transparent covers this pixel
+    if(revealage >= 1.0f)
+    {
+        discard;
+    }
+
+    vec4 accum = texelFetch(accumTexture, texel, 0);
+    vec3 averageColor = accum.rgb / max(accum.a, 0.00001f);
+
+    // blended over the opaque scene with SRC_ALPHA, ONE_MINUS_SRC_ALPHA
+    fragmentColor = vec4(averageColor, 1.0f - revealage);
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#version 330 core
+in vec2 fragmentCorner;
+
+layout (location = 0) out vec4 fragmentColor;
+
+void main()
+{
+   // cut the quad down to a round flake
+   float distanceSquared = dot(fragmentCorner, fragmentCorner);
+   if (distanceSquared > 1.0f)
+      discard;
+
+   // a little darker toward the rim so the flakes read as round
+   fragmentColor = vec4(vec3(1.0f - 0.25f * distanceSquared), 1.0f);
+}
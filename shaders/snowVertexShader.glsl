@@ -0,0 +1,22 @@
+#version 330 core
+// one entry of each array per flake - the quad corners come from the vertex index
+layout (location = 0) in float inPositionX;
+layout (location = 1) in float inPositionY;
+layout (location = 2) in float inPositionZ;
+layout (location = 3) in float inSize;
+
+out vec2 fragmentCorner;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+   vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0f - 1.0f;
+   fragmentCorner = corner;
+
+   // grow the quad in view space so it always faces the camera
+   vec4 viewPosition = view * vec4(inPositionX, inPositionY, inPositionZ, 1.0f);
+   viewPosition.xy += corner * inSize;
+   gl_Position = projection * viewPosition;
+}
@@ -0,0 +1,66 @@
+#version 330 core
+// let the vertex shader pick the viewport or layer of each view
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_NV_viewport_array2 : enable
+#extension GL_AMD_vertex_shader_layer : enable
+#extension GL_AMD_vertex_shader_viewport_index : enable
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+out vec4 fragmentPositionLightSpace;
+// untransformed surface, used for finding the lightmap texel
+out vec3 fragmentObjectPosition;
+out vec3 fragmentObjectNormal;
+// normal in world space, used for the irradiance probes
+out vec3 fragmentWorldNormal;
+// view the vertex was drawn for, used for the camera position
+flat out int fragmentViewIndex;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform mat4 lightSpaceMatrix = mat4(1.0f);
+
+// must match MultiViewRenderer::MAX_VIEWS
+#define MAX_VIEWS 6
+// when viewCount is above zero each instance of a draw is one
+// view, drawn into its own viewport, or its own layer when
+// bLayeredViews is set
+uniform int viewCount = 0;
+uniform bool bLayeredViews = false;
+uniform mat4 viewMatrices[MAX_VIEWS];
+uniform mat4 projectionMatrices[MAX_VIEWS];
+
+// must match depthVertexShader.glsl exactly for the depth pre-pass
+invariant gl_Position;
+
+void main()
+{
+   // the same statement as depthVertexShader.glsl, ahead of any
+   // branch, so the single view pass can test GL_EQUAL against the
+   // pre-pass - only the views drawn together replace it
+   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
+   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
+   fragmentViewIndex = 0;
+   if (viewCount > 0)
+   {
+      fragmentViewIndex = gl_InstanceID % viewCount;
+      gl_Position = projectionMatrices[fragmentViewIndex] * viewMatrices[fragmentViewIndex] * model * vec4(inVertexPosition, 1.0f);
+#if defined(GL_ARB_shader_viewport_layer_array) || defined(GL_NV_viewport_array2) || (defined(GL_AMD_vertex_shader_layer) && defined(GL_AMD_vertex_shader_viewport_index))
+      if (bLayeredViews == true)
+         gl_Layer = fragmentViewIndex;
+      else
+         gl_ViewportIndex = fragmentViewIndex;
+#endif
+   }
+   fragmentVertexNormal = inVertexNormal;
+   fragmentTextureCoordinate = inTextureCoordinate;
+   fragmentPositionLightSpace = lightSpaceMatrix * model * vec4(inVertexPosition, 1.0f);
+   fragmentObjectPosition = inVertexPosition;
+   fragmentObjectNormal = inVertexNormal;
+   fragmentWorldNormal = transpose(inverse(mat3(model))) * inVertexNormal;
+}
\ No newline at end of file